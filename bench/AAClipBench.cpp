@@ -12,6 +12,8 @@
 #include "SkString.h"
 #include "SkCanvas.h"
 #include "SkRandom.h"
+#include "SkRRect.h"
+#include "SkTArray.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // This bench tests out AA/BW clipping via canvas' clipPath and clipRect calls
@@ -88,8 +90,13 @@ private:
 class NestedAAClipBench : public SkBenchmark {
     SkString fName;
     bool     fDoAA;
+    bool     fReusePaths;
     SkRect   fDrawRect;
     SkRandom fRandom;
+    // when reusing, the clip paths made by the first loop, in the order they
+    // are clipped to, as a picture or a UI drawing the same frame again has
+    SkTArray<SkPath> fPaths;
+    int      fPathIndex;
 
     static const int kNestingDepth = 3;
     static const int kImageSize = 400;
@@ -97,8 +104,11 @@ class NestedAAClipBench : public SkBenchmark {
     SkPoint fSizes[kNestingDepth+1];
 
 public:
-    NestedAAClipBench(bool doAA) : fDoAA(doAA) {
-        fName.printf("nested_aaclip_%s", doAA ? "AA" : "BW");
+    NestedAAClipBench(bool doAA, bool reusePaths = false)
+        : fDoAA(doAA)
+        , fReusePaths(reusePaths)
+        , fPathIndex(0) {
+        fName.printf("nested_aaclip_%s%s", doAA ? "AA" : "BW", reusePaths ? "_reuse" : "");
 
         fDrawRect = SkRect::MakeLTRB(0, 0,
                                      SkIntToScalar(kImageSize),
@@ -125,11 +135,20 @@ protected:
                                            fSizes[depth].fX, fSizes[depth].fY);
             temp.offset(offset);
 
-            SkPath path;
-            path.addRoundRect(temp, SkIntToScalar(3), SkIntToScalar(3));
-            SkASSERT(path.isConvex());
+            SkPath newPath;
+            const SkPath* path = &newPath;
+            if (fReusePaths && fPathIndex < fPaths.count()) {
+                path = &fPaths[fPathIndex];
+            } else {
+                newPath.addRoundRect(temp, SkIntToScalar(3), SkIntToScalar(3));
+                if (fReusePaths) {
+                    path = &fPaths.push_back(newPath);
+                }
+            }
+            fPathIndex += 1;
+            SkASSERT(path->isConvex());
 
-            canvas->clipPath(path,
+            canvas->clipPath(*path,
                              0 == depth ? SkRegion::kReplace_Op :
                                           SkRegion::kIntersect_Op,
                              fDoAA);
@@ -162,6 +181,7 @@ protected:
 
         for (int i = 0; i < loops; ++i) {
             SkPoint offset = SkPoint::Make(0, 0);
+            fPathIndex = 0;
             this->recurse(canvas, 0, offset);
         }
     }
@@ -170,6 +190,63 @@ private:
     typedef SkBenchmark INHERITED;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// This bench clips to a pair of nested rects and round rects, as a UI does for a
+// rounded card and the content scrolled inside it, which reduce to one of them.
+class ReducedAAClipBench : public SkBenchmark {
+public:
+    enum Type {
+        kRectRect_Type,     // an AA rect and an overlapping BW rect
+        kRRectRect_Type,    // a rect inside a round rect
+        kRectRRect_Type,    // a round rect inside a rect
+    };
+
+private:
+    SkString fName;
+    Type     fType;
+    SkRRect  fCard;
+    SkRect   fContent;
+
+public:
+    ReducedAAClipBench(Type type) : fType(type) {
+        static const char* gNames[] = { "rect_rect", "rrect_rect", "rect_rrect" };
+        fName.printf("aaclip_reduce_%s", gNames[type]);
+
+        fCard.setRectXY(SkRect::MakeLTRB(20.5f, 20.5f, 380.5f, 380.5f), 12, 12);
+        fContent = SkRect::MakeLTRB(40.25f, 40.25f, 360.75f, 360.75f);
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+    virtual void onDraw(const int loops, SkCanvas* canvas) {
+        SkPaint paint;
+        this->setupPaint(&paint);
+
+        for (int i = 0; i < loops; ++i) {
+            canvas->save();
+            switch (fType) {
+                case kRectRect_Type:
+                    canvas->clipRect(fCard.rect(), SkRegion::kIntersect_Op, true);
+                    canvas->clipRect(fContent.makeOffset(100, 0), SkRegion::kIntersect_Op, false);
+                    break;
+                case kRRectRect_Type:
+                    canvas->clipRRect(fCard, SkRegion::kIntersect_Op, true);
+                    canvas->clipRect(fContent, SkRegion::kIntersect_Op, true);
+                    break;
+                case kRectRRect_Type:
+                    canvas->clipRect(fContent, SkRegion::kIntersect_Op, true);
+                    canvas->clipRRect(fCard, SkRegion::kIntersect_Op, true);
+                    break;
+            }
+            // draw a corner of the clip, so that most of the time is clipping
+            canvas->drawRect(SkRect::MakeXYWH(0, 0, 50, 50), paint);
+            canvas->restore();
+        }
+    }
+private:
+    typedef SkBenchmark INHERITED;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 class AAClipBuilderBench : public SkBenchmark {
     SkString fName;
@@ -249,9 +326,14 @@ DEF_BENCH( return SkNEW_ARGS(AAClipBuilderBench, (false, true)); )
 DEF_BENCH( return SkNEW_ARGS(AAClipBuilderBench, (true, false)); )
 DEF_BENCH( return SkNEW_ARGS(AAClipBuilderBench, (true, true)); )
 DEF_BENCH( return SkNEW_ARGS(AAClipRegionBench, ()); )
+DEF_BENCH( return SkNEW_ARGS(ReducedAAClipBench, (ReducedAAClipBench::kRectRect_Type)); )
+DEF_BENCH( return SkNEW_ARGS(ReducedAAClipBench, (ReducedAAClipBench::kRRectRect_Type)); )
+DEF_BENCH( return SkNEW_ARGS(ReducedAAClipBench, (ReducedAAClipBench::kRectRRect_Type)); )
 DEF_BENCH( return SkNEW_ARGS(AAClipBench, (false, false)); )
 DEF_BENCH( return SkNEW_ARGS(AAClipBench, (false, true)); )
 DEF_BENCH( return SkNEW_ARGS(AAClipBench, (true, false)); )
 DEF_BENCH( return SkNEW_ARGS(AAClipBench, (true, true)); )
 DEF_BENCH( return SkNEW_ARGS(NestedAAClipBench, (false)); )
 DEF_BENCH( return SkNEW_ARGS(NestedAAClipBench, (true)); )
+DEF_BENCH( return SkNEW_ARGS(NestedAAClipBench, (false, true)); )
+DEF_BENCH( return SkNEW_ARGS(NestedAAClipBench, (true, true)); )
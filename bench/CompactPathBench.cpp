@@ -0,0 +1,155 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBenchmark.h"
+#include "SkBitmap.h"
+#include "SkCompactPath.h"
+#include "SkCoreBlitters.h"
+#include "SkPath.h"
+#include "SkRandom.h"
+#include "SkRasterClip.h"
+#include "SkScan.h"
+#include "SkString.h"
+#include "SkTArray.h"
+
+enum {
+    kTileSize = 512,
+    kPathCount = 500,
+};
+
+// Many small shapes across a tile, like the buildings and roads of a map.
+static void make_tile_paths(SkTArray<SkPath>* paths) {
+    SkRandom rand;
+    for (int i = 0; i < kPathCount; ++i) {
+        SkPath& path = paths->push_back();
+        SkScalar x = rand.nextRangeScalar(0, kTileSize);
+        SkScalar y = rand.nextRangeScalar(0, kTileSize);
+        path.moveTo(x, y);
+        int count = rand.nextRangeU(4, 40);
+        for (int j = 0; j < count; ++j) {
+            x = SkScalarPin(x + rand.nextRangeScalar(-12, 12), 0, kTileSize);
+            y = SkScalarPin(y + rand.nextRangeScalar(-12, 12), 0, kTileSize);
+            if (0 == (i & 7) && (j & 1)) {
+                path.quadTo(x + rand.nextRangeScalar(-4, 4), y + rand.nextRangeScalar(-4, 4),
+                            x, y);
+            } else {
+                path.lineTo(x, y);
+            }
+        }
+        path.close();
+    }
+}
+
+/**
+ *  Fills the paths of a tile into a mask, from the paths or from their compact
+ *  copies.
+ */
+class CompactPathFillBench : public SkBenchmark {
+    SkString                        fName;
+    const bool                      fCompact;
+    const bool                      fDoAA;
+    SkTArray<SkPath>                fPaths;
+    SkTArray<SkCompactPath*>        fCompactPaths;
+    SkBitmap                        fMask;
+
+public:
+    CompactPathFillBench(bool compact, bool doAA) : fCompact(compact), fDoAA(doAA) {
+        fName.printf("compactpath_fill_%s_%s", compact ? "compact" : "path", doAA ? "aa" : "bw");
+    }
+
+    virtual ~CompactPathFillBench() {
+        for (int i = 0; i < fCompactPaths.count(); ++i) {
+            fCompactPaths[i]->unref();
+        }
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        make_tile_paths(&fPaths);
+        if (fCompact) {
+            for (int i = 0; i < fPaths.count(); ++i) {
+                fCompactPaths.push_back(SkCompactPath::Create(fPaths[i]));
+            }
+            fPaths.reset();
+        }
+        fMask.allocPixels(SkImageInfo::MakeA8(kTileSize, kTileSize));
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        const SkRasterClip clip(SkIRect::MakeWH(kTileSize, kTileSize));
+        SkPaint paint;
+        SkA8_Coverage_Blitter blitter(fMask, paint);
+        for (int i = 0; i < loops; ++i) {
+            if (fCompact) {
+                for (int j = 0; j < fCompactPaths.count(); ++j) {
+                    if (fDoAA) {
+                        SkScan::AntiFillPath(*fCompactPaths[j], clip, &blitter);
+                    } else {
+                        SkScan::FillPath(*fCompactPaths[j], clip, &blitter);
+                    }
+                }
+            } else {
+                for (int j = 0; j < fPaths.count(); ++j) {
+                    if (fDoAA) {
+                        SkScan::AntiFillPath(fPaths[j], clip, &blitter);
+                    } else {
+                        SkScan::FillPath(fPaths[j], clip, &blitter);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+/**
+ *  Makes the compact copies of the paths of a tile.
+ */
+class CompactPathCreateBench : public SkBenchmark {
+    SkTArray<SkPath> fPaths;
+
+public:
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return "compactpath_create";
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        make_tile_paths(&fPaths);
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        for (int i = 0; i < loops; ++i) {
+            for (int j = 0; j < fPaths.count(); ++j) {
+                SkCompactPath::Create(fPaths[j])->unref();
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+DEF_BENCH( return SkNEW_ARGS(CompactPathFillBench, (false, false)); )
+DEF_BENCH( return SkNEW_ARGS(CompactPathFillBench, (true, false)); )
+DEF_BENCH( return SkNEW_ARGS(CompactPathFillBench, (false, true)); )
+DEF_BENCH( return SkNEW_ARGS(CompactPathFillBench, (true, true)); )
+DEF_BENCH( return SkNEW(CompactPathCreateBench); )
@@ -9,6 +9,7 @@
 #include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkDashPathEffect.h"
+#include "SkGraphics.h"
 #include "SkPaint.h"
 #include "SkPath.h"
 #include "SkRandom.h"
@@ -440,6 +441,58 @@ private:
     typedef SkBenchmark INHERITED;
 };
 
+// Draws the dashed gridlines of a spreadsheet as one path, again and again, with
+// and without the cache of dash outlines.
+class DashGridPathBench : public SkBenchmark {
+    SkString fName;
+    SkPath   fPath;
+    bool     fCached;
+
+    SkAutoTUnref<SkPathEffect> fPathEffect;
+
+public:
+    DashGridPathBench(bool cached) : fCached(cached) {
+        fName.printf("dashgrid_path_%s", cached ? "cached" : "uncached");
+
+        for (int i = 0; i <= 20; ++i) {
+            SkScalar pos = 20.5f + i * 22.f;
+            fPath.moveTo(20.5f, pos);
+            fPath.lineTo(460.5f, pos);
+            fPath.moveTo(pos, 20.5f);
+            fPath.lineTo(pos, 460.5f);
+        }
+
+        SkScalar vals[] = { SkIntToScalar(3), SkIntToScalar(3) };
+        fPathEffect.reset(SkDashPathEffect::Create(vals, 2, 0));
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        SkPaint p;
+        this->setupPaint(&p);
+        p.setColor(SK_ColorBLACK);
+        p.setStyle(SkPaint::kStroke_Style);
+        p.setStrokeWidth(SK_Scalar1);
+        p.setPathEffect(fPathEffect);
+
+        size_t limit = SkGraphics::GetStrokeCacheByteLimit();
+        if (!fCached) {
+            SkGraphics::SetStrokeCacheByteLimit(0);
+        }
+        for (int i = 0; i < loops; ++i) {
+            canvas->drawPath(fPath, p);
+        }
+        SkGraphics::SetStrokeCacheByteLimit(limit);
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static const SkScalar gDots[] = { SK_Scalar1, SK_Scalar1 };
@@ -487,3 +540,6 @@ DEF_BENCH( return new DashGridBench(1, 1, false); )
 DEF_BENCH( return new DashGridBench(3, 1, true); )
 DEF_BENCH( return new DashGridBench(3, 1, false); )
 #endif
+
+DEF_BENCH( return new DashGridPathBench(true); )
+DEF_BENCH( return new DashGridPathBench(false); )
@@ -7,10 +7,16 @@
  */
 #include "SkBenchmark.h"
 #include "SkBitmap.h"
+#include "SkColorPriv.h"
 #include "SkCommandLineFlags.h"
+#include "SkData.h"
 #include "SkImageDecoder.h"
+#include "SkImageEncoder.h"
 #include "SkOSFile.h"
+#include "SkRandom.h"
+#include "SkStream.h"
 #include "SkString.h"
+#include "SkThreadPool.h"
 #include "sk_tool_utils.h"
 
 DEFINE_string(decodeBenchFilename, "resources/CMYK.jpeg", "Path to image for DecodeBench.");
@@ -48,3 +54,79 @@ private:
 DEF_BENCH( return new DecodeBench(kN32_SkColorType); )
 DEF_BENCH( return new DecodeBench(kRGB_565_SkColorType); )
 DEF_BENCH( return new DecodeBench(kARGB_4444_SkColorType); )
+
+/**
+ *  Decodes a large (12 MP) JPEG, generated at setup, on one thread or on
+ *  several threads. Images encoded by Skia have a restart marker after every
+ *  row of MCUs, which lets the decoder split them into bands.
+ */
+class DecodeLargeJpegBench : public SkBenchmark {
+    enum {
+        kWidth = 4000,
+        kHeight = 3000,
+    };
+    const int               fThreadCount;
+    SkString                fName;
+    SkAutoTUnref<SkData>    fEncoded;
+public:
+    DecodeLargeJpegBench(int threadCount) : fThreadCount(threadCount) {
+        if (threadCount < 0) {
+            fName.set("decode_large_jpeg_threads_per_core");
+        } else {
+            fName.printf("decode_large_jpeg_threads_%d", threadCount);
+        }
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        // A photo-like mix of smooth gradients and noise.
+        SkBitmap bm;
+        bm.allocN32Pixels(kWidth, kHeight);
+        SkRandom rand;
+        for (int y = 0; y < kHeight; ++y) {
+            SkPMColor* row = bm.getAddr32(0, y);
+            for (int x = 0; x < kWidth; ++x) {
+                const U8CPU noise = rand.nextU() & 0x1F;
+                row[x] = SkPackARGB32(0xFF, (x >> 4) & 0xFF, (y >> 4) & 0xFF,
+                                      (((x + y) >> 5) & 0xFF) ^ noise);
+            }
+        }
+        SkAutoTDelete<SkImageEncoder> encoder(SkImageEncoder::Create(SkImageEncoder::kJPEG_Type));
+        if (encoder.get()) {
+            encoder->setJPEGRestartRows(1);
+            fEncoded.reset(encoder->encodeData(bm, 90));
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        if (NULL == fEncoded.get()) {
+            return;
+        }
+        for (int i = 0; i < loops; i++) {
+            SkMemoryStream stream(fEncoded);
+            SkAutoTDelete<SkImageDecoder> decoder(SkImageDecoder::Factory(&stream));
+            if (NULL == decoder.get()) {
+                return;
+            }
+            stream.rewind();
+            decoder->setThreadCount(fThreadCount);
+            SkBitmap bm;
+            decoder->decode(&stream, &bm, kN32_SkColorType, SkImageDecoder::kDecodePixels_Mode);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+DEF_BENCH( return new DecodeLargeJpegBench(1); )
+DEF_BENCH( return new DecodeLargeJpegBench(4); )
+DEF_BENCH( return new DecodeLargeJpegBench(SkThreadPool::kThreadPerCore); )
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBenchmark.h"
+#include "SkCanvas.h"
+#include "SkDistanceFieldGen.h"
+#include "SkPaint.h"
+#include "SkString.h"
+#include "SkTemplates.h"
+#include "SkThreadPool.h"
+
+// A glyph-like image: an antialiased ring.
+static void make_ring(unsigned char* image, int size) {
+    const float center = size * 0.5f;
+    const float outer = size * 0.45f;
+    const float inner = size * 0.3f;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const float dx = x + 0.5f - center;
+            const float dy = y + 0.5f - center;
+            const float dist = sqrtf(dx*dx + dy*dy);
+            const float coverage = SkScalarPin(SkTMin(outer - dist, dist - inner) + 0.5f, 0, 1);
+            image[y*size + x] = (unsigned char)(coverage * 255);
+        }
+    }
+}
+
+class GenerateRowsProc : public SkRunnable {
+public:
+    GenerateRowsProc(unsigned char* field, const unsigned char* image, int size,
+                     int startRow, int rowCount)
+        : fField(field)
+        , fImage(image)
+        , fSize(size)
+        , fStartRow(startRow)
+        , fRowCount(rowCount) {}
+
+    virtual void run() SK_OVERRIDE {
+        const int fieldWidth = fSize + 2*SK_DistanceFieldPad;
+        SkGenerateDistanceFieldRowsFromA8Image(fField + fStartRow*fieldWidth, fImage,
+                                               fSize, fSize, fSize, fStartRow, fRowCount);
+    }
+
+private:
+    unsigned char*          fField;
+    const unsigned char*    fImage;
+    const int               fSize;
+    const int               fStartRow;
+    const int               fRowCount;
+};
+
+/**
+ *  Generates the distance field of a glyph-sized or a large image, in one pass or in
+ *  bands of rows on several threads.
+ */
+class DistanceFieldGenBench : public SkBenchmark {
+    const int                       fSize;
+    const int                       fThreadCount;
+    SkString                        fName;
+    SkAutoTMalloc<unsigned char>    fImage;
+    SkAutoTMalloc<unsigned char>    fField;
+public:
+    DistanceFieldGenBench(int size, int threadCount)
+        : fSize(size)
+        , fThreadCount(threadCount)
+        , fImage(size * size)
+        , fField(SkComputeDistanceFieldSize(size, size)) {
+        fName.printf("distance_field_gen_%d", size);
+        if (threadCount > 0) {
+            fName.appendf("_threads_%d", threadCount);
+        }
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        make_ring(fImage.get(), fSize);
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        for (int i = 0; i < loops; ++i) {
+            if (fThreadCount > 0) {
+                const int fieldHeight = fSize + 2*SK_DistanceFieldPad;
+                SkThreadPool pool(fThreadCount);
+                for (int j = 0; j < fThreadCount; ++j) {
+                    const int startRow = fieldHeight * j / fThreadCount;
+                    const int endRow = fieldHeight * (j + 1) / fThreadCount;
+                    pool.add(SkNEW_ARGS(GenerateRowsProc, (fField.get(), fImage.get(), fSize,
+                                                           startRow, endRow - startRow)));
+                }
+                pool.wait();
+            } else {
+                SkGenerateDistanceFieldFromA8Image(fField.get(), fImage.get(),
+                                                   fSize, fSize, fSize);
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+/**
+ *  Draws large text at a different size each time, as when zooming, from the glyphs'
+ *  masks or from their distance fields. Masks are rasterized (and cached) for each size;
+ *  the distance fields are made once and scaled.
+ */
+class DistanceFieldTextBench : public SkBenchmark {
+    enum {
+        kSizeCount = 1600,
+    };
+    const bool  fDistanceField;
+    SkString    fName;
+    SkPaint     fPaint;
+public:
+    DistanceFieldTextBench(bool distanceField) : fDistanceField(distanceField) {
+        fName.printf("text_zoom_%s", distanceField ? "distance_field" : "mask");
+        fPaint.setAntiAlias(true);
+        fPaint.setDistanceFieldTextTEMP(distanceField);
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        static const char kText[] = "Hamburgefons";
+        for (int i = 0; i < loops; ++i) {
+            // sizes from 40 to 200, in steps of 0.1
+            fPaint.setTextSize(SkIntToScalar(40) + SkIntToScalar(i % kSizeCount) / 10);
+            canvas->drawText(kText, sizeof(kText) - 1, 0, 200, fPaint);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+DEF_BENCH( return new DistanceFieldGenBench(64, 0); )
+DEF_BENCH( return new DistanceFieldGenBench(512, 0); )
+DEF_BENCH( return new DistanceFieldGenBench(512, 4); )
+DEF_BENCH( return new DistanceFieldGenBench(512, 1); )
+
+DEF_BENCH( return new DistanceFieldTextBench(false); )
+DEF_BENCH( return new DistanceFieldTextBench(true); )
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#include "SkBenchmark.h"
+#include "SkBitmap.h"
+#include "SkColorPriv.h"
+#include "SkData.h"
+#include "SkImageEncoder.h"
+#include "SkRandom.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkThreadPool.h"
+
+/**
+ *  Encodes a generated 1024x768 image as PNG with the given preset on the
+ *  given number of threads. The image has smooth gradients, noise and
+ *  translucent areas, so that the filters, zlib and the scanline transforms
+ *  all do real work.
+ */
+class PNGEncodeBench : public SkBenchmark {
+    enum {
+        kWidth = 1024,
+        kHeight = 768,
+    };
+    const SkImageEncoder::Preset    fPreset;
+    const int                       fThreadCount;
+    SkString                        fName;
+    SkBitmap                        fBitmap;
+public:
+    PNGEncodeBench(SkImageEncoder::Preset preset, int threadCount)
+        : fPreset(preset)
+        , fThreadCount(threadCount) {
+        static const char* const gPresetNames[] = { "default", "fast", "small" };
+        fName.printf("encode_png_%s", gPresetNames[preset]);
+        if (threadCount < 0) {
+            fName.append("_threads_per_core");
+        } else {
+            fName.appendf("_threads_%d", threadCount);
+        }
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        fBitmap.allocN32Pixels(kWidth, kHeight);
+        SkRandom rand;
+        for (int y = 0; y < kHeight; ++y) {
+            SkPMColor* row = fBitmap.getAddr32(0, y);
+            for (int x = 0; x < kWidth; ++x) {
+                // A translucent band across the top of the image.
+                const U8CPU a = y < kHeight / 8 ? (x >> 2) & 0xFF : 0xFF;
+                const U8CPU noise = rand.nextU() & 0x7;
+                row[x] = SkPreMultiplyARGB(a, (x >> 2) & 0xFF, ((y >> 2) + noise) & 0xFF,
+                                           ((x + y) >> 3) & 0xFF);
+            }
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        SkAutoTDelete<SkImageEncoder> encoder(SkImageEncoder::Create(SkImageEncoder::kPNG_Type));
+        if (NULL == encoder.get()) {
+            return;
+        }
+        encoder->setPreset(fPreset);
+        encoder->setThreadCount(fThreadCount);
+        for (int i = 0; i < loops; i++) {
+            SkDynamicMemoryWStream stream;
+            encoder->encodeStream(&stream, fBitmap, SkImageEncoder::kDefaultQuality);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+DEF_BENCH( return new PNGEncodeBench(SkImageEncoder::kDefault_Preset, 1); )
+DEF_BENCH( return new PNGEncodeBench(SkImageEncoder::kFast_Preset, 1); )
+DEF_BENCH( return new PNGEncodeBench(SkImageEncoder::kSmall_Preset, 1); )
+DEF_BENCH( return new PNGEncodeBench(SkImageEncoder::kDefault_Preset,
+                                     SkThreadPool::kThreadPerCore); )
+DEF_BENCH( return new PNGEncodeBench(SkImageEncoder::kFast_Preset,
+                                     SkThreadPool::kThreadPerCore); )
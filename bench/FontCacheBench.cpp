@@ -8,6 +8,7 @@
 #include "SkBenchmark.h"
 #include "SkCanvas.h"
 #include "SkFontHost.h"
+#include "SkGraphics.h"
 #include "SkPaint.h"
 #include "SkString.h"
 #include "SkTemplates.h"
@@ -53,6 +54,63 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ *  Draws the glyphs at several sizes, with the font cache limited so that
+ *  they do not all fit in it unless their images are run-length encoded.
+ *  Compare the two to see the cost of drawing from the encoded images, and
+ *  what keeping more glyphs in the cache saves.
+ */
+class FontCacheDrawBench : public SkBenchmark {
+    const bool  fCompress;
+    size_t      fPrevLimit;
+    bool        fPrevCompress;
+public:
+    explicit FontCacheDrawBench(bool compress) : fCompress(compress) {}
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fCompress ? "fontcache_draw_rle" : "fontcache_draw";
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        fPrevLimit = SkGraphics::SetFontCacheLimit(kCacheLimit);
+        fPrevCompress = SkGraphics::SetFontCacheCompression(fCompress);
+        SkGraphics::PurgeFontCache();
+    }
+
+    virtual void onPostDraw() SK_OVERRIDE {
+        SkGraphics::SetFontCacheCompression(fPrevCompress);
+        SkGraphics::SetFontCacheLimit(fPrevLimit);
+        SkGraphics::PurgeFontCache();
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        static const SkScalar kSizes[] = { 12, 24, 48, 72 };
+        SkPaint paint;
+        this->setupPaint(&paint);
+        paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+
+        for (int i = 0; i < loops; ++i) {
+            const uint16_t* array = gUniqueGlyphIDs;
+            while (*array != gUniqueGlyphIDs_Sentinel) {
+                const int count = count_glyphs(array);
+                for (size_t j = 0; j < SK_ARRAY_COUNT(kSizes); ++j) {
+                    paint.setTextSize(kSizes[j]);
+                    canvas->drawText(array, count * sizeof(uint16_t), 0, kSizes[j], paint);
+                }
+                array += count + 1;    // skip the sentinel
+            }
+        }
+    }
+
+private:
+    static const size_t kCacheLimit = 768 * 1024;
+
+    typedef SkBenchmark INHERITED;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 static uint32_t rotr(uint32_t value, unsigned bits) {
     return (value >> bits) | (value << (32 - bits));
 }
@@ -153,6 +211,8 @@ private:
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new FontCacheBench(); )
+DEF_BENCH( return new FontCacheDrawBench(false); )
+DEF_BENCH( return new FontCacheDrawBench(true); )
 
 // undefine this to run the efficiency test
 //DEF_BENCH( return new FontCacheEfficiency(); )
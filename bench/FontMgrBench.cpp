@@ -0,0 +1,74 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBenchmark.h"
+#include "SkFontMgr.h"
+#include "SkFontStyle.h"
+#include "SkString.h"
+#include "SkTArray.h"
+#include "SkTypeface.h"
+
+/**
+ *  Matches typefaces by family and style, or by a character for fallback, with
+ *  the default font manager. With fontconfig, the queries are answered by the
+ *  font index when SK_FONT_INDEX_PATH names an up to date one.
+ */
+class FontMgrMatchBench : public SkBenchmark {
+    const bool                  fCharacter;
+    SkString                    fName;
+    SkAutoTUnref<SkFontMgr>     fMgr;
+    SkTArray<SkString>          fFamilies;
+public:
+    explicit FontMgrMatchBench(bool character) : fCharacter(character) {
+        fName.printf("fontmgr_match_%s", character ? "character" : "family_style");
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        fMgr.reset(SkFontMgr::RefDefault());
+        fFamilies.reset();
+        for (int i = 0; i < fMgr->countFamilies(); ++i) {
+            fMgr->getFamilyName(i, &fFamilies.push_back());
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        static const SkUnichar gChars[] = { 'A', 0xE9, 0x3B1, 0x416, 0x5D0, 0x4E2D, 0x1F600 };
+        if (fFamilies.empty()) {
+            return;
+        }
+        for (int i = 0; i < loops; ++i) {
+            const char* family = fFamilies[i % fFamilies.count()].c_str();
+            const SkFontStyle style(i & 1 ? SkFontStyle::kBold_Weight : SkFontStyle::kNormal_Weight,
+                                    SkFontStyle::kNormal_Width,
+                                    i & 2 ? SkFontStyle::kItalic_Slant
+                                          : SkFontStyle::kUpright_Slant);
+            SkTypeface* face;
+            if (fCharacter) {
+                face = fMgr->matchFamilyStyleCharacter(family, style, NULL,
+                                                       gChars[i % SK_ARRAY_COUNT(gChars)]);
+            } else {
+                face = fMgr->matchFamilyStyle(family, style);
+            }
+            SkSafeUnref(face);
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+DEF_BENCH( return new FontMgrMatchBench(false); )
+DEF_BENCH( return new FontMgrMatchBench(true); )
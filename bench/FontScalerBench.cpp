@@ -6,40 +6,100 @@
  */
 
 #include "SkBenchmark.h"
+#include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkGraphics.h"
 #include "SkPaint.h"
-#include "SkRandom.h"
+#include "SkRunnable.h"
 #include "SkString.h"
+#include "SkTArray.h"
+#include "SkThreadPool.h"
+#include "SkTypeface.h"
 
+static void draw_sizes(SkCanvas* canvas, const SkString& text, const SkPaint& paint) {
+    SkPaint p(paint);
+    for (int ps = 9; ps <= 24; ps += 2) {
+        p.setTextSize(SkIntToScalar(ps));
+        canvas->drawText(text.c_str(), text.size(), 0, SkIntToScalar(20), p);
+    }
+}
+
+// Draws the text with one typeface into a canvas of its own, on a pool thread.
+class DrawSizesProc : public SkRunnable {
+public:
+    DrawSizesProc(const SkString& text, const SkPaint& paint) : fText(text), fPaint(paint) {}
+
+    virtual void run() SK_OVERRIDE {
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(640, 32);
+        SkCanvas canvas(bitmap);
+        draw_sizes(&canvas, fText, fPaint);
+    }
+
+private:
+    const SkString& fText;
+    const SkPaint&  fPaint;
+};
+
+/**
+ *  Times the creation of glyphs. With more than one thread, each thread draws
+ *  with a different typeface, so that the font host can generate the glyphs
+ *  of different faces concurrently.
+ */
 class FontScalerBench : public SkBenchmark {
     SkString fName;
     SkString fText;
     bool     fDoLCD;
+    int      fThreadCount;
+    SkTArray<SkPaint> fPaints;
 public:
-    FontScalerBench(bool doLCD)  {
+    FontScalerBench(bool doLCD, int threadCount = 1)  {
         fName.printf("fontscaler_%s", doLCD ? "lcd" : "aa");
+        if (threadCount > 1) {
+            fName.appendf("_threads_%d", threadCount);
+        }
         fText.set("abcdefghijklmnopqrstuvwxyz01234567890");
         fDoLCD = doLCD;
+        fThreadCount = threadCount;
     }
 
 protected:
     virtual const char* onGetName() { return fName.c_str(); }
-    virtual void onDraw(const int loops, SkCanvas* canvas) {
-        SkPaint paint;
-        this->setupPaint(&paint);
-        paint.setLCDRenderText(fDoLCD);
 
+    virtual void onPreDraw() SK_OVERRIDE {
+        static const char* gFamilies[] = { "serif", "sans-serif", "monospace", "cursive" };
+        static const SkTypeface::Style gStyles[] = {
+            SkTypeface::kNormal, SkTypeface::kBold, SkTypeface::kItalic, SkTypeface::kBoldItalic
+        };
+        fPaints.reset();
+        for (int i = 0; i < fThreadCount; ++i) {
+            SkPaint& paint = fPaints.push_back();
+            this->setupPaint(&paint);
+            paint.setLCDRenderText(fDoLCD);
+            if (fThreadCount > 1) {
+                const int family = i % SK_ARRAY_COUNT(gFamilies);
+                const int style = (i / SK_ARRAY_COUNT(gFamilies)) % SK_ARRAY_COUNT(gStyles);
+                SkSafeUnref(paint.setTypeface(SkTypeface::CreateFromName(gFamilies[family],
+                                                                         gStyles[style])));
+            }
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) {
         for (int i = 0; i < loops; i++) {
             // this is critical - we want to time the creation process, so we
             // explicitly flush our cache before each run
             SkGraphics::PurgeFontCache();
 
-            for (int ps = 9; ps <= 24; ps += 2) {
-                paint.setTextSize(SkIntToScalar(ps));
-                canvas->drawText(fText.c_str(), fText.size(),
-                        0, SkIntToScalar(20), paint);
+            if (1 == fThreadCount) {
+                draw_sizes(canvas, fText, fPaints[0]);
+                continue;
+            }
+            SkThreadPool pool(fThreadCount);
+            for (int t = 0; t < fThreadCount; ++t) {
+                pool.add(SkNEW_ARGS(DrawSizesProc, (fText, fPaints[t])));
             }
+            pool.wait();
         }
     }
 private:
@@ -50,3 +110,5 @@ private:
 
 DEF_BENCH( return SkNEW_ARGS(FontScalerBench, (false)); )
 DEF_BENCH( return SkNEW_ARGS(FontScalerBench, (true)); )
+DEF_BENCH( return SkNEW_ARGS(FontScalerBench, (false, 4)); )
+DEF_BENCH( return SkNEW_ARGS(FontScalerBench, (false, 16)); )
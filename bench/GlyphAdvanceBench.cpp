@@ -0,0 +1,109 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBenchmark.h"
+#include "SkGlyphAdvanceTable.h"
+#include "SkGraphics.h"
+#include "SkPaint.h"
+#include "SkTypeface.h"
+
+// Large fonts, whose glyphs are spread across many pages of the table. The
+// default typeface is used if none of them is installed.
+static const char* const kCJKFamilies[] = {
+    "Noto Sans CJK SC",
+    "Source Han Sans",
+    "Droid Sans Fallback",
+    "WenQuanYi Zen Hei",
+    "AR PL UMing CN",
+};
+
+static SkTypeface* create_large_typeface() {
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kCJKFamilies); ++i) {
+        SkTypeface* typeface = SkTypeface::CreateFromName(kCJKFamilies[i],
+                                                          SkTypeface::kNormal);
+        if (typeface && typeface->countGlyphs() > 10000) {
+            return typeface;
+        }
+        SkSafeUnref(typeface);
+    }
+    return SkTypeface::RefDefault();
+}
+
+/*  Gets the advances, in font units, of the glyphs a document in a large
+    font might use: one in every few of its glyphs, in order, as
+    SkAdvancedTypefaceMetrics asks for them for a PDF font subset. They are
+    either read from the shared advance table, or scaled from scratch by the
+    scaler at one pixel per unit.
+*/
+class GlyphAdvanceBench : public SkBenchmark {
+public:
+    GlyphAdvanceBench(bool useTable) : fUseTable(useTable) {
+        fName.printf("glyph_advances_cjk_%s", useTable ? "table" : "scaler");
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        fTypeface.reset(create_large_typeface());
+        const int glyphCount = fTypeface->countGlyphs();
+        const int step = SkMax32(1, glyphCount / 2000);
+        for (int glyphID = 0; glyphID < glyphCount; glyphID += step) {
+            *fGlyphIDs.append() = glyphID;
+        }
+        fAdvances.reset(fGlyphIDs.count());
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        if (fUseTable) {
+            for (int i = 0; i < loops; ++i) {
+                SkAutoTUnref<SkGlyphAdvanceTable> table(SkGlyphAdvanceTable::RefFor(fTypeface));
+                table->readHorizontalMetrics(fTypeface, fGlyphIDs.begin(), fGlyphIDs.count());
+                for (int j = 0; j < fGlyphIDs.count(); ++j) {
+                    int16_t advance = 0;
+                    table->getAdvance(fGlyphIDs[j], NULL, NULL, &advance);
+                    fAdvances[j] = SkIntToScalar(advance);
+                }
+            }
+        } else {
+            SkPaint paint;
+            paint.setTypeface(fTypeface);
+            paint.setTextSize(SkIntToScalar(fTypeface->getUnitsPerEm()));
+            paint.setHinting(SkPaint::kNo_Hinting);
+            paint.setLinearText(true);
+            paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+            SkAutoTMalloc<uint16_t> glyphs(fGlyphIDs.count());
+            for (int j = 0; j < fGlyphIDs.count(); ++j) {
+                glyphs[j] = SkToU16(fGlyphIDs[j]);
+            }
+            for (int i = 0; i < loops; ++i) {
+                // Each query starts from the scaler, as the metrics did.
+                SkGraphics::PurgeFontCache();
+                paint.getTextWidths(glyphs.get(), fGlyphIDs.count() * sizeof(uint16_t),
+                                    fAdvances.get());
+            }
+        }
+    }
+
+private:
+    const bool                  fUseTable;
+    SkString                    fName;
+    SkAutoTUnref<SkTypeface>    fTypeface;
+    SkTDArray<uint32_t>         fGlyphIDs;
+    SkAutoTMalloc<SkScalar>     fAdvances;
+
+    typedef SkBenchmark INHERITED;
+};
+
+DEF_BENCH( return new GlyphAdvanceBench(true); )
+DEF_BENCH( return new GlyphAdvanceBench(false); )
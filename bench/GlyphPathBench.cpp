@@ -0,0 +1,98 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBenchmark.h"
+#include "SkCanvas.h"
+#include "SkGlyphCache.h"
+#include "SkGlyphPathCache.h"
+#include "SkPaint.h"
+#include "SkString.h"
+
+static const char kText[] = "Hamburgefons";
+static const size_t kTextLen = sizeof(kText) - 1;
+
+/**
+ *  Gets the paths of glyphs at a different size and angle each time, as in a
+ *  map that is zoomed and rotated, or draws them stroked, which makes each
+ *  strike's glyphs from their paths. The paths come from the shared outlines,
+ *  or with the cache turned off, from the font.
+ */
+class GlyphPathBench : public SkBenchmark {
+    enum {
+        kSizeCount = 5000,
+    };
+    const bool  fShared;
+    const bool  fDraw;
+    size_t      fSavedLimit;
+    SkString    fName;
+    SkPaint     fPaint;
+    uint16_t    fGlyphs[kTextLen];
+public:
+    GlyphPathBench(bool shared, bool draw) : fShared(shared), fDraw(draw), fSavedLimit(0) {
+        fName.printf("%s_%s", draw ? "text_stroked_zoom" : "glyph_paths",
+                     shared ? "shared" : "font");
+        fPaint.setAntiAlias(true);
+        fPaint.setHinting(SkPaint::kNo_Hinting);
+        if (draw) {
+            fPaint.setStyle(SkPaint::kStroke_Style);
+            fPaint.setStrokeWidth(SkIntToScalar(2));
+        }
+        fPaint.textToGlyphs(kText, kTextLen, fGlyphs);
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return fDraw || backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        fSavedLimit = SkGlyphPathCache::Get().getByteLimit();
+        if (!fShared) {
+            SkGlyphPathCache::Get().setByteLimit(0);
+        }
+    }
+
+    virtual void onPostDraw() SK_OVERRIDE {
+        SkGlyphPathCache::Get().setByteLimit(fSavedLimit);
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) SK_OVERRIDE {
+        for (int i = 0; i < loops; ++i) {
+            const int step = i % kSizeCount;
+            // sizes from 20 to 70, in steps of 0.01, each at its own angle, so that
+            // (almost) every size is a new strike
+            fPaint.setTextSize(SkIntToScalar(20) + SkIntToScalar(step) / 100);
+            SkMatrix matrix;
+            matrix.setRotate(SkIntToScalar(step % 90), SkIntToScalar(200), SkIntToScalar(200));
+            if (fDraw) {
+                canvas->save();
+                canvas->concat(matrix);
+                canvas->drawText(kText, kTextLen, SkIntToScalar(200), SkIntToScalar(200),
+                                 fPaint);
+                canvas->restore();
+            } else {
+                SkAutoGlyphCache autoCache(fPaint, NULL, &matrix);
+                SkGlyphCache* cache = autoCache.getCache();
+                for (size_t j = 0; j < kTextLen; ++j) {
+                    cache->findPath(cache->getGlyphIDMetrics(fGlyphs[j]));
+                }
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+DEF_BENCH( return new GlyphPathBench(false, false); )
+DEF_BENCH( return new GlyphPathBench(true, false); )
+DEF_BENCH( return new GlyphPathBench(false, true); )
+DEF_BENCH( return new GlyphPathBench(true, true); )
@@ -424,6 +424,55 @@ private:
     typedef MatrixBench INHERITED;
 };
 
+class MapPointsMatrixBench : public MatrixBench {
+public:
+    enum Type {
+        kTranslate_Type,
+        kScale_Type,
+        kScaleTranslate_Type,
+        kAffine_Type,
+        kPerspective_Type,
+    };
+
+    MapPointsMatrixBench(const char* name, Type type) : INHERITED(name) {
+        switch (type) {
+            case kTranslate_Type:
+                fMatrix.setTranslate(1.5f, 2.5f);
+                break;
+            case kScale_Type:
+                fMatrix.setScale(1.5f, 2.5f);
+                break;
+            case kScaleTranslate_Type:
+                fMatrix.setScale(1.5f, 2.5f, 10, 20);
+                break;
+            case kAffine_Type:
+                fMatrix.setRotate(30, 10, 20);
+                break;
+            case kPerspective_Type:
+                fMatrix.setRotate(30, 10, 20);
+                fMatrix.setPerspX(0.001f);
+                fMatrix.setPerspY(0.002f);
+                break;
+        }
+        SkRandom rand;
+        for (int i = 0; i < kCount; ++i) {
+            fSrc[i].set(rand.nextRangeF(-1000, 1000), rand.nextRangeF(-1000, 1000));
+        }
+    }
+
+protected:
+    virtual void performTest() SK_OVERRIDE {
+        fMatrix.mapPoints(fDst, fSrc, kCount);
+    }
+
+private:
+    enum { kCount = 1024 };
+    SkMatrix fMatrix;
+    SkPoint fSrc[kCount];
+    SkPoint fDst[kCount];
+    typedef MatrixBench INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new EqualsMatrixBench(); )
@@ -470,3 +519,14 @@ DEF_BENCH( return new InvertMapRectMatrixBench(
 
 DEF_BENCH( return new ScaleTransMixedMatrixBench(); )
 DEF_BENCH( return new ScaleTransDoubleMatrixBench(); )
+
+DEF_BENCH( return new MapPointsMatrixBench("mappoints_translate",
+                                           MapPointsMatrixBench::kTranslate_Type); )
+DEF_BENCH( return new MapPointsMatrixBench("mappoints_scale",
+                                           MapPointsMatrixBench::kScale_Type); )
+DEF_BENCH( return new MapPointsMatrixBench("mappoints_scaletranslate",
+                                           MapPointsMatrixBench::kScaleTranslate_Type); )
+DEF_BENCH( return new MapPointsMatrixBench("mappoints_affine",
+                                           MapPointsMatrixBench::kAffine_Type); )
+DEF_BENCH( return new MapPointsMatrixBench("mappoints_perspective",
+                                           MapPointsMatrixBench::kPerspective_Type); )
@@ -831,6 +831,76 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "SkPathOps.h"
+
+// Unions many small shapes that are mostly apart, in pairs and threes that overlap, as the
+// polygons of a map or the glyphs of some text are: with SkOpBuilder, or with an Op() per shape.
+class ManyUnionBench : public SkBenchmark {
+public:
+    ManyUnionBench(bool useBuilder) : fUseBuilder(useBuilder) {
+        fName.printf("path_union_many_%s", useBuilder ? "builder" : "sequential");
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        SkRandom rand;
+        for (int y = 0; y < kGridSize; ++y) {
+            for (int x = 0; x < kGridSize; ++x) {
+                const int count = rand.nextRangeU(1, 3);
+                for (int i = 0; i < count; ++i) {
+                    SkRect oval = SkRect::MakeXYWH(SkIntToScalar(x * 20 + i * 4),
+                                                   SkIntToScalar(y * 20 + i * 3),
+                                                   SkIntToScalar(10), SkIntToScalar(8));
+                    fShapes.push_back().addOval(oval);
+                }
+            }
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        for (int i = 0; i < loops; ++i) {
+            SkPath result;
+            if (fUseBuilder) {
+                SkOpBuilder builder;
+                for (int j = 0; j < fShapes.count(); ++j) {
+                    builder.add(fShapes[j], kUnion_PathOp);
+                }
+                builder.resolve(&result);
+            } else {
+                result = fShapes[0];
+                for (int j = 1; j < fShapes.count(); ++j) {
+                    Op(result, fShapes[j], kUnion_PathOp, &result);
+                }
+            }
+        }
+    }
+
+    virtual void onPostDraw() SK_OVERRIDE {
+        fShapes.reset();
+    }
+
+private:
+    enum {
+        kGridSize = 8,
+    };
+
+    const bool          fUseBuilder;
+    SkString            fName;
+    SkTArray<SkPath>    fShapes;
+
+    typedef SkBenchmark INHERITED;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 #include "SkGeometry.h"
 
 class ConicBench_Chop5 : public SkBenchmark {
@@ -1039,6 +1109,9 @@ DEF_BENCH( return new ConservativelyContainsBench(ConservativelyContainsBench::k
 DEF_BENCH( return new ConservativelyContainsBench(ConservativelyContainsBench::kRoundRect_Type); )
 DEF_BENCH( return new ConservativelyContainsBench(ConservativelyContainsBench::kOval_Type); )
 
+DEF_BENCH( return new ManyUnionBench(true); )
+DEF_BENCH( return new ManyUnionBench(false); )
+
 DEF_BENCH( return new ConicBench_Chop5() )
 DEF_BENCH( return new ConicBench_ChopHalf() )
 DEF_BENCH( return new ConicBench_ComputeError() )
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#include "SkBenchmark.h"
+#include "SkPath.h"
+#include "SkPathOps.h"
+#include "SkRandom.h"
+#include "SkString.h"
+
+// A closed ring of many short edges, like a tessellated coastline or a flattened glyph outline.
+static void add_ring(SkPath* path, SkScalar cx, SkScalar cy, SkScalar radius, int edges,
+                     SkRandom* rand) {
+    for (int i = 0; i < edges; ++i) {
+        SkScalar angle = SK_ScalarPI * 2 * i / edges;
+        SkScalar r = radius + rand->nextRangeScalar(-radius / 50, radius / 50);
+        SkScalar x = cx + r * SkScalarCos(angle);
+        SkScalar y = cy + r * SkScalarSin(angle);
+        if (0 == i) {
+            path->moveTo(x, y);
+        } else {
+            path->lineTo(x, y);
+        }
+    }
+    path->close();
+}
+
+/*  Simplifies, or unions, large generated paths whose edges mostly meet
+    nothing but their neighbours: most of the work is finding the few pairs
+    of edges that do intersect.
+*/
+class PathOpsBench : public SkBenchmark {
+public:
+    PathOpsBench(bool union_, int edges) : fUnion(union_), fEdges(edges) {
+        fName.printf("pathops_%s_ring_%d", union_ ? "union" : "simplify", edges);
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        SkRandom rand;
+        fOne.reset();
+        fTwo.reset();
+        add_ring(&fOne, 0, 0, SkIntToScalar(1000), fEdges, &rand);
+        if (fUnion) {
+            add_ring(&fTwo, SkIntToScalar(700), 0, SkIntToScalar(1000), fEdges, &rand);
+        } else {
+            // a second contour across the first makes a few crossings to resolve
+            add_ring(&fOne, SkIntToScalar(700), 0, SkIntToScalar(1000), fEdges, &rand);
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        SkPath result;
+        for (int i = 0; i < loops; ++i) {
+            if (fUnion) {
+                Op(fOne, fTwo, kUnion_PathOp, &result);
+            } else {
+                Simplify(fOne, &result);
+            }
+        }
+    }
+
+private:
+    const bool  fUnion;
+    const int   fEdges;
+    SkString    fName;
+    SkPath      fOne;
+    SkPath      fTwo;
+
+    typedef SkBenchmark INHERITED;
+};
+
+/*  Simplifies many small groups of overlapping contours that are apart
+    from each other, like a layer of map features or the outlines of a page
+    of text, on threadCount threads.
+*/
+class PathOpsComponentsBench : public SkBenchmark {
+public:
+    PathOpsComponentsBench(int gridSize, int threadCount)
+        : fGridSize(gridSize)
+        , fThreadCount(threadCount) {
+        fName.printf("pathops_simplify_components_%d", gridSize * gridSize);
+        if (1 != threadCount) {
+            fName.appendf("_threads_%d", threadCount);
+        }
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        SkRandom rand;
+        fPath.reset();
+        for (int y = 0; y < fGridSize; ++y) {
+            for (int x = 0; x < fGridSize; ++x) {
+                SkScalar cx = SkIntToScalar(x * 30);
+                SkScalar cy = SkIntToScalar(y * 30);
+                add_ring(&fPath, cx, cy, SkIntToScalar(10), 16, &rand);
+                add_ring(&fPath, cx + 6, cy + 4, SkIntToScalar(10), 16, &rand);
+            }
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        SkPath result;
+        for (int i = 0; i < loops; ++i) {
+            Simplify(fPath, &result, fThreadCount);
+        }
+    }
+
+private:
+    const int   fGridSize;
+    const int   fThreadCount;
+    SkString    fName;
+    SkPath      fPath;
+
+    typedef SkBenchmark INHERITED;
+};
+
+DEF_BENCH( return new PathOpsBench(false, 256); )
+DEF_BENCH( return new PathOpsBench(false, 4096); )
+DEF_BENCH( return new PathOpsBench(true, 256); )
+DEF_BENCH( return new PathOpsBench(true, 4096); )
+
+DEF_BENCH( return new PathOpsComponentsBench(8, 1); )
+DEF_BENCH( return new PathOpsComponentsBench(32, 1); )
+DEF_BENCH( return new PathOpsComponentsBench(8, 4); )
+DEF_BENCH( return new PathOpsComponentsBench(32, 4); )
@@ -117,6 +117,73 @@ private:
     typedef SkBenchmark INHERITED;
 };
 
+/**
+ *  Builds a region out of many small rects, as damage tracking does, either by
+ *  adding the rects one at a time with op(), or all at once with setRects() or
+ *  setRegions().
+ */
+class RegionBuildBench : public SkBenchmark {
+public:
+    enum Method {
+        kOp_Method,
+        kSetRects_Method,
+        kSetRegions_Method,
+    };
+
+private:
+    enum {
+        W = 1024,
+        H = 768,
+        N = 1000,
+    };
+    SkIRect  fRects[N];
+    SkRegion fRegions[N];
+    Method   fMethod;
+    SkString fName;
+
+public:
+    RegionBuildBench(Method method) : fMethod(method) {
+        static const char* gNames[] = { "op", "setrects", "setregions" };
+        fName.printf("region_build_%s_%d", gNames[method], N);
+
+        SkRandom rand;
+        for (int i = 0; i < N; i++) {
+            fRects[i] = SkIRect::MakeXYWH(rand.nextU() % W, rand.nextU() % H,
+                                          1 + rand.nextU() % 64, 1 + rand.nextU() % 64);
+            fRegions[i].setRect(fRects[i]);
+        }
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() { return fName.c_str(); }
+
+    virtual void onDraw(const int loops, SkCanvas*) {
+        for (int i = 0; i < loops; ++i) {
+            SkRegion rgn;
+            switch (fMethod) {
+                case kOp_Method:
+                    for (int j = 0; j < N; ++j) {
+                        rgn.op(fRects[j], SkRegion::kUnion_Op);
+                    }
+                    break;
+                case kSetRects_Method:
+                    rgn.setRects(fRects, N);
+                    break;
+                case kSetRegions_Method:
+                    rgn.setRegions(fRegions, N, SkRegion::kUnion_Op);
+                    break;
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
 class RectSectBench : public SkBenchmark {
     enum {
         N = 1000
@@ -184,5 +251,9 @@ DEF_BENCH( return SkNEW_ARGS(RegionBench, (SMALL, sectsrgn_proc, "intersectsrgn"
 DEF_BENCH( return SkNEW_ARGS(RegionBench, (SMALL, sectsrect_proc, "intersectsrect")); )
 DEF_BENCH( return SkNEW_ARGS(RegionBench, (SMALL, containsxy_proc, "containsxy")); )
 
+DEF_BENCH( return SkNEW_ARGS(RegionBuildBench, (RegionBuildBench::kOp_Method)); )
+DEF_BENCH( return SkNEW_ARGS(RegionBuildBench, (RegionBuildBench::kSetRects_Method)); )
+DEF_BENCH( return SkNEW_ARGS(RegionBuildBench, (RegionBuildBench::kSetRegions_Method)); )
+
 DEF_BENCH( return SkNEW_ARGS(RectSectBench, (false)); )
 DEF_BENCH( return SkNEW_ARGS(RectSectBench, (true)); )
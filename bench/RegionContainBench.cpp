@@ -15,6 +15,16 @@ static bool sect_proc(SkRegion& a, SkRegion& b) {
     return result.op(a, b, SkRegion::kIntersect_Op);
 }
 
+static bool xor_proc(SkRegion& a, SkRegion& b) {
+    SkRegion result;
+    return result.op(a, b, SkRegion::kXOR_Op);
+}
+
+static bool diff_proc(SkRegion& a, SkRegion& b) {
+    SkRegion result;
+    return result.op(b, a, SkRegion::kDifference_Op);
+}
+
 class RegionContainBench : public SkBenchmark {
 public:
     typedef bool (*Proc)(SkRegion& a, SkRegion& b);
@@ -65,3 +75,5 @@ private:
 };
 
 DEF_BENCH( return SkNEW_ARGS(RegionContainBench, (sect_proc, "sect")); )
+DEF_BENCH( return SkNEW_ARGS(RegionContainBench, (xor_proc, "xor")); )
+DEF_BENCH( return SkNEW_ARGS(RegionContainBench, (diff_proc, "diff")); )
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#include "SkBenchmark.h"
+#include "SkBitmap.h"
+#include "SkImageDecoder.h"
+#include "SkRandom.h"
+#include "SkScaledBitmapSampler.h"
+#include "SkString.h"
+
+/**
+ *  Measures only the conversion of decoded rows into the destination bitmap,
+ *  which every decoder does through SkScaledBitmapSampler, without the cost
+ *  of decompression.
+ */
+class ScaledBitmapSamplerBench : public SkBenchmark {
+    enum {
+        kWidth = 1024,
+        kHeight = 64,
+    };
+
+    class Decoder : public SkImageDecoder {
+    protected:
+        virtual bool onDecode(SkStream*, SkBitmap*, SkImageDecoder::Mode) SK_OVERRIDE {
+            return false;
+        }
+    };
+
+    const SkScaledBitmapSampler::SrcConfig  fSrcConfig;
+    const int                               fSrcPixelSize;
+    const bool                              fPremultiply;
+    const int                               fSampleSize;
+    SkString                                fName;
+    SkAutoMalloc                            fSrc;
+    SkBitmap                                fDst;
+    Decoder                                 fDecoder;
+public:
+    ScaledBitmapSamplerBench(SkScaledBitmapSampler::SrcConfig sc, bool premultiply,
+                             int sampleSize)
+        : fSrcConfig(sc)
+        , fSrcPixelSize(src_pixel_size(sc))
+        , fPremultiply(premultiply)
+        , fSampleSize(sampleSize) {
+        static const char* const gConfigNames[] = {
+            "gray", "index", "rgb", "rgbx", "rgba", "565"
+        };
+        fName.printf("scaled_bitmap_sampler_%s_8888", gConfigNames[sc]);
+        if (SkScaledBitmapSampler::kRGBA == sc) {
+            fName.append(premultiply ? "_premul" : "_unpremul");
+        }
+        if (sampleSize > 1) {
+            fName.appendf("_sample%d", sampleSize);
+        }
+        fDecoder.setRequireUnpremultipliedColors(!premultiply);
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        const size_t rowBytes = kWidth * fSrcPixelSize;
+        fSrc.reset(rowBytes * kHeight);
+        uint8_t* src = (uint8_t*)fSrc.get();
+        SkRandom rand;
+        for (size_t i = 0; i < rowBytes * kHeight; ++i) {
+            src[i] = rand.nextU() & 0xFF;
+        }
+        if (SkScaledBitmapSampler::kRGBA == fSrcConfig) {
+            // Make most pixels opaque, as in typical images.
+            for (int i = 0; i < kWidth * kHeight; ++i) {
+                if (rand.nextU() % 4 != 0) {
+                    src[4 * i + 3] = 0xFF;
+                }
+            }
+        }
+        SkScaledBitmapSampler sampler(kWidth, kHeight, fSampleSize);
+        fDst.allocPixels(SkImageInfo::MakeN32(sampler.scaledWidth(), sampler.scaledHeight(),
+                                              fPremultiply ? kPremul_SkAlphaType
+                                                           : kUnpremul_SkAlphaType));
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        const uint8_t* src = (const uint8_t*)fSrc.get();
+        const size_t rowBytes = kWidth * fSrcPixelSize;
+        for (int i = 0; i < loops; i++) {
+            SkScaledBitmapSampler sampler(kWidth, kHeight, fSampleSize);
+            if (!sampler.begin(&fDst, fSrcConfig, fDecoder)) {
+                return;
+            }
+            for (int y = 0; y < sampler.scaledHeight(); ++y) {
+                const int srcY = sampler.srcY0() + y * sampler.srcDY();
+                sampler.next(src + srcY * rowBytes);
+            }
+        }
+    }
+
+private:
+    static int src_pixel_size(SkScaledBitmapSampler::SrcConfig sc) {
+        switch (sc) {
+            case SkScaledBitmapSampler::kGray:
+            case SkScaledBitmapSampler::kIndex:
+                return 1;
+            case SkScaledBitmapSampler::kRGB:
+                return 3;
+            case SkScaledBitmapSampler::kRGB_565:
+                return 2;
+            default:
+                return 4;
+        }
+    }
+
+    typedef SkBenchmark INHERITED;
+};
+
+DEF_BENCH( return new ScaledBitmapSamplerBench(SkScaledBitmapSampler::kGray, true, 1); )
+DEF_BENCH( return new ScaledBitmapSamplerBench(SkScaledBitmapSampler::kRGB, true, 1); )
+DEF_BENCH( return new ScaledBitmapSamplerBench(SkScaledBitmapSampler::kRGBX, true, 1); )
+DEF_BENCH( return new ScaledBitmapSamplerBench(SkScaledBitmapSampler::kRGBA, true, 1); )
+DEF_BENCH( return new ScaledBitmapSamplerBench(SkScaledBitmapSampler::kRGBA, false, 1); )
+// Sampling every other pixel uses the portable procs.
+DEF_BENCH( return new ScaledBitmapSamplerBench(SkScaledBitmapSampler::kRGBA, true, 2); )
@@ -7,7 +7,10 @@
 
 #include "SkBenchmark.h"
 #include "SkCanvas.h"
+#include "SkGraphics.h"
 #include "SkPaint.h"
+#include "SkPath.h"
+#include "SkRandom.h"
 #include "SkRRect.h"
 #include "SkString.h"
 
@@ -102,3 +105,50 @@ DEF_BENCH( return new StrokeRRectBench(SkPaint::kMiter_Join, draw_rrect); )
 DEF_BENCH( return new StrokeRRectBench(SkPaint::kRound_Join, draw_oval); )
 DEF_BENCH( return new StrokeRRectBench(SkPaint::kBevel_Join, draw_oval); )
 DEF_BENCH( return new StrokeRRectBench(SkPaint::kMiter_Join, draw_oval); )
+
+// Draws the same stroked polyline again and again, like a chart that is redrawn
+// on every frame, with and without the cache of stroke outlines.
+//
+class StrokePolylineBench : public SkBenchmark {
+    SkString fName;
+    SkPath   fPath;
+    bool     fCached;
+public:
+    StrokePolylineBench(bool cached) : fCached(cached) {
+        fName.printf("draw_stroke_polyline_%s", cached ? "cached" : "uncached");
+
+        SkRandom rand;
+        fPath.moveTo(0, 200);
+        for (int i = 1; i <= 500; ++i) {
+            fPath.lineTo(SkIntToScalar(i), rand.nextRangeScalar(100, 300));
+        }
+    }
+
+protected:
+    virtual const char* onGetName() {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) {
+        SkPaint paint;
+        this->setupPaint(&paint);
+        paint.setStyle(SkPaint::kStroke_Style);
+        paint.setStrokeJoin(SkPaint::kRound_Join);
+        paint.setStrokeWidth(3);
+
+        size_t limit = SkGraphics::GetStrokeCacheByteLimit();
+        if (!fCached) {
+            SkGraphics::SetStrokeCacheByteLimit(0);
+        }
+        for (int i = 0; i < loops; ++i) {
+            canvas->drawPath(fPath, paint);
+        }
+        SkGraphics::SetStrokeCacheByteLimit(limit);
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+DEF_BENCH( return new StrokePolylineBench(true); )
+DEF_BENCH( return new StrokePolylineBench(false); )
@@ -12,6 +12,7 @@
 #include "SkRandom.h"
 #include "SkString.h"
 #include "SkTemplates.h"
+#include "SkTextBlob.h"
 
 enum FontQuality {
     kBW,
@@ -126,6 +127,86 @@ private:
     typedef SkBenchmark INHERITED;
 };
 
+/*  Draws the same text as TextBench, from an SkTextBlob made once, so that
+    the conversion to glyphs, the measuring and, for the non-subpixel cases,
+    the glyph lookups are not part of the loop.
+ */
+class TextBlobBench : public SkBenchmark {
+    SkPaint     fPaint;
+    SkString    fName;
+    FontQuality fFQ;
+    bool        fDoPos;
+    SkAutoTUnref<SkTextBlob> fBlob;
+public:
+    TextBlobBench(const char text[], int ps,
+                  SkColor color, FontQuality fq, bool doPos = false)  {
+        fFQ = fq;
+        fDoPos = doPos;
+
+        fPaint.setAntiAlias(kBW != fq);
+        fPaint.setLCDRenderText(kLCD == fq);
+        fPaint.setTextSize(SkIntToScalar(ps));
+        fPaint.setColor(color);
+
+        size_t len = strlen(text);
+        if (doPos) {
+            SkAutoTArray<SkScalar> adv(SkToInt(len));
+            fPaint.getTextWidths(text, len, adv.get());
+            SkAutoTArray<SkPoint> pos(SkToInt(len));
+            SkScalar x = 0;
+            for (size_t i = 0; i < len; ++i) {
+                pos[i].set(x, SkIntToScalar(50));
+                x += adv[i];
+            }
+            fBlob.reset(SkTextBlob::CreatePos(text, len, pos.get(), fPaint));
+        } else {
+            fBlob.reset(SkTextBlob::Create(text, len, fPaint));
+        }
+    }
+
+protected:
+    virtual const char* onGetName() {
+        fName.printf("text_%g", SkScalarToFloat(fPaint.getTextSize()));
+        fName.append(fDoPos ? "_posblob" : "_blob");
+        fName.appendf("_%s", fontQualityName(fPaint));
+        if (SK_ColorBLACK != fPaint.getColor()) {
+            fName.appendf("_%02X", fPaint.getAlpha());
+        } else {
+            fName.append("_BK");
+        }
+        return fName.c_str();
+    }
+
+    virtual void onDraw(const int loops, SkCanvas* canvas) {
+        const SkIPoint dim = this->getSize();
+        SkRandom rand;
+
+        SkPaint paint(fPaint);
+        this->setupPaint(&paint);
+        paint.setColor(fPaint.getColor());
+
+        const SkScalar x0 = SkIntToScalar(-10);
+        const SkScalar y0 = SkIntToScalar(-10);
+
+        if (fDoPos) {
+            canvas->translate(SK_Scalar1, SK_Scalar1);
+        }
+
+        for (int i = 0; i < loops; i++) {
+            if (fDoPos) {
+                canvas->drawTextBlob(fBlob, 0, 0, paint);
+            } else {
+                SkScalar x = x0 + rand.nextUScalar1() * dim.fX;
+                SkScalar y = y0 + rand.nextUScalar1() * dim.fY;
+                canvas->drawTextBlob(fBlob, x, y, paint);
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #define STR     "Hamburgefons"
@@ -143,3 +224,8 @@ DEF_BENCH( return new TextBench(STR, 16, 0xFFFF0000, kLCD); )
 DEF_BENCH( return new TextBench(STR, 16, 0x88FF0000, kLCD); )
 
 DEF_BENCH( return new TextBench(STR, 16, 0xFF000000, kAA, true); )
+
+DEF_BENCH( return new TextBlobBench(STR, 16, 0xFF000000, kBW); )
+DEF_BENCH( return new TextBlobBench(STR, 16, 0xFF000000, kAA); )
+DEF_BENCH( return new TextBlobBench(STR, 16, 0xFF000000, kLCD); )
+DEF_BENCH( return new TextBlobBench(STR, 16, 0xFF000000, kAA, true); )
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBenchmark.h"
+#include "SkBitmap.h"
+#include "SkColorPriv.h"
+#include "SkCoreBlitters.h"
+#include "SkData.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkRandom.h"
+#include "SkRasterClip.h"
+#include "SkScan.h"
+#include "SkString.h"
+#include "SkTextureCompressor.h"
+#include "SkThreadPool.h"
+
+static const char* format_name(SkTextureCompressor::Format format) {
+    switch (format) {
+        case SkTextureCompressor::kLATC_Format:       return "latc";
+        case SkTextureCompressor::kR11_EAC_Format:    return "r11eac";
+        case SkTextureCompressor::kASTC_12x12_Format: return "astc12x12";
+        case SkTextureCompressor::kETC1_Format:       return "etc1";
+    }
+    return "";
+}
+
+/**
+ *  Compresses a 1200x1200 atlas, as prepared offline, with the given format
+ *  on the given number of threads. The alpha formats compress an A8 atlas,
+ *  and ETC1 an N32 one.
+ */
+class TextureCompressionBench : public SkBenchmark {
+    enum {
+        kSize = 1200,   // a multiple of 4 and 12
+    };
+    const SkTextureCompressor::Format   fFormat;
+    const int                           fThreadCount;
+    SkString                            fName;
+    SkBitmap                            fBitmap;
+public:
+    TextureCompressionBench(SkTextureCompressor::Format format, int threadCount)
+        : fFormat(format)
+        , fThreadCount(threadCount) {
+        fName.printf("compress_%s", format_name(format));
+        if (threadCount < 0) {
+            fName.append("_threads_per_core");
+        } else {
+            fName.appendf("_threads_%d", threadCount);
+        }
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onPreDraw() SK_OVERRIDE {
+        // Mostly empty and full blocks with smooth edges between them, like
+        // the masks of a glyph or path atlas, and some noise.
+        SkRandom rand;
+        if (SkTextureCompressor::kETC1_Format == fFormat) {
+            fBitmap.allocN32Pixels(kSize, kSize);
+        } else {
+            fBitmap.allocPixels(SkImageInfo::MakeA8(kSize, kSize));
+        }
+        for (int y = 0; y < kSize; ++y) {
+            for (int x = 0; x < kSize; ++x) {
+                const int dx = (x % 100) - 50;
+                const int dy = (y % 100) - 50;
+                const int value = SkPin32(40 * 40 - (dx * dx + dy * dy) + 128, 0, 255);
+                const U8CPU noise = rand.nextU() & 0x3;
+                if (SkTextureCompressor::kETC1_Format == fFormat) {
+                    *fBitmap.getAddr32(x, y) = SkPackARGB32(0xFF, value, x & 0xFF,
+                                                            (y + noise) & 0xFF);
+                } else {
+                    *fBitmap.getAddr8(x, y) = SkTMax<int>(value - noise, 0);
+                }
+            }
+        }
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        for (int i = 0; i < loops; ++i) {
+            SkAutoDataUnref data(SkTextureCompressor::CompressBitmapToFormat(fBitmap, fFormat,
+                                                                             fThreadCount));
+            if (NULL == data) {
+                return;
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+/**
+ *  Antialiases a path into a compressed mask, either through an A8 mask which
+ *  is compressed afterwards, or with the blitter that compresses the rows as
+ *  the scan converter produces them.
+ */
+class CompressedBlitterBench : public SkBenchmark {
+    enum {
+        kSize = 480,    // a multiple of 4 and 12
+    };
+    const SkTextureCompressor::Format   fFormat;
+    const bool                          fUseBlitter;
+    SkString                            fName;
+    SkPath                              fPath;
+public:
+    CompressedBlitterBench(SkTextureCompressor::Format format, bool useBlitter)
+        : fFormat(format)
+        , fUseBlitter(useBlitter) {
+        fName.printf("compress_path_%s_%s", format_name(format),
+                     useBlitter ? "blitter" : "a8");
+        SkRandom rand;
+        for (int i = 0; i < 10; ++i) {
+            fPath.addCircle(rand.nextRangeScalar(0, kSize), rand.nextRangeScalar(0, kSize),
+                            rand.nextRangeScalar(10, 100));
+        }
+    }
+
+    virtual bool isSuitableFor(Backend backend) SK_OVERRIDE {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    virtual const char* onGetName() SK_OVERRIDE {
+        return fName.c_str();
+    }
+
+    virtual void onDraw(const int loops, SkCanvas*) SK_OVERRIDE {
+        const SkRasterClip clip(SkIRect::MakeWH(kSize, kSize));
+        const int size = SkTextureCompressor::GetCompressedDataSize(fFormat, kSize, kSize);
+        SkAutoMalloc storage(size);
+        for (int i = 0; i < loops; ++i) {
+            if (fUseBlitter) {
+                SkAutoTDelete<SkBlitter> blitter(SkTextureCompressor::CreateBlitterForFormat(
+                    kSize, kSize, storage.get(), fFormat));
+                SkScan::AntiFillPath(fPath, clip, blitter.get());
+            } else {
+                SkBitmap mask;
+                mask.allocPixels(SkImageInfo::MakeA8(kSize, kSize));
+                mask.eraseColor(0);
+                {
+                    SkPaint paint;
+                    SkA8_Coverage_Blitter blitter(mask, paint);
+                    SkScan::AntiFillPath(fPath, clip, &blitter);
+                }
+                SkTextureCompressor::CompressBufferToFormat(
+                    reinterpret_cast<uint8_t*>(storage.get()), mask.getAddr8(0, 0),
+                    kAlpha_8_SkColorType, kSize, kSize, mask.rowBytes(), fFormat);
+            }
+        }
+    }
+
+private:
+    typedef SkBenchmark INHERITED;
+};
+
+DEF_BENCH( return new TextureCompressionBench(SkTextureCompressor::kLATC_Format, 1); )
+DEF_BENCH( return new TextureCompressionBench(SkTextureCompressor::kR11_EAC_Format, 1); )
+DEF_BENCH( return new TextureCompressionBench(SkTextureCompressor::kASTC_12x12_Format, 1); )
+DEF_BENCH( return new TextureCompressionBench(SkTextureCompressor::kR11_EAC_Format,
+                                              SkThreadPool::kThreadPerCore); )
+DEF_BENCH( return new TextureCompressionBench(SkTextureCompressor::kASTC_12x12_Format,
+                                              SkThreadPool::kThreadPerCore); )
+#ifndef SK_IGNORE_ETC1_SUPPORT
+DEF_BENCH( return new TextureCompressionBench(SkTextureCompressor::kETC1_Format, 1); )
+DEF_BENCH( return new TextureCompressionBench(SkTextureCompressor::kETC1_Format,
+                                              SkThreadPool::kThreadPerCore); )
+#endif
+
+DEF_BENCH( return new CompressedBlitterBench(SkTextureCompressor::kR11_EAC_Format, false); )
+DEF_BENCH( return new CompressedBlitterBench(SkTextureCompressor::kR11_EAC_Format, true); )
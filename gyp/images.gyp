@@ -30,6 +30,8 @@
         '../src/image/',
         # So src/ports/SkImageDecoder_CG can access SkStreamHelpers.h
         '../src/images/',
+        # for access to SkScaledBitmapSampler_opts.h
+        '../src/opts/',
       ],
       'sources': [
         '../include/images/SkDecodingImageGenerator.h',
@@ -12,14 +12,18 @@
         '../src/sfnt',
       ],
       'sources': [
+        '../src/sfnt/SkFontIndex.h',
+        '../src/sfnt/SkGlyphAdvanceTable.h',
         '../src/sfnt/SkIBMFamilyClass.h',
         '../src/sfnt/SkOTTableTypes.h',
+        '../src/sfnt/SkOTTable_cmap.h',
         '../src/sfnt/SkOTTable_EBDT.h',
         '../src/sfnt/SkOTTable_EBLC.h',
         '../src/sfnt/SkOTTable_EBSC.h',
         '../src/sfnt/SkOTTable_glyf.h',
         '../src/sfnt/SkOTTable_head.h',
         '../src/sfnt/SkOTTable_hhea.h',
+        '../src/sfnt/SkOTTable_hmtx.h',
         '../src/sfnt/SkOTTable_loca.h',
         '../src/sfnt/SkOTTable_maxp.h',
         '../src/sfnt/SkOTTable_maxp_CFF.h',
@@ -40,6 +44,8 @@
         '../src/sfnt/SkTTCFHeader.h',
         '../src/sfnt/SkTypedEnum.h',
 
+        '../src/sfnt/SkFontIndex.cpp',
+        '../src/sfnt/SkGlyphAdvanceTable.cpp',
         '../src/sfnt/SkOTTable_name.cpp',
         '../src/sfnt/SkOTUtils.cpp',
       ],
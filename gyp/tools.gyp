@@ -41,6 +41,14 @@
             ],
           },
         ],
+        ['skia_os in ["linux", "freebsd", "openbsd", "solaris", "chromeos"] and '
+         'not skia_no_fontconfig',
+          {
+            'dependencies': [
+              'build_font_index',
+            ],
+          },
+        ],
       ],
     },
     {
@@ -598,6 +606,32 @@
         ],
       },
     ],
+    ['skia_os in ["linux", "freebsd", "openbsd", "solaris", "chromeos"] and '
+     'not skia_no_fontconfig',
+      {
+        'targets': [
+          {
+            'target_name': 'build_font_index',
+            'type': 'executable',
+            'sources': [
+              '../tools/build_font_index.cpp',
+            ],
+            'include_dirs': [
+              '../src/sfnt',
+            ],
+            'dependencies': [
+              'flags.gyp:flags',
+              'skia_lib.gyp:skia_lib',
+            ],
+            'link_settings': {
+              'libraries': [
+                '-lfontconfig',
+              ],
+            },
+          },
+        ],
+      },
+    ],
     ['skia_win_debuggers_path and skia_os == "win"',
       {
         'targets': [
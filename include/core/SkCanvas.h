@@ -33,6 +33,7 @@ class SkPicture;
 class SkRRect;
 class SkSurface;
 class SkSurface_Base;
+class SkTextBlob;
 class GrContext;
 class GrRenderTarget;
 
@@ -964,6 +965,16 @@ public:
                                 const SkPath& path, const SkMatrix* matrix,
                                 const SkPaint& paint);
 
+    /** Draw the glyphs of the blob, with its origin at (x,y). The font
+        attributes (typeface, size, text flags...) come from the blob, the rest
+        from the paint.
+        @param blob     The glyph run to be drawn
+        @param x        The x-coordinate of the origin of the blob
+        @param y        The y-coordinate of the origin of the blob
+        @param paint    The paint used for the glyphs (e.g. color, style)
+    */
+    void drawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y, const SkPaint& paint);
+
     /** PRIVATE / EXPERIMENTAL -- do not call
         Perform back-end analysis/optimization of a picture. This may attach
         optimization data to the picture which can be used by a later
@@ -1227,6 +1238,14 @@ protected:
                                   const SkPath& path, const SkMatrix* matrix,
                                   const SkPaint& paint);
 
+    virtual void onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                                const SkPaint& paint);
+
+    // For canvases that do not know about blobs: draws the blob with
+    // drawPosText().
+    void drawTextBlobAsPosText(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                               const SkPaint& paint);
+
     enum ClipEdgeStyle {
         kHard_ClipEdgeStyle,
         kSoft_ClipEdgeStyle
@@ -21,6 +21,7 @@ struct SkIRect;
 class SkMatrix;
 class SkMetaData;
 class SkRegion;
+class SkTextBlob;
 
 class GrRenderTarget;
 
@@ -249,6 +250,12 @@ protected:
     virtual void drawTextOnPath(const SkDraw&, const void* text, size_t len,
                                 const SkPath& path, const SkMatrix* matrix,
                                 const SkPaint& paint) = 0;
+    /**
+     *  The font attributes of the blob have already been applied to paint.
+     *  Default impl draws the glyphs with drawPosText().
+     */
+    virtual void drawTextBlob(const SkDraw&, const SkTextBlob* blob,
+                              SkScalar x, SkScalar y, const SkPaint& paint);
     virtual void drawVertices(const SkDraw&, SkCanvas::VertexMode, int vertexCount,
                               const SkPoint verts[], const SkPoint texs[],
                               const SkColor colors[], SkXfermode* xmode,
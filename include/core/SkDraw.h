@@ -62,6 +62,8 @@ public:
                         int scalarsPerPosition, const SkPaint& paint) const;
     void    drawTextOnPath(const char text[], size_t byteLength,
                         const SkPath&, const SkMatrix*, const SkPaint&) const;
+    void    drawTextBlob(const SkTextBlob*, SkScalar x, SkScalar y,
+                         const SkPaint&) const;
     void    drawVertices(SkCanvas::VertexMode mode, int count,
                          const SkPoint vertices[], const SkPoint textures[],
                          const SkColor colors[], SkXfermode* xmode,
@@ -113,6 +115,18 @@ public:
                                     const SkScalar pos[], SkScalar constY,
                                     int scalarsPerPosition, const SkPaint&) const;
 
+    /**
+     *  Returns true if the paint asks for distance field text, and the text is
+     *  filled, without effects, and big enough on the device to be drawn by
+     *  scaling its glyphs' distance fields instead of rasterizing each size.
+     */
+    static bool ShouldDrawTextAsDistanceField(const SkPaint&, const SkMatrix&);
+    void        drawText_asDistanceField(const char text[], size_t byteLength,
+                                         SkScalar x, SkScalar y, const SkPaint&) const;
+    void        drawPosText_asDistanceField(const char text[], size_t byteLength,
+                                            const SkScalar pos[], SkScalar constY,
+                                            int scalarsPerPosition, const SkPaint&) const;
+
 private:
     void    drawDevMask(const SkMask& mask, const SkPaint&) const;
     void    drawBitmapAsMask(const SkBitmap&, const SkPaint&) const;
@@ -100,6 +100,20 @@ public:
         fPreferQualityOverSpeed = qualityOverSpeed;
     }
 
+    /** Returns the maximum number of threads the decoder may use for a single
+        decode. The default is 1, meaning the whole decode happens on the
+        calling thread.
+    */
+    int getThreadCount() const { return fThreadCount; }
+
+    /** Allow the decoder to split a decode across up to count threads, if the
+        image allows it (currently only baseline JPEGs with restart markers).
+        A negative count means one thread per core.
+        This is a hint that may not be respected by the decoder.
+        The default is 1.
+    */
+    void setThreadCount(int count) { fThreadCount = count; }
+
     /** Set to true to require the decoder to return a bitmap with unpremultiplied
         colors. The default is false, meaning the resulting bitmap will have its
         colors premultiplied.
@@ -287,6 +301,49 @@ public:
      */
     bool decodeSubset(SkBitmap* bm, const SkIRect& subset, SkColorType pref);
 
+    /** Returned by appendData() to report the progress of an incremental decode.
+    */
+    enum IncrementalResult {
+        kFailure_IncrementalResult,     //!< the data is invalid, or the decode was cancelled
+        kPartial_IncrementalResult,     //!< more data is needed to finish the image
+        kComplete_IncrementalResult,    //!< the entire image has been decoded
+    };
+
+    /**
+     *  Prepare to decode an image whose encoded data will arrive in pieces,
+     *  via appendData(), rather than from a complete stream.
+     *
+     *  The bitmap must remain valid until the decode completes or fails. Its
+     *  info is set and its pixels allocated as soon as enough data has
+     *  arrived to read the image header. Until then bitmap->isNull() is true.
+     *  Rows that have not been decoded yet are zero (transparent), except in
+     *  a GIF, where they are filled as if the data had ended there.
+     *
+     *  @param pref If the PrefConfigTable is not set, prefer this colortype.
+     *              See NOTE ABOUT PREFERRED CONFIGS.
+     *  @return false if this decoder does not support incremental decoding.
+     */
+    bool startIncrementalDecode(SkBitmap* bitmap, SkColorType pref);
+
+    /**
+     *  Append the next length bytes of encoded data to an incremental decode
+     *  started by startIncrementalDecode(), and decode as much of the image
+     *  as that data allows.
+     *
+     *  If startRow and endRow are not NULL, they are set to the range of
+     *  bitmap rows [*startRow, *endRow) whose pixels changed during this call.
+     *  The range is empty (*startRow == *endRow) if no pixels changed.
+     *  Formats that refine the whole image in several passes (progressive
+     *  JPEG, interlaced PNG and GIF) may report the same rows more than once.
+     *
+     *  Once kComplete_IncrementalResult or kFailure_IncrementalResult is
+     *  returned, further data is ignored until startIncrementalDecode() is
+     *  called again. After a failure, the bitmap may still hold the rows
+     *  that were decoded before the error.
+     */
+    IncrementalResult appendData(const void* data, size_t length,
+                                 int* startRow = NULL, int* endRow = NULL);
+
     /** Given a stream, this will try to find an appropriate decoder object.
         If none is found, the method returns NULL.
     */
@@ -389,6 +446,18 @@ protected:
         return false;
     }
 
+    // If the decoder wants to support incremental decoding, these methods
+    // must be overridden. They are called by startIncrementalDecode(...) and
+    // appendData(...). startRow and endRow are never NULL, and are already
+    // set to an empty range when onAppendData is called.
+    virtual bool onStartIncrementalDecode(SkBitmap* bitmap) {
+        return false;
+    }
+    virtual IncrementalResult onAppendData(const void* data, size_t length,
+                                           int* startRow, int* endRow) {
+        return kFailure_IncrementalResult;
+    }
+
     /*
      * Crop a rectangle from the src Bitmap to the dest Bitmap. src and dst are
      * both sampled by sampleSize from an original Bitmap.
@@ -445,6 +514,25 @@ protected:
     */
     bool allocPixelRef(SkBitmap*, SkColorTable*) const;
 
+    /*  Helper for incremental decoders. Like allocPixelRef, but also clears the
+        pixels to zero, so that rows which have not been decoded yet are
+        transparent.
+    */
+    bool allocIncrementalPixelRef(SkBitmap*, SkColorTable*) const;
+
+    /*  Helper for incremental decoders. Grow the row range [*startRow, *endRow)
+        reported by appendData() to include row.
+    */
+    static void JoinRowRange(int row, int* startRow, int* endRow) {
+        if (*startRow == *endRow) {
+            *startRow = row;
+            *endRow = row + 1;
+        } else {
+            *startRow = SkMin32(*startRow, row);
+            *endRow = SkMax32(*endRow, row + 1);
+        }
+    }
+
     /**
      *  The raw data of the src image.
      */
@@ -476,8 +564,10 @@ private:
     bool                    fUsePrefTable;
     bool                    fSkipWritingZeroes;
     mutable bool            fShouldCancelDecode;
+    bool                    fIncrementalDecodeActive;
     bool                    fPreferQualityOverSpeed;
     bool                    fRequireUnpremultipliedColors;
+    int                     fThreadCount;
 };
 
 /** Calling newDecoder with a stream returns a new matching imagedecoder
@@ -30,6 +30,7 @@ public:
     };
     static SkImageEncoder* Create(Type);
 
+    SkImageEncoder();
     virtual ~SkImageEncoder();
 
     /*  Quality ranges from 0..100 */
@@ -59,6 +60,72 @@ public:
      */
     bool encodeStream(SkWStream* stream, const SkBitmap& bm, int quality);
 
+    /**
+     *  Lossless encoders (currently only PNG) can trade encoding speed for
+     *  output size. A preset sets the filters, zlib level and zlib strategy
+     *  below together; setting any of them afterwards overrides the preset.
+     */
+    enum Preset {
+        kDefault_Preset,    //!< the library defaults
+        kFast_Preset,       //!< fastest encode, for large volumes of thumbnails
+        kSmall_Preset,      //!< smallest output, at several times the cost
+    };
+    void setPreset(Preset);
+
+    /**
+     *  Row filters PNG may choose from. With more than one, the encoder picks
+     *  a filter for each row. kDefault_PNGFilterFlags lets libpng choose.
+     */
+    enum PNGFilterFlags {
+        kDefault_PNGFilterFlags = 0,
+        kNone_PNGFilterFlag     = 0x08,
+        kSub_PNGFilterFlag      = 0x10,
+        kUp_PNGFilterFlag       = 0x20,
+        kAvg_PNGFilterFlag      = 0x40,
+        kPaeth_PNGFilterFlag    = 0x80,
+        kAll_PNGFilterFlags     = 0xF8,
+    };
+    unsigned getPNGFilters() const { return fPNGFilters; }
+    void setPNGFilters(unsigned filterFlags) { fPNGFilters = filterFlags; }
+
+    enum {
+        kDefault_ZLibLevel = -1
+    };
+    /**
+     *  The zlib compression level, from 0 (store) to 9 (best), or
+     *  kDefault_ZLibLevel.
+     */
+    int getZLibLevel() const { return fZLibLevel; }
+    void setZLibLevel(int level) { fZLibLevel = SkPin32(level, kDefault_ZLibLevel, 9); }
+
+    enum ZLibStrategy {
+        kDefault_ZLibStrategy,
+        kFiltered_ZLibStrategy,
+        kHuffmanOnly_ZLibStrategy,
+        kRLE_ZLibStrategy,
+    };
+    ZLibStrategy getZLibStrategy() const { return fZLibStrategy; }
+    void setZLibStrategy(ZLibStrategy strategy) { fZLibStrategy = strategy; }
+
+    /**
+     *  The number of threads an encoder may use. Values greater than one let
+     *  the PNG encoder compress bands of rows in parallel, which makes the
+     *  output slightly larger. SkThreadPool::kThreadPerCore (-1) uses one
+     *  thread per core. The default is 1.
+     */
+    int getThreadCount() const { return fThreadCount; }
+    void setThreadCount(int count) { fThreadCount = count; }
+
+    /**
+     *  The number of rows of MCUs between the restart markers the JPEG encoder
+     *  writes, or 0 (the default) for none. Restart markers make the output a
+     *  few bytes per marker larger, and let a decoder with a thread count
+     *  greater than one (see SkImageDecoder::setThreadCount) decode bands of
+     *  the image in parallel.
+     */
+    int getJPEGRestartRows() const { return fJPEGRestartRows; }
+    void setJPEGRestartRows(int rows) { fJPEGRestartRows = SkMax32(rows, 0); }
+
     static SkData* EncodeData(const SkBitmap&, Type, int quality);
     static bool EncodeFile(const char file[], const SkBitmap&, Type,
                            int quality);
@@ -74,6 +141,13 @@ protected:
      * This must be overridden by each SkImageEncoder implementation.
      */
     virtual bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) = 0;
+
+private:
+    unsigned        fPNGFilters;
+    int             fZLibLevel;
+    ZLibStrategy    fZLibStrategy;
+    int             fThreadCount;
+    int             fJPEGRestartRows;
 };
 
 // This macro declares a global (i.e., non-class owned) creation entry point
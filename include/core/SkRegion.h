@@ -297,6 +297,16 @@ public:
      */
     bool op(const SkRegion& rgna, const SkRegion& rgnb, Op op);
 
+    /**
+     *  Set this region to regions[0] op regions[1] op ... op regions[count-1].
+     *  For kUnion_Op and kIntersect_Op this builds the result in one pass over
+     *  the rects of all the regions, which is much faster than calling op() in
+     *  a loop when there are many regions. Other ops are applied in turn. If
+     *  count is 0, then this region is set to the empty region.
+     *  @return true if the resulting region is non-empty
+     */
+    bool setRegions(const SkRegion regions[], int count, Op op);
+
 #ifdef SK_BUILD_FOR_ANDROID
     /** Returns a new char* containing the list of rectangles in this region
      */
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTextBlob_DEFINED
+#define SkTextBlob_DEFINED
+
+#include "SkPaint.h"
+#include "SkRect.h"
+#include "SkRefCnt.h"
+#include "SkTemplates.h"
+#include "SkThread.h"
+
+class SkGlyphCache;
+struct SkGlyph;
+
+/** \class SkTextBlob
+
+    An immutable run of text, already converted to glyphs and positioned, for
+    text that is drawn many times. Drawing a blob with SkCanvas::drawTextBlob()
+    skips the conversion of the text to glyphs, the measuring and kerning, and
+    after the first draw with a given strike, the lookups of the glyphs in the
+    glyph cache.
+
+    The blob holds the font attributes of the paint it was created with: the
+    typeface, text size, scale and skew, hinting, and the text flags such as
+    antialiasing, subpixel positioning and LCD rendering. The paint passed to
+    drawTextBlob() provides the rest (color, shader, style, ...). Like
+    drawPosText(), drawing a blob does not underline or strike through.
+*/
+class SK_API SkTextBlob : public SkRefCnt {
+public:
+    SK_DECLARE_INST_COUNT(SkTextBlob)
+
+    /** Returns a blob of the text, positioned as drawText() would, with the
+        origin at (0, 0) and interpreted according to the Align setting of
+        the paint.
+    */
+    static SkTextBlob* Create(const void* text, size_t byteLength, const SkPaint& paint);
+
+    /** Returns a blob of the text, with each glyph at the corresponding
+        position, interpreted according to the Align setting of the paint.
+    */
+    static SkTextBlob* CreatePos(const void* text, size_t byteLength,
+                                 const SkPoint pos[], const SkPaint& paint);
+
+    virtual ~SkTextBlob();
+
+    int count() const { return fCount; }
+    const uint16_t* glyphs() const { return fGlyphs.get(); }
+
+    /** The position of the left side of each glyph's baseline, relative to the
+        origin of the blob.
+    */
+    const SkPoint* positions() const { return fPositions.get(); }
+
+    /** Bounds of the unhinted glyphs, relative to the origin of the blob.
+        Hinting may move the glyphs' masks by up to a device pixel.
+    */
+    const SkRect& bounds() const { return fBounds; }
+
+    /** Sets the font attributes of paint to those of the blob, with glyph ID
+        encoding and left alignment.
+    */
+    void applyFontToPaint(SkPaint* paint) const;
+
+    /** A unique ID for this blob (never 0).
+    */
+    uint32_t uniqueID() const { return fUniqueID; }
+
+    /** The glyphs of the blob in one strike (one SkGlyphCache), in the order
+        of glyphs(). They stay valid as long as the caller holds the cache.
+    */
+    class StrikeGlyphs : public SkRefCnt {
+    public:
+        const SkGlyph* const* glyphs() const { return fGlyphs.get(); }
+
+    private:
+        StrikeGlyphs(int count, uint32_t cacheID) : fGlyphs(count), fCacheID(cacheID) {}
+
+        SkAutoTMalloc<const SkGlyph*>   fGlyphs;
+        uint32_t                        fCacheID;
+
+        friend class SkTextBlob;
+        typedef SkRefCnt INHERITED;
+    };
+
+    /** Returns the glyphs of the blob in the cache, which must not be
+        subpixel, and whose descriptor must come from a paint to which
+        applyFontToPaint() was applied. The caller must unref the result.
+        The glyphs of the last strike are kept, so that drawing the blob again
+        with the same strike does not look them up.
+    */
+    StrikeGlyphs* refStrikeGlyphs(SkGlyphCache* cache) const;
+
+private:
+    SkTextBlob(int count, const SkPaint& paint);
+
+    static SkTextBlob* CreateFromGlyphs(const SkPaint& paint, int count,
+                                        const uint16_t glyphs[], const SkPoint pos[],
+                                        const SkRect bounds[]);
+
+    const int                   fCount;
+    SkAutoTMalloc<uint16_t>     fGlyphs;
+    SkAutoTMalloc<SkPoint>      fPositions;
+    SkRect                      fBounds;
+    SkPaint                     fFont;
+    const uint32_t              fUniqueID;
+
+    mutable SkMutex             fStrikeMutex;
+    mutable StrikeGlyphs*       fStrikeGlyphs;
+
+    typedef SkRefCnt INHERITED;
+};
+
+#endif
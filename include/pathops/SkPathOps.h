@@ -8,6 +8,8 @@
 #define SkPathOps_DEFINED
 
 #include "SkPreConfig.h"
+#include "SkTArray.h"
+#include "SkTDArray.h"
 
 class SkPath;
 
@@ -36,9 +38,13 @@ enum SkPathOp {
     @param two The second operand (for difference, the subtrahend)
     @param result The product of the operands. The result may be one of the
                   inputs.
+    @param threadCount The groups of contours that are apart from each other
+                  are resolved on up to this many threads; a negative count
+                  uses one thread per core. The result does not depend on it.
     @return True if operation succeeded.
   */
-bool SK_API Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result);
+bool SK_API Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result,
+               int threadCount = 1);
 
 /** Set this path to a set of non-overlapping contours that describe the
     same area as the original path.
@@ -50,8 +56,36 @@ bool SK_API Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result
 
     @param path The path to simplify.
     @param result The simplified path. The result may be the input.
+    @param threadCount As for Op().
     @return True if simplification succeeded.
   */
-bool SK_API Simplify(const SkPath& path, SkPath* result);
+bool SK_API Simplify(const SkPath& path, SkPath* result, int threadCount = 1);
+
+/** Combines many paths at once. Each path added is combined with the result of
+    the paths added before it, with its operator:
+    result = (((first op1 second) op2 third) ...).
+    Unlike as many calls to Op(), consecutive unions, intersections, exclusive
+    ors and differences are combined as balanced trees of Op() calls, and for
+    paths that are not inverse filled, only the paths whose bounds overlap are
+    combined: unioning many shapes that are mostly apart (the polygons of a
+    map, say) does not intersect each with the growing result.
+  */
+class SK_API SkOpBuilder {
+public:
+    /** Adds a path to be combined with the paths before it. The operator of
+        the first path is ignored; it is the initial result.
+      */
+    void add(const SkPath& path, SkPathOp op);
+
+    /** Sets result to the combination of the paths added, and empties the
+        builder. Returns false, leaving result unmodified, if some operation
+        could not produce a result. The result may be one of the paths added.
+      */
+    bool resolve(SkPath* result);
+
+private:
+    SkTArray<SkPath> fPaths;
+    SkTDArray<SkPathOp> fOps;
+};
 
 #endif
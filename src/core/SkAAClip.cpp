@@ -655,6 +655,13 @@ bool SkAAClip::set(const SkAAClip& src) {
     return !this->isEmpty();
 }
 
+size_t SkAAClip::getRunsSize() const {
+    if (NULL == fRunHead) {
+        return 0;
+    }
+    return sizeof(RunHead) + fRunHead->fRowCount * sizeof(YOffset) + fRunHead->fDataSize;
+}
+
 bool SkAAClip::setEmpty() {
     this->freeRuns();
     fBounds.setEmpty();
@@ -419,6 +419,11 @@ void SkBitmapDevice::drawTextOnPath(const SkDraw& draw, const void* text,
     draw.drawTextOnPath((const char*)text, len, path, matrix, paint);
 }
 
+void SkBitmapDevice::drawTextBlob(const SkDraw& draw, const SkTextBlob* blob,
+                                  SkScalar x, SkScalar y, const SkPaint& paint) {
+    draw.drawTextBlob(blob, x, y, paint);
+}
+
 void SkBitmapDevice::drawVertices(const SkDraw& draw, SkCanvas::VertexMode vmode,
                                   int vertexCount,
                                   const SkPoint verts[], const SkPoint textures[],
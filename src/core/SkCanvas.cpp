@@ -8,6 +8,7 @@
 
 #include "SkCanvas.h"
 #include "SkBitmapDevice.h"
+#include "SkChecksum.h"
 #include "SkDeviceImageFilterProxy.h"
 #include "SkDraw.h"
 #include "SkDrawFilter.h"
@@ -19,8 +20,11 @@
 #include "SkRRect.h"
 #include "SkSmallAllocator.h"
 #include "SkSurface_Base.h"
+#include "SkTDynamicHash.h"
 #include "SkTemplates.h"
+#include "SkTextBlob.h"
 #include "SkTextFormatParams.h"
+#include "SkTInternalLList.h"
 #include "SkTLazy.h"
 #include "SkUtils.h"
 
@@ -105,6 +109,151 @@ void SkCanvas::predrawNotify() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static bool same_raster_clip(const SkRasterClip& a, const SkRasterClip& b) {
+    if (a.isBW() != b.isBW()) {
+        return false;
+    }
+    // Both compare their runs' pointers before their runs.
+    return a.isBW() ? a.bwRgn() == b.bwRgn() : a.aaRgn() == b.aaRgn();
+}
+
+/*  The clips that clipPath() recently made on the root device, so that
+    clipping again to the same path, with the same matrix and op, from the same
+    clip (as the next playback of a picture, or the next frame drawn from the
+    same paths, does) shares the clip made before instead of scan converting
+    the path again. As the clip made is shared, the clips nested in it are then
+    found too.
+
+    The clip stack's gen IDs cannot be the key, as each clip op gets a new one.
+    Instead the key is the path's gen ID, the matrix, the op, the device size,
+    and the bounds of the clip clipped to, whose runs are then compared. A path
+    is only kept the second time it is clipped to, so that the paths made for a
+    single clip do not push out the others, and the least recently used clips
+    are evicted past kMaxEntries, or once the runs of the clips kept take more
+    than kMaxBytes. A clip whose runs alone take more is not kept.
+*/
+class ClipPathCache : SkNoncopyable {
+public:
+    ClipPathCache() : fBytesUsed(0) {
+        sk_bzero(fRecent, sizeof(fRecent));
+    }
+
+    ~ClipPathCache() {
+        while (Entry* entry = fLRU.head()) {
+            this->remove(entry);
+        }
+    }
+
+    struct Key {
+        Key(const SkPath& path, const SkMatrix& matrix, SkRegion::Op op, bool doAA,
+            const SkISize& deviceSize, const SkRasterClip& prevClip) {
+            sk_bzero(this, sizeof(Key));
+            fGenID = path.getGenerationID();
+            fFlags = path.getFillType() | (op << 2) | (doAA << 5) | (prevClip.isBW() << 6);
+            fDeviceSize = deviceSize;
+            fPrevBounds = prevClip.getBounds();
+            for (int i = 0; i < 9; ++i) {
+                fMatrix[i] = matrix[i];
+            }
+        }
+
+        bool operator==(const Key& other) const {
+            return 0 == memcmp(this, &other, sizeof(Key));
+        }
+
+        uint32_t hash() const {
+            SK_COMPILE_ASSERT(SkIsAlign4(sizeof(Key)), key_must_be_words);
+            return SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(this), sizeof(Key));
+        }
+
+        uint32_t    fGenID;
+        uint32_t    fFlags;     // fill type, op, doAA, and whether the clip clipped to is BW
+        SkISize     fDeviceSize;
+        SkIRect     fPrevBounds;
+        SkScalar    fMatrix[9];
+    };
+
+    /** If the clip made by clipping clip to the key's path is kept, sets clip
+        to it and returns true.
+    */
+    bool find(const Key& key, SkRasterClip* clip) {
+        Entry* entry = fHash.find(key);
+        if (NULL == entry || !same_raster_clip(entry->fPrevClip, *clip)) {
+            return false;
+        }
+        if (fLRU.head() != entry) {
+            fLRU.remove(entry);
+            fLRU.addToHead(entry);
+        }
+        *clip = entry->fClip;
+        return true;
+    }
+
+    void add(const Key& key, const SkRasterClip& prevClip, const SkRasterClip& clip) {
+        const uint32_t hash = key.hash();
+        uint32_t* recent = &fRecent[hash & (kRecentCount - 1)];
+        if (*recent != hash) {
+            *recent = hash;
+            return;
+        }
+        const size_t bytes = sizeof(Entry) + prevClip.approximateRunsSize() +
+                             clip.approximateRunsSize();
+        Entry* entry = fHash.find(key);
+        if (entry) {
+            // It was made from another clip with the same bounds.
+            this->remove(entry);
+        }
+        if (bytes > kMaxBytes) {
+            return;
+        }
+        while (fHash.count() == kMaxEntries || fBytesUsed + bytes > kMaxBytes) {
+            this->remove(fLRU.tail());
+        }
+        entry = SkNEW_ARGS(Entry, (key));
+        entry->fPrevClip = prevClip;
+        entry->fClip = clip;
+        entry->fBytes = bytes;
+        fHash.add(entry);
+        fLRU.addToHead(entry);
+        fBytesUsed += bytes;
+    }
+
+private:
+    enum {
+        kMaxEntries = 256,
+        kRecentCount = 256,
+    };
+    static const size_t kMaxBytes = 2 * 1024 * 1024;
+
+    struct Entry {
+        explicit Entry(const Key& key) : fKey(key) {}
+
+        Key             fKey;
+        SkRasterClip    fPrevClip;  // keeps the runs of the clip clipped to alive
+        SkRasterClip    fClip;
+        size_t          fBytes;
+
+        static const Key& GetKey(const Entry& entry) { return entry.fKey; }
+        static uint32_t Hash(const Key& key) { return key.hash(); }
+
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+    };
+
+    void remove(Entry* entry) {
+        SkASSERT(fBytesUsed >= entry->fBytes);
+        fBytesUsed -= entry->fBytes;
+        fHash.remove(entry->fKey);
+        fLRU.remove(entry);
+        SkDELETE(entry);
+    }
+
+    SkTDynamicHash<Entry, Key>  fHash;
+    SkTInternalLList<Entry>     fLRU;   // most recently used first
+    size_t                      fBytesUsed;
+    // The hashes of keys that were clipped to and not found.
+    uint32_t                    fRecent[kRecentCount];
+};
+
 /*  This is the record we keep for each SkBaseDevice that the user installs.
     The clip/matrix/proc are fields that reflect the top of the save/restore
     stack. Whenever the canvas changes, it marks a dirty flag, and then before
@@ -118,9 +267,11 @@ struct DeviceCM {
     SkRasterClip        fClip;
     const SkMatrix*     fMatrix;
     SkPaint*            fPaint; // may be null (in the future)
+    ClipPathCache*      fClipPathCache; // only made for the root device
 
     DeviceCM(SkBaseDevice* device, int x, int y, const SkPaint* paint, SkCanvas* canvas)
-            : fNext(NULL) {
+            : fNext(NULL)
+            , fClipPathCache(NULL) {
         if (NULL != device) {
             device->ref();
             device->onAttachToCanvas(canvas);
@@ -135,6 +286,14 @@ struct DeviceCM {
             fDevice->unref();
         }
         SkDELETE(fPaint);
+        SkDELETE(fClipPathCache);
+    }
+
+    ClipPathCache* clipPathCache() {
+        if (NULL == fClipPathCache) {
+            fClipPathCache = SkNEW(ClipPathCache);
+        }
+        return fClipPathCache;
     }
 
     void updateMC(const SkMatrix& totalMatrix, const SkRasterClip& totalClip,
@@ -765,6 +924,9 @@ SkCanvas* SkCanvas::canvasForDrawIter() {
 
 void SkCanvas::updateDeviceCMCache() {
     if (fDeviceCMDirty) {
+        // scan convert a clip shape once, rather than in each copy
+        fMCRec->fRasterClip->realize();
+
         const SkMatrix& totalMatrix = this->getTotalMatrix();
         const SkRasterClip& totalClip = *fMCRec->fRasterClip;
         DeviceCM*       layer = fMCRec->fTopLayer;
@@ -1384,6 +1546,7 @@ static void clip_path_helper(const SkCanvas* canvas, SkRasterClip* currClip,
     SkRegion base;
 
     if (SkRegion::kIntersect_Op == op) {
+        currClip->realize();
         // since we are intersect, we can do better (tighter) with currRgn's
         // bounds, than just using the device. However, if currRgn is complex,
         // our region blitter may hork, so we do that case in two steps.
@@ -1439,6 +1602,12 @@ void SkCanvas::onClipRRect(const SkRRect& rrect, SkRegion::Op op, ClipEdgeStyle
 
         fClipStack.clipDevRRect(transformedRRect, op, kSoft_ClipEdgeStyle == edgeStyle);
 
+        if (SkRegion::kIntersect_Op == op &&
+            fMCRec->fRasterClip->quickIntersect(transformedRRect,
+                                                kSoft_ClipEdgeStyle == edgeStyle)) {
+            return;
+        }
+
         SkPath devPath;
         devPath.addRRect(transformedRRect);
 
@@ -1529,9 +1698,22 @@ void SkCanvas::onClipPath(const SkPath& path, SkRegion::Op op, ClipEdgeStyle edg
             }
         }
         op = SkRegion::kReplace_Op;
+        clip_path_helper(this, fMCRec->fRasterClip, devPath, op, edgeStyle);
+        return;
     }
 
-    clip_path_helper(this, fMCRec->fRasterClip, devPath, op, edgeStyle);
+    const bool doAA = kSoft_ClipEdgeStyle == edgeStyle;
+    // the key and the path's clip need the runs of the clip clipped to
+    fMCRec->fRasterClip->realize();
+    const ClipPathCache::Key key(path, *fMCRec->fMatrix, op, doAA,
+                                 this->getBaseLayerSize(), *fMCRec->fRasterClip);
+    ClipPathCache* cache = ((MCRec*)fMCStack.front())->fLayer->clipPathCache();
+    if (cache->find(key, fMCRec->fRasterClip)) {
+        return;
+    }
+    const SkRasterClip prevClip(*fMCRec->fRasterClip);
+    clip_path_helper(this, fMCRec->fRasterClip, devPath, op, doAA);
+    cache->add(key, prevClip, *fMCRec->fRasterClip);
 }
 
 void SkCanvas::updateClipConservativelyUsingBounds(const SkRect& bounds, SkRegion::Op op,
@@ -1695,6 +1877,7 @@ bool SkCanvas::quickReject(const SkRect& rect) const {
         fMCRec->fMatrix->mapRect(&dst, rect);
         SkIRect idst;
         dst.roundOut(&idst);
+        fMCRec->fRasterClip->realize();
         return !SkIRect::Intersects(idst, fMCRec->fRasterClip->getBounds());
     } else {
         const SkRect& clipR = this->getLocalClipBounds();
@@ -1743,6 +1926,9 @@ bool SkCanvas::getClipBounds(SkRect* bounds) const {
 }
 
 bool SkCanvas::getClipDeviceBounds(SkIRect* bounds) const {
+    // the bounds of a clip shape are those of the coverage it is scan
+    // converted to
+    fMCRec->fRasterClip->realize();
     const SkRasterClip& clip = *fMCRec->fRasterClip;
     if (clip.isEmpty()) {
         if (bounds) {
@@ -2315,6 +2501,61 @@ void SkCanvas::onDrawTextOnPath(const void* text, size_t byteLength, const SkPat
     LOOPER_END
 }
 
+void SkCanvas::onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                              const SkPaint& paint) {
+    if (0 == blob->count()) {
+        return;
+    }
+
+    SkPaint blobPaint(paint);
+    blob->applyFontToPaint(&blobPaint);
+
+    // The blob's bounds are measured without the matrix, and hinting may move
+    // the glyphs' masks by a device pixel, which can be many units of the blob
+    // when the matrix scales down. Outset the bounds by a pixel in device space.
+    SkRect storage;
+    SkRect r = blob->bounds().makeOffset(x, y);
+    const SkRect* bounds = NULL;
+    const SkMatrix& matrix = this->getTotalMatrix();
+    SkMatrix inverse;
+    if (!matrix.hasPerspective() && matrix.invert(&inverse) &&
+        blobPaint.canComputeFastBounds()) {
+        if (!r.isEmpty()) {
+            SkRect devRect;
+            matrix.mapRect(&devRect, r);
+            devRect.outset(SK_Scalar1, SK_Scalar1);
+            inverse.mapRect(&r, devRect);
+        }
+        bounds = &blobPaint.computeFastBounds(r, &storage);
+        if (this->quickReject(*bounds)) {
+            return;
+        }
+    }
+
+    LOOPER_BEGIN(blobPaint, SkDrawFilter::kText_Type, bounds)
+
+    while (iter.next()) {
+        SkDeviceFilteredPaint dfp(iter.fDevice, looper.paint());
+        iter.fDevice->drawTextBlob(iter, blob, x, y, dfp.paint());
+    }
+
+    LOOPER_END
+}
+
+void SkCanvas::drawTextBlobAsPosText(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                                     const SkPaint& paint) {
+    SkPaint blobPaint(paint);
+    blob->applyFontToPaint(&blobPaint);
+
+    const int count = blob->count();
+    SkAutoSTMalloc<64, SkPoint> pos(count);
+    const SkPoint* blobPos = blob->positions();
+    for (int i = 0; i < count; ++i) {
+        pos[i].set(blobPos[i].fX + x, blobPos[i].fY + y);
+    }
+    this->drawPosText(blob->glyphs(), count * sizeof(uint16_t), pos.get(), blobPaint);
+}
+
 // These will become non-virtual, so they always call the (virtual) onDraw... method
 void SkCanvas::drawText(const void* text, size_t byteLength, SkScalar x, SkScalar y,
                         const SkPaint& paint) {
@@ -2332,6 +2573,11 @@ void SkCanvas::drawTextOnPath(const void* text, size_t byteLength, const SkPath&
                               const SkMatrix* matrix, const SkPaint& paint) {
     this->onDrawTextOnPath(text, byteLength, path, matrix, paint);
 }
+void SkCanvas::drawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                            const SkPaint& paint) {
+    SkASSERT(blob);
+    this->onDrawTextBlob(blob, x, y, paint);
+}
 
 void SkCanvas::drawVertices(VertexMode vmode, int vertexCount,
                             const SkPoint verts[], const SkPoint texs[],
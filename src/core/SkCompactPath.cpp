@@ -0,0 +1,353 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCompactPath.h"
+
+#include "SkChecksum.h"
+#include "SkTDArray.h"
+
+// The points are rounded to this many steps across the bounds of the path.
+static const int kMaxStep = 0xFFFF;
+
+static inline bool fits_in_byte(int32_t value) {
+    return value >= -128 && value <= 127;
+}
+
+static inline unsigned get_verb(const uint8_t verbs[], int index) {
+    return (verbs[index >> 1] >> ((index & 1) << 2)) & 0xF;
+}
+
+static SkScalar step_across(SkScalar size) {
+    return size / kMaxStep;
+}
+
+static int32_t round_to_step(SkScalar value, SkScalar origin, SkScalar step) {
+    if (0 == step) {
+        return 0;
+    }
+    return SkPin32(SkScalarRoundToInt((value - origin) / step), 0, kMaxStep);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkCompactPath::PointReader::init(const SkCompactPath& path) {
+    fCoords = path.coords();
+    fX = 0;
+    fY = 0;
+    fOrigin = path.fOrigin;
+    fStep = path.fStep;
+    fIsDelta = SkToBool(path.fIsDelta);
+}
+
+void SkCompactPath::PointReader::next(SkPoint* pt) {
+    if (fIsDelta) {
+        fX += (int8_t)fCoords[0];
+        fY += (int8_t)fCoords[1];
+        fCoords += 2;
+    } else {
+        fX = fCoords[0] | (fCoords[1] << 8);
+        fY = fCoords[2] | (fCoords[3] << 8);
+        fCoords += 4;
+    }
+    pt->set(fOrigin.fX + fX * fStep.fX, fOrigin.fY + fY * fStep.fY);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkCompactPath::SkCompactPath() : fData(NULL), fDataSize(0) {}
+
+SkCompactPath::~SkCompactPath() {
+    sk_free(fData);
+}
+
+SkCompactPath* SkCompactPath::Create(const SkPath& path) {
+    if (!path.isFinite()) {
+        return NULL;
+    }
+
+    SkCompactPath* compact = SkNEW(SkCompactPath);
+    const SkRect& bounds = path.getBounds();
+    compact->fOrigin.set(bounds.fLeft, bounds.fTop);
+    compact->fStep.set(step_across(bounds.width()), step_across(bounds.height()));
+
+    SkTDArray<SkScalar> conicWeights;
+    SkTDArray<uint8_t> verbs;
+    SkTDArray<int32_t> steps;
+    int verbCount = 0;
+    int pointCount = 0;
+
+    SkPath::RawIter iter(path);
+    SkPoint pts[4];
+    SkPath::Verb verb;
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        if (verbCount & 1) {
+            verbs.top() |= verb << 4;
+        } else {
+            *verbs.append() = verb;
+        }
+        verbCount += 1;
+
+        const SkPoint* newPts;
+        int newCount;
+        switch (verb) {
+            case SkPath::kMove_Verb:
+                newPts = pts;
+                newCount = 1;
+                break;
+            case SkPath::kLine_Verb:
+                newPts = &pts[1];
+                newCount = 1;
+                break;
+            case SkPath::kConic_Verb:
+                *conicWeights.append() = iter.conicWeight();
+                // fall through
+            case SkPath::kQuad_Verb:
+                newPts = &pts[1];
+                newCount = 2;
+                break;
+            case SkPath::kCubic_Verb:
+                newPts = &pts[1];
+                newCount = 3;
+                break;
+            default:
+                newPts = NULL;
+                newCount = 0;
+                break;
+        }
+        for (int i = 0; i < newCount; ++i) {
+            *steps.append() = round_to_step(newPts[i].fX, compact->fOrigin.fX, compact->fStep.fX);
+            *steps.append() = round_to_step(newPts[i].fY, compact->fOrigin.fY, compact->fStep.fY);
+        }
+        pointCount += newCount;
+    }
+
+    bool isDelta = true;
+    for (int i = 0; i < steps.count() && isDelta; ++i) {
+        isDelta = fits_in_byte(steps[i] - (i >= 2 ? steps[i - 2] : 0));
+    }
+    SkTDArray<uint8_t> coords;
+    if (isDelta) {
+        for (int i = 0; i < steps.count(); ++i) {
+            *coords.append() = (uint8_t)(steps[i] - (i >= 2 ? steps[i - 2] : 0));
+        }
+    } else {
+        for (int i = 0; i < steps.count(); ++i) {
+            uint8_t* bytes = coords.append(2);
+            bytes[0] = (uint8_t)steps[i];
+            bytes[1] = (uint8_t)(steps[i] >> 8);
+        }
+    }
+    compact->fIsDelta = isDelta;
+
+    size_t weightsSize = conicWeights.count() * sizeof(SkScalar);
+    compact->fDataSize = SkToU32(weightsSize + verbs.count() + coords.count());
+    compact->fData = (uint8_t*)sk_malloc_throw(compact->fDataSize);
+    memcpy(compact->fData, conicWeights.begin(), weightsSize);
+    memcpy(compact->fData + weightsSize, verbs.begin(), verbs.count());
+    memcpy(compact->fData + weightsSize + verbs.count(), coords.begin(), coords.count());
+    compact->fVerbCount = verbCount;
+    compact->fPointCount = pointCount;
+    compact->fConicCount = conicWeights.count();
+    compact->fFillType = SkToU8(path.getFillType());
+
+    // The bounds, convexity and segments are those of the rounded points.
+    SkPath rounded;
+    compact->toPath(&rounded);
+    compact->fBounds = rounded.getBounds();
+    compact->fIsConvex = rounded.isConvex();
+    compact->fSegmentMasks = SkToU8(rounded.getSegmentMasks());
+
+    uint32_t hash = SkChecksum::Murmur3((const uint32_t*)&compact->fOrigin,
+                                        2 * sizeof(SkPoint), compact->fFillType);
+    compact->fHash = SkChecksum::Murmur3((const uint32_t*)compact->fData,
+                                         compact->fDataSize & ~3u, hash);
+    return compact;
+}
+
+void SkCompactPath::toPath(SkPath* path) const {
+    path->reset();
+    path->incReserve(fPointCount);
+
+    PointReader reader;
+    reader.init(*this);
+    const uint8_t* verbs = this->verbs();
+    const SkScalar* conicWeights = this->conicWeights();
+    SkPoint pts[3];
+    for (int i = 0; i < fVerbCount; ++i) {
+        switch (get_verb(verbs, i)) {
+            case SkPath::kMove_Verb:
+                reader.next(&pts[0]);
+                path->moveTo(pts[0]);
+                break;
+            case SkPath::kLine_Verb:
+                reader.next(&pts[0]);
+                path->lineTo(pts[0]);
+                break;
+            case SkPath::kQuad_Verb:
+                reader.next(&pts[0]);
+                reader.next(&pts[1]);
+                path->quadTo(pts[0], pts[1]);
+                break;
+            case SkPath::kConic_Verb:
+                reader.next(&pts[0]);
+                reader.next(&pts[1]);
+                path->conicTo(pts[0], pts[1], *conicWeights++);
+                break;
+            case SkPath::kCubic_Verb:
+                reader.next(&pts[0]);
+                reader.next(&pts[1]);
+                reader.next(&pts[2]);
+                path->cubicTo(pts[0], pts[1], pts[2]);
+                break;
+            case SkPath::kClose_Verb:
+                path->close();
+                break;
+            default:
+                SkDEBUGFAIL("unexpected verb");
+                break;
+        }
+    }
+    path->setFillType(this->getFillType());
+}
+
+bool SkCompactPath::operator==(const SkCompactPath& other) const {
+    return fHash == other.fHash &&
+           fFillType == other.fFillType &&
+           fOrigin == other.fOrigin &&
+           fStep == other.fStep &&
+           fIsDelta == other.fIsDelta &&
+           fVerbCount == other.fVerbCount &&
+           fDataSize == other.fDataSize &&
+           0 == memcmp(fData, other.fData, fDataSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkCompactPath::Iter::Iter(const SkCompactPath& path, bool forceClose) {
+    fReader.init(path);
+    fVerbs = path.verbs();
+    fConicWeights = path.conicWeights();
+    fVerbIndex = 0;
+    fVerbCount = path.fVerbCount;
+    fMoveTo.set(0, 0);
+    fLastPt.set(0, 0);
+    fForceClose = forceClose;
+    fNeedClose = false;
+    fAfterMove = false;
+}
+
+SkPath::Verb SkCompactPath::Iter::autoClose(SkPoint pts[2]) {
+    if (fLastPt != fMoveTo) {
+        pts[0] = fLastPt;
+        pts[1] = fMoveTo;
+        fLastPt = fMoveTo;
+        return SkPath::kLine_Verb;
+    }
+    pts[0] = fMoveTo;
+    return SkPath::kClose_Verb;
+}
+
+// This follows SkPath::Iter::doNext(), so that the two give the same verbs
+// and points.
+SkPath::Verb SkCompactPath::Iter::next(SkPoint pts[4]) {
+    if (fVerbIndex == fVerbCount) {
+        if (fNeedClose && !fAfterMove) {
+            if (SkPath::kLine_Verb == this->autoClose(pts)) {
+                return SkPath::kLine_Verb;
+            }
+            fNeedClose = false;
+            return SkPath::kClose_Verb;
+        }
+        return SkPath::kDone_Verb;
+    }
+
+    SkPath::Verb verb = (SkPath::Verb)get_verb(fVerbs, fVerbIndex);
+    fVerbIndex += 1;
+    switch (verb) {
+        case SkPath::kMove_Verb:
+            if (fNeedClose) {
+                fVerbIndex -= 1;
+                verb = this->autoClose(pts);
+                if (SkPath::kClose_Verb == verb) {
+                    fNeedClose = false;
+                }
+                return verb;
+            }
+            if (fVerbIndex == fVerbCount) {
+                // a trailing moveTo
+                return SkPath::kDone_Verb;
+            }
+            fReader.next(&fMoveTo);
+            pts[0] = fMoveTo;
+            fLastPt = fMoveTo;
+            fNeedClose = fForceClose;
+            fAfterMove = true;
+            break;
+        case SkPath::kLine_Verb:
+            pts[0] = fLastPt;
+            fReader.next(&pts[1]);
+            fLastPt = pts[1];
+            fAfterMove = false;
+            break;
+        case SkPath::kConic_Verb:
+            fConicWeights += 1;
+            // fall through
+        case SkPath::kQuad_Verb:
+            pts[0] = fLastPt;
+            fReader.next(&pts[1]);
+            fReader.next(&pts[2]);
+            fLastPt = pts[2];
+            fAfterMove = false;
+            break;
+        case SkPath::kCubic_Verb:
+            pts[0] = fLastPt;
+            fReader.next(&pts[1]);
+            fReader.next(&pts[2]);
+            fReader.next(&pts[3]);
+            fLastPt = pts[3];
+            fAfterMove = false;
+            break;
+        case SkPath::kClose_Verb:
+            verb = this->autoClose(pts);
+            if (SkPath::kLine_Verb == verb) {
+                fVerbIndex -= 1;
+            } else {
+                fNeedClose = false;
+                fAfterMove = true;
+            }
+            fLastPt = fMoveTo;
+            break;
+        default:
+            SkDEBUGFAIL("unexpected verb");
+            return SkPath::kDone_Verb;
+    }
+    return verb;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkCompactPathPool::~SkCompactPathPool() {
+    SkTDynamicHash<SkCompactPath, SkCompactPath>::Iter iter(&fPaths);
+    while (!iter.done()) {
+        (*iter).unref();
+        ++iter;
+    }
+}
+
+SkCompactPath* SkCompactPathPool::add(const SkPath& path) {
+    SkCompactPath* compact = SkCompactPath::Create(path);
+    if (NULL == compact) {
+        return NULL;
+    }
+    SkCompactPath* found = fPaths.find(*compact);
+    if (found) {
+        compact->unref();
+        return SkRef(found);
+    }
+    fPaths.add(compact);
+    return SkRef(compact);
+}
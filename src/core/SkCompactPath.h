@@ -0,0 +1,171 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkCompactPath_DEFINED
+#define SkCompactPath_DEFINED
+
+#include "SkPath.h"
+#include "SkRefCnt.h"
+#include "SkTDynamicHash.h"
+
+/** \class SkCompactPath
+
+    An immutable, compact copy of a path, for keeping very many paths that are
+    only drawn. The points are rounded to a grid of 65536 x 65536 steps across
+    the bounds of the path, so a point moves by at most half a step (1/131070
+    of the width or height of the path). Each point takes four bytes rather
+    than eight, or two if the path moves less than 128 steps from each point
+    to the next, in which case the points are stored as those moves. Each verb
+    takes four bits.
+
+    SkScan::FillPath() and SkScan::AntiFillPath() draw a compact path directly,
+    building its edges as they decode it, exactly as they would draw the path
+    that toPath() returns.
+*/
+class SkCompactPath : public SkRefCnt {
+public:
+    SK_DECLARE_INST_COUNT(SkCompactPath)
+
+    /** Returns a compact copy of the path, or NULL if the path has points that
+        are not finite. The caller must unref the result.
+    */
+    static SkCompactPath* Create(const SkPath& path);
+
+    virtual ~SkCompactPath();
+
+    /** The bounds of the points, after rounding.
+    */
+    const SkRect& getBounds() const { return fBounds; }
+
+    SkPath::FillType getFillType() const { return (SkPath::FillType)fFillType; }
+    bool isInverseFillType() const { return SkPath::IsInverseFillType(this->getFillType()); }
+
+    /** Whether the path is convex, after rounding.
+    */
+    bool isConvex() const { return SkToBool(fIsConvex); }
+
+    uint32_t getSegmentMasks() const { return fSegmentMasks; }
+    int countPoints() const { return fPointCount; }
+    int countVerbs() const { return fVerbCount; }
+
+    /** The heap memory held by the compact path, including itself.
+    */
+    size_t bytesUsed() const { return sizeof(*this) + fDataSize; }
+
+    /** Sets path to the points and verbs of the compact path.
+    */
+    void toPath(SkPath* path) const;
+
+    /** Two compact paths are equal if they have the same fill type, points
+        and verbs.
+    */
+    bool operator==(const SkCompactPath& other) const;
+
+    // For SkTDynamicHash.
+    static const SkCompactPath& GetKey(const SkCompactPath& path) { return path; }
+    static uint32_t Hash(const SkCompactPath& path) { return path.fHash; }
+
+private:
+    // Reads the points back in order.
+    class PointReader {
+    public:
+        void init(const SkCompactPath& path);
+        void next(SkPoint* pt);
+
+    private:
+        const uint8_t*  fCoords;
+        int32_t         fX;
+        int32_t         fY;
+        SkPoint         fOrigin;
+        SkPoint         fStep;
+        bool            fIsDelta;
+    };
+
+public:
+    /** Iterates through the verbs and points of a compact path, like
+        SkPath::Iter.
+    */
+    class Iter {
+    public:
+        Iter(const SkCompactPath& path, bool forceClose);
+
+        /** Returns the next verb, and its points, as SkPath::Iter::next()
+            would for the path that toPath() returns (without skipping
+            degenerate segments).
+        */
+        SkPath::Verb next(SkPoint pts[4]);
+
+        /** The weight of the conic that next() returned last.
+        */
+        SkScalar conicWeight() const { return fConicWeights[-1]; }
+
+    private:
+        SkPath::Verb autoClose(SkPoint pts[2]);
+
+        PointReader         fReader;
+        const uint8_t*      fVerbs;
+        const SkScalar*     fConicWeights;
+        int                 fVerbIndex;
+        int                 fVerbCount;
+        SkPoint             fMoveTo;
+        SkPoint             fLastPt;
+        bool                fForceClose;
+        bool                fNeedClose;
+        bool                fAfterMove;
+    };
+
+private:
+    SkCompactPath();
+
+    SkRect          fBounds;
+    SkPoint         fOrigin;
+    SkPoint         fStep;
+    // The conic weights, then the verbs, two to a byte, then the coordinates.
+    uint8_t*        fData;
+    uint32_t        fDataSize;
+    int             fVerbCount;
+    int             fPointCount;
+    int             fConicCount;
+    uint32_t        fHash;
+    uint8_t         fFillType;
+    uint8_t         fIsConvex;
+    uint8_t         fSegmentMasks;
+    // Whether the coordinates are one byte moves from the previous point,
+    // rather than two byte steps from the origin.
+    uint8_t         fIsDelta;
+
+    const SkScalar* conicWeights() const { return (const SkScalar*)fData; }
+    const uint8_t* verbs() const { return fData + fConicCount * sizeof(SkScalar); }
+    const uint8_t* coords() const { return this->verbs() + ((fVerbCount + 1) >> 1); }
+
+    typedef SkRefCnt INHERITED;
+};
+
+/** \class SkCompactPathPool
+
+    Makes compact copies of paths, sharing one copy among all the paths that
+    have the same compact form. Not thread safe.
+*/
+class SkCompactPathPool : SkNoncopyable {
+public:
+    ~SkCompactPathPool();
+
+    /** Returns the compact copy of the path, which is the same object for
+        each path with the same compact form, or NULL if the path has points
+        that are not finite. The caller must unref the result.
+    */
+    SkCompactPath* add(const SkPath& path);
+
+    /** The number of distinct compact paths in the pool.
+    */
+    int count() const { return fPaths.count(); }
+
+private:
+    SkTDynamicHash<SkCompactPath, SkCompactPath> fPaths;
+};
+
+#endif
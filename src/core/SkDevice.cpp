@@ -7,6 +7,7 @@
 
 #include "SkDevice.h"
 #include "SkMetaData.h"
+#include "SkTextBlob.h"
 
 SkBaseDevice::SkBaseDevice()
     : fLeakyProperties(SkDeviceProperties::MakeDefault())
@@ -77,6 +78,18 @@ void SkBaseDevice::drawDRRect(const SkDraw& draw, const SkRRect& outer,
     this->drawPath(draw, path, paint, preMatrix, pathIsMutable);
 }
 
+void SkBaseDevice::drawTextBlob(const SkDraw& draw, const SkTextBlob* blob,
+                                SkScalar x, SkScalar y, const SkPaint& paint) {
+    const int count = blob->count();
+    SkAutoSTMalloc<64, SkPoint> pos(count);
+    const SkPoint* blobPos = blob->positions();
+    for (int i = 0; i < count; ++i) {
+        pos[i].set(blobPos[i].fX + x, blobPos[i].fY + y);
+    }
+    this->drawPosText(draw, blob->glyphs(), count * sizeof(uint16_t), &pos[0].fX, 0, 2,
+                      paint);
+}
+
 bool SkBaseDevice::readPixels(const SkImageInfo& info, void* dstP, size_t rowBytes, int x, int y) {
 #ifdef SK_DEBUG
     SkASSERT(info.width() > 0 && info.height() > 0);
@@ -6,14 +6,36 @@
  */
 
 #include "SkDistanceFieldGen.h"
+#include "SkFixed.h"
+#include "SkMask.h"
+#include "SkMatrix.h"
 #include "SkPoint.h"
 
-struct DFData {
-    float   fAlpha;      // alpha value of source texel
-    float   fDistSq;     // distance squared to nearest (so far) edge texel
-    SkPoint fDistVector; // distance vector to nearest (so far) edge texel
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
+
+// The transform works on the distances to the nearest (so far) edge texel, kept in
+// separate arrays so that a row of texels can be processed several at a time.
+struct DFRows {
+    float* fDistSq;      // distance squared to nearest (so far) edge texel
+    float* fDistX;       // distance vector to nearest (so far) edge texel
+    float* fDistY;
 };
 
+// we expand our temp data by one more on each side to simplify
+// the scanning code -- will always be treated as infinitely far away
+static const int kDataPad = SK_DistanceFieldPad + 1;
+
+// Fields taller than this are generated in bands, so that the temp data of a band stays
+// small for large images.
+static const int kBandRows = 256;
+
+// The rows generated above and below a band. Only distances within
+// SK_DistanceFieldMagnitude of an edge are kept, and those come from edges that are
+// no further away than that.
+static const int kBandHalo = 3*SK_DistanceFieldMagnitude;
+
 enum NeighborFlags {
     kLeft_NeighborFlag        = 0x01,
     kRight_NeighborFlag       = 0x02,
@@ -63,21 +85,71 @@ static bool found_edge(const unsigned char* imagePtr, int width, int neighborFla
     return false;
 }
 
-static void init_glyph_data(DFData* data, unsigned char* edges, const unsigned char* image,
-                            int dataWidth, int dataHeight,
-                            int imageWidth, int imageHeight,
-                            int pad) {
-    data += pad*dataWidth;
-    data += pad;
-    edges += (pad*dataWidth + pad);
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+// Same as found_edge() for the 16 texels at imagePtr, none of which may be on the border
+// of the image. Returns 0xFF for the edges, 0 otherwise.
+static inline __m128i found_edges16(const unsigned char* imagePtr, int width) {
+    const int offsets[8] = {-1, 1, -width-1, -width, -width+1, width-1, width, width+1 };
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_cmpeq_epi8(zero, zero);
+
+    // >= 128, and < 128 but not 0
+    const __m128i curr = _mm_loadu_si128((const __m128i*)imagePtr);
+    const __m128i currHigh = _mm_cmplt_epi8(curr, zero);
+    const __m128i currLow = _mm_andnot_si128(_mm_or_si128(currHigh, _mm_cmpeq_epi8(curr, zero)),
+                                             ones);
+    __m128i edges = zero;
+    for (int i = 0; i < 8; ++i) {
+        const __m128i neighbor = _mm_loadu_si128((const __m128i*)(imagePtr + offsets[i]));
+        const __m128i neighborHigh = _mm_cmplt_epi8(neighbor, zero);
+        const __m128i neighborLow = _mm_andnot_si128(_mm_or_si128(neighborHigh,
+                                                                  _mm_cmpeq_epi8(neighbor, zero)),
+                                                     ones);
+        // sharp transition, or both <128 and >0
+        edges = _mm_or_si128(edges, _mm_or_si128(_mm_xor_si128(currHigh, neighborHigh),
+                                                 _mm_and_si128(currLow, neighborLow)));
+    }
+    return edges;
+}
+#endif
 
-    for (int j = 0; j < imageHeight; ++j) {
+// Copies the alpha of the padded image into the data rows [bandTop-1, bandTop+bandHeight]
+// and marks the edges in the rows [bandTop, bandTop+bandHeight). image holds the rows of
+// the padded image that those need, starting at imageTop.
+static void init_glyph_data(float* alpha, unsigned char* edges,
+                            const unsigned char* image, int imageTop,
+                            int dataWidth, int bandTop, int bandHeight,
+                            int imageWidth, int imageHeight) {
+    for (int y = bandTop - 1; y <= bandTop + bandHeight; ++y) {
+        const int j = y - SK_DistanceFieldPad;
+        if (j < 0 || j >= imageHeight) {
+            alpha += dataWidth;
+            continue;
+        }
+        const unsigned char* imagePtr = image + (j - imageTop)*imageWidth;
+        float* alphaPtr = alpha + SK_DistanceFieldPad;
         for (int i = 0; i < imageWidth; ++i) {
-            if (255 == *image) {
-                data->fAlpha = 1.0f;
+            if (255 == imagePtr[i]) {
+                alphaPtr[i] = 1.0f;
             } else {
-                data->fAlpha = (*image)*0.00392156862f;  // 1/255
+                alphaPtr[i] = imagePtr[i]*0.00392156862f;  // 1/255
             }
+        }
+        alpha += dataWidth;
+
+        if (y < bandTop || y >= bandTop + bandHeight) {
+            continue;
+        }
+        unsigned char* edgePtr = edges + (y - bandTop)*dataWidth + SK_DistanceFieldPad;
+        int i = 0;
+        while (i < imageWidth) {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+            if (i > 0 && i + 16 < imageWidth && j > 0 && j < imageHeight-1) {
+                _mm_storeu_si128((__m128i*)(edgePtr + i), found_edges16(imagePtr + i, imageWidth));
+                i += 16;
+                continue;
+            }
+#endif
             int checkMask = kAll_NeighborFlags;
             if (i == 0) {
                 checkMask &= ~(kLeft_NeighborFlag|kTopLeft_NeighborFlag|kBottomLeft_NeighborFlag);
@@ -91,15 +163,11 @@ static void init_glyph_data(DFData* data, unsigned char* edges, const unsigned c
             if (j == imageHeight-1) {
                 checkMask &= ~(kBottomLeft_NeighborFlag|kBottom_NeighborFlag|kBottomRight_NeighborFlag);
             }
-            if (found_edge(image, imageWidth, checkMask)) {
-                *edges = 255;  // using 255 makes for convenient debug rendering
+            if (found_edge(imagePtr + i, imageWidth, checkMask)) {
+                edgePtr[i] = 255;  // using 255 makes for convenient debug rendering
             }
-            ++data;
-            ++image;
-            ++edges;
+            ++i;
         }
-        data += 2*pad;
-        edges += 2*pad;
     }
 }
 
@@ -145,45 +213,45 @@ static float edge_distance(const SkPoint& direction, float alpha) {
     return distance;
 }
 
-static void init_distances(DFData* data, unsigned char* edges, int width, int height) {
-    // skip one pixel border
-    DFData* currData = data;
-    DFData* prevData = data - width;
-    DFData* nextData = data + width;
-
+// alpha starts one row above the band, and has a row below it
+static void init_distances(const DFRows& rows, const float* alpha, const unsigned char* edges,
+                           int width, int height) {
+    int index = 0;
     for (int j = 0; j < height; ++j) {
+        const float* prevAlpha = alpha + j*width;
+        const float* currAlpha = prevAlpha + width;
+        const float* nextAlpha = currAlpha + width;
         for (int i = 0; i < width; ++i) {
             if (*edges) {
                 // we should not be in the one-pixel outside band
-                SkASSERT(i > 0 && i < width-1 && j > 0 && j < height-1);
+                SkASSERT(i > 0 && i < width-1);
                 // gradient will point from low to high
                 // +y is down in this case
                 // i.e., if you're outside, gradient points towards edge
                 // if you're inside, gradient points away from edge
                 SkPoint currGrad;
-                currGrad.fX = (prevData+1)->fAlpha - (prevData-1)->fAlpha
-                             + SK_ScalarSqrt2*(currData+1)->fAlpha
-                             - SK_ScalarSqrt2*(currData-1)->fAlpha
-                             + (nextData+1)->fAlpha - (nextData-1)->fAlpha;
-                currGrad.fY = (nextData-1)->fAlpha - (prevData-1)->fAlpha
-                             + SK_ScalarSqrt2*nextData->fAlpha
-                             - SK_ScalarSqrt2*prevData->fAlpha
-                             + (nextData+1)->fAlpha - (prevData+1)->fAlpha;
+                currGrad.fX = prevAlpha[i+1] - prevAlpha[i-1]
+                             + SK_ScalarSqrt2*currAlpha[i+1]
+                             - SK_ScalarSqrt2*currAlpha[i-1]
+                             + nextAlpha[i+1] - nextAlpha[i-1];
+                currGrad.fY = nextAlpha[i-1] - prevAlpha[i-1]
+                             + SK_ScalarSqrt2*nextAlpha[i]
+                             - SK_ScalarSqrt2*prevAlpha[i]
+                             + nextAlpha[i+1] - prevAlpha[i+1];
                 currGrad.setLengthFast(1.0f);
 
                 // init squared distance to edge and distance vector
-                float dist = edge_distance(currGrad, currData->fAlpha);
-                currGrad.scale(dist, &currData->fDistVector);
-                currData->fDistSq = dist*dist;
+                float dist = edge_distance(currGrad, currAlpha[i]);
+                rows.fDistX[index] = currGrad.fX*dist;
+                rows.fDistY[index] = currGrad.fY*dist;
+                rows.fDistSq[index] = dist*dist;
             } else {
                 // init distance to "far away"
-                currData->fDistSq = 2000000.f;
-                currData->fDistVector.fX = 1000.f;
-                currData->fDistVector.fY = 1000.f;
+                rows.fDistSq[index] = 2000000.f;
+                rows.fDistX[index] = 1000.f;
+                rows.fDistY[index] = 1000.f;
             }
-            ++currData;
-            ++prevData;
-            ++nextData;
+            ++index;
             ++edges;
         }
     }
@@ -191,124 +259,167 @@ static void init_distances(DFData* data, unsigned char* edges, int width, int he
 
 // Danielsson's 8SSEDT
 
-// first stage forward pass
-// (forward in Y, forward in X)
-static void F1(DFData* curr, int width) {
-    // upper left
-    DFData* check = curr - width-1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq - 2.0f*(distVec.fX + distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// The squared distance from a texel to the edge texel nearest to its neighbor at (-DX, -DY),
+// given the neighbor's squared distance and distance vector.
+template <int DX, int DY>
+static inline float neighbor_dist_sq(float distSq, float distX, float distY) {
+    if (DX < 0 && DY < 0) {
+        return distSq - 2.0f*(distX + distY - 1.0f);
+    } else if (0 == DX && DY < 0) {
+        return distSq - 2.0f*distY + 1.0f;
+    } else if (DX > 0 && DY < 0) {
+        return distSq + 2.0f*(distX - distY + 1.0f);
+    } else if (DX < 0 && 0 == DY) {
+        return distSq - 2.0f*distX + 1.0f;
+    } else if (DX > 0 && 0 == DY) {
+        return distSq + 2.0f*distX + 1.0f;
+    } else if (DX < 0 && DY > 0) {
+        return distSq - 2.0f*(distX - distY - 1.0f);
+    } else if (0 == DX && DY > 0) {
+        return distSq + 2.0f*distY + 1.0f;
+    } else {
+        SkASSERT(DX > 0 && DY > 0);
+        return distSq + 2.0f*(distX + distY + 1.0f);
     }
+}
 
-    // up
-    check = curr - width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+template <int DX, int DY>
+static inline void test_neighbor(const DFRows& rows, int curr, int check) {
+    float distSq = neighbor_dist_sq<DX, DY>(rows.fDistSq[check],
+                                            rows.fDistX[check], rows.fDistY[check]);
+    if (distSq < rows.fDistSq[curr]) {
+        rows.fDistSq[curr] = distSq;
+        rows.fDistX[curr] = rows.fDistX[check] + DX;
+        rows.fDistY[curr] = rows.fDistY[check] + DY;
     }
+}
 
-    // upper right
-    check = curr - width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX - distVec.fY + 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+static inline __m128 select_ps(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
 
-    // left
-    check = curr - 1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// Same as neighbor_dist_sq(), with the operations in the same order so that the results
+// are the same.
+template <int DX, int DY>
+static inline __m128 neighbor_dist_sq4(__m128 distSq, __m128 distX, __m128 distY) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    if (DX < 0 && DY < 0) {
+        return _mm_sub_ps(distSq, _mm_mul_ps(two, _mm_sub_ps(_mm_add_ps(distX, distY), one)));
+    } else if (0 == DX && DY < 0) {
+        return _mm_add_ps(_mm_sub_ps(distSq, _mm_mul_ps(two, distY)), one);
+    } else if (DX > 0 && DY < 0) {
+        return _mm_add_ps(distSq, _mm_mul_ps(two, _mm_add_ps(_mm_sub_ps(distX, distY), one)));
+    } else if (DX < 0 && DY > 0) {
+        return _mm_sub_ps(distSq, _mm_mul_ps(two, _mm_sub_ps(_mm_sub_ps(distX, distY), one)));
+    } else if (0 == DX && DY > 0) {
+        return _mm_add_ps(_mm_add_ps(distSq, _mm_mul_ps(two, distY)), one);
+    } else {
+        SkASSERT(DX > 0 && DY > 0);
+        return _mm_add_ps(distSq, _mm_mul_ps(two, _mm_add_ps(_mm_add_ps(distX, distY), one)));
     }
 }
 
-// second stage forward pass
-// (forward in Y, backward in X)
-static void F2(DFData* curr, int width) {
-    // right
-    DFData* check = curr + 1;
-    float distSq = check->fDistSq;
-    SkPoint distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+template <int DX, int DY>
+static inline void test_neighbor4(const DFRows& rows, int check, __m128 notEdge,
+                                  __m128* distSq, __m128* distX, __m128* distY) {
+    const __m128 checkX = _mm_loadu_ps(rows.fDistX + check);
+    const __m128 checkY = _mm_loadu_ps(rows.fDistY + check);
+    const __m128 checkSq = neighbor_dist_sq4<DX, DY>(_mm_loadu_ps(rows.fDistSq + check),
+                                                     checkX, checkY);
+    const __m128 closer = _mm_and_ps(_mm_cmplt_ps(checkSq, *distSq), notEdge);
+    *distSq = select_ps(closer, checkSq, *distSq);
+    *distX = select_ps(closer, DX ? _mm_add_ps(checkX, _mm_set1_ps((float)DX)) : checkX, *distX);
+    *distY = select_ps(closer, DY ? _mm_add_ps(checkY, _mm_set1_ps((float)DY)) : checkY, *distY);
 }
+#endif
 
-// first stage backward pass
-// (backward in Y, forward in X)
-static void B1(DFData* curr, int width) {
-    // left
-    DFData* check = curr - 1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// Tests the three neighbors in the row above (DY == -1) or below (DY == 1) of count
+// texels, starting at curr, against that row starting at check. These don't depend on
+// each other within a row, so they can be done four at a time.
+template <int DY>
+static void test_row_neighbors(const DFRows& rows, const unsigned char* edges,
+                               int curr, int check, int count) {
+    int i = 0;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        int32_t edgeBytes;
+        memcpy(&edgeBytes, edges + i, sizeof(edgeBytes));
+        __m128i edge4 = _mm_cvtsi32_si128(edgeBytes);
+        edge4 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(edge4, zero), zero);
+        // don't need to calculate distance for edge pixels
+        const __m128 notEdge = _mm_castsi128_ps(_mm_cmpeq_epi32(edge4, zero));
+
+        __m128 distSq = _mm_loadu_ps(rows.fDistSq + curr + i);
+        __m128 distX = _mm_loadu_ps(rows.fDistX + curr + i);
+        __m128 distY = _mm_loadu_ps(rows.fDistY + curr + i);
+        test_neighbor4<-1, DY>(rows, check + i - 1, notEdge, &distSq, &distX, &distY);
+        test_neighbor4< 0, DY>(rows, check + i,     notEdge, &distSq, &distX, &distY);
+        test_neighbor4< 1, DY>(rows, check + i + 1, notEdge, &distSq, &distX, &distY);
+        _mm_storeu_ps(rows.fDistSq + curr + i, distSq);
+        _mm_storeu_ps(rows.fDistX + curr + i, distX);
+        _mm_storeu_ps(rows.fDistY + curr + i, distY);
+    }
+#endif
+    for (; i < count; ++i) {
+        // don't need to calculate distance for edge pixels
+        if (!edges[i]) {
+            test_neighbor<-1, DY>(rows, curr + i, check + i - 1);
+            test_neighbor< 0, DY>(rows, curr + i, check + i);
+            test_neighbor< 1, DY>(rows, curr + i, check + i + 1);
+        }
     }
 }
 
-// second stage backward pass
-// (backward in Y, backwards in X)
-static void B2(DFData* curr, int width) {
-    // right
-    DFData* check = curr + 1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// The left neighbor depends on the texel before it, so that pass stays one at a time.
+static void test_left_neighbors(const DFRows& rows, const unsigned char* edges,
+                                int curr, int count) {
+    for (int i = 0; i < count; ++i) {
+        if (!edges[i]) {
+            test_neighbor<-1, 0>(rows, curr + i, curr + i - 1);
+        }
     }
+}
 
-    // bottom left
-    check = curr + width-1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*(distVec.fX - distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+static void test_right_neighbors(const DFRows& rows, const unsigned char* edges,
+                                 int curr, int count) {
+    for (int i = count - 1; i >= 0; --i) {
+        if (!edges[i]) {
+            test_neighbor<1, 0>(rows, curr + i, curr + i + 1);
+        }
     }
+}
 
-    // bottom
-    check = curr + width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// Propagates the distances through the rows of the band; the first and last rows are
+// only read.
+static void transform_distances(const DFRows& rows, const unsigned char* edges,
+                                int width, int height) {
+    const int count = width - 2;
+
+    // forwards in y
+    for (int j = 1; j < height-1; ++j) {
+        const int curr = j*width + 1; // skip outer buffer
+        const unsigned char* currEdge = edges + curr;
+        // upper left, up and upper right, then forwards in x (left)
+        test_row_neighbors<-1>(rows, currEdge, curr, curr - width, count);
+        test_left_neighbors(rows, currEdge, curr, count);
+        // backwards in x (right)
+        test_right_neighbors(rows, currEdge, curr, count);
     }
 
-    // bottom right
-    check = curr + width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX + distVec.fY + 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+    // backwards in y
+    for (int j = height-2; j > 0; --j) {
+        const int curr = j*width + 1;
+        const unsigned char* currEdge = edges + curr;
+        // forwards in x (left)
+        test_left_neighbors(rows, currEdge, curr, count);
+        // lower left, down and lower right, then backwards in x (right). This tests the
+        // same neighbors as testing the right neighbor first; only ties may resolve
+        // differently.
+        test_row_neighbors<1>(rows, currEdge, curr, curr + width, count);
+        test_right_neighbors(rows, currEdge, curr, count);
     }
 }
 
@@ -327,135 +438,159 @@ static unsigned char pack_distance_field_val(float dist, float distanceMagnitude
 }
 #endif
 
+// Packs count distances into the distance field.
+static void pack_distances(unsigned char* dfPtr, const float* distSq, const float* alpha,
+                           const unsigned char* edges, int count) {
+    int i = 0;
+#if DUMP_EDGE
+    for (; i < count; ++i) {
+        float edge = 0.0f;
+        if (edges[i]) {
+            edge = 0.25f;
+        }
+        // blend with original image
+        float result = alpha[i] + (1.0f-alpha[i])*edge;
+        dfPtr[i] = sk_float_round2int(255*result);
+    }
+#else
+    const float distanceMagnitude = (float)SK_DistanceFieldMagnitude;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 magnitude = _mm_set1_ps(distanceMagnitude);
+    const __m128 negMagnitude = _mm_set1_ps(-distanceMagnitude);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 scale = _mm_set1_ps(128.0f);
+    const __m128i maxVal = _mm_set1_epi32(255);
+    for (; i + 4 <= count; i += 4) {
+        __m128 dist = _mm_sqrt_ps(_mm_loadu_ps(distSq + i));
+        const __m128 inside = _mm_cmpgt_ps(_mm_loadu_ps(alpha + i), half);
+        dist = _mm_xor_ps(dist, _mm_and_ps(inside, signBit));
+
+        __m128i val = _mm_cvttps_epi32(_mm_div_ps(_mm_mul_ps(_mm_sub_ps(magnitude, dist),
+                                                              scale),
+                                                   magnitude));
+        const __m128i nearInside = _mm_castps_si128(_mm_cmple_ps(dist, negMagnitude));
+        const __m128i farOutside = _mm_castps_si128(_mm_cmpgt_ps(dist, magnitude));
+        val = _mm_or_si128(_mm_and_si128(nearInside, maxVal), _mm_andnot_si128(nearInside, val));
+        val = _mm_andnot_si128(farOutside, val);
+        val = _mm_packus_epi16(_mm_packs_epi32(val, val), val);
+        int32_t packed = _mm_cvtsi128_si32(val);
+        memcpy(dfPtr + i, &packed, sizeof(packed));
+    }
+#endif
+    for (; i < count; ++i) {
+        float dist;
+        if (alpha[i] > 0.5f) {
+            dist = -SkScalarSqrt(distSq[i]);
+        } else {
+            dist = SkScalarSqrt(distSq[i]);
+        }
+        dfPtr[i] = pack_distance_field_val(dist, distanceMagnitude);
+    }
+#endif
+}
+
+// The data rows [*bandTop, *bandTop + *bandHeight) used to generate the rows
+// [startRow, startRow+rowCount) of the field: the data rows of those, and kBandHalo rows
+// on each side.
+static void compute_band(int height, int startRow, int rowCount,
+                         int* bandTop, int* bandHeight) {
+    const int dataHeight = height + 2*kDataPad;
+    // field row r is data row r+1
+    *bandTop = SkMax32(startRow + 1 - kBandHalo, 0);
+    *bandHeight = SkMin32(startRow + rowCount + 1 + kBandHalo, dataHeight) - *bandTop;
+}
+
+// The rows [*copyTop, *copyBottom) of the padded image that the band reads.
+static void compute_band_copy_rows(int height, int bandTop, int bandHeight,
+                                   int* copyTop, int* copyBottom) {
+    // the alpha of the rows next to the band, and the neighbors of the band's rows
+    *copyTop = SkMax32(bandTop - 1 - SK_DistanceFieldPad, 0);
+    *copyBottom = SkMin32(bandTop + bandHeight + 1 - SK_DistanceFieldPad, height + 2);
+}
+
 // assumes a padded 8-bit image and distance field
 // width and height are the original width and height of the image
-static bool generate_distance_field_from_image(unsigned char* distanceField,
-                                               const unsigned char* copyPtr,
-                                               int width, int height) {
+// generates the rows [startRow, startRow+rowCount) of the field; copyPtr holds the rows
+// of the padded image that compute_band_copy_rows() gives, starting at copyTop
+static bool generate_distance_field_rows(unsigned char* distanceField,
+                                         const unsigned char* copyPtr, int copyTop,
+                                         int width, int height,
+                                         int startRow, int rowCount) {
     SkASSERT(NULL != distanceField);
     SkASSERT(NULL != copyPtr);
 
-    // we expand our temp data by one more on each side to simplify
-    // the scanning code -- will always be treated as infinitely far away
-    int pad = SK_DistanceFieldPad + 1;
-
     // set params for distance field data
-    int dataWidth = width + 2*pad;
-    int dataHeight = height + 2*pad;
+    const int dataWidth = width + 2*kDataPad;
+    int bandTop, bandHeight;
+    compute_band(height, startRow, rowCount, &bandTop, &bandHeight);
 
     // create temp data
-    size_t dataSize = dataWidth*dataHeight*sizeof(DFData);
-    SkAutoSMalloc<1024> dfStorage(dataSize);
-    DFData* dataPtr = (DFData*) dfStorage.get();
-    sk_bzero(dataPtr, dataSize);
-
-    SkAutoSMalloc<1024> edgeStorage(dataWidth*dataHeight*sizeof(char));
-    unsigned char* edgePtr = (unsigned char*) edgeStorage.get();
-    sk_bzero(edgePtr, dataWidth*dataHeight*sizeof(char));
+    const size_t dataCount = dataWidth*bandHeight;
+    const size_t alphaCount = dataWidth*(bandHeight + 2);
+    SkAutoSMalloc<4096> dfStorage((3*dataCount + alphaCount)*sizeof(float) +
+                                  dataCount*sizeof(char));
+    DFRows rows;
+    rows.fDistSq = (float*) dfStorage.get();
+    rows.fDistX = rows.fDistSq + dataCount;
+    rows.fDistY = rows.fDistX + dataCount;
+    float* alphaPtr = rows.fDistY + dataCount;
+    unsigned char* edgePtr = (unsigned char*) (alphaPtr + alphaCount);
+    sk_bzero(alphaPtr, alphaCount*sizeof(float) + dataCount*sizeof(char));
 
     // copy glyph into distance field storage
-    init_glyph_data(dataPtr, edgePtr, copyPtr,
-                    dataWidth, dataHeight,
-                    width+2, height+2, SK_DistanceFieldPad);
+    init_glyph_data(alphaPtr, edgePtr, copyPtr, copyTop, dataWidth, bandTop, bandHeight,
+                    width+2, height+2);
 
     // create initial distance data, particularly at edges
-    init_distances(dataPtr, edgePtr, dataWidth, dataHeight);
+    init_distances(rows, alphaPtr, edgePtr, dataWidth, bandHeight);
 
     // now perform Euclidean distance transform to propagate distances
+    transform_distances(rows, edgePtr, dataWidth, bandHeight);
 
-    // forwards in y
-    DFData* currData = dataPtr+dataWidth+1; // skip outer buffer
-    unsigned char* currEdge = edgePtr+dataWidth+1;
-    for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
-
-        currData += dataWidth+1;
-        currEdge += dataWidth+1;
+    // copy results to final distance field data
+    const int fieldWidth = dataWidth - 2;
+    unsigned char* dfPtr = distanceField;
+    for (int row = startRow; row < startRow + rowCount; ++row) {
+        const int j = row + 1 - bandTop;
+        pack_distances(dfPtr, rows.fDistSq + j*dataWidth + 1, alphaPtr + (j+1)*dataWidth + 1,
+                       edgePtr + j*dataWidth + 1, fieldWidth);
+        dfPtr += fieldWidth;
     }
 
-    // backwards in y
-    currData = dataPtr+dataWidth*(dataHeight-2) - 1; // skip outer buffer
-    currEdge = edgePtr+dataWidth*(dataHeight-2) - 1;
-    for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
+    return true;
+}
 
-        currData -= dataWidth-1;
-        currEdge -= dataWidth-1;
+static bool generate_distance_field_from_image(unsigned char* distanceField,
+                                               const unsigned char* copyPtr,
+                                               int width, int height) {
+    const int fieldWidth = width + 2*SK_DistanceFieldPad;
+    const int fieldHeight = height + 2*SK_DistanceFieldPad;
+    for (int row = 0; row < fieldHeight; row += kBandRows) {
+        generate_distance_field_rows(distanceField + row*fieldWidth, copyPtr, 0, width, height,
+                                     row, SkMin32(kBandRows, fieldHeight - row));
     }
+    return true;
+}
 
-    // copy results to final distance field data
-    currData = dataPtr + dataWidth+1;
-    currEdge = edgePtr + dataWidth+1;
-    unsigned char *dfPtr = distanceField;
-    for (int j = 1; j < dataHeight-1; ++j) {
-        for (int i = 1; i < dataWidth-1; ++i) {
-#if DUMP_EDGE
-            float alpha = currData->fAlpha;
-            float edge = 0.0f;
-            if (*currEdge) {
-                edge = 0.25f;
-            }
-            // blend with original image
-            float result = alpha + (1.0f-alpha)*edge;
-            unsigned char val = sk_float_round2int(255*result);
-            *dfPtr++ = val;
-#else
-            float dist;
-            if (currData->fAlpha > 0.5f) {
-                dist = -SkScalarSqrt(currData->fDistSq);
-            } else {
-                dist = SkScalarSqrt(currData->fDistSq);
-            }
-            *dfPtr++ = pack_distance_field_val(dist, (float)SK_DistanceFieldMagnitude);
-#endif
-            ++currData;
-            ++currEdge;
+// we copy our source image into a padded copy to ensure we catch edge transitions
+// around the outside
+// copies the rows [copyTop, copyBottom) of the padded image
+static void copy_a8_image(unsigned char* copyPtr, const unsigned char* image,
+                          int width, int height, int rowBytes,
+                          int copyTop, int copyBottom) {
+    unsigned char* currDestPtr = copyPtr;
+    for (int i = copyTop; i < copyBottom; ++i) {
+        if (0 == i || height + 1 == i) {
+            sk_bzero(currDestPtr, (width+2)*sizeof(char));
+            currDestPtr += width + 2;
+            continue;
         }
-        currData += 2;
-        currEdge += 2;
+        *currDestPtr++ = 0;
+        memcpy(currDestPtr, image + (i-1)*rowBytes, width);
+        currDestPtr += width;
+        *currDestPtr++ = 0;
     }
-
-    return true;
 }
 
 // assumes an 8-bit image and distance field
@@ -468,24 +603,32 @@ bool SkGenerateDistanceFieldFromA8Image(unsigned char* distanceField,
     // create temp data
     SkAutoSMalloc<1024> copyStorage((width+2)*(height+2)*sizeof(char));
     unsigned char* copyPtr = (unsigned char*) copyStorage.get();
-
-    // we copy our source image into a padded copy to ensure we catch edge transitions
-    // around the outside
-    const unsigned char* currSrcScanLine = image;
-    sk_bzero(copyPtr, (width+2)*sizeof(char));
-    unsigned char* currDestPtr = copyPtr + width + 2;
-    for (int i = 0; i < height; ++i) {
-        *currDestPtr++ = 0;
-        memcpy(currDestPtr, currSrcScanLine, rowBytes);
-        currSrcScanLine += rowBytes;
-        currDestPtr += width;
-        *currDestPtr++ = 0;
-    }
-    sk_bzero(currDestPtr, (width+2)*sizeof(char));
+    copy_a8_image(copyPtr, image, width, height, rowBytes, 0, height+2);
 
     return generate_distance_field_from_image(distanceField, copyPtr, width, height);
 }
 
+bool SkGenerateDistanceFieldRowsFromA8Image(unsigned char* distanceField,
+                                            const unsigned char* image,
+                                            int width, int height, int rowBytes,
+                                            int startRow, int rowCount) {
+    SkASSERT(NULL != distanceField);
+    SkASSERT(NULL != image);
+    SkASSERT(startRow >= 0 && rowCount >= 0);
+    SkASSERT(startRow + rowCount <= height + 2*SK_DistanceFieldPad);
+
+    // only copy the rows the band needs
+    int bandTop, bandHeight, copyTop, copyBottom;
+    compute_band(height, startRow, rowCount, &bandTop, &bandHeight);
+    compute_band_copy_rows(height, bandTop, bandHeight, &copyTop, &copyBottom);
+    SkAutoSMalloc<1024> copyStorage((width+2)*(copyBottom-copyTop)*sizeof(char));
+    unsigned char* copyPtr = (unsigned char*) copyStorage.get();
+    copy_a8_image(copyPtr, image, width, height, rowBytes, copyTop, copyBottom);
+
+    return generate_distance_field_rows(distanceField, copyPtr, copyTop, width, height,
+                                        startRow, rowCount);
+}
+
 // assumes a 1-bit image and 8-bit distance field
 bool SkGenerateDistanceFieldFromBWImage(unsigned char* distanceField,
                                         const unsigned char* image,
@@ -519,3 +662,68 @@ bool SkGenerateDistanceFieldFromBWImage(unsigned char* distanceField,
 
     return generate_distance_field_from_image(distanceField, copyPtr, width, height);
 }
+
+// Returns the texel at (x, y), or 0 (as far outside as the field goes) off the field.
+static inline int field_texel(const unsigned char* distanceField, int fieldWidth,
+                              int fieldHeight, int x, int y) {
+    if ((unsigned)x >= (unsigned)fieldWidth || (unsigned)y >= (unsigned)fieldHeight) {
+        return 0;
+    }
+    return distanceField[y*fieldWidth + x];
+}
+
+void SkDistanceFieldToA8Mask(const SkMask& mask, const unsigned char* distanceField,
+                             int fieldWidth, int fieldHeight,
+                             const SkMatrix& deviceToField, SkScalar pixelsPerTexel) {
+    SkASSERT(SkMask::kA8_Format == mask.fFormat);
+    SkASSERT(!deviceToField.hasPerspective());
+
+    // A texel value v is (SK_DistanceFieldMagnitude - distance)*128/SK_DistanceFieldMagnitude,
+    // with the distance in texels, positive outside. The coverage of a pixel is
+    // 0.5 - distance in pixels, which is linear in v. The filtered values are 16.16.
+    const float magnitude = (float)SK_DistanceFieldMagnitude*pixelsPerTexel;
+    const float scale = magnitude*(255.0f/128.0f)/65536.0f;
+    const float bias = (0.5f - magnitude)*255.0f;
+
+    // step through the field in 16.16, filtering with 8 bit weights
+    const SkFixed dxu = SkScalarToFixed(deviceToField.getScaleX());
+    const SkFixed dxv = SkScalarToFixed(deviceToField.getSkewY());
+    const SkIRect& bounds = mask.fBounds;
+    uint8_t* row = mask.fImage;
+    for (int y = bounds.fTop; y < bounds.fBottom; ++y) {
+        // sample at pixel centers; texel centers are at +0.5 too
+        SkPoint start;
+        deviceToField.mapXY(bounds.fLeft + SK_ScalarHalf, y + SK_ScalarHalf, &start);
+        SkFixed u = SkScalarToFixed(start.fX - SK_ScalarHalf);
+        SkFixed v = SkScalarToFixed(start.fY - SK_ScalarHalf);
+        for (int x = 0; x < bounds.width(); ++x) {
+            const int iu = u >> 16;
+            const int iv = v >> 16;
+            const int wu = (u >> 8) & 0xFF;
+            const int wv = (v >> 8) & 0xFF;
+
+            int t00, t10, t01, t11;
+            if ((unsigned)iu < (unsigned)(fieldWidth - 1) &&
+                (unsigned)iv < (unsigned)(fieldHeight - 1)) {
+                const unsigned char* texel = distanceField + iv*fieldWidth + iu;
+                t00 = texel[0];
+                t10 = texel[1];
+                t01 = texel[fieldWidth];
+                t11 = texel[fieldWidth + 1];
+            } else {
+                t00 = field_texel(distanceField, fieldWidth, fieldHeight, iu, iv);
+                t10 = field_texel(distanceField, fieldWidth, fieldHeight, iu + 1, iv);
+                t01 = field_texel(distanceField, fieldWidth, fieldHeight, iu, iv + 1);
+                t11 = field_texel(distanceField, fieldWidth, fieldHeight, iu + 1, iv + 1);
+            }
+            const int top = (t00 << 8) + (t10 - t00)*wu;
+            const int bottom = (t01 << 8) + (t11 - t01)*wu;
+            const float coverage = ((top << 8) + (bottom - top)*wv)*scale + bias;
+            row[x] = coverage <= 0 ? 0 : (coverage >= 255 ? 255 : (uint8_t)(coverage + 0.5f));
+
+            u += dxu;
+            v += dxv;
+        }
+        row += mask.fRowBytes;
+    }
+}
@@ -7,7 +7,10 @@
 #ifndef SkDistanceFieldGen_DEFINED
 #define SkDistanceFieldGen_DEFINED
 
-#include "SkTypes.h"
+#include "SkScalar.h"
+
+class SkMatrix;
+struct SkMask;
 
 // the max magnitude for the distance field
 // distance values are limited to the range [-SK_DistanceFieldMagnitude, SK_DistanceFieldMagnitude)
@@ -37,6 +40,24 @@ bool SkGenerateDistanceFieldFromA8Image(unsigned char* distanceField,
                                         const unsigned char* image,
                                         int w, int h, int rowBytes);
 
+/** Given 8-bit mask data, generate rows [startRow, startRow + rowCount) of the associated
+ *  distance field. Bands of rows generated separately (e.g. on different threads) match
+ *  SkGenerateDistanceFieldFromA8Image() where distances are within the field's range.
+
+ *  @param distanceField     The first row of the band of the distance field, with the
+ *                           padded width.
+ *  @param image             8-bit mask we're using to generate the distance field.
+ *  @param w                 Width of the original image.
+ *  @param h                 Height of the original image.
+ *  @param rowBytes          Size of each row in the image, in bytes
+ *  @param startRow          First row of the distance field to generate.
+ *  @param rowCount          Number of rows to generate.
+ */
+bool SkGenerateDistanceFieldRowsFromA8Image(unsigned char* distanceField,
+                                            const unsigned char* image,
+                                            int w, int h, int rowBytes,
+                                            int startRow, int rowCount);
+
 /** Given 1-bit mask data, generate the associated distance field
 
  *  @param distanceField     The distance field to be generated. Should already be allocated
@@ -50,6 +71,19 @@ bool SkGenerateDistanceFieldFromBWImage(unsigned char* distanceField,
                                         const unsigned char* image,
                                         int w, int h, int rowBytes);
 
+/** Render a distance field into an 8-bit mask, for drawing it at a scale other than the
+ *  one it was made at.
+
+ *  @param mask              The A8 mask to fill; each pixel of its bounds is sampled.
+ *  @param distanceField     The distance field, fieldWidth x fieldHeight texels.
+ *  @param deviceToField     Maps the mask's (device) pixels to the field's texels.
+ *                           Must not have perspective.
+ *  @param pixelsPerTexel    Device pixels per texel, to convert field distances to pixels.
+ */
+void SkDistanceFieldToA8Mask(const SkMask& mask, const unsigned char* distanceField,
+                             int fieldWidth, int fieldHeight,
+                             const SkMatrix& deviceToField, SkScalar pixelsPerTexel);
+
 /** Given width and height of original image, return size (in bytes) of distance field
  *  @param w                 Width of the original image.
  *  @param h                 Height of the original image.
@@ -11,6 +11,7 @@
 #include "SkColorPriv.h"
 #include "SkDevice.h"
 #include "SkDeviceLooper.h"
+#include "SkDistanceFieldGen.h"
 #include "SkFixed.h"
 #include "SkMaskFilter.h"
 #include "SkPaint.h"
@@ -23,6 +24,7 @@
 #include "SkSmallAllocator.h"
 #include "SkString.h"
 #include "SkStroke.h"
+#include "SkTextBlob.h"
 #include "SkTextMapStateProc.h"
 #include "SkTLazy.h"
 #include "SkUtils.h"
@@ -1337,6 +1339,7 @@ void SkDraw::drawSprite(const SkBitmap& bitmap, int x, int y,
 
 #include "SkScalerContext.h"
 #include "SkGlyphCache.h"
+#include "SkMaskRLE.h"
 #include "SkTextToPathIter.h"
 #include "SkUtils.h"
 
@@ -1440,12 +1443,17 @@ static void D1G_RectClip(const SkDraw1Glyph& state, SkFixed fx, SkFixed fy, cons
 
     uint8_t* aa = (uint8_t*)glyph.fImage;
     if (NULL == aa) {
-        aa = (uint8_t*)state.fCache->findImage(glyph);
+        aa = (uint8_t*)state.fCache->findStoredImage(glyph);
         if (NULL == aa) {
             return; // can't rasterize glyph
         }
     }
 
+    if (glyph.fRLEImage) {
+        SkMaskRLE::Blit(aa, mask.fBounds, *bounds, state.fBlitter);
+        return;
+    }
+
     mask.fRowBytes = glyph.rowBytes();
     mask.fFormat = static_cast<SkMask::Format>(glyph.fMaskFormat);
     mask.fImage = aa;
@@ -1470,12 +1478,20 @@ static void D1G_RgnClip(const SkDraw1Glyph& state, SkFixed fx, SkFixed fy, const
         const SkIRect&  cr = clipper.rect();
         const uint8_t*  aa = (const uint8_t*)glyph.fImage;
         if (NULL == aa) {
-            aa = (uint8_t*)state.fCache->findImage(glyph);
+            aa = (uint8_t*)state.fCache->findStoredImage(glyph);
             if (NULL == aa) {
                 return;
             }
         }
 
+        if (glyph.fRLEImage) {
+            do {
+                SkMaskRLE::Blit(aa, mask.fBounds, cr, state.fBlitter);
+                clipper.next();
+            } while (!clipper.done());
+            return;
+        }
+
         mask.fRowBytes = glyph.rowBytes();
         mask.fFormat = static_cast<SkMask::Format>(glyph.fMaskFormat);
         mask.fImage = (uint8_t*)aa;
@@ -1554,6 +1570,11 @@ void SkDraw::drawText(const char text[], size_t byteLength,
         return;
     }
 
+    if (ShouldDrawTextAsDistanceField(paint, *fMatrix) && needsRasterTextBlit(*this)) {
+        this->drawText_asDistanceField(text, byteLength, x, y, paint);
+        return;
+    }
+
     // SkScalarRec doesn't currently have a way of representing hairline stroke and
     // will fill if its frame-width is 0.
     if (ShouldDrawTextAsPaths(paint, *fMatrix)) {
@@ -1704,6 +1725,12 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
         return;
     }
 
+    if (ShouldDrawTextAsDistanceField(paint, *fMatrix) && needsRasterTextBlit(*this)) {
+        this->drawPosText_asDistanceField(text, byteLength, pos, constY,
+                                          scalarsPerPosition, paint);
+        return;
+    }
+
     if (ShouldDrawTextAsPaths(paint, *fMatrix)) {
         this->drawPosText_asPaths(text, byteLength, pos, constY,
                                   scalarsPerPosition, paint);
@@ -1834,6 +1861,307 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
     }
 }
 
+void SkDraw::drawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                          const SkPaint& paint) const {
+    SkDEBUGCODE(this->validate();)
+
+    const int count = blob->count();
+    if (0 == count || fRC->isEmpty()) {
+        return;
+    }
+
+    const uint16_t* glyphIDs = blob->glyphs();
+    const SkPoint* pos = blob->positions();
+
+    const bool asDistanceField = ShouldDrawTextAsDistanceField(paint, *fMatrix) &&
+                                 needsRasterTextBlit(*this);
+    if (asDistanceField || ShouldDrawTextAsPaths(paint, *fMatrix)) {
+        SkAutoSTMalloc<64, SkPoint> devPos(count);
+        for (int i = 0; i < count; ++i) {
+            devPos[i].set(pos[i].fX + x, pos[i].fY + y);
+        }
+        if (asDistanceField) {
+            this->drawPosText_asDistanceField((const char*)glyphIDs, count * sizeof(uint16_t),
+                                              &devPos[0].fX, 0, 2, paint);
+        } else {
+            this->drawPosText_asPaths((const char*)glyphIDs, count * sizeof(uint16_t),
+                                      &devPos[0].fX, 0, 2, paint);
+        }
+        return;
+    }
+
+    SkAutoGlyphCache    autoCache(paint, &fDevice->fLeakyProperties, fMatrix);
+    SkGlyphCache*       cache = autoCache.getCache();
+
+    SkAAClipBlitterWrapper wrapper;
+    SkAutoBlitterChoose blitterChooser;
+    SkBlitter* blitter = NULL;
+    if (needsRasterTextBlit(*this)) {
+        blitterChooser.choose(*fBitmap, *fMatrix, paint);
+        blitter = blitterChooser.get();
+        if (fRC->isAA()) {
+            wrapper.init(*fRC, blitter);
+            blitter = wrapper.getBlitter();
+        }
+    }
+
+    SkDraw1Glyph       d1g;
+    SkDraw1Glyph::Proc proc = d1g.init(this, blitter, cache, paint);
+    SkMatrix::MapXYProc mapProc = fMatrix->getMapXYProc();
+
+    if (cache->isSubpixel()) {
+        SkAxisAlignment baseline = SkComputeAxisAlignmentForHText(*fMatrix);
+
+        SkFixed fxMask = ~0;
+        SkFixed fyMask = ~0;
+        if (kX_SkAxisAlignment == baseline) {
+            fyMask = 0;
+#ifndef SK_IGNORE_SUBPIXEL_AXIS_ALIGN_FIX
+            d1g.fHalfSampleY = SK_FixedHalf;
+#endif
+        } else if (kY_SkAxisAlignment == baseline) {
+            fxMask = 0;
+#ifndef SK_IGNORE_SUBPIXEL_AXIS_ALIGN_FIX
+            d1g.fHalfSampleX = SK_FixedHalf;
+#endif
+        }
+
+        for (int i = 0; i < count; ++i) {
+            SkPoint devLoc;
+            mapProc(*fMatrix, pos[i].fX + x, pos[i].fY + y, &devLoc);
+            SkFixed fx = SkScalarToFixed(devLoc.fX) + d1g.fHalfSampleX;
+            SkFixed fy = SkScalarToFixed(devLoc.fY) + d1g.fHalfSampleY;
+
+            const SkGlyph& glyph = cache->getGlyphIDMetrics(glyphIDs[i],
+                                                            fx & fxMask, fy & fyMask);
+            if (glyph.fWidth) {
+                proc(d1g, fx, fy, glyph);
+            }
+        }
+    } else {
+        // The glyphs do not depend on the positions, so the blob can hand us
+        // the ones it looked up the last time it was drawn with this strike.
+        SkAutoTUnref<SkTextBlob::StrikeGlyphs> strike(blob->refStrikeGlyphs(cache));
+        const SkGlyph* const* glyphs = strike->glyphs();
+
+        for (int i = 0; i < count; ++i) {
+            const SkGlyph& glyph = *glyphs[i];
+            if (glyph.fWidth) {
+                SkPoint devLoc;
+                mapProc(*fMatrix, pos[i].fX + x, pos[i].fY + y, &devLoc);
+                proc(d1g,
+                     SkScalarToFixed(devLoc.fX) + SK_FixedHalf,
+                     SkScalarToFixed(devLoc.fY) + SK_FixedHalf,
+                     glyph);
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Device text sizes at or above this can be drawn from distance fields.
+static const SkScalar kMinDistanceFieldTextSize = SkIntToScalar(32);
+// The text sizes the distance fields are made at. Device sizes up to twice the smaller
+// one are drawn from its fields, bigger ones from the larger, so that each glyph has at
+// most two fields for all sizes.
+static const SkScalar kDistanceFieldTextSize = SkIntToScalar(64);
+static const SkScalar kLargeDistanceFieldTextSize = SkIntToScalar(128);
+
+// The scale of the matrix for text: the square root of the area of a unit square.
+static SkScalar text_matrix_scale(const SkMatrix& ctm) {
+    const SkScalar det = SkScalarMul(ctm.getScaleX(), ctm.getScaleY()) -
+                         SkScalarMul(ctm.getSkewX(), ctm.getSkewY());
+    return SkScalarSqrt(SkScalarAbs(det));
+}
+
+bool SkDraw::ShouldDrawTextAsDistanceField(const SkPaint& paint, const SkMatrix& ctm) {
+    if (!paint.isDistanceFieldTextTEMP()) {
+        return false;
+    }
+
+    // the fields only describe the filled outlines
+    if (paint.getRasterizer() || paint.getMaskFilter() || paint.getPathEffect() ||
+        SkPaint::kFill_Style != paint.getStyle()) {
+        return false;
+    }
+
+    // we only scale the fields, with an affine matrix
+    if (ctm.hasPerspective()) {
+        return false;
+    }
+
+    const SkScalar deviceTextSize = SkScalarMul(paint.getTextSize(), text_matrix_scale(ctm));
+    return deviceTextSize >= kMinDistanceFieldTextSize;
+}
+
+// Sets up the paint for the glyphs to make the distance fields from: unhinted outlines
+// at one of the field text sizes. Returns the scale from those glyphs to the text size.
+static SkScalar setup_distance_field_paint(SkPaint* paint, SkScalar deviceTextSize) {
+    const SkScalar textSize = paint->getTextSize();
+    paint->setTextSize(deviceTextSize > 2*kDistanceFieldTextSize ? kLargeDistanceFieldTextSize
+                                                                  : kDistanceFieldTextSize);
+    paint->setAntiAlias(true);
+    paint->setLCDRenderText(false);
+    paint->setAutohinted(false);
+    paint->setHinting(SkPaint::kNo_Hinting);
+    paint->setLinearText(true);
+    paint->setSubpixelText(false);
+    return SkScalarDiv(textSize, paint->getTextSize());
+}
+
+// Draws glyphs by scaling their distance fields to the device. The fields are cached
+// with the glyphs in the cache of the field text size.
+class SkDistanceFieldGlyphBlitter {
+public:
+    SkDistanceFieldGlyphBlitter(const SkDraw& draw, const SkPaint& paint,
+                                SkGlyphCache* cache, SkScalar textRatio)
+        : fDraw(draw)
+        , fCache(cache)
+        , fTextRatio(textRatio) {
+        fBlitterChooser.choose(*draw.fBitmap, *draw.fMatrix, paint);
+        fWrapper.init(*draw.fRC, fBlitterChooser.get());
+        fBlitter = fWrapper.getBlitter();
+        fPixelsPerTexel = SkScalarMul(textRatio, text_matrix_scale(*draw.fMatrix));
+    }
+
+    // (x, y) is the glyph's origin, before the matrix
+    void drawGlyph(const SkGlyph& glyph, SkScalar x, SkScalar y) {
+        if (0 == glyph.fWidth) {
+            return;
+        }
+        const unsigned char* field = (const unsigned char*)fCache->findDistanceField(glyph);
+        if (NULL == field) {
+            return;
+        }
+        const int fieldWidth = glyph.fWidth + 2*SK_DistanceFieldPad;
+        const int fieldHeight = glyph.fHeight + 2*SK_DistanceFieldPad;
+
+        SkMatrix fieldToDevice;
+        fieldToDevice.setTranslate(SkIntToScalar(glyph.fLeft - SK_DistanceFieldPad),
+                                   SkIntToScalar(glyph.fTop - SK_DistanceFieldPad));
+        fieldToDevice.postScale(fTextRatio, fTextRatio);
+        fieldToDevice.postTranslate(x, y);
+        fieldToDevice.postConcat(*fDraw.fMatrix);
+
+        // the glyph's coverage ends half a texel outside its image
+        SkRect fieldBounds = SkRect::MakeXYWH(SkIntToScalar(SK_DistanceFieldPad - 1),
+                                              SkIntToScalar(SK_DistanceFieldPad - 1),
+                                              SkIntToScalar(glyph.fWidth + 2),
+                                              SkIntToScalar(glyph.fHeight + 2));
+        fieldToDevice.mapRect(&fieldBounds);
+        SkIRect bounds;
+        fieldBounds.roundOut(&bounds);
+        SkMatrix deviceToField;
+        if (!bounds.intersect(fWrapper.getBounds()) || !fieldToDevice.invert(&deviceToField)) {
+            return;
+        }
+
+        SkMask mask;
+        mask.fFormat = SkMask::kA8_Format;
+        mask.fBounds = bounds;
+        mask.fRowBytes = bounds.width();
+        mask.fImage = (uint8_t*)fStorage.reset(mask.computeImageSize());
+        SkDistanceFieldToA8Mask(mask, field, fieldWidth, fieldHeight, deviceToField,
+                                fPixelsPerTexel);
+
+        const SkRegion& clip = fWrapper.getRgn();
+        if (clip.isRect()) {
+            fBlitter->blitMask(mask, bounds);
+        } else {
+            SkRegion::Cliperator clipper(clip, bounds);
+            while (!clipper.done()) {
+                fBlitter->blitMask(mask, clipper.rect());
+                clipper.next();
+            }
+        }
+    }
+
+private:
+    const SkDraw&           fDraw;
+    SkGlyphCache*           fCache;
+    SkScalar                fTextRatio;
+    SkScalar                fPixelsPerTexel;
+    SkAutoBlitterChoose     fBlitterChooser;
+    SkAAClipBlitterWrapper  fWrapper;
+    SkBlitter*              fBlitter;
+    SkAutoSMalloc<1024>     fStorage;
+};
+
+void SkDraw::drawText_asDistanceField(const char text[], size_t byteLength,
+                                      SkScalar x, SkScalar y, const SkPaint& paint) const {
+    SkPaint dfPaint(paint);
+    const SkScalar textRatio = setup_distance_field_paint(&dfPaint,
+            SkScalarMul(paint.getTextSize(), text_matrix_scale(*fMatrix)));
+
+    SkDrawCacheProc         glyphCacheProc = dfPaint.getDrawCacheProc();
+    SkAutoGlyphCacheNoGamma autoCache(dfPaint, NULL, NULL);
+    SkGlyphCache*           cache = autoCache.getCache();
+
+    // need to measure first
+    if (paint.getTextAlign() != SkPaint::kLeft_Align) {
+        SkVector stop;
+        measure_text(cache, glyphCacheProc, text, byteLength, &stop);
+        stop.scale(textRatio);
+        if (paint.getTextAlign() == SkPaint::kCenter_Align) {
+            stop.scale(SK_ScalarHalf);
+        }
+        x -= stop.fX;
+        y -= stop.fY;
+    }
+
+    SkDistanceFieldGlyphBlitter blitter(*this, paint, cache, textRatio);
+    SkAutoKern autokern;
+    SkFixed fx = SkScalarToFixed(x);
+    SkFixed fy = SkScalarToFixed(y);
+    const SkFixed fixedRatio = SkScalarToFixed(textRatio);
+    const char* stop = text + byteLength;
+    while (text < stop) {
+        const SkGlyph& glyph = glyphCacheProc(cache, &text, 0, 0);
+
+        fx += SkFixedMul(autokern.adjust(glyph), fixedRatio);
+        blitter.drawGlyph(glyph, SkFixedToScalar(fx), SkFixedToScalar(fy));
+
+        fx += SkFixedMul(glyph.fAdvanceX, fixedRatio);
+        fy += SkFixedMul(glyph.fAdvanceY, fixedRatio);
+    }
+}
+
+void SkDraw::drawPosText_asDistanceField(const char text[], size_t byteLength,
+                                         const SkScalar pos[], SkScalar constY,
+                                         int scalarsPerPosition,
+                                         const SkPaint& paint) const {
+    SkPaint dfPaint(paint);
+    const SkScalar textRatio = setup_distance_field_paint(&dfPaint,
+            SkScalarMul(paint.getTextSize(), text_matrix_scale(*fMatrix)));
+
+    SkDrawCacheProc         glyphCacheProc = dfPaint.getDrawCacheProc();
+    SkAutoGlyphCacheNoGamma autoCache(dfPaint, NULL, NULL);
+    SkGlyphCache*           cache = autoCache.getCache();
+
+    SkScalar alignScale = 0;
+    if (SkPaint::kCenter_Align == paint.getTextAlign()) {
+        alignScale = SkScalarHalf(textRatio);
+    } else if (SkPaint::kRight_Align == paint.getTextAlign()) {
+        alignScale = textRatio;
+    }
+
+    SkDistanceFieldGlyphBlitter blitter(*this, paint, cache, textRatio);
+    SkTextMapStateProc tmsProc(SkMatrix::I(), constY, scalarsPerPosition);
+    const char* stop = text + byteLength;
+    while (text < stop) {
+        const SkGlyph& glyph = glyphCacheProc(cache, &text, 0, 0);
+        if (glyph.fWidth) {
+            SkPoint loc;
+            tmsProc(pos, &loc);
+            loc.fX -= SkScalarMul(SkFixedToScalar(glyph.fAdvanceX), alignScale);
+            loc.fY -= SkScalarMul(SkFixedToScalar(glyph.fAdvanceY), alignScale);
+            blitter.drawGlyph(glyph, loc.fX, loc.fY);
+        }
+        pos += scalarsPerPosition;
+    }
+}
+
 #if defined _WIN32 && _MSC_VER >= 1300
 #pragma warning ( pop )
 #endif
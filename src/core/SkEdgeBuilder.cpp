@@ -6,6 +6,7 @@
  * found in the LICENSE file.
  */
 #include "SkEdgeBuilder.h"
+#include "SkCompactPath.h"
 #include "SkPath.h"
 #include "SkEdge.h"
 #include "SkEdgeClipper.h"
@@ -79,13 +80,13 @@ static void setShiftedClip(SkRect* dst, const SkIRect& src, int shift) {
              SkIntToScalar(src.fBottom >> shift));
 }
 
-int SkEdgeBuilder::buildPoly(const SkPath& path, const SkIRect* iclip,
+template <typename PathIter>
+int SkEdgeBuilder::buildPoly(PathIter* iter, int pointCount, const SkIRect* iclip,
                              int shiftUp) {
-    SkPath::Iter    iter(path, true);
     SkPoint         pts[4];
     SkPath::Verb    verb;
 
-    int maxEdgeCount = path.countPoints();
+    int maxEdgeCount = pointCount;
     if (iclip) {
         // clipping can turn 1 line into (up to) kMaxClippedLineSegments, since
         // we turn portions that are clipped out on the left/right into vertical
@@ -106,7 +107,7 @@ int SkEdgeBuilder::buildPoly(const SkPath& path, const SkIRect* iclip,
         SkRect clip;
         setShiftedClip(&clip, *iclip, shiftUp);
 
-        while ((verb = iter.next(pts, false)) != SkPath::kDone_Verb) {
+        while ((verb = iter->next(pts)) != SkPath::kDone_Verb) {
             switch (verb) {
                 case SkPath::kMove_Verb:
                 case SkPath::kClose_Verb:
@@ -130,7 +131,7 @@ int SkEdgeBuilder::buildPoly(const SkPath& path, const SkIRect* iclip,
             }
         }
     } else {
-        while ((verb = iter.next(pts, false)) != SkPath::kDone_Verb) {
+        while ((verb = iter->next(pts)) != SkPath::kDone_Verb) {
             switch (verb) {
                 case SkPath::kMove_Verb:
                 case SkPath::kClose_Verb:
@@ -161,19 +162,19 @@ static void handle_quad(SkEdgeBuilder* builder, const SkPoint pts[3]) {
     }
 }
 
-int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip,
-                         int shiftUp) {
+template <typename PathIter>
+int SkEdgeBuilder::buildEdges(PathIter* iter, uint32_t segmentMasks, int pointCount,
+                              const SkIRect* iclip, int shiftUp) {
     fAlloc.reset();
     fList.reset();
     fShiftUp = shiftUp;
 
     SkScalar conicTol = SK_ScalarHalf * (1 << shiftUp);
 
-    if (SkPath::kLine_SegmentMask == path.getSegmentMasks()) {
-        return this->buildPoly(path, iclip, shiftUp);
+    if (SkPath::kLine_SegmentMask == segmentMasks) {
+        return this->buildPoly(iter, pointCount, iclip, shiftUp);
     }
 
-    SkPath::Iter    iter(path, true);
     SkPoint         pts[4];
     SkPath::Verb    verb;
 
@@ -182,7 +183,7 @@ int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip,
         setShiftedClip(&clip, *iclip, shiftUp);
         SkEdgeClipper clipper;
 
-        while ((verb = iter.next(pts, false)) != SkPath::kDone_Verb) {
+        while ((verb = iter->next(pts)) != SkPath::kDone_Verb) {
             switch (verb) {
                 case SkPath::kMove_Verb:
                 case SkPath::kClose_Verb:
@@ -209,7 +210,7 @@ int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip,
                     SkPoint storage[MAX_QUAD_PTS];
 
                     SkConic conic;
-                    conic.set(pts, iter.conicWeight());
+                    conic.set(pts, iter->conicWeight());
                     int pow2 = conic.computeQuadPOW2(conicTol);
                     pow2 = SkMin32(pow2, MAX_POW2);
                     int quadCount = conic.chopIntoQuadsPOW2(storage, pow2);
@@ -231,7 +232,7 @@ int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip,
             }
         }
     } else {
-        while ((verb = iter.next(pts, false)) != SkPath::kDone_Verb) {
+        while ((verb = iter->next(pts)) != SkPath::kDone_Verb) {
             switch (verb) {
                 case SkPath::kMove_Verb:
                 case SkPath::kClose_Verb:
@@ -252,7 +253,7 @@ int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip,
                     SkPoint storage[MAX_QUAD_PTS];
 
                     SkConic conic;
-                    conic.set(pts, iter.conicWeight());
+                    conic.set(pts, iter->conicWeight());
                     int pow2 = conic.computeQuadPOW2(conicTol);
                     pow2 = SkMin32(pow2, MAX_POW2);
                     int quadCount = conic.chopIntoQuadsPOW2(storage, pow2);
@@ -278,3 +279,25 @@ int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip,
     fEdgeList = fList.begin();
     return fList.count();
 }
+
+// SkPath::Iter, closing each contour and keeping degenerate segments.
+class PathEdgeIter {
+public:
+    explicit PathEdgeIter(const SkPath& path) : fIter(path, true) {}
+
+    SkPath::Verb next(SkPoint pts[4]) { return fIter.next(pts, false); }
+    SkScalar conicWeight() const { return fIter.conicWeight(); }
+
+private:
+    SkPath::Iter fIter;
+};
+
+int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip, int shiftUp) {
+    PathEdgeIter iter(path);
+    return this->buildEdges(&iter, path.getSegmentMasks(), path.countPoints(), iclip, shiftUp);
+}
+
+int SkEdgeBuilder::build(const SkCompactPath& path, const SkIRect* iclip, int shiftUp) {
+    SkCompactPath::Iter iter(path, true);
+    return this->buildEdges(&iter, path.getSegmentMasks(), path.countPoints(), iclip, shiftUp);
+}
@@ -13,6 +13,7 @@
 #include "SkTDArray.h"
 
 struct SkEdge;
+class SkCompactPath;
 class SkEdgeClipper;
 class SkPath;
 
@@ -23,6 +24,7 @@ public:
     // returns the number of built edges. The array of those edge pointers
     // is returned from edgeList().
     int build(const SkPath& path, const SkIRect* clip, int shiftUp);
+    int build(const SkCompactPath& path, const SkIRect* clip, int shiftUp);
 
     SkEdge** edgeList() { return fEdgeList; }
 
@@ -46,7 +48,13 @@ public:
     void addCubic(const SkPoint pts[]);
     void addClipper(SkEdgeClipper*);
 
-    int buildPoly(const SkPath& path, const SkIRect* clip, int shiftUp);
+private:
+    // PathIter is SkCompactPath::Iter, or SkPath::Iter wrapped to match it.
+    template <typename PathIter>
+    int buildEdges(PathIter* iter, uint32_t segmentMasks, int pointCount,
+                   const SkIRect* clip, int shiftUp);
+    template <typename PathIter>
+    int buildPoly(PathIter* iter, int pointCount, const SkIRect* clip, int shiftUp);
 };
 
 #endif
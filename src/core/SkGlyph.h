@@ -32,6 +32,7 @@ struct SkGlyph {
     void*       fDistanceField;
     uint8_t     fMaskFormat;
     int8_t      fRsbDelta, fLsbDelta;  // used by auto-kerning
+    bool        fRLEImage;  // fImage is an SkMaskRLE encoding of the mask
 
     void init(uint32_t id) {
         fID             = id;
@@ -39,6 +40,7 @@ struct SkGlyph {
         fPath           = NULL;
         fDistanceField  = NULL;
         fMaskFormat     = MASK_FORMAT_UNKNOWN;
+        fRLEImage       = false;
     }
 
     /**
@@ -10,10 +10,14 @@
 #include "SkGlyphCache.h"
 #include "SkGlyphCache_Globals.h"
 #include "SkDistanceFieldGen.h"
+#include "SkGlyphImageStore.h"
 #include "SkGraphics.h"
 #include "SkLazyPtr.h"
+#include "SkMaskRLE.h"
 #include "SkPaint.h"
 #include "SkPath.h"
+#include "SkSharedGlyphStore.h"
+#include "SkString.h"
 #include "SkTemplates.h"
 #include "SkTLS.h"
 #include "SkTypeface.h"
@@ -41,6 +45,55 @@ static SkGlyphCache_Globals& getGlobals() {
     return tls ? *tls : getSharedGlobals();
 }
 
+// The store of glyphs shared with other processes, if any. Set by
+// SkGraphics::SetSharedFontCache(). Strikes hold a ref to the store they
+// were created with, so the mutex only guards taking that ref.
+SK_DECLARE_STATIC_MUTEX(gSharedStoreMutex);
+static SkSharedGlyphStore* gSharedStore;
+
+// Returns a ref to the shared store, or NULL.
+static SkSharedGlyphStore* ref_shared_store() {
+    SkAutoMutexAcquire ac(gSharedStoreMutex);
+    return SkSafeRef(gSharedStore);
+}
+
+// Whether new strikes run-length encode their A8 images. Set by
+// SkGraphics::SetFontCacheCompression().
+static int32_t gCompressImages;
+
+// The typeface IDs in a descriptor are only unique within a process, so the
+// strikes in the shared store are keyed by a copy of the descriptor with the
+// IDs replaced by a hash of the font's 'head' table, which holds the checksum
+// and dates of the font file, its family name and its style. Returns false if
+// the font cannot be identified that way.
+static bool make_shared_key(SkTypeface* typeface, const SkDescriptor& desc,
+                            SkAutoDescriptor* key) {
+    static const SkFontTableTag kHeadTableTag = SkSetFourByteTag('h', 'e', 'a', 'd');
+    uint32_t head[14];  // the 54 bytes of the table, padded
+    memset(head, 0, sizeof(head));
+    if (0 == typeface->getTableData(kHeadTableTag, 0, 54, head)) {
+        return false;
+    }
+    SkString name;
+    typeface->getFamilyName(&name);
+    SkAutoSTMalloc<16, uint32_t> nameWords((name.size() + 4) >> 2);
+    memset(nameWords.get(), 0, SkAlign4(name.size() + 1));
+    memcpy(nameWords.get(), name.c_str(), name.size());
+
+    uint32_t fontID = SkChecksum::Murmur3(head, sizeof(head), typeface->style());
+    fontID = SkChecksum::Murmur3(nameWords.get(), SkAlign4(name.size() + 1), fontID);
+
+    memcpy((void*)key->getDesc(), &desc, desc.getLength());
+    SkScalerContext::Rec* rec = (SkScalerContext::Rec*)
+            key->getDesc()->findEntry(kRec_SkDescriptorTag, NULL);
+    if (NULL == rec || rec->fOrigFontID != rec->fFontID) {
+        return false;
+    }
+    rec->fOrigFontID = rec->fFontID = fontID;
+    key->getDesc()->computeChecksum();
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifdef RECORD_HASH_EFFICIENCY
@@ -73,8 +126,18 @@ static SkGlyphCache_Globals& getGlobals() {
 #define kMinGlyphImageSize  (16*2)
 #define kMinAllocAmount     ((sizeof(SkGlyph) + kMinGlyphImageSize) * kMinGlyphCount)
 
+static uint32_t next_cache_id() {
+    static int32_t gNextID;
+    int32_t id;
+    do {
+        id = sk_atomic_inc(&gNextID) + 1;
+    } while (0 == id);
+    return id;
+}
+
 SkGlyphCache::SkGlyphCache(SkTypeface* typeface, const SkDescriptor* desc, SkScalerContext* ctx)
-        : fScalerContext(ctx), fGlyphAlloc(kMinAllocAmount) {
+        : fScalerContext(ctx), fUniqueID(next_cache_id()), fGlyphAlloc(kMinAllocAmount)
+        , fCompressImages(0 != sk_acquire_load(&gCompressImages)), fImageScratchSize(0) {
     SkASSERT(typeface);
     SkASSERT(desc);
     SkASSERT(ctx);
@@ -84,6 +147,15 @@ SkGlyphCache::SkGlyphCache(SkTypeface* typeface, const SkDescriptor* desc, SkSca
     fDesc = desc->copy();
     fScalerContext->getFontMetrics(&fFontMetrics);
 
+    fSharedStore.reset(ref_shared_store());
+    if (fSharedStore.get()) {
+        SkAutoDescriptor key(desc->getLength());
+        if (!make_shared_key(typeface, *desc, &key) ||
+            !fSharedStore->findStrike(*key.getDesc(), &fSharedStrike)) {
+            fSharedStore.reset(NULL);
+        }
+    }
+
     // init to 0 so that all of the pointers will be null
     memset(fGlyphHash, 0, sizeof(fGlyphHash));
     // init with 0xFF so that the charCode field will be -1, which is invalid
@@ -128,6 +200,9 @@ SkGlyphCache::~SkGlyphCache() {
         if (path) {
             SkDELETE(path);
         }
+        if ((*gptr)->fRLEImage) {
+            SkGlyphImageStore::Get().unref((const uint8_t*)(*gptr)->fImage);
+        }
         gptr += 1;
     }
     SkDescriptor::Free(fDesc);
@@ -210,7 +285,7 @@ const SkGlyph& SkGlyphCache::getUnicharMetrics(SkUnichar charCode) {
     } else {
         RecordHashSuccess();
         if (rec->fGlyph->isJustAdvance()) {
-            fScalerContext->getMetrics(rec->fGlyph);
+            this->generateMetrics(rec->fGlyph);
         }
     }
     SkASSERT(rec->fGlyph->isFullMetrics());
@@ -233,7 +308,7 @@ const SkGlyph& SkGlyphCache::getUnicharMetrics(SkUnichar charCode,
     } else {
         RecordHashSuccess();
         if (rec->fGlyph->isJustAdvance()) {
-            fScalerContext->getMetrics(rec->fGlyph);
+            this->generateMetrics(rec->fGlyph);
         }
     }
     SkASSERT(rec->fGlyph->isFullMetrics());
@@ -253,7 +328,7 @@ const SkGlyph& SkGlyphCache::getGlyphIDMetrics(uint16_t glyphID) {
     } else {
         RecordHashSuccess();
         if (glyph->isJustAdvance()) {
-            fScalerContext->getMetrics(glyph);
+            this->generateMetrics(glyph);
         }
     }
     SkASSERT(glyph->isFullMetrics());
@@ -274,7 +349,7 @@ const SkGlyph& SkGlyphCache::getGlyphIDMetrics(uint16_t glyphID,
     } else {
         RecordHashSuccess();
         if (glyph->isJustAdvance()) {
-            fScalerContext->getMetrics(glyph);
+            this->generateMetrics(glyph);
         }
     }
     SkASSERT(glyph->isFullMetrics());
@@ -303,7 +378,7 @@ SkGlyph* SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
         glyph = gptr[hi];
         if (glyph->fID == id) {
             if (kFull_MetricsType == mtype && glyph->isJustAdvance()) {
-                fScalerContext->getMetrics(glyph);
+                this->generateMetrics(glyph);
             }
             return glyph;
         }
@@ -326,21 +401,53 @@ SkGlyph* SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
         fScalerContext->getAdvance(glyph);
     } else {
         SkASSERT(kFull_MetricsType == mtype);
-        fScalerContext->getMetrics(glyph);
+        this->generateMetrics(glyph);
     }
 
     return glyph;
 }
 
+void SkGlyphCache::generateMetrics(SkGlyph* glyph) {
+    if (fSharedStore && fSharedStore->findGlyph(fSharedStrike, glyph)) {
+        return;
+    }
+    fScalerContext->getMetrics(glyph);
+    if (fSharedStore) {
+        fSharedStore->addGlyph(fSharedStrike, *glyph);
+    }
+}
+
 const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
+    const void* image = this->findStoredImage(glyph);
+    if (image && glyph.fRLEImage) {
+        const size_t rowBytes = glyph.rowBytes();
+        uint8_t* pixels = this->getImageScratch(rowBytes * glyph.fHeight);
+        SkMaskRLE::Decode((const uint8_t*)image, glyph.fWidth, glyph.fHeight, pixels, rowBytes);
+        return pixels;
+    }
+    return image;
+}
+
+const void* SkGlyphCache::findStoredImage(const SkGlyph& glyph) {
     if (glyph.fWidth > 0 && glyph.fWidth < kMaxGlyphWidth) {
         if (NULL == glyph.fImage) {
+            if (fCompressImages && SkMask::kA8_Format == glyph.fMaskFormat) {
+                this->generateRLEImage(const_cast<SkGlyph*>(&glyph));
+                return glyph.fImage;
+            }
             size_t  size = glyph.computeImageSize();
             const_cast<SkGlyph&>(glyph).fImage = fGlyphAlloc.alloc(size,
                                         SkChunkAlloc::kReturnNil_AllocFailType);
             // check that alloc() actually succeeded
             if (NULL != glyph.fImage) {
-                fScalerContext->getImage(glyph);
+                SkGlyph& mutableGlyph = const_cast<SkGlyph&>(glyph);
+                if (NULL == fSharedStore ||
+                    !fSharedStore->findImage(fSharedStrike, &mutableGlyph, glyph.fImage)) {
+                    fScalerContext->getImage(glyph);
+                    if (fSharedStore) {
+                        fSharedStore->addImage(fSharedStrike, glyph);
+                    }
+                }
                 // TODO: the scaler may have changed the maskformat during
                 // getImage (e.g. from AA or LCD to BW) which means we may have
                 // overallocated the buffer. Check if the new computedImageSize
@@ -352,6 +459,50 @@ const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
     return glyph.fImage;
 }
 
+void SkGlyphCache::generateRLEImage(SkGlyph* glyph) {
+    // generate the mask in the scratch buffer, with room for its encoding
+    const size_t size = glyph->computeImageSize();
+    const size_t maxEncodedSize = SkMaskRLE::ComputeMaxSize(glyph->fWidth, glyph->fHeight);
+    uint8_t* pixels = this->getImageScratch(size + maxEncodedSize);
+    glyph->fImage = pixels;
+    if (NULL == fSharedStore || !fSharedStore->findImage(fSharedStrike, glyph, pixels)) {
+        fScalerContext->getImage(*glyph);
+        if (fSharedStore) {
+            fSharedStore->addImage(fSharedStrike, *glyph);
+        }
+    }
+    glyph->fImage = NULL;
+
+    // the scaler may have changed the format
+    if (SkMask::kA8_Format == glyph->fMaskFormat) {
+        uint8_t* encoded = pixels + size;
+        const size_t encodedSize = SkMaskRLE::Encode(pixels, glyph->rowBytes(),
+                                                     glyph->fWidth, glyph->fHeight, encoded);
+        if (SkGlyphImageStore::ComputeSize(encodedSize) < size) {
+            glyph->fImage = const_cast<uint8_t*>(SkGlyphImageStore::Get().ref(
+                    encoded, encodedSize, glyph->fWidth, glyph->fHeight));
+            // the store's bytes are counted once, by SkGlyphCache_Globals
+            glyph->fRLEImage = true;
+            return;
+        }
+    }
+
+    const size_t imageSize = glyph->computeImageSize();
+    glyph->fImage = fGlyphAlloc.alloc(imageSize, SkChunkAlloc::kReturnNil_AllocFailType);
+    if (NULL != glyph->fImage) {
+        memcpy(glyph->fImage, pixels, imageSize);
+        fMemoryUsed += imageSize;
+    }
+}
+
+uint8_t* SkGlyphCache::getImageScratch(size_t size) {
+    if (size > fImageScratchSize) {
+        fImageScratch.reset(size);
+        fImageScratchSize = size;
+    }
+    return fImageScratch.get();
+}
+
 const SkPath* SkGlyphCache::findPath(const SkGlyph& glyph) {
     if (glyph.fWidth) {
         if (glyph.fPath == NULL) {
@@ -381,14 +532,14 @@ const void* SkGlyphCache::findDistanceField(const SkGlyph& glyph) {
                     if (SkMask::kA8_Format == maskFormat) {
                         // make the distance field from the image
                         SkGenerateDistanceFieldFromA8Image((unsigned char*)glyph.fDistanceField,
-                                                           (unsigned char*)glyph.fImage,
+                                                           (const unsigned char*)image,
                                                            glyph.fWidth, glyph.fHeight,
                                                            glyph.rowBytes());
                         fMemoryUsed += size;
                     } else if (SkMask::kBW_Format == maskFormat) {
                         // make the distance field from the image
                         SkGenerateDistanceFieldFromBWImage((unsigned char*)glyph.fDistanceField,
-                                                           (unsigned char*)glyph.fImage,
+                                                           (const unsigned char*)image,
                                                            glyph.fWidth, glyph.fHeight,
                                                            glyph.rowBytes());
                         fMemoryUsed += size;
@@ -484,7 +635,11 @@ int SkGlyphCache_Globals::setCacheCountLimit(int newCount) {
 
 void SkGlyphCache_Globals::purgeAll() {
     SkAutoMutexAcquire    ac(fMutex);
-    this->internalPurge(fTotalMemoryUsed);
+    this->internalPurge(this->getTotalMemoryUsed());
+}
+
+size_t SkGlyphCache_Globals::getTotalMemoryUsed() const {
+    return fTotalMemoryUsed + SkGlyphImageStore::Get().getBytesUsed();
 }
 
 void SkGlyphCache::VisitAllCaches(bool (*proc)(SkGlyphCache*, void*),
@@ -601,14 +756,15 @@ SkGlyphCache* SkGlyphCache_Globals::internalGetTail() const {
 size_t SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
     this->validate();
 
+    const size_t totalMemoryUsed = this->getTotalMemoryUsed();
     size_t bytesNeeded = 0;
-    if (fTotalMemoryUsed > fCacheSizeLimit) {
-        bytesNeeded = fTotalMemoryUsed - fCacheSizeLimit;
+    if (totalMemoryUsed > fCacheSizeLimit) {
+        bytesNeeded = totalMemoryUsed - fCacheSizeLimit;
     }
     bytesNeeded = SkTMax(bytesNeeded, minBytesNeeded);
     if (bytesNeeded) {
         // no small purges!
-        bytesNeeded = SkTMax(bytesNeeded, fTotalMemoryUsed >> 2);
+        bytesNeeded = SkTMax(bytesNeeded, totalMemoryUsed >> 2);
     }
 
     int countNeeded = 0;
@@ -632,12 +788,16 @@ size_t SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
     while (cache != NULL &&
            (bytesFreed < bytesNeeded || countFreed < countNeeded)) {
         SkGlyphCache* prev = cache->fPrev;
-        bytesFreed += cache->fMemoryUsed;
         countFreed += 1;
 
         this->internalDetachCache(cache);
         SkDELETE(cache);
         cache = prev;
+
+        // Deleting a strike only frees the encoded images no other strike
+        // uses, and strikes in use elsewhere may add images meanwhile.
+        const size_t nowUsed = this->getTotalMemoryUsed();
+        bytesFreed = totalMemoryUsed > nowUsed ? totalMemoryUsed - nowUsed : 0;
     }
 
     this->validate();
@@ -691,7 +851,7 @@ void SkGlyphCache::validate() const {
         const SkGlyph* glyph = fGlyphArray[i];
         SkASSERT(glyph);
         SkASSERT(fGlyphAlloc.contains(glyph));
-        if (glyph->fImage) {
+        if (glyph->fImage && !glyph->fRLEImage) {
             SkASSERT(fGlyphAlloc.contains(glyph->fImage));
         }
         if (glyph->fDistanceField) {
@@ -721,6 +881,7 @@ void SkGlyphCache_Globals::validate() const {
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "SkGlyphPathCache.h"
 #include "SkTypefaceCache.h"
 
 size_t SkGraphics::GetFontCacheLimit() {
@@ -728,11 +889,16 @@ size_t SkGraphics::GetFontCacheLimit() {
 }
 
 size_t SkGraphics::SetFontCacheLimit(size_t bytes) {
+    SkAutoTUnref<SkSharedGlyphStore> store(ref_shared_store());
+    if (store.get()) {
+        store->setByteLimit(bytes);
+    }
+    SkGlyphPathCache::Get().setByteLimit(bytes / 4);
     return getSharedGlobals().setCacheSizeLimit(bytes);
 }
 
 size_t SkGraphics::GetFontCacheUsed() {
-    return getSharedGlobals().getTotalMemoryUsed();
+    return getSharedGlobals().getTotalMemoryUsed() + SkGlyphPathCache::Get().getBytesUsed();
 }
 
 int SkGraphics::GetFontCacheCountLimit() {
@@ -749,9 +915,40 @@ int SkGraphics::GetFontCacheCountUsed() {
 
 void SkGraphics::PurgeFontCache() {
     getSharedGlobals().purgeAll();
+    SkGlyphPathCache::Get().purgeAll();
     SkTypefaceCache::PurgeAll();
 }
 
+bool SkGraphics::GetFontCacheCompression() {
+    return 0 != sk_acquire_load(&gCompressImages);
+}
+
+bool SkGraphics::SetFontCacheCompression(bool compress) {
+    const bool prev = GetFontCacheCompression();
+    sk_release_store(&gCompressImages, compress ? 1 : 0);
+    return prev;
+}
+
+bool SkGraphics::SetSharedFontCache(void* memory, size_t size) {
+    SkSharedGlyphStore* store = NULL;
+    if (memory) {
+        store = SkSharedGlyphStore::Create(memory, size);
+        if (NULL == store) {
+            return false;
+        }
+        store->setByteLimit(GetFontCacheLimit());
+    }
+    {
+        SkAutoMutexAcquire ac(gSharedStoreMutex);
+        SkTSwap(gSharedStore, store);
+    }
+    // Strikes that other threads have detached may still use the previous
+    // store; they hold their own refs to it.
+    SkSafeUnref(store);
+    getSharedGlobals().purgeAll();
+    return true;
+}
+
 size_t SkGraphics::GetTLSFontCacheLimit() {
     const SkGlyphCache_Globals* tls = SkGlyphCache_Globals::FindTLS();
     return tls ? tls->getCacheSizeLimit() : 0;
@@ -15,6 +15,7 @@
 #include "SkDescriptor.h"
 #include "SkGlyph.h"
 #include "SkScalerContext.h"
+#include "SkSharedGlyphStore.h"
 #include "SkTemplates.h"
 #include "SkTDArray.h"
 
@@ -45,7 +46,8 @@ public:
 
     /** Returns a glyph with all fields valid except fImage and fPath, which
         may be null. If they are null, call findImage or findPath for those.
-        If they are not null, then they are valid.
+        If they are not null, then they are valid (fImage is encoded if
+        fRLEImage is set).
 
         This call is potentially slower than the matching ...Advance call. If
         you only need the fAdvance/fDevKern fields, call those instead.
@@ -85,9 +87,16 @@ public:
 #endif
 
     /** Return the image associated with the glyph. If it has not been generated
-        this will trigger that.
+        this will trigger that. If the strike keeps the image run-length
+        encoded, it is decoded into a buffer of the strike that is only valid
+        until the next call.
     */
     const void* findImage(const SkGlyph&);
+    /** Return the image associated with the glyph as the strike keeps it:
+        an SkMaskRLE encoding if glyph.fRLEImage is set, or else the same as
+        findImage. If it has not been generated this will trigger that.
+    */
+    const void* findStoredImage(const SkGlyph&);
     /** Return the Path associated with the glyph. If it has not been generated
         this will trigger that.
     */
@@ -105,6 +114,11 @@ public:
 
     const SkDescriptor& getDescriptor() const { return *fDesc; }
 
+    /** A unique ID for this cache (never 0). A cache that is purged and
+        created again for the same descriptor gets a new ID.
+    */
+    uint32_t getUniqueID() const { return fUniqueID; }
+
     SkMask::Format getMaskFormat() const {
         return fScalerContext->getMaskFormat();
     }
@@ -199,13 +213,24 @@ private:
     };
 
     SkGlyph* lookupMetrics(uint32_t id, MetricsType);
+    // Fills in the full metrics, from the shared store if it has them.
+    void generateMetrics(SkGlyph*);
+    // Generates the image of an A8 glyph, and keeps it run-length encoded if
+    // that is smaller.
+    void generateRLEImage(SkGlyph*);
+    uint8_t* getImageScratch(size_t size);
     static bool DetachProc(const SkGlyphCache*, void*) { return true; }
 
     SkGlyphCache*       fNext, *fPrev;
     SkDescriptor*       fDesc;
     SkScalerContext*    fScalerContext;
+    uint32_t            fUniqueID;
     SkPaint::FontMetrics fFontMetrics;
 
+    // If the glyphs are shared with other processes, their strike.
+    SkAutoTUnref<SkSharedGlyphStore>    fSharedStore;
+    SkSharedGlyphStore::Strike          fSharedStrike;
+
     enum {
         kHashBits   = 8,
         kHashCount  = 1 << kHashBits,
@@ -215,6 +240,12 @@ private:
     SkTDArray<SkGlyph*> fGlyphArray;
     SkChunkAlloc        fGlyphAlloc;
 
+    // Whether A8 images are run-length encoded, and the buffer they are
+    // generated and decoded in.
+    bool                    fCompressImages;
+    SkAutoTMalloc<uint8_t>  fImageScratch;
+    size_t                  fImageScratchSize;
+
     struct CharGlyphRec {
         uint32_t    fID;    // unichar + subpixel
         SkGlyph*    fGlyph;
@@ -56,7 +56,9 @@ public:
     SkGlyphCache* internalGetHead() const { return fHead; }
     SkGlyphCache* internalGetTail() const;
 
-    size_t getTotalMemoryUsed() const { return fTotalMemoryUsed; }
+    // The bytes of the strikes, plus those of the run-length encoded images
+    // in SkGlyphImageStore, which the strikes share and do not count.
+    size_t getTotalMemoryUsed() const;
     int getCacheCountUsed() const { return fCacheCount; }
 
 #ifdef SK_DEBUG
@@ -75,7 +77,7 @@ public:
     // or count limit.
     bool isOverBudget() const {
         return fCacheCount > fCacheCountLimit ||
-               fTotalMemoryUsed > fCacheSizeLimit;
+               this->getTotalMemoryUsed() > fCacheSizeLimit;
     }
 
     void purgeAll(); // does not change budget
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGlyphImageStore.h"
+
+#include "SkLazyPtr.h"
+
+// An image is allocated with its encoding following it, and is looked up by
+// an image of the same encoding, so its key can compare the data after itself.
+struct SkGlyphImageStore::Key {
+    uint32_t    fHash;
+    uint32_t    fSize;
+    uint16_t    fWidth;
+    uint16_t    fHeight;
+
+    const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(this + 1); }
+
+    bool operator==(const Key& other) const {
+        return fHash == other.fHash && fSize == other.fSize &&
+               fWidth == other.fWidth && fHeight == other.fHeight &&
+               0 == memcmp(this->data(), other.data(), fSize);
+    }
+};
+
+struct SkGlyphImageStore::Image {
+    int32_t fRefCnt;
+    Key     fKey;
+
+    const uint8_t* data() const { return fKey.data(); }
+
+    static Image* FromData(const uint8_t* data) {
+        return reinterpret_cast<Image*>(const_cast<uint8_t*>(data) - sizeof(Image));
+    }
+
+    static const Key& GetKey(const Image& image) { return image.fKey; }
+    static uint32_t Hash(const Key& key) { return key.fHash; }
+};
+
+// FNV-1a; the encodings are not word aligned, and are mostly short.
+static uint32_t hash_encoding(const uint8_t data[], size_t size, int width, int height) {
+    uint32_t hash = 2166136261u ^ ((width << 16) | height);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+namespace {
+
+SkGlyphImageStore* create_store() {
+    return SkNEW(SkGlyphImageStore);
+}
+
+// The strikes of the font cache, which may be destroyed at exit after any
+// other static, release their images into the store, so it is never destroyed.
+void leave_store(SkGlyphImageStore*) {}
+
+}  // namespace
+
+SkGlyphImageStore& SkGlyphImageStore::Get() {
+    SK_DECLARE_STATIC_LAZY_PTR(SkGlyphImageStore, store, create_store, leave_store);
+    return *store.get();
+}
+
+size_t SkGlyphImageStore::ComputeSize(size_t encodedSize) {
+    SK_COMPILE_ASSERT(sizeof(Image) == 16, Image_has_padding);
+    return sizeof(Image) + encodedSize;
+}
+
+SkGlyphImageStore::SkGlyphImageStore()
+    : fBytesUsed(0)
+    , fHitCount(0)
+    , fMissCount(0) {}
+
+SkGlyphImageStore::~SkGlyphImageStore() {
+    SkTDynamicHash<Image, Key, Image>::Iter iter(&fImages);
+    for (; !iter.done(); ++iter) {
+        sk_free(&*iter);
+    }
+}
+
+const uint8_t* SkGlyphImageStore::ref(const uint8_t encoded[], size_t size,
+                                      int width, int height) {
+    SkASSERT(width > 0 && width <= 0xFFFF && height > 0 && height <= 0xFFFF);
+    Image* image = static_cast<Image*>(sk_malloc_throw(ComputeSize(size)));
+    image->fRefCnt = 1;
+    image->fKey.fHash = hash_encoding(encoded, size, width, height);
+    image->fKey.fSize = SkToU32(size);
+    image->fKey.fWidth = SkToU16(width);
+    image->fKey.fHeight = SkToU16(height);
+    memcpy(const_cast<uint8_t*>(image->data()), encoded, size);
+
+    SkAutoMutexAcquire ac(fMutex);
+    Image* found = fImages.find(image->fKey);
+    if (found) {
+        sk_free(image);
+        found->fRefCnt += 1;
+        fHitCount += 1;
+        return found->data();
+    }
+    fImages.add(image);
+    fBytesUsed += ComputeSize(size);
+    fMissCount += 1;
+    return image->data();
+}
+
+void SkGlyphImageStore::unref(const uint8_t* data) {
+    Image* image = Image::FromData(data);
+
+    SkAutoMutexAcquire ac(fMutex);
+    SkASSERT(image->fRefCnt > 0);
+    if (0 == --image->fRefCnt) {
+        fImages.remove(image->fKey);
+        fBytesUsed -= ComputeSize(image->fKey.fSize);
+        sk_free(image);
+    }
+}
+
+size_t SkGlyphImageStore::getBytesUsed() const {
+    SkAutoMutexAcquire ac(fMutex);
+    return fBytesUsed;
+}
+
+int SkGlyphImageStore::countImages() const {
+    SkAutoMutexAcquire ac(fMutex);
+    return fImages.count();
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGlyphImageStore_DEFINED
+#define SkGlyphImageStore_DEFINED
+
+#include "SkTDynamicHash.h"
+#include "SkThread.h"
+
+/** \class SkGlyphImageStore
+
+    The run-length encoded glyph images (see SkMaskRLE) of all strikes, each
+    kept once however many glyphs have it. Identical masks are common: the
+    same glyph in strikes that differ only in ways that do not change its A8
+    mask (such as the gamma of LCD text), at subpixel positions that round to
+    the same pixels, or glyphs that are the same shape (such as 'l' and '|' in
+    many fonts at small sizes).
+
+    An image is refcounted by the glyphs that use it, and freed when the last
+    of their strikes is. The strikes do not count the images towards the font
+    cache; SkGlyphCache_Globals adds the bytes of the whole store to theirs,
+    so each image counts once however many strikes use it, and purges strikes
+    until the images they free bring the total within the limit.
+*/
+class SkGlyphImageStore : SkNoncopyable {
+public:
+    /** The process-wide store.
+    */
+    static SkGlyphImageStore& Get();
+
+    /** Returns the number of bytes an encoded image of this size uses.
+    */
+    static size_t ComputeSize(size_t encodedSize);
+
+    SkGlyphImageStore();
+    ~SkGlyphImageStore();
+
+    /** Returns the store's copy of the encoded image of a width x height mask,
+        adding one if there is none. The caller owns a reference to it.
+    */
+    const uint8_t* ref(const uint8_t encoded[], size_t size, int width, int height);
+
+    /** Releases a reference to an image returned by ref().
+    */
+    void unref(const uint8_t* image);
+
+    size_t getBytesUsed() const;
+    int countImages() const;
+
+    /** The number of images found in the store, and the number added.
+    */
+    int getHitCount() const { return fHitCount; }
+    int getMissCount() const { return fMissCount; }
+
+private:
+    struct Key;
+    struct Image;
+
+    mutable SkMutex                     fMutex;
+    SkTDynamicHash<Image, Key, Image>   fImages;
+    size_t                              fBytesUsed;
+    int32_t                             fHitCount;
+    int32_t                             fMissCount;
+};
+
+#endif
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGlyphPathCache.h"
+
+#include "SkDescriptor.h"
+#include "SkGlyph.h"
+#include "SkGlyphCache_Globals.h"
+#include "SkLazyPtr.h"
+#include "SkPath.h"
+#include "SkScalerContext.h"
+#include "SkTDynamicHash.h"
+
+// The outlines are generated this large, so that the font's rounding of the
+// points (to 1/64 of a pixel with FreeType) is negligible at any size, and
+// scaled down to kOutlineSize by a power of two.
+static const int kGenerateSize = 1024;
+
+// Each typeface keeps a scaler context open to generate its outlines.
+static const int kMaxTypefaces = 32;
+
+struct Outline {
+    uint16_t    fGlyphIndex;
+    SkPath      fPath;
+
+    static const uint16_t& GetKey(const Outline& outline) { return outline.fGlyphIndex; }
+    static uint32_t Hash(const uint16_t& glyphIndex) { return glyphIndex; }
+};
+
+static size_t outline_bytes(const SkPath& path) {
+    return sizeof(Outline) + path.countPoints() * sizeof(SkPoint) + path.countVerbs();
+}
+
+class SkGlyphPathCache::Typeface {
+public:
+    Typeface(uint32_t fontID, SkScalerContext* context)
+        : fFontID(fontID)
+        , fContext(context)
+        , fBytesUsed(0) {}
+
+    ~Typeface() {
+        SkTDynamicHash<Outline, uint16_t>::Iter iter(&fOutlines);
+        for (; !iter.done(); ++iter) {
+            SkDELETE(&*iter);
+        }
+        SkDELETE(fContext);
+    }
+
+    const uint32_t                      fFontID;
+    SkScalerContext*                    fContext;
+    SkTDynamicHash<Outline, uint16_t>   fOutlines;
+    size_t                              fBytesUsed;
+
+private:
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Typeface);
+};
+
+// A context for the unhinted outlines of the typeface at kGenerateSize.
+static SkScalerContext* create_outline_context(SkTypeface* typeface) {
+    SkScalerContextRec rec;
+    sk_bzero(&rec, sizeof(rec));
+    rec.fOrigFontID = SkTypeface::UniqueID(typeface);
+    rec.fFontID = rec.fOrigFontID;
+    rec.fTextSize = SkIntToScalar(kGenerateSize);
+    rec.fPreScaleX = SK_Scalar1;
+    rec.fPost2x2[0][0] = SK_Scalar1;
+    rec.fPost2x2[1][1] = SK_Scalar1;
+    rec.fMaskFormat = SkMask::kA8_Format;
+    rec.setHinting(SkPaint::kNo_Hinting);
+    rec.ignorePreBlend();
+
+    SkAutoDescriptor ad(SkDescriptor::ComputeOverhead(1) + sizeof(rec));
+    SkDescriptor* desc = ad.getDesc();
+    desc->init();
+    desc->addEntry(kRec_SkDescriptorTag, sizeof(rec), &rec);
+    desc->computeChecksum();
+    return typeface->createScalerContext(desc, true);
+}
+
+bool SkGlyphPathCache::CanShareOutlines(const SkScalerContextRec& rec) {
+    return SkPaint::kNo_Hinting == rec.getHinting() &&
+           0 == (rec.fFlags & (SkScalerContext::kEmbolden_Flag | SkScalerContext::kVertical_Flag));
+}
+
+SkGlyphPathCache& SkGlyphPathCache::Get() {
+    SK_DECLARE_STATIC_LAZY_PTR(SkGlyphPathCache, cache);
+    return *cache.get();
+}
+
+SkGlyphPathCache::SkGlyphPathCache()
+    : fTypefaceCount(0)
+    , fBytesUsed(0)
+    , fByteLimit(SK_DEFAULT_FONT_CACHE_LIMIT / 4)
+    , fHitCount(0)
+    , fMissCount(0) {}
+
+SkGlyphPathCache::~SkGlyphPathCache() {
+    this->purgeAll();
+}
+
+SkGlyphPathCache::Typeface* SkGlyphPathCache::findTypeface(SkTypeface* typeface) {
+    const uint32_t fontID = SkTypeface::UniqueID(typeface);
+    SkTInternalLList<Typeface>::Iter iter;
+    Typeface* entry = iter.init(fTypefaces, SkTInternalLList<Typeface>::Iter::kHead_IterStart);
+    for (; entry; entry = iter.next()) {
+        if (entry->fFontID == fontID) {
+            fTypefaces.remove(entry);
+            fTypefaces.addToHead(entry);
+            return entry;
+        }
+    }
+
+    SkScalerContext* context = create_outline_context(typeface);
+    if (NULL == context) {
+        return NULL;
+    }
+    entry = SkNEW_ARGS(Typeface, (fontID, context));
+    fTypefaces.addToHead(entry);
+    fTypefaceCount += 1;
+    return entry;
+}
+
+bool SkGlyphPathCache::findOutline(SkTypeface* typeface, uint16_t glyphIndex, SkPath* path) {
+    SkAutoMutexAcquire ac(fMutex);
+    if (0 == fByteLimit) {
+        return false;
+    }
+
+    Typeface* entry = this->findTypeface(typeface);
+    if (NULL == entry) {
+        return false;
+    }
+
+    Outline* outline = entry->fOutlines.find(glyphIndex);
+    if (outline) {
+        fHitCount += 1;
+        *path = outline->fPath;
+        return true;
+    }
+
+    SkGlyph glyph;
+    glyph.init(SkGlyph::MakeID(glyphIndex));
+    SkPath generated;
+    entry->fContext->generatePath(glyph, &generated);
+
+    outline = SkNEW(Outline);
+    outline->fGlyphIndex = glyphIndex;
+    const SkScalar scale = SkIntToScalar(kOutlineSize) / kGenerateSize;
+    SkMatrix matrix;
+    matrix.setScale(scale, scale);
+    generated.transform(matrix, &outline->fPath);
+    entry->fOutlines.add(outline);
+    fMissCount += 1;
+
+    const size_t bytes = outline_bytes(outline->fPath);
+    entry->fBytesUsed += bytes;
+    fBytesUsed += bytes;
+
+    // The caller's copy shares the points, so the outline may be purged.
+    *path = outline->fPath;
+    this->purgeToLimit();
+    return true;
+}
+
+void SkGlyphPathCache::purgeToLimit() {
+    while (fTypefaceCount > 0 &&
+           (fBytesUsed > fByteLimit || fTypefaceCount > kMaxTypefaces)) {
+        Typeface* entry = fTypefaces.tail();
+        fTypefaces.remove(entry);
+        fTypefaceCount -= 1;
+        fBytesUsed -= entry->fBytesUsed;
+        SkDELETE(entry);
+    }
+}
+
+size_t SkGlyphPathCache::getByteLimit() const {
+    SkAutoMutexAcquire ac(fMutex);
+    return fByteLimit;
+}
+
+void SkGlyphPathCache::setByteLimit(size_t limit) {
+    SkAutoMutexAcquire ac(fMutex);
+    fByteLimit = limit;
+    this->purgeToLimit();
+}
+
+size_t SkGlyphPathCache::getBytesUsed() const {
+    SkAutoMutexAcquire ac(fMutex);
+    return fBytesUsed;
+}
+
+int SkGlyphPathCache::countTypefaces() const {
+    SkAutoMutexAcquire ac(fMutex);
+    return fTypefaceCount;
+}
+
+void SkGlyphPathCache::purgeAll() {
+    SkAutoMutexAcquire ac(fMutex);
+    while (Typeface* entry = fTypefaces.head()) {
+        fTypefaces.remove(entry);
+        SkDELETE(entry);
+    }
+    fTypefaceCount = 0;
+    fBytesUsed = 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGlyphPathCache_DEFINED
+#define SkGlyphPathCache_DEFINED
+
+#include "SkTInternalLList.h"
+#include "SkThread.h"
+
+class SkPath;
+class SkTypeface;
+struct SkScalerContextRec;
+
+/** \class SkGlyphPathCache
+
+    The unhinted outlines of glyphs, kept once per typeface and shared by all
+    of its strikes. A scaler context that needs the path of a glyph at any size
+    or transform maps the typeface's outline with its text matrix, instead of
+    asking the font for it again. An outline is generated once, and a strike at
+    kOutlineSize with no other transform uses it as is: its path shares the
+    outline's SkPathRef.
+
+    The outlines count towards the font cache: they may use a quarter of the
+    font cache limit, and when they use more the least recently used typefaces
+    are purged.
+*/
+class SkGlyphPathCache : SkNoncopyable {
+public:
+    /** The size at which the outlines are kept, the same as the size at which
+        SkPaint converts text to paths.
+    */
+    static const int kOutlineSize = 64;
+
+    /** The process-wide cache.
+    */
+    static SkGlyphPathCache& Get();
+
+    /** Returns true if the paths of a strike with this rec are its text matrix
+        applied to the unhinted outlines: when it is not hinted, emboldened, or
+        vertical.
+    */
+    static bool CanShareOutlines(const SkScalerContextRec&);
+
+    SkGlyphPathCache();
+    ~SkGlyphPathCache();
+
+    /** Sets path to the outline of the glyph (a glyph index of the typeface,
+        not a packed SkGlyph ID) at kOutlineSize, generating it if needed.
+        Returns false if the cache is turned off or the typeface cannot make
+        outlines.
+    */
+    bool findOutline(SkTypeface*, uint16_t glyphIndex, SkPath* path);
+
+    /** The number of bytes the outlines may use before typefaces are purged.
+        A limit of 0 turns the cache off.
+    */
+    size_t getByteLimit() const;
+    void setByteLimit(size_t limit);
+
+    size_t getBytesUsed() const;
+    int countTypefaces() const;
+
+    void purgeAll();
+
+    /** The number of outlines found in the cache, and the number generated.
+    */
+    int getHitCount() const { return fHitCount; }
+    int getMissCount() const { return fMissCount; }
+
+private:
+    class Typeface;
+
+    // Must be called with the mutex held.
+    Typeface*   findTypeface(SkTypeface*);
+    void        purgeToLimit();
+
+    mutable SkMutex                 fMutex;
+    SkTInternalLList<Typeface>      fTypefaces;     // most recently used first
+    int                             fTypefaceCount;
+    size_t                          fBytesUsed;
+    size_t                          fByteLimit;
+    int32_t                         fHitCount;
+    int32_t                         fMissCount;
+};
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMaskRLE.h"
+
+#include "SkBlitter.h"
+#include "SkTemplates.h"
+
+enum {
+    kLiteral_Kind       = 0x00,
+    kTransparent_Kind   = 0x40,
+    kOpaque_Kind        = 0x80,
+    kRepeat_Kind        = 0xC0,
+
+    kKindMask           = 0xC0,
+    kMaxRun             = 64
+};
+
+static inline int run_length(unsigned control) {
+    return (control & (kMaxRun - 1)) + 1;
+}
+
+size_t SkMaskRLE::ComputeMaxSize(int width, int height) {
+    SkASSERT(width >= 0 && height >= 0);
+    // at worst a row is all literals, with a control byte for every kMaxRun
+    return (size_t)height * (width + (width + kMaxRun - 1) / kMaxRun);
+}
+
+static uint8_t* encode_row(const uint8_t* src, int width, uint8_t* dst) {
+    uint8_t* literal = NULL;   // the control byte of the literal being added to
+    int x = 0;
+    while (x < width) {
+        const uint8_t value = src[x];
+        const int max = SkMin32(width - x, kMaxRun);
+        int run = 1;
+        while (run < max && src[x + run] == value) {
+            run += 1;
+        }
+
+        // Runs of no or full coverage need no data, so they are worth breaking
+        // a literal for when they are two pixels long, or one if there is no
+        // literal to add the pixel to.
+        const bool solid = 0 == value || 0xFF == value;
+        if (run >= 3 || (solid && (run >= 2 || NULL == literal))) {
+            if (0 == value) {
+                *dst++ = kTransparent_Kind | (run - 1);
+            } else if (0xFF == value) {
+                *dst++ = kOpaque_Kind | (run - 1);
+            } else {
+                *dst++ = kRepeat_Kind | (run - 1);
+                *dst++ = value;
+            }
+            literal = NULL;
+            x += run;
+        } else {
+            if (NULL == literal) {
+                literal = dst++;
+                *literal = kLiteral_Kind;
+            } else {
+                *literal += 1;
+            }
+            *dst++ = value;
+            if (kMaxRun - 1 == *literal) {
+                literal = NULL;
+            }
+            x += 1;
+        }
+    }
+    return dst;
+}
+
+size_t SkMaskRLE::Encode(const uint8_t* src, size_t srcRowBytes, int width, int height,
+                         uint8_t* dst) {
+    uint8_t* const start = dst;
+    for (int y = 0; y < height; ++y) {
+        dst = encode_row(src, width, dst);
+        src += srcRowBytes;
+    }
+    SkASSERT((size_t)(dst - start) <= ComputeMaxSize(width, height));
+    return dst - start;
+}
+
+void SkMaskRLE::Decode(const uint8_t* src, int width, int height,
+                       uint8_t* dst, size_t dstRowBytes) {
+    for (int y = 0; y < height; ++y) {
+        int x = 0;
+        while (x < width) {
+            const unsigned control = *src++;
+            const int n = run_length(control);
+            SkASSERT(x + n <= width);
+            switch (control & kKindMask) {
+                case kLiteral_Kind:
+                    memcpy(dst + x, src, n);
+                    src += n;
+                    break;
+                case kTransparent_Kind:
+                    memset(dst + x, 0, n);
+                    break;
+                case kOpaque_Kind:
+                    memset(dst + x, 0xFF, n);
+                    break;
+                default:
+                    memset(dst + x, *src++, n);
+                    break;
+            }
+            x += n;
+        }
+        dst += dstRowBytes;
+    }
+}
+
+static const uint8_t* skip_row(const uint8_t* src, int width) {
+    int x = 0;
+    while (x < width) {
+        const unsigned control = *src++;
+        const int n = run_length(control);
+        switch (control & kKindMask) {
+            case kLiteral_Kind:
+                src += n;
+                break;
+            case kRepeat_Kind:
+                src += 1;
+                break;
+            default:
+                break;
+        }
+        x += n;
+    }
+    return src;
+}
+
+// Decodes the pixels [left, right) of a row that is width wide into dst.
+static const uint8_t* decode_row(const uint8_t* src, int width, int left, int right,
+                                 uint8_t* dst) {
+    int x = 0;
+    while (x < width) {
+        const unsigned control = *src++;
+        const int n = run_length(control);
+        const int l = SkMax32(x, left);
+        const int r = SkMin32(x + n, right);
+        switch (control & kKindMask) {
+            case kLiteral_Kind:
+                if (l < r) {
+                    memcpy(dst + l - left, src + l - x, r - l);
+                }
+                src += n;
+                break;
+            case kTransparent_Kind:
+                if (l < r) {
+                    memset(dst + l - left, 0, r - l);
+                }
+                break;
+            case kOpaque_Kind:
+                if (l < r) {
+                    memset(dst + l - left, 0xFF, r - l);
+                }
+                break;
+            default:
+                if (l < r) {
+                    memset(dst + l - left, *src, r - l);
+                }
+                src += 1;
+                break;
+        }
+        x += n;
+    }
+    return src;
+}
+
+void SkMaskRLE::Blit(const uint8_t* src, const SkIRect& bounds, const SkIRect& clip,
+                     SkBlitter* blitter) {
+    SkASSERT(bounds.contains(clip));
+    if (clip.isEmpty()) {
+        return;
+    }
+
+    // The clipped rows are decoded a band at a time into a small A8 mask, so
+    // that the blitter draws them with its own mask procs.
+    static const int kBandBytes = 2048;
+    const int width = clip.width();
+    const int bandRows = SkMin32(clip.height(), SkMax32(1, kBandBytes / width));
+    SkAutoSMalloc<kBandBytes> storage(width * bandRows);
+
+    SkMask mask;
+    mask.fImage = (uint8_t*)storage.get();
+    mask.fRowBytes = width;
+    mask.fFormat = SkMask::kA8_Format;
+
+    for (int y = bounds.fTop; y < clip.fTop; ++y) {
+        src = skip_row(src, bounds.width());
+    }
+    for (int top = clip.fTop; top < clip.fBottom; top += bandRows) {
+        const int bottom = SkMin32(top + bandRows, clip.fBottom);
+        uint8_t* dst = mask.fImage;
+        for (int y = top; y < bottom; ++y) {
+            src = decode_row(src, bounds.width(), clip.fLeft - bounds.fLeft,
+                             clip.fRight - bounds.fLeft, dst);
+            dst += width;
+        }
+        mask.fBounds.set(clip.fLeft, top, clip.fRight, bottom);
+        blitter->blitMask(mask, mask.fBounds);
+    }
+}
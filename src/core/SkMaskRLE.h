@@ -0,0 +1,56 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMaskRLE_DEFINED
+#define SkMaskRLE_DEFINED
+
+#include "SkRect.h"
+
+class SkBlitter;
+
+/** \class SkMaskRLE
+
+    A run-length encoding of A8 masks, for glyph images. Each row is a sequence
+    of runs that do not cross rows. A run starts with a control byte whose top
+    two bits are its kind, and whose low six bits are its length less one:
+
+        00  literal: the length's coverage values follow
+        01  transparent: no data follows
+        10  opaque: no data follows
+        11  repeat: a single coverage value follows
+
+    Glyphs are mostly empty or solid, with partially covered pixels on their
+    edges, so large glyphs shrink to a third of their size or less; small ones,
+    which are mostly edges, shrink less. A mask is drawn straight from its
+    encoding, a few rows at a time: only the part inside the clip is expanded,
+    into a small buffer that the blitter draws with its own A8 mask procs.
+*/
+class SkMaskRLE {
+public:
+    /** Returns the most bytes a mask of this size can be encoded into.
+    */
+    static size_t ComputeMaxSize(int width, int height);
+
+    /** Encodes the A8 mask of width x height into dst, which must have room
+        for ComputeMaxSize() bytes, and returns the size of the encoding.
+    */
+    static size_t Encode(const uint8_t* src, size_t srcRowBytes, int width, int height,
+                         uint8_t* dst);
+
+    /** Decodes an encoded mask of width x height into dst.
+    */
+    static void Decode(const uint8_t* src, int width, int height,
+                       uint8_t* dst, size_t dstRowBytes);
+
+    /** Blits the part of the encoded mask, positioned at bounds, that is
+        inside clip, which must be contained in bounds.
+    */
+    static void Blit(const uint8_t* src, const SkIRect& bounds, const SkIRect& clip,
+                     SkBlitter* blitter);
+};
+
+#endif
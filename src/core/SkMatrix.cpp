@@ -11,6 +11,10 @@
 
 #include <stddef.h>
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
+
 // In a few places, we performed the following
 //      a * b + c * d + e
 // as
@@ -867,6 +871,30 @@ void SkMatrix::Identity_pts(const SkMatrix& m, SkPoint dst[],
         memcpy(dst, src, count * sizeof(SkPoint));
 }
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+// The SSE2 loops below map two points at a time, held as x0 y0 x1 y1, doing the
+// same operations in the same order as the scalar loops, so the results match.
+// Any odd point left over is mapped by the scalar loop.
+
+static inline __m128 load_2_pts(const SkPoint src[]) {
+    return _mm_loadu_ps(&src->fX);
+}
+
+static inline void store_2_pts(SkPoint dst[], __m128 pts) {
+    _mm_storeu_ps(&dst->fX, pts);
+}
+
+// x0 x0 x1 x1
+static inline __m128 splat_xs(__m128 pts) {
+    return _mm_shuffle_ps(pts, pts, _MM_SHUFFLE(2, 2, 0, 0));
+}
+
+// y0 y0 y1 y1
+static inline __m128 splat_ys(__m128 pts) {
+    return _mm_shuffle_ps(pts, pts, _MM_SHUFFLE(3, 3, 1, 1));
+}
+#endif
+
 void SkMatrix::Trans_pts(const SkMatrix& m, SkPoint dst[],
                          const SkPoint src[], int count) {
     SkASSERT(m.getType() == kTranslate_Mask);
@@ -874,6 +902,17 @@ void SkMatrix::Trans_pts(const SkMatrix& m, SkPoint dst[],
     if (count > 0) {
         SkScalar tx = m.fMat[kMTransX];
         SkScalar ty = m.fMat[kMTransY];
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        const __m128 trans = _mm_setr_ps(tx, ty, tx, ty);
+        for (; count >= 2; count -= 2) {
+            store_2_pts(dst, _mm_add_ps(load_2_pts(src), trans));
+            src += 2;
+            dst += 2;
+        }
+        if (0 == count) {
+            return;
+        }
+#endif
         do {
             dst->fY = src->fY + ty;
             dst->fX = src->fX + tx;
@@ -890,6 +929,17 @@ void SkMatrix::Scale_pts(const SkMatrix& m, SkPoint dst[],
     if (count > 0) {
         SkScalar mx = m.fMat[kMScaleX];
         SkScalar my = m.fMat[kMScaleY];
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        const __m128 scale = _mm_setr_ps(mx, my, mx, my);
+        for (; count >= 2; count -= 2) {
+            store_2_pts(dst, _mm_mul_ps(load_2_pts(src), scale));
+            src += 2;
+            dst += 2;
+        }
+        if (0 == count) {
+            return;
+        }
+#endif
         do {
             dst->fY = src->fY * my;
             dst->fX = src->fX * mx;
@@ -908,6 +958,18 @@ void SkMatrix::ScaleTrans_pts(const SkMatrix& m, SkPoint dst[],
         SkScalar my = m.fMat[kMScaleY];
         SkScalar tx = m.fMat[kMTransX];
         SkScalar ty = m.fMat[kMTransY];
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        const __m128 scale = _mm_setr_ps(mx, my, mx, my);
+        const __m128 trans = _mm_setr_ps(tx, ty, tx, ty);
+        for (; count >= 2; count -= 2) {
+            store_2_pts(dst, _mm_add_ps(_mm_mul_ps(load_2_pts(src), scale), trans));
+            src += 2;
+            dst += 2;
+        }
+        if (0 == count) {
+            return;
+        }
+#endif
         do {
             dst->fY = src->fY * my + ty;
             dst->fX = src->fX * mx + tx;
@@ -926,6 +988,21 @@ void SkMatrix::Rot_pts(const SkMatrix& m, SkPoint dst[],
         SkScalar my = m.fMat[kMScaleY];
         SkScalar kx = m.fMat[kMSkewX];
         SkScalar ky = m.fMat[kMSkewY];
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        // x' = x * mx + y * kx, y' = x * ky + y * my
+        const __m128 xCoeffs = _mm_setr_ps(mx, ky, mx, ky);
+        const __m128 yCoeffs = _mm_setr_ps(kx, my, kx, my);
+        for (; count >= 2; count -= 2) {
+            __m128 pts = load_2_pts(src);
+            store_2_pts(dst, _mm_add_ps(_mm_mul_ps(splat_xs(pts), xCoeffs),
+                                        _mm_mul_ps(splat_ys(pts), yCoeffs)));
+            src += 2;
+            dst += 2;
+        }
+        if (0 == count) {
+            return;
+        }
+#endif
         do {
             SkScalar sy = src->fY;
             SkScalar sx = src->fX;
@@ -948,6 +1025,26 @@ void SkMatrix::RotTrans_pts(const SkMatrix& m, SkPoint dst[],
         SkScalar ky = m.fMat[kMSkewY];
         SkScalar tx = m.fMat[kMTransX];
         SkScalar ty = m.fMat[kMTransY];
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        const __m128 xCoeffs = _mm_setr_ps(mx, ky, mx, ky);
+        const __m128 yCoeffs = _mm_setr_ps(kx, my, kx, my);
+        const __m128 trans = _mm_setr_ps(tx, ty, tx, ty);
+        for (; count >= 2; count -= 2) {
+            __m128 pts = load_2_pts(src);
+            __m128 xs = _mm_mul_ps(splat_xs(pts), xCoeffs);
+            __m128 ys = _mm_mul_ps(splat_ys(pts), yCoeffs);
+#ifdef SK_LEGACY_MATRIX_MATH_ORDER
+            store_2_pts(dst, _mm_add_ps(xs, _mm_add_ps(ys, trans)));
+#else
+            store_2_pts(dst, _mm_add_ps(_mm_add_ps(xs, ys), trans));
+#endif
+            src += 2;
+            dst += 2;
+        }
+        if (0 == count) {
+            return;
+        }
+#endif
         do {
             SkScalar sy = src->fY;
             SkScalar sx = src->fX;
@@ -969,6 +1066,42 @@ void SkMatrix::Persp_pts(const SkMatrix& m, SkPoint dst[],
     SkASSERT(m.hasPerspective());
 
     if (count > 0) {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        const SkScalar* mat = m.fMat;
+        const __m128 xCoeffs = _mm_setr_ps(mat[kMScaleX], mat[kMSkewY],
+                                           mat[kMScaleX], mat[kMSkewY]);
+        const __m128 yCoeffs = _mm_setr_ps(mat[kMSkewX], mat[kMScaleY],
+                                           mat[kMSkewX], mat[kMScaleY]);
+        const __m128 trans = _mm_setr_ps(mat[kMTransX], mat[kMTransY],
+                                         mat[kMTransX], mat[kMTransY]);
+        const __m128 persp0 = _mm_set1_ps(mat[kMPersp0]);
+        const __m128 persp1 = _mm_set1_ps(mat[kMPersp1]);
+        const __m128 persp2 = _mm_set1_ps(mat[kMPersp2]);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(SK_Scalar1);
+        for (; count >= 2; count -= 2) {
+            __m128 pts = load_2_pts(src);
+            __m128 xs = splat_xs(pts);
+            __m128 ys = splat_ys(pts);
+            __m128 xy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, xCoeffs),
+                                              _mm_mul_ps(ys, yCoeffs)), trans);
+#ifdef SK_LEGACY_MATRIX_MATH_ORDER
+            __m128 z = _mm_add_ps(_mm_mul_ps(xs, persp0),
+                                  _mm_add_ps(_mm_mul_ps(ys, persp1), persp2));
+#else
+            __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, persp0),
+                                             _mm_mul_ps(ys, persp1)), persp2);
+#endif
+            // as below, a zero z is left as zero rather than inverted
+            z = _mm_andnot_ps(_mm_cmpeq_ps(z, zero), _mm_div_ps(one, z));
+            store_2_pts(dst, _mm_mul_ps(xy, z));
+            src += 2;
+            dst += 2;
+        }
+        if (0 == count) {
+            return;
+        }
+#endif
         do {
             SkScalar sy = src->fY;
             SkScalar sx = src->fX;
@@ -28,6 +28,7 @@
 #include "SkShader.h"
 #include "SkStringUtils.h"
 #include "SkStroke.h"
+#include "SkStrokeCache.h"
 #include "SkTextFormatParams.h"
 #include "SkTextToPathIter.h"
 #include "SkTLazy.h"
@@ -2307,6 +2308,13 @@ SkMaskFilter* SkPaint::setMaskFilter(SkMaskFilter* filter) {
 
 bool SkPaint::getFillPath(const SkPath& src, SkPath* dst,
                           const SkRect* cullRect) const {
+    SkStrokeCache::Key key;
+    const bool cacheable = key.init(src, *this, cullRect);
+    bool fill;
+    if (cacheable && SkStrokeCache::Get().find(key, dst, &fill)) {
+        return fill;
+    }
+
     SkStrokeRec rec(*this);
 
     const SkPath* srcPtr = &src;
@@ -2327,7 +2335,11 @@ bool SkPaint::getFillPath(const SkPath& src, SkPath* dst,
             *dst = *srcPtr;
         }
     }
-    return !rec.isHairlineStyle();
+    fill = !rec.isHairlineStyle();
+    if (cacheable) {
+        SkStrokeCache::Get().add(key, *dst, fill);
+    }
+    return fill;
 }
 
 const SkRect& SkPaint::doComputeFastBounds(const SkRect& origSrc,
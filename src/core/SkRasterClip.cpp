@@ -6,18 +6,31 @@
  */
 
 #include "SkRasterClip.h"
+#include "SkPath.h"
 
 
 SkRasterClip::SkRasterClip() {
     fIsBW = true;
     fIsEmpty = true;
     fIsRect = false;
+    fShape.setEmpty();
+    fIsDeferred = false;
     SkDEBUGCODE(this->validate();)
 }
 
 SkRasterClip::SkRasterClip(const SkRasterClip& src) {
     AUTO_RASTERCLIP_VALIDATE(src);
 
+    fShape = src.fShape;
+    fShapeIsAA = src.fShapeIsAA;
+    fIsDeferred = src.fIsDeferred;
+    if (fIsDeferred) {
+        fIsBW = true;
+        fIsEmpty = false;
+        fIsRect = false;
+        return;
+    }
+
     fIsBW = src.fIsBW;
     if (fIsBW) {
         fBW = src.fBW;
@@ -34,6 +47,8 @@ SkRasterClip::SkRasterClip(const SkIRect& bounds) : fBW(bounds) {
     fIsBW = true;
     fIsEmpty = this->computeIsEmpty();  // bounds might be empty, so compute
     fIsRect = !fIsEmpty;
+    fShape.setEmpty();
+    fIsDeferred = false;
     SkDEBUGCODE(this->validate();)
 }
 
@@ -42,10 +57,12 @@ SkRasterClip::~SkRasterClip() {
 }
 
 bool SkRasterClip::isComplex() const {
+    SkASSERT(!fIsDeferred);
     return fIsBW ? fBW.isComplex() : !fAA.isEmpty();
 }
 
 const SkIRect& SkRasterClip::getBounds() const {
+    SkASSERT(!fIsDeferred);
     return fIsBW ? fBW.getBounds() : fAA.getBounds();
 }
 
@@ -57,6 +74,8 @@ bool SkRasterClip::setEmpty() {
     fAA.setEmpty();
     fIsEmpty = true;
     fIsRect = false;
+    fShape.setEmpty();
+    fIsDeferred = false;
     return false;
 }
 
@@ -67,12 +86,18 @@ bool SkRasterClip::setRect(const SkIRect& rect) {
     fAA.setEmpty();
     fIsRect = fBW.setRect(rect);
     fIsEmpty = !fIsRect;
+    fShape.setEmpty();
+    fIsDeferred = false;
     return fIsRect;
 }
 
 bool SkRasterClip::setPath(const SkPath& path, const SkRegion& clip, bool doAA) {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
+    if (fIsDeferred) {
+        // replaced without being scan converted
+        (void)this->setEmpty();
+    }
     if (this->isBW() && !doAA) {
         (void)fBW.setPath(path, clip);
     } else {
@@ -95,6 +120,11 @@ bool SkRasterClip::setPath(const SkPath& path, const SkIRect& clip, bool doAA) {
 bool SkRasterClip::op(const SkIRect& rect, SkRegion::Op op) {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
+    this->realize();
+    if (SkRegion::kIntersect_Op == op && rect.contains(this->getBounds())) {
+        // unchanged, and still its shape
+        return !this->isEmpty();
+    }
     fIsBW ? fBW.op(rect, op) : fAA.op(rect, op);
     return this->updateCacheAndReturnNonEmpty();
 }
@@ -102,6 +132,7 @@ bool SkRasterClip::op(const SkIRect& rect, SkRegion::Op op) {
 bool SkRasterClip::op(const SkRegion& rgn, SkRegion::Op op) {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
+    this->realize();
     if (fIsBW) {
         (void)fBW.op(rgn, op);
     } else {
@@ -116,6 +147,8 @@ bool SkRasterClip::op(const SkRasterClip& clip, SkRegion::Op op) {
     AUTO_RASTERCLIP_VALIDATE(*this);
     clip.validate();
 
+    SkASSERT(!clip.fIsDeferred);
+    this->realize();
     if (this->isBW() && clip.isBW()) {
         (void)fBW.op(clip.fBW, op);
     } else {
@@ -149,9 +182,23 @@ static bool nearly_integral(SkScalar x) {
     return x - SkScalarFloorToScalar(x) < domain;
 }
 
+static SkRRect rect_rrect(const SkRect& r) {
+    SkRRect rrect;
+    rrect.setRect(r);
+    return rrect;
+}
+
 bool SkRasterClip::op(const SkRect& r, SkRegion::Op op, bool doAA) {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
+    if (SkRegion::kReplace_Op == op) {
+        return this->setShape(rect_rrect(r), doAA);
+    }
+    if (SkRegion::kIntersect_Op == op && this->quickIntersect(rect_rrect(r), doAA)) {
+        return !this->isEmpty();
+    }
+
+    this->realize();
     if (fIsBW && doAA) {
         // check that the rect really needs aa, or is it close enought to
         // integer boundaries that we can just treat it as a BW rect?
@@ -180,6 +227,7 @@ void SkRasterClip::translate(int dx, int dy, SkRasterClip* dst) const {
     }
 
     AUTO_RASTERCLIP_VALIDATE(*this);
+    SkASSERT(!fIsDeferred);
 
     if (this->isEmpty()) {
         dst->setEmpty();
@@ -190,6 +238,10 @@ void SkRasterClip::translate(int dx, int dy, SkRasterClip* dst) const {
         return;
     }
 
+    // dst may be this
+    SkRRect shape = fShape;
+    const bool shapeIsAA = fShapeIsAA;
+
     dst->fIsBW = fIsBW;
     if (fIsBW) {
         fBW.translate(dx, dy, &dst->fBW);
@@ -199,17 +251,157 @@ void SkRasterClip::translate(int dx, int dy, SkRasterClip* dst) const {
         dst->fBW.setEmpty();
     }
     dst->updateCacheAndReturnNonEmpty();
+    if (!shape.isEmpty()) {
+        shape.offset(SkIntToScalar(dx), SkIntToScalar(dy));
+        dst->fShape = shape;
+        dst->fShapeIsAA = shapeIsAA;
+    }
 }
 
 bool SkRasterClip::quickContains(const SkIRect& ir) const {
+    SkASSERT(!fIsDeferred);
     return fIsBW ? fBW.quickContains(ir) : fAA.quickContains(ir);
 }
 
+bool SkRasterClip::getShape(SkRRect* shape, bool* doAA) const {
+    if (!fShape.isEmpty()) {
+        *shape = fShape;
+        *doAA = fShapeIsAA;
+        return true;
+    }
+    if (fIsBW && fIsRect) {
+        shape->setRect(SkRect::Make(fBW.getBounds()));
+        *doAA = false;
+        return true;
+    }
+    return false;
+}
+
+// Whether every pixel inner covers, outer covers fully, so that intersecting
+// them leaves inner just as combining their coverages does. A BW shape covers
+// the pixels whose centers it contains, so BW shapes only need to nest; an
+// anti-aliased one must contain the pixels the other touches. Conservative: an
+// inner round rect is tested by its bounds.
+static bool covers(const SkRRect& outer, bool outerIsAA, const SkRRect& inner, bool innerIsAA) {
+    if (!outerIsAA && !innerIsAA) {
+        return outer.contains(inner.getBounds());
+    }
+    SkIRect ir;
+    inner.getBounds().roundOut(&ir);
+    return outer.contains(SkRect::Make(ir));
+}
+
+bool SkRasterClip::quickIntersect(const SkRRect& rrect, bool doAA) {
+    SkRRect shape;
+    bool shapeIsAA;
+    if (!this->getShape(&shape, &shapeIsAA)) {
+        return false;
+    }
+
+    SkRRect other = rrect;
+    if (!doAA && rrect.isRect()) {
+        // what a BW rect covers
+        SkIRect ir;
+        rrect.rect().round(&ir);
+        other.setRect(SkRect::Make(ir));
+    }
+
+    // A BW rect covers whole pixels, so reducing it with an AA shape is
+    // exact. Otherwise only reduce shapes whose edges are alike.
+    if (shapeIsAA != doAA &&
+        !(!shapeIsAA && shape.isRect()) && !(!doAA && other.isRect())) {
+        return false;
+    }
+
+    if (covers(other, doAA, shape, shapeIsAA)) {
+        return true;
+    }
+    if (covers(shape, shapeIsAA, other, doAA)) {
+        (void)this->setShape(other, doAA);
+        return true;
+    }
+    // The edges of a BW rect fall between pixels, so it cuts the other rect's
+    // coverage off exactly. Two anti-aliased edges in the same pixel would
+    // multiply their coverages instead, so two AA rects are combined as clips.
+    if (shape.isRect() && other.isRect() && !(shapeIsAA && doAA)) {
+        SkRect r;
+        if (!r.intersect(shape.rect(), other.rect())) {
+            (void)this->setEmpty();
+        } else {
+            (void)this->setShape(rect_rrect(r), shapeIsAA || doAA);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Shapes smaller than this are scan converted right away, so that a deferred
+// shape is never empty.
+static const SkScalar kMinDeferredSize = 2;
+
+bool SkRasterClip::setShape(const SkRRect& shape, bool doAA) {
+    const SkRect& r = shape.getBounds();
+    if (shape.isRect() &&
+        (!doAA || (nearly_integral(r.fLeft) && nearly_integral(r.fTop) &&
+                   nearly_integral(r.fRight) && nearly_integral(r.fBottom)))) {
+        SkIRect ir;
+        r.round(&ir);
+        return this->setRect(ir);
+    }
+
+    (void)this->setEmpty();
+    if (shape.isEmpty()) {
+        return false;
+    }
+    fShape = shape;
+    fShapeIsAA = doAA;
+    if (r.width() < kMinDeferredSize || r.height() < kMinDeferredSize) {
+        this->realizeShape();
+        return !fIsEmpty;
+    }
+    fIsDeferred = true;
+    fIsEmpty = false;
+    return true;
+}
+
+void SkRasterClip::realizeShape() {
+    SkASSERT(!fShape.isEmpty());
+    const SkRRect shape = fShape;
+    const bool doAA = fShapeIsAA;
+    SkIRect ir;
+    shape.getBounds().roundOut(&ir);
+
+    if (shape.isRect()) {
+        SkASSERT(doAA);
+        fIsBW = false;
+        fBW.setEmpty();
+        (void)fAA.setRect(shape.rect(), true);
+    } else {
+        SkPath path;
+        path.addRRect(shape);
+        const SkRegion bounds(ir);
+
+        fIsBW = !doAA;
+        fBW.setEmpty();
+        fAA.setEmpty();
+        if (doAA) {
+            (void)fAA.setPath(path, &bounds, true);
+        } else {
+            (void)fBW.setPath(path, bounds);
+        }
+    }
+    if (this->updateCacheAndReturnNonEmpty()) {
+        fShape = shape;
+        fShapeIsAA = doAA;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 const SkRegion& SkRasterClip::forceGetBW() {
     AUTO_RASTERCLIP_VALIDATE(*this);
 
+    this->realize();
     if (!fIsBW) {
         fBW.setRect(fAA.getBounds());
     }
@@ -227,6 +419,12 @@ void SkRasterClip::convertToAA() {
 
 #ifdef SK_DEBUG
 void SkRasterClip::validate() const {
+    if (fIsDeferred) {
+        SkASSERT(!fShape.isEmpty());
+        SkASSERT(!fIsEmpty);
+        return;
+    }
+
     // can't ever assert that fBW is empty, since we may have called forceGetBW
     if (fIsBW) {
         SkASSERT(fAA.isEmpty());
@@ -10,6 +10,7 @@
 
 #include "SkRegion.h"
 #include "SkAAClip.h"
+#include "SkRRect.h"
 
 class SkRasterClip {
 public:
@@ -18,24 +19,40 @@ public:
     SkRasterClip(const SkRasterClip&);
     ~SkRasterClip();
 
-    bool isBW() const { return fIsBW; }
-    bool isAA() const { return !fIsBW; }
-    const SkRegion& bwRgn() const { SkASSERT(fIsBW); return fBW; }
-    const SkAAClip& aaRgn() const { SkASSERT(!fIsBW); return fAA; }
+    // These need the clip to be realized.
+    bool isBW() const { SkASSERT(!fIsDeferred); return fIsBW; }
+    bool isAA() const { SkASSERT(!fIsDeferred); return !fIsBW; }
+    const SkRegion& bwRgn() const { SkASSERT(!fIsDeferred && fIsBW); return fBW; }
+    const SkAAClip& aaRgn() const { SkASSERT(!fIsDeferred && !fIsBW); return fAA; }
 
+    /**
+     *  A clip that is not realized yet is never empty.
+     */
     bool isEmpty() const {
-        SkASSERT(this->computeIsEmpty() == fIsEmpty);
+        SkASSERT(fIsDeferred || this->computeIsEmpty() == fIsEmpty);
         return fIsEmpty;
     }
 
+    /**
+     *  Returns true if the clip is a BW rect. A clip that is not realized yet
+     *  is not one.
+     */
     bool isRect() const {
-        SkASSERT(this->computeIsRect() == fIsRect);
+        SkASSERT(fIsDeferred || this->computeIsRect() == fIsRect);
         return fIsRect;
     }
 
     bool isComplex() const;
     const SkIRect& getBounds() const;
 
+    /**
+     *  Returns about how many bytes the runs of the clip take. Copies share
+     *  them, so this counts them once per copy.
+     */
+    size_t approximateRunsSize() const {
+        return this->isBW() ? fBW.writeToMemory(NULL) : fAA.getRunsSize();
+    }
+
     bool setEmpty();
     bool setRect(const SkIRect&);
 
@@ -47,6 +64,40 @@ public:
     bool op(const SkRasterClip&, SkRegion::Op);
     bool op(const SkRect&, SkRegion::Op, bool doAA);
 
+    /**
+     *  If the clip is exactly the coverage of one rect or round rect (as after
+     *  clipping the device bounds to it), returns true, and sets shape to it
+     *  and doAA to whether its edges are anti-aliased.
+     */
+    bool getShape(SkRRect* shape, bool* doAA) const;
+
+    /**
+     *  If the clip is one rect or round rect, and intersecting it with rrect
+     *  reduces to one shape (one fully covers the pixels of the other, or
+     *  both are rects and one is BW), makes the clip that shape alone,
+     *  without combining two clips, and returns true. Otherwise returns false
+     *  and leaves the clip unchanged. The clip made is the one combining them
+     *  would make, so two anti-aliased edges in a pixel still multiply their
+     *  coverages.
+     *
+     *  An anti-aliased rect or a round rect set this way (or by replacing the
+     *  clip with a rect) is not scan converted until realize() is called, so
+     *  a shape that a later clip supersedes never is.
+     */
+    bool quickIntersect(const SkRRect& rrect, bool doAA);
+
+    /**
+     *  Scan converts the shape the clip was set to, if it has not been. This
+     *  must be called before the clip is read, other than by isEmpty(),
+     *  isRect() and getShape(), or copied to be drawn through; copies made
+     *  after it share the result.
+     */
+    void realize() {
+        if (fIsDeferred) {
+            this->realizeShape();
+        }
+    }
+
     void translate(int dx, int dy, SkRasterClip* dst) const;
     void translate(int dx, int dy) {
         this->translate(dx, dy, this);
@@ -83,6 +134,12 @@ private:
     // these 2 are caches based on querying the right obj based on fIsBW
     bool        fIsEmpty;
     bool        fIsRect;
+    // The rect or round rect the clip was made from, if it is not a BW rect
+    // (whose shape is its bounds). Empty if the clip is not one shape.
+    SkRRect     fShape;
+    bool        fShapeIsAA;
+    // True if fShape has not been scan converted into fBW or fAA yet.
+    bool        fIsDeferred;
 
     bool computeIsEmpty() const {
         return fIsBW ? fBW.isEmpty() : fAA.isEmpty();
@@ -95,10 +152,14 @@ private:
     bool updateCacheAndReturnNonEmpty() {
         fIsEmpty = this->computeIsEmpty();
         fIsRect = this->computeIsRect();
+        fShape.setEmpty();
+        fIsDeferred = false;
         return !fIsEmpty;
     }
 
     void convertToAA();
+    bool setShape(const SkRRect&, bool doAA);
+    void realizeShape();
 };
 
 class SkAutoRasterClipValidate : SkNoncopyable {
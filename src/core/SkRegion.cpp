@@ -8,6 +8,8 @@
 
 
 #include "SkRegionPriv.h"
+#include "SkTDArray.h"
+#include "SkTSort.h"
 #include "SkTemplates.h"
 #include "SkThread.h"
 #include "SkUtils.h"
@@ -585,16 +587,191 @@ void SkRegion::translate(int dx, int dy, SkRegion* dst) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+struct RectTopLT {
+    bool operator()(const SkIRect& a, const SkIRect& b) const {
+        return a.fTop < b.fTop;
+    }
+};
+
+/*  Build the runs of the area covered by at least minCoverage of the rects,
+    sweeping down through the bands between successive tops and bottoms of
+    the rects. Within each band the lefts and rights of the rects that span it
+    are sorted, and walked in order to find where the coverage reaches
+    minCoverage. Each scanline is compared with the one above it, as RgnOper
+    does, so that equal scanlines are merged.
+
+    The rects must all be non-empty. The rects may be reordered.
+ */
+static void sweep_covered_runs(SkIRect rects[], int count, int minCoverage,
+                               SkTDArray<SkRegion::RunType>* runs) {
+    SkASSERT(count > 0);
+    SkASSERT(minCoverage > 0);
+
+    SkTQSort(rects, rects + count - 1, RectTopLT());
+
+    SkTDArray<SkRegion::RunType> ys;
+    ys.setCount(count * 2);
+    for (int i = 0; i < count; ++i) {
+        SkASSERT(!rects[i].isEmpty());
+        ys[2 * i] = rects[i].fTop;
+        ys[2 * i + 1] = rects[i].fBottom;
+    }
+    SkTQSort(ys.begin(), ys.end() - 1);
+    int yCount = 1;
+    for (int i = 1; i < ys.count(); ++i) {
+        if (ys[i] != ys[yCount - 1]) {
+            ys[yCount++] = ys[i];
+        }
+    }
+
+    SkTDArray<const SkIRect*> active;
+    SkTDArray<SkRegion::RunType> lefts, rites;
+    int nextRect = 0;
+    // the start of the scanline above, at its bottom, or -1 if there is none
+    int prevStart = -1;
+    int prevLen = 0;
+
+    runs->rewind();
+    *runs->append() = ys[0];    // top, moved down past any empty bands
+
+    for (int i = 0; i + 1 < yCount; ++i) {
+        const SkRegion::RunType top = ys[i];
+        const SkRegion::RunType bot = ys[i + 1];
+
+        for (int j = active.count() - 1; j >= 0; --j) {
+            if (active[j]->fBottom <= top) {
+                active.removeShuffle(j);
+            }
+        }
+        while (nextRect < count && rects[nextRect].fTop <= top) {
+            *active.append() = &rects[nextRect++];
+        }
+
+        const int n = active.count();
+        lefts.setCount(n);
+        rites.setCount(n);
+        for (int j = 0; j < n; ++j) {
+            lefts[j] = active[j]->fLeft;
+            rites[j] = active[j]->fRight;
+        }
+        if (n > 1) {
+            SkTQSort(lefts.begin(), lefts.end() - 1);
+            SkTQSort(rites.begin(), rites.end() - 1);
+        }
+
+        // [Bottom, IntervalCount, [Left, Right]..., X-Sentinel]
+        const int start = runs->count();
+        runs->append(2);
+        int l = 0;
+        int r = 0;
+        int coverage = 0;
+        while (r < n) {
+            const SkRegion::RunType x = l < n ? SkMin32(lefts[l], rites[r]) : rites[r];
+            const bool wasCovered = coverage >= minCoverage;
+            while (l < n && lefts[l] == x) {
+                coverage += 1;
+                l += 1;
+            }
+            while (r < n && rites[r] == x) {
+                coverage -= 1;
+                r += 1;
+            }
+            if (wasCovered != (coverage >= minCoverage)) {
+                *runs->append() = x;
+            }
+        }
+        *runs->append() = SkRegion::kRunTypeSentinel;
+
+        const int len = runs->count() - start - 2;
+        SkASSERT((len & 1) == 1);
+        if (prevStart >= 0 && prevLen == len &&
+                !memcmp(&(*runs)[prevStart + 2], &(*runs)[start + 2],
+                        len * sizeof(SkRegion::RunType))) {
+            // the same as the scanline above, so extend that one down
+            (*runs)[prevStart] = bot;
+            runs->setCount(start);
+        } else if (prevStart < 0 && 1 == len) {
+            // nothing covered yet
+            (*runs)[0] = bot;
+            runs->setCount(start);
+        } else {
+            (*runs)[start] = bot;
+            (*runs)[start + 1] = len >> 1;
+            prevStart = start;
+            prevLen = len;
+        }
+    }
+
+    if (1 == prevLen) {
+        // drop the empty scanline at the bottom
+        runs->setCount(prevStart);
+    }
+    *runs->append() = SkRegion::kRunTypeSentinel;
+}
+
 bool SkRegion::setRects(const SkIRect rects[], int count) {
+    SkTDArray<SkIRect> nonEmpty;
+    nonEmpty.setReserve(count);
+    for (int i = 0; i < count; ++i) {
+        if (!rects[i].isEmpty()) {
+            *nonEmpty.append() = rects[i];
+        }
+    }
+    if (nonEmpty.count() <= 1) {
+        return nonEmpty.isEmpty() ? this->setEmpty() : this->setRect(nonEmpty[0]);
+    }
+
+    SkTDArray<RunType> runs;
+    sweep_covered_runs(nonEmpty.begin(), nonEmpty.count(), 1, &runs);
+    return this->setRuns(runs.begin(), runs.count());
+}
+
+bool SkRegion::setRegions(const SkRegion regions[], int count, Op op) {
     if (0 == count) {
-        this->setEmpty();
-    } else {
-        this->setRect(rects[0]);
-        for (int i = 1; i < count; i++) {
-            this->op(rects[i], kUnion_Op);
+        return this->setEmpty();
+    }
+    if (1 == count) {
+        return this->setRegion(regions[0]);
+    }
+    if (kUnion_Op != op && kIntersect_Op != op) {
+        SkRegion result(regions[0]);
+        for (int i = 1; i < count; ++i) {
+            result.op(regions[i], op);
         }
+        this->swap(result);
+        return !this->isEmpty();
     }
-    return !this->isEmpty();
+
+    // Only the part of each region within the bounds of them all can be in
+    // their intersection.
+    SkIRect clip = SkIRect::MakeLargest();
+    if (kIntersect_Op == op) {
+        for (int i = 0; i < count; ++i) {
+            if (regions[i].isEmpty() || !clip.intersect(regions[i].getBounds())) {
+                return this->setEmpty();
+            }
+        }
+    }
+
+    // The rects of a region are disjoint, so each region covers a point at
+    // most once, and the intersection is where all of them cover it.
+    SkTDArray<SkIRect> rects;
+    for (int i = 0; i < count; ++i) {
+        for (Iterator iter(regions[i]); !iter.done(); iter.next()) {
+            SkIRect r = iter.rect();
+            if (r.intersect(clip)) {
+                *rects.append() = r;
+            }
+        }
+    }
+    if (rects.isEmpty()) {
+        return this->setEmpty();
+    }
+
+    SkTDArray<RunType> runs;
+    sweep_covered_runs(rects.begin(), rects.count(),
+                       kUnion_Op == op ? 1 : count, &runs);
+    return this->setRuns(runs.begin(), runs.count());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -630,13 +807,6 @@ struct spanRec {
         fB_runs = b_runs;
     }
 
-    bool done() const {
-        SkASSERT(fA_left <= SkRegion::kRunTypeSentinel);
-        SkASSERT(fB_left <= SkRegion::kRunTypeSentinel);
-        return fA_left == SkRegion::kRunTypeSentinel &&
-               fB_left == SkRegion::kRunTypeSentinel;
-    }
-
     void next() {
         assert_valid_pair(fA_left, fA_rite);
         assert_valid_pair(fB_left, fB_rite);
@@ -704,23 +874,66 @@ struct spanRec {
     }
 };
 
+static bool inside_is_kept(int inside, int min, int max) {
+    return (unsigned)(inside - min) <= (unsigned)(max - min);
+}
+
+/*  Append the interval [left, rite), and then the intervals in runs up to stop,
+    which are all to the right of it, and are copied as they are.
+ */
+static SkRegion::RunType* append_intervals(SkRegion::RunType dst[], bool firstInterval,
+                                           int left, int rite,
+                                           const SkRegion::RunType runs[],
+                                           const SkRegion::RunType stop[]) {
+    if (firstInterval || dst[-1] < left) {
+        *dst++ = (SkRegion::RunType)(left);
+        *dst++ = (SkRegion::RunType)(rite);
+    } else {
+        dst[-1] = (SkRegion::RunType)(rite);
+    }
+    size_t count = stop - runs;
+    memcpy(dst, runs, count * sizeof(SkRegion::RunType));
+    return dst + count;
+}
+
 static SkRegion::RunType* operate_on_span(const SkRegion::RunType a_runs[],
                                           const SkRegion::RunType b_runs[],
                                           SkRegion::RunType dst[],
                                           int min, int max) {
+    // The interval-counts are just before the intervals.
+    const SkRegion::RunType* a_stop = a_runs + a_runs[-1] * 2;
+    const SkRegion::RunType* b_stop = b_runs + b_runs[-1] * 2;
     spanRec rec;
     bool    firstInterval = true;
 
     rec.init(a_runs, b_runs);
 
-    while (!rec.done()) {
+    for (;;) {
+        // Once one side runs out of intervals, the rest of the other side's
+        // are either all kept or all dropped, so we can copy them in one go
+        // rather than merging them one by one.
+        if (SkRegion::kRunTypeSentinel == rec.fB_left) {
+            if (SkRegion::kRunTypeSentinel != rec.fA_left && inside_is_kept(1, min, max)) {
+                dst = append_intervals(dst, firstInterval, rec.fA_left, rec.fA_rite,
+                                       rec.fA_runs, a_stop);
+            }
+            break;
+        }
+        if (SkRegion::kRunTypeSentinel == rec.fA_left) {
+            if (inside_is_kept(2, min, max)) {
+                dst = append_intervals(dst, firstInterval, rec.fB_left, rec.fB_rite,
+                                       rec.fB_runs, b_stop);
+            }
+            break;
+        }
+
         rec.next();
 
         int left = rec.fLeft;
         int rite = rec.fRite;
 
         // add left,rite to our dst buffer (checking for coincidence
-        if ((unsigned)(rec.fInside - min) <= (unsigned)(max - min) &&
+        if (inside_is_kept(rec.fInside, min, max) &&
                 left < rite) {    // skip if equal
             if (firstInterval || dst[-1] < left) {
                 *dst++ = (SkRegion::RunType)(left);
@@ -13,6 +13,7 @@
 #include "SkDraw.h"
 #include "SkFontHost.h"
 #include "SkGlyph.h"
+#include "SkGlyphPathCache.h"
 #include "SkMaskFilter.h"
 #include "SkMaskGamma.h"
 #include "SkReadBuffer.h"
@@ -817,11 +818,34 @@ SkUnichar SkScalerContext::generateGlyphToChar(uint16_t glyph) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+bool SkScalerContext::findSharedOutline(const SkGlyph& glyph, SkPath* path) {
+    if (!SkGlyphPathCache::CanShareOutlines(fRec)) {
+        return false;
+    }
+    SkPath outline;
+    if (!SkGlyphPathCache::Get().findOutline(fTypeface, glyph.getGlyphID(fBaseGlyphCount),
+                                             &outline)) {
+        return false;
+    }
+
+    SkMatrix textMatrix, matrix;
+    fRec.getSingleMatrix(&textMatrix);
+    const SkScalar scale = SK_Scalar1 / SkGlyphPathCache::kOutlineSize;
+    matrix.setScale(scale, scale);
+    matrix.postConcat(textMatrix);
+    // at kOutlineSize, with no other transform, this shares the outline's points
+    outline.transform(matrix, path);
+    return true;
+}
+
 void SkScalerContext::internalGetPath(const SkGlyph& glyph, SkPath* fillPath,
                                   SkPath* devPath, SkMatrix* fillToDevMatrix) {
     SkPath  path;
 
-    this->getGlyphContext(glyph)->generatePath(glyph, &path);
+    SkScalerContext* context = this->getGlyphContext(glyph);
+    if (!context->findSharedOutline(glyph, &path)) {
+        context->generatePath(glyph, &path);
+    }
 
     if (fRec.fFlags & SkScalerContext::kSubpixelPositioning_Flag) {
         SkFixed dx = glyph.getSubXFixed();
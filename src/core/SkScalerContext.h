@@ -287,6 +287,10 @@ private:
     void internalGetPath(const SkGlyph& glyph, SkPath* fillPath,
                          SkPath* devPath, SkMatrix* fillToDevMatrix);
 
+    // Sets path to the glyph outline from the typeface's shared outlines, if
+    // this context's paths can use them.
+    bool findSharedOutline(const SkGlyph& glyph, SkPath* path);
+
     // Return the context associated with the next logical typeface, or NULL if
     // there are no more entries in the fallback chain.
     SkScalerContext* allocNextContext() const;
@@ -298,6 +302,9 @@ private:
     // is found, just returns the original context (this)
     SkScalerContext* getGlyphContext(const SkGlyph& glyph);
 
+    // generates the outlines it shares at one size
+    friend class SkGlyphPathCache;
+
     // returns the right context from our link-list for this char. If no match
     // is found it returns NULL. If a match is found then the glyphID param is
     // set to the glyphID that maps to the provided char.
@@ -15,6 +15,7 @@
 class SkRasterClip;
 class SkRegion;
 class SkBlitter;
+class SkCompactPath;
 class SkPath;
 
 /** Defines a fixed-point rectangle, identical to the integer SkIRect, but its
@@ -36,6 +37,9 @@ public:
     static void AntiFillXRect(const SkXRect&, const SkRasterClip&, SkBlitter*);
     static void FillPath(const SkPath&, const SkRasterClip&, SkBlitter*);
     static void AntiFillPath(const SkPath&, const SkRasterClip&, SkBlitter*);
+    // These draw what the above draw for the path that SkCompactPath::toPath() returns.
+    static void FillPath(const SkCompactPath&, const SkRasterClip&, SkBlitter*);
+    static void AntiFillPath(const SkCompactPath&, const SkRasterClip&, SkBlitter*);
     static void FrameRect(const SkRect&, const SkPoint& strokeSize,
                           const SkRasterClip&, SkBlitter*);
     static void AntiFrameRect(const SkRect&, const SkPoint& strokeSize,
@@ -62,6 +66,19 @@ private:
     static void FillPath(const SkPath&, const SkRegion& clip, SkBlitter*);
     static void AntiFillPath(const SkPath&, const SkRegion& clip, SkBlitter*,
                              bool forceRLE = false);
+    static void FillPath(const SkCompactPath&, const SkRegion& clip, SkBlitter*);
+    static void AntiFillPath(const SkCompactPath&, const SkRegion& clip, SkBlitter*,
+                             bool forceRLE = false);
+    // The above, for Path = SkPath or SkCompactPath.
+    template <typename Path>
+    static void FillPathInRegion(const Path&, const SkRegion& clip, SkBlitter*);
+    template <typename Path>
+    static void AntiFillPathInRegion(const Path&, const SkRegion& clip, SkBlitter*,
+                                     bool forceRLE);
+    template <typename Path>
+    static void FillPathInRasterClip(const Path&, const SkRasterClip&, SkBlitter*);
+    template <typename Path>
+    static void AntiFillPathInRasterClip(const Path&, const SkRasterClip&, SkBlitter*);
     static void FillTriangle(const SkPoint pts[], const SkRegion*, SkBlitter*);
 
     static void AntiFrameRect(const SkRect&, const SkPoint& strokeSize,
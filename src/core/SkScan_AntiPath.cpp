@@ -8,6 +8,7 @@
 
 
 #include "SkScanPriv.h"
+#include "SkCompactPath.h"
 #include "SkPath.h"
 #include "SkMatrix.h"
 #include "SkBlitter.h"
@@ -598,8 +599,9 @@ static bool safeRoundOut(const SkRect& src, SkIRect* dst, int32_t maxInt) {
     return false;
 }
 
-void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
-                          SkBlitter* blitter, bool forceRLE) {
+template <typename Path>
+void SkScan::AntiFillPathInRegion(const Path& path, const SkRegion& origClip,
+                                  SkBlitter* blitter, bool forceRLE) {
     if (origClip.isEmpty()) {
         return;
     }
@@ -700,12 +702,23 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
     }
 }
 
+void SkScan::AntiFillPath(const SkPath& path, const SkRegion& clip,
+                          SkBlitter* blitter, bool forceRLE) {
+    AntiFillPathInRegion(path, clip, blitter, forceRLE);
+}
+
+void SkScan::AntiFillPath(const SkCompactPath& path, const SkRegion& clip,
+                          SkBlitter* blitter, bool forceRLE) {
+    AntiFillPathInRegion(path, clip, blitter, forceRLE);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SkRasterClip.h"
 
-void SkScan::FillPath(const SkPath& path, const SkRasterClip& clip,
-                          SkBlitter* blitter) {
+template <typename Path>
+void SkScan::FillPathInRasterClip(const Path& path, const SkRasterClip& clip,
+                                  SkBlitter* blitter) {
     if (clip.isEmpty()) {
         return;
     }
@@ -722,8 +735,9 @@ void SkScan::FillPath(const SkPath& path, const SkRasterClip& clip,
     }
 }
 
-void SkScan::AntiFillPath(const SkPath& path, const SkRasterClip& clip,
-                          SkBlitter* blitter) {
+template <typename Path>
+void SkScan::AntiFillPathInRasterClip(const Path& path, const SkRasterClip& clip,
+                                      SkBlitter* blitter) {
     if (clip.isEmpty()) {
         return;
     }
@@ -739,3 +753,20 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRasterClip& clip,
         SkScan::AntiFillPath(path, tmp, &aaBlitter, true);
     }
 }
+
+void SkScan::FillPath(const SkPath& path, const SkRasterClip& clip, SkBlitter* blitter) {
+    FillPathInRasterClip(path, clip, blitter);
+}
+
+void SkScan::FillPath(const SkCompactPath& path, const SkRasterClip& clip, SkBlitter* blitter) {
+    FillPathInRasterClip(path, clip, blitter);
+}
+
+void SkScan::AntiFillPath(const SkPath& path, const SkRasterClip& clip, SkBlitter* blitter) {
+    AntiFillPathInRasterClip(path, clip, blitter);
+}
+
+void SkScan::AntiFillPath(const SkCompactPath& path, const SkRasterClip& clip,
+                          SkBlitter* blitter) {
+    AntiFillPathInRasterClip(path, clip, blitter);
+}
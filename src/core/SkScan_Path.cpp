@@ -7,6 +7,7 @@
 
 #include "SkScanPriv.h"
 #include "SkBlitter.h"
+#include "SkCompactPath.h"
 #include "SkEdge.h"
 #include "SkEdgeBuilder.h"
 #include "SkGeometry.h"
@@ -429,9 +430,11 @@ static SkEdge* sort_edges(SkEdge* list[], int count, SkEdge** last) {
 //
 // clipRect (if no null) has already been shifted up
 //
-void sk_fill_path(const SkPath& path, const SkIRect* clipRect, SkBlitter* blitter,
-                  int start_y, int stop_y, int shiftEdgesUp,
-                  const SkRegion& clipRgn) {
+// Path is SkPath or SkCompactPath.
+template <typename Path>
+static void fill_path_edges(const Path& path, const SkIRect* clipRect, SkBlitter* blitter,
+                            int start_y, int stop_y, int shiftEdgesUp,
+                            const SkRegion& clipRgn) {
     SkASSERT(&path && blitter);
 
     SkEdgeBuilder   builder;
@@ -507,6 +510,18 @@ void sk_fill_path(const SkPath& path, const SkIRect* clipRect, SkBlitter* blitte
     }
 }
 
+void sk_fill_path(const SkPath& path, const SkIRect* clipRect, SkBlitter* blitter,
+                  int start_y, int stop_y, int shiftEdgesUp,
+                  const SkRegion& clipRgn) {
+    fill_path_edges(path, clipRect, blitter, start_y, stop_y, shiftEdgesUp, clipRgn);
+}
+
+void sk_fill_path(const SkCompactPath& path, const SkIRect* clipRect, SkBlitter* blitter,
+                  int start_y, int stop_y, int shiftEdgesUp,
+                  const SkRegion& clipRgn) {
+    fill_path_edges(path, clipRect, blitter, start_y, stop_y, shiftEdgesUp, clipRgn);
+}
+
 void sk_blit_above(SkBlitter* blitter, const SkIRect& ir, const SkRegion& clip) {
     const SkIRect& cr = clip.getBounds();
     SkIRect tmp;
@@ -583,8 +598,9 @@ static bool clip_to_limit(const SkRegion& orig, SkRegion* reduced) {
     return true;
 }
 
-void SkScan::FillPath(const SkPath& path, const SkRegion& origClip,
-                      SkBlitter* blitter) {
+template <typename Path>
+void SkScan::FillPathInRegion(const Path& path, const SkRegion& origClip,
+                              SkBlitter* blitter) {
     if (origClip.isEmpty()) {
         return;
     }
@@ -633,6 +649,14 @@ void SkScan::FillPath(const SkPath& path, const SkRegion& origClip,
     }
 }
 
+void SkScan::FillPath(const SkPath& path, const SkRegion& clip, SkBlitter* blitter) {
+    FillPathInRegion(path, clip, blitter);
+}
+
+void SkScan::FillPath(const SkCompactPath& path, const SkRegion& clip, SkBlitter* blitter) {
+    FillPathInRegion(path, clip, blitter);
+}
+
 void SkScan::FillPath(const SkPath& path, const SkIRect& ir,
                       SkBlitter* blitter) {
     SkRegion rgn(ir);
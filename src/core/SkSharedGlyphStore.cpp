@@ -0,0 +1,662 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkSharedGlyphStore.h"
+
+#include "SkDescriptor.h"
+#include "SkGlyph.h"
+#include "SkTemplates.h"
+#include "SkThread.h"
+
+#if defined(SK_BUILD_FOR_WIN)
+    #include <windows.h>
+#else
+    #include <errno.h>
+    #include <sched.h>
+    #include <signal.h>
+    #include <unistd.h>
+#endif
+
+// The memory holds, in order:
+//
+// - the Header,
+// - kStrikeCount StrikeRecs, each with its key and a fixed size hash table of
+//   glyph entries,
+// - the next links of the chunks, which chain the chunks of a strike, and
+//   the free chunks,
+// - the chunks, from which the images of a strike are allocated.
+//
+// All the offsets are from the start of the memory, since each process maps
+// it at a different address.
+
+static const int32_t kMagic = SkSetFourByteTag('s', 'k', 'g', 's');
+static const int32_t kInitializing = 1;
+static const uint32_t kVersion = 2;
+
+static const int kStrikeCount = 64;
+static const int kGlyphsPerStrike = 512;   // must be a power of 2
+static const int kMaxProbe = 32;
+static const size_t kMaxKeyLength = 256;
+static const size_t kChunkSize = 16 * 1024;
+static const int kMinChunkCount = 16;
+
+// How many times lock() tries before yielding, and between checks of whether
+// the process holding the lock is still alive.
+static const int kLockSpinCount = 100;
+
+// StrikeRec::fWriter holds the id of the process writing to or evicting the
+// strike, or kNoWriter.
+static const int32_t kNoWriter = 0;
+
+struct SkSharedGlyphStore::Header {
+    int32_t     fState;         // 0, kInitializing or kMagic
+    uint32_t    fVersion;
+    uint32_t    fSize;
+    int32_t     fLock;          // the id of the process holding it, or 0
+    int32_t     fClock;
+    int32_t     fChunkCount;
+    int32_t     fChunkLimit;
+    int32_t     fChunksUsed;
+    int32_t     fFreeChunk;
+    int32_t     fStrikesUsed;
+    uint32_t    fChunksOffset;
+};
+
+struct SkSharedGlyphStore::Entry {
+    uint32_t    fID;            // the glyph's fID + 1, or 0 if empty; written last
+    int32_t     fImage;         // offset of the ImageRec, or 0
+    SkFixed     fAdvanceX, fAdvanceY;
+    uint16_t    fWidth, fHeight;
+    int16_t     fTop, fLeft;
+    uint8_t     fMaskFormat;
+    int8_t      fRsbDelta, fLsbDelta;
+};
+
+struct SkSharedGlyphStore::StrikeRec {
+    int32_t     fSeq;           // incremented twice by each eviction
+    int32_t     fWriter;        // the id of the process changing it, or 0
+    int32_t     fLastUse;
+    uint32_t    fChecksum;
+    uint32_t    fKeyLength;     // 0 if the strike is free
+    int32_t     fFirstChunk;    // the most recently allocated chunk, or -1
+    uint32_t    fChunkUsed;     // bytes used in fFirstChunk
+    uint32_t    fKey[kMaxKeyLength >> 2];
+    Entry       fEntries[kGlyphsPerStrike];
+};
+
+namespace {
+
+// Precedes each image in a chunk.
+struct ImageRec {
+    uint32_t    fSize;
+    uint8_t     fMaskFormat;
+    uint8_t     fPad[3];
+};
+
+}  // namespace
+
+size_t SkSharedGlyphStore::StrikesOffset() {
+    return SkAlign8(sizeof(Header));
+}
+
+size_t SkSharedGlyphStore::ChunkLinksOffset() {
+    return StrikesOffset() + kStrikeCount * sizeof(StrikeRec);
+}
+
+size_t SkSharedGlyphStore::ChunksOffset(int chunkCount) {
+    return SkAlign8(ChunkLinksOffset() + chunkCount * sizeof(int32_t));
+}
+
+int SkSharedGlyphStore::CountChunks(size_t size) {
+    if (size < ChunksOffset(0)) {
+        return 0;
+    }
+    const size_t avail = size - ChunksOffset(0);
+    // Each chunk also needs its link, and the alignment may cost 7 bytes.
+    return (int)(SkTMin<size_t>((avail - SkTMin<size_t>(avail, 7)) /
+                                (kChunkSize + sizeof(int32_t)), SK_MaxS32));
+}
+
+// Identifies this process in Header::fLock and StrikeRec::fWriter; never 0.
+static int32_t process_id() {
+#if defined(SK_BUILD_FOR_WIN)
+    const int32_t id = (int32_t)GetCurrentProcessId();
+#else
+    const int32_t id = (int32_t)getpid();
+#endif
+    return 0 == id ? -1 : id;
+}
+
+// Whether the process is known to have exited. If its id has been reused
+// since, it is taken to be alive, and whatever it held stays held.
+static bool process_is_dead(int32_t id) {
+    if (id <= 0) {
+        return false;
+    }
+#if defined(SK_BUILD_FOR_WIN)
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)id);
+    if (NULL == process) {
+        return ERROR_INVALID_PARAMETER == GetLastError();
+    }
+    const bool exited = WAIT_OBJECT_0 == WaitForSingleObject(process, 0);
+    CloseHandle(process);
+    return exited;
+#else
+    return 0 != kill((pid_t)id, 0) && ESRCH == errno;
+#endif
+}
+
+static void yield_processor() {
+#if defined(SK_BUILD_FOR_WIN)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+static inline unsigned hash_glyph_id(uint32_t id) {
+    // The subpixel bits are at the top, so mix them down.
+    return (id * 2654435761u) >> 23;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t SkSharedGlyphStore::MinSize() {
+    return ChunksOffset(kMinChunkCount) + kMinChunkCount * kChunkSize;
+}
+
+SkSharedGlyphStore* SkSharedGlyphStore::Create(void* memory, size_t size) {
+    if (NULL == memory || !SkIsAlign4((intptr_t)memory) || size < MinSize() ||
+        size > SK_MaxU32) {
+        return NULL;
+    }
+    Header* header = static_cast<Header*>(memory);
+    for (;;) {
+        const int32_t state = sk_acquire_load(&header->fState);
+        if (kMagic == state) {
+            if (kVersion != header->fVersion || size != header->fSize) {
+                return NULL;
+            }
+            return SkNEW_ARGS(SkSharedGlyphStore, (memory, size));
+        }
+        if (0 == state) {
+            if (!sk_atomic_cas(&header->fState, 0, kInitializing)) {
+                continue;
+            }
+            const int chunkCount = CountChunks(size);
+            header->fVersion = kVersion;
+            header->fSize = SkToU32(size);
+            header->fLock = 0;
+            header->fClock = 0;
+            header->fChunkCount = chunkCount;
+            header->fChunkLimit = chunkCount;
+            header->fChunksUsed = 0;
+            header->fFreeChunk = 0;
+            header->fStrikesUsed = 0;
+            header->fChunksOffset = SkToU32(ChunksOffset(chunkCount));
+
+            char* base = static_cast<char*>(memory);
+            StrikeRec* strikes = reinterpret_cast<StrikeRec*>(base + StrikesOffset());
+            memset(strikes, 0, kStrikeCount * sizeof(StrikeRec));
+            for (int i = 0; i < kStrikeCount; ++i) {
+                strikes[i].fFirstChunk = -1;
+            }
+            int32_t* links = reinterpret_cast<int32_t*>(base + ChunkLinksOffset());
+            for (int i = 0; i < chunkCount; ++i) {
+                links[i] = i + 1 < chunkCount ? i + 1 : -1;
+            }
+            sk_release_store(&header->fState, kMagic);
+            continue;
+        }
+        if (kInitializing != state) {
+            return NULL;
+        }
+        // Another process is formatting the memory; it does not take long.
+    }
+}
+
+SkSharedGlyphStore::SkSharedGlyphStore(void* memory, size_t size)
+    : fHeader(static_cast<Header*>(memory))
+    , fBase(static_cast<char*>(memory))
+    , fSize(size)
+    , fHitCount(0)
+    , fMissCount(0) {
+}
+
+SkSharedGlyphStore::~SkSharedGlyphStore() {}
+
+SkSharedGlyphStore::StrikeRec* SkSharedGlyphStore::strikeRec(const Strike& strike) const {
+    if (strike.fIndex < 0 || strike.fIndex >= kStrikeCount) {
+        return NULL;
+    }
+    return reinterpret_cast<StrikeRec*>(fBase + StrikesOffset()) + strike.fIndex;
+}
+
+void SkSharedGlyphStore::lock() {
+    const int32_t self = process_id();
+    for (int tries = 0;; ++tries) {
+        if (sk_atomic_cas(&fHeader->fLock, 0, self)) {
+            return;
+        }
+        // The lock only guards a few list operations, so spin a little first.
+        if (tries < kLockSpinCount) {
+            continue;
+        }
+        yield_processor();
+        if (0 != tries % kLockSpinCount) {
+            continue;
+        }
+        // A thread of this process cannot have died holding the lock. Another
+        // process may have; a holder that is only slow (descheduled, stopped
+        // in a debugger) still owns the lists, so the lock is never taken
+        // from a process that may be alive.
+        const int32_t holder = sk_acquire_load(&fHeader->fLock);
+        if (0 != holder && self != holder && process_is_dead(holder) &&
+            sk_atomic_cas(&fHeader->fLock, holder, self)) {
+            SkDebugf("SkSharedGlyphStore: process %d died holding the lock, "
+                     "taking it over\n", holder);
+            this->reset();
+            return;
+        }
+    }
+}
+
+void SkSharedGlyphStore::unlock() {
+    // Only ever release the lock this process holds.
+    SkAssertResult(sk_atomic_cas(&fHeader->fLock, process_id(), 0));
+}
+
+bool SkSharedGlyphStore::acquireWriter(StrikeRec* rec) {
+    const int32_t self = process_id();
+    if (sk_atomic_cas(&rec->fWriter, kNoWriter, self)) {
+        return true;
+    }
+    // Another thread of this process may be the writer, or another process,
+    // which is only replaced once it has exited.
+    const int32_t writer = sk_acquire_load(&rec->fWriter);
+    return self != writer && process_is_dead(writer) &&
+           sk_atomic_cas(&rec->fWriter, writer, self);
+}
+
+void SkSharedGlyphStore::releaseWriter(StrikeRec* rec) {
+    sk_release_store(&rec->fWriter, kNoWriter);
+}
+
+void SkSharedGlyphStore::recordHit(bool hit) {
+    sk_atomic_inc(hit ? &fHitCount : &fMissCount);
+}
+
+bool SkSharedGlyphStore::validate(const Strike& strike, const StrikeRec* rec) const {
+    // The compare-and-swap is a full barrier, so that none of the reads of the
+    // glyph can be reordered after this check of the sequence number.
+    return sk_atomic_cas(const_cast<int32_t*>(&rec->fSeq), strike.fSeq, strike.fSeq);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkSharedGlyphStore::reset() {
+    // The dead holder may have been anywhere in a list operation, so rebuild
+    // the free list from scratch, and drop every strike that no live process
+    // is writing to. The holder only changed the chunks of the strikes it was
+    // the writer of, so those of the strikes kept are intact.
+    StrikeRec* strikes = reinterpret_cast<StrikeRec*>(fBase + StrikesOffset());
+    int32_t* links = reinterpret_cast<int32_t*>(fBase + ChunkLinksOffset());
+    const int chunkCount = fHeader->fChunkCount;
+    SkAutoTMalloc<bool> used(chunkCount);
+    sk_bzero(used.get(), chunkCount * sizeof(bool));
+    int chunksUsed = 0;
+    int strikesUsed = 0;
+
+    for (int i = 0; i < kStrikeCount; ++i) {
+        StrikeRec* rec = &strikes[i];
+        if (!this->acquireWriter(rec)) {
+            int32_t chunk = rec->fFirstChunk;
+            for (int n = 0; chunk >= 0 && chunk < chunkCount && n < chunkCount; ++n) {
+                used[chunk] = true;
+                chunksUsed += 1;
+                chunk = links[chunk];
+            }
+            strikesUsed += 0 != rec->fKeyLength;
+            continue;
+        }
+        const int32_t seq = rec->fSeq & ~1;
+        sk_release_store(&rec->fSeq, seq + 1);
+        memset(rec->fEntries, 0, sizeof(rec->fEntries));
+        rec->fFirstChunk = -1;
+        rec->fChunkUsed = 0;
+        rec->fChecksum = 0;
+        rec->fKeyLength = 0;
+        sk_release_store(&rec->fSeq, seq + 2);
+        this->releaseWriter(rec);
+    }
+
+    int32_t freeChunk = -1;
+    for (int i = chunkCount - 1; i >= 0; --i) {
+        if (!used[i]) {
+            links[i] = freeChunk;
+            freeChunk = i;
+        }
+    }
+    fHeader->fFreeChunk = freeChunk;
+    fHeader->fChunksUsed = chunksUsed;
+    fHeader->fStrikesUsed = strikesUsed;
+}
+
+bool SkSharedGlyphStore::evictStrike(StrikeRec* rec) {
+    if (0 == rec->fKeyLength || !this->acquireWriter(rec)) {
+        return false;
+    }
+    // An odd sequence number tells readers that the strike is changing. A
+    // writer that died may have left it odd.
+    const int32_t seq = rec->fSeq & ~1;
+    sk_release_store(&rec->fSeq, seq + 1);
+
+    int32_t* links = reinterpret_cast<int32_t*>(fBase + ChunkLinksOffset());
+    int32_t chunk = rec->fFirstChunk;
+    while (chunk >= 0) {
+        const int32_t next = links[chunk];
+        links[chunk] = fHeader->fFreeChunk;
+        fHeader->fFreeChunk = chunk;
+        fHeader->fChunksUsed -= 1;
+        chunk = next;
+    }
+    memset(rec->fEntries, 0, sizeof(rec->fEntries));
+    rec->fFirstChunk = -1;
+    rec->fChunkUsed = 0;
+    rec->fChecksum = 0;
+    rec->fKeyLength = 0;
+    fHeader->fStrikesUsed -= 1;
+
+    sk_release_store(&rec->fSeq, seq + 2);
+    this->releaseWriter(rec);
+    return true;
+}
+
+SkSharedGlyphStore::StrikeRec* SkSharedGlyphStore::lruStrike(const StrikeRec* except,
+                                                             bool needChunks) const {
+    StrikeRec* strikes = reinterpret_cast<StrikeRec*>(fBase + StrikesOffset());
+    StrikeRec* victim = NULL;
+    for (int i = 0; i < kStrikeCount; ++i) {
+        StrikeRec* candidate = &strikes[i];
+        if (candidate == except || 0 == candidate->fKeyLength ||
+            (needChunks && candidate->fFirstChunk < 0)) {
+            continue;
+        }
+        const int32_t writer = sk_acquire_load(&candidate->fWriter);
+        if (kNoWriter != writer && !process_is_dead(writer)) {
+            continue;
+        }
+        if (NULL == victim || candidate->fLastUse - victim->fLastUse < 0) {
+            victim = candidate;
+        }
+    }
+    return victim;
+}
+
+bool SkSharedGlyphStore::findStrike(const SkDescriptor& key, Strike* strike) {
+    const size_t length = key.getLength();
+    if (length > kMaxKeyLength) {
+        return false;
+    }
+    StrikeRec* strikes = reinterpret_cast<StrikeRec*>(fBase + StrikesOffset());
+
+    this->lock();
+    StrikeRec* rec = NULL;
+    StrikeRec* freeRec = NULL;
+    for (int i = 0; i < kStrikeCount; ++i) {
+        StrikeRec* candidate = &strikes[i];
+        if (0 == candidate->fKeyLength) {
+            if (NULL == freeRec) {
+                freeRec = candidate;
+            }
+        } else if (candidate->fKeyLength == length &&
+                   candidate->fChecksum == key.getChecksum() &&
+                   0 == memcmp(candidate->fKey, &key, length)) {
+            rec = candidate;
+            break;
+        }
+    }
+    if (NULL == rec) {
+        if (NULL == freeRec) {
+            StrikeRec* victim = this->lruStrike(NULL, false);
+            if (NULL == victim || !this->evictStrike(victim)) {
+                this->unlock();
+                return false;
+            }
+            freeRec = victim;
+        }
+        rec = freeRec;
+        memcpy(rec->fKey, &key, length);
+        rec->fChecksum = key.getChecksum();
+        rec->fKeyLength = SkToU32(length);
+        fHeader->fStrikesUsed += 1;
+    }
+    rec->fLastUse = sk_atomic_inc(&fHeader->fClock);
+    strike->fIndex = SkToInt(rec - strikes);
+    strike->fSeq = rec->fSeq;
+    this->unlock();
+    return true;
+}
+
+int32_t SkSharedGlyphStore::allocChunk(StrikeRec* except) {
+    while (fHeader->fChunksUsed >= fHeader->fChunkLimit || fHeader->fFreeChunk < 0) {
+        StrikeRec* victim = this->lruStrike(except, true);
+        if (NULL == victim || !this->evictStrike(victim)) {
+            return -1;
+        }
+    }
+    int32_t* links = reinterpret_cast<int32_t*>(fBase + ChunkLinksOffset());
+    const int32_t chunk = fHeader->fFreeChunk;
+    fHeader->fFreeChunk = links[chunk];
+    fHeader->fChunksUsed += 1;
+    return chunk;
+}
+
+void* SkSharedGlyphStore::allocImage(StrikeRec* rec, size_t size, int32_t* offset) {
+    const size_t needed = SkAlign4(sizeof(ImageRec) + size);
+    if (needed > kChunkSize) {
+        return NULL;
+    }
+    if (rec->fFirstChunk < 0 || rec->fChunkUsed + needed > kChunkSize) {
+        this->lock();
+        const int32_t chunk = this->allocChunk(rec);
+        if (chunk >= 0) {
+            int32_t* links = reinterpret_cast<int32_t*>(fBase + ChunkLinksOffset());
+            links[chunk] = rec->fFirstChunk;
+            rec->fFirstChunk = chunk;
+            rec->fChunkUsed = 0;
+        }
+        this->unlock();
+        if (chunk < 0) {
+            return NULL;
+        }
+    }
+    *offset = SkToS32(fHeader->fChunksOffset + rec->fFirstChunk * kChunkSize + rec->fChunkUsed);
+    rec->fChunkUsed += SkToU32(needed);
+    return fBase + *offset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkSharedGlyphStore::Entry* SkSharedGlyphStore::findEntry(StrikeRec* rec, uint32_t id) const {
+    const uint32_t key = id + 1;
+    const unsigned start = hash_glyph_id(id);
+    for (int i = 0; i < kMaxProbe; ++i) {
+        Entry* entry = &rec->fEntries[(start + i) & (kGlyphsPerStrike - 1)];
+        const uint32_t entryID = sk_acquire_load(&entry->fID);
+        if (entryID == key) {
+            return entry;
+        }
+        if (0 == entryID) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+bool SkSharedGlyphStore::findGlyph(const Strike& strike, SkGlyph* glyph) {
+    StrikeRec* rec = this->strikeRec(strike);
+    if (NULL == rec || sk_acquire_load(&rec->fSeq) != strike.fSeq) {
+        return false;
+    }
+    const Entry* entry = this->findEntry(rec, glyph->fID);
+    if (NULL == entry) {
+        this->recordHit(false);
+        return false;
+    }
+    const Entry copy = *entry;
+    if (!this->validate(strike, rec) || MASK_FORMAT_JUST_ADVANCE == copy.fMaskFormat) {
+        this->recordHit(false);
+        return false;
+    }
+    glyph->fAdvanceX = copy.fAdvanceX;
+    glyph->fAdvanceY = copy.fAdvanceY;
+    glyph->fWidth = copy.fWidth;
+    glyph->fHeight = copy.fHeight;
+    glyph->fTop = copy.fTop;
+    glyph->fLeft = copy.fLeft;
+    glyph->fMaskFormat = copy.fMaskFormat;
+    glyph->fRsbDelta = copy.fRsbDelta;
+    glyph->fLsbDelta = copy.fLsbDelta;
+    this->recordHit(true);
+    return true;
+}
+
+bool SkSharedGlyphStore::findImage(const Strike& strike, SkGlyph* glyph, void* dst) {
+    StrikeRec* rec = this->strikeRec(strike);
+    if (NULL == rec || sk_acquire_load(&rec->fSeq) != strike.fSeq) {
+        return false;
+    }
+    const Entry* entry = this->findEntry(rec, glyph->fID);
+    const int32_t offset = entry ? sk_acquire_load(&entry->fImage) : 0;
+    // The entry may have been reused by now, so check the offset before
+    // reading anything from it.
+    if (offset < (int32_t)fHeader->fChunksOffset ||
+        offset + sizeof(ImageRec) > fSize) {
+        this->recordHit(false);
+        return false;
+    }
+    ImageRec imageRec;
+    memcpy(&imageRec, fBase + offset, sizeof(imageRec));
+
+    SkGlyph stored = *glyph;
+    stored.fMaskFormat = imageRec.fMaskFormat;
+    const size_t size = stored.computeImageSize();
+    if (imageRec.fSize != size || size > glyph->computeImageSize() ||
+        offset + sizeof(ImageRec) + size > fSize) {
+        this->recordHit(false);
+        return false;
+    }
+    memcpy(dst, fBase + offset + sizeof(ImageRec), size);
+    if (!this->validate(strike, rec)) {
+        this->recordHit(false);
+        return false;
+    }
+    glyph->fMaskFormat = imageRec.fMaskFormat;
+    this->recordHit(true);
+    return true;
+}
+
+void SkSharedGlyphStore::addGlyph(const Strike& strike, const SkGlyph& glyph) {
+    StrikeRec* rec = this->strikeRec(strike);
+    if (NULL == rec || !glyph.isFullMetrics() ||
+        !this->acquireWriter(rec)) {
+        return;
+    }
+    // Nobody can evict the strike while we are its writer.
+    if (rec->fSeq == strike.fSeq) {
+        const uint32_t key = glyph.fID + 1;
+        const unsigned start = hash_glyph_id(glyph.fID);
+        for (int i = 0; i < kMaxProbe; ++i) {
+            Entry* entry = &rec->fEntries[(start + i) & (kGlyphsPerStrike - 1)];
+            if (entry->fID == key) {
+                break;
+            }
+            if (0 == entry->fID) {
+                entry->fImage = 0;
+                entry->fAdvanceX = glyph.fAdvanceX;
+                entry->fAdvanceY = glyph.fAdvanceY;
+                entry->fWidth = glyph.fWidth;
+                entry->fHeight = glyph.fHeight;
+                entry->fTop = glyph.fTop;
+                entry->fLeft = glyph.fLeft;
+                entry->fMaskFormat = glyph.fMaskFormat;
+                entry->fRsbDelta = glyph.fRsbDelta;
+                entry->fLsbDelta = glyph.fLsbDelta;
+                sk_release_store(&entry->fID, key);
+                break;
+            }
+        }
+        rec->fLastUse = sk_atomic_inc(&fHeader->fClock);
+    }
+    this->releaseWriter(rec);
+}
+
+void SkSharedGlyphStore::addImage(const Strike& strike, const SkGlyph& glyph) {
+    StrikeRec* rec = this->strikeRec(strike);
+    if (NULL == rec || NULL == glyph.fImage ||
+        !this->acquireWriter(rec)) {
+        return;
+    }
+    if (rec->fSeq == strike.fSeq) {
+        Entry* entry = this->findEntry(rec, glyph.fID);
+        if (entry && 0 == entry->fImage) {
+            const size_t size = glyph.computeImageSize();
+            int32_t offset;
+            char* dst = static_cast<char*>(this->allocImage(rec, size, &offset));
+            if (dst) {
+                ImageRec imageRec;
+                imageRec.fSize = SkToU32(size);
+                imageRec.fMaskFormat = glyph.fMaskFormat;
+                memset(imageRec.fPad, 0, sizeof(imageRec.fPad));
+                memcpy(dst, &imageRec, sizeof(imageRec));
+                memcpy(dst + sizeof(imageRec), glyph.fImage, size);
+                sk_release_store(&entry->fImage, offset);
+            }
+        }
+    }
+    this->releaseWriter(rec);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t SkSharedGlyphStore::getByteLimit() const {
+    return fHeader->fChunkLimit * kChunkSize;
+}
+
+void SkSharedGlyphStore::setByteLimit(size_t limit) {
+    const int chunkLimit = (int)SkTMin<size_t>(SkTMax<size_t>(limit / kChunkSize, 1),
+                                                fHeader->fChunkCount);
+
+    this->lock();
+    fHeader->fChunkLimit = chunkLimit;
+    while (fHeader->fChunksUsed > chunkLimit) {
+        StrikeRec* victim = this->lruStrike(NULL, true);
+        if (NULL == victim || !this->evictStrike(victim)) {
+            // The rest is evicted as the writers allocate chunks.
+            break;
+        }
+    }
+    this->unlock();
+}
+
+size_t SkSharedGlyphStore::getBytesUsed() const {
+    return sk_acquire_load(&fHeader->fChunksUsed) * kChunkSize;
+}
+
+int SkSharedGlyphStore::countStrikes() const {
+    return sk_acquire_load(&fHeader->fStrikesUsed);
+}
+
+void SkSharedGlyphStore::purgeAll() {
+    StrikeRec* strikes = reinterpret_cast<StrikeRec*>(fBase + StrikesOffset());
+    this->lock();
+    for (int i = 0; i < kStrikeCount; ++i) {
+        this->evictStrike(&strikes[i]);
+    }
+    this->unlock();
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSharedGlyphStore_DEFINED
+#define SkSharedGlyphStore_DEFINED
+
+#include "SkRefCnt.h"
+
+class SkDescriptor;
+struct SkGlyph;
+
+/** \class SkSharedGlyphStore
+
+    A store of glyph metrics and images in a block of memory that several
+    processes have mapped, so that a process can reuse the glyphs that another
+    one has already generated. SkGlyphCache consults it before asking its
+    scaler context for a glyph, and adds the glyphs it generates to it.
+
+    The store holds a fixed number of strikes, keyed by descriptor. Reading a
+    glyph never blocks: a strike carries a sequence number that changes when
+    the strike is evicted, and readers discard whatever they copied if it
+    changed underneath them. Glyphs are added by at most one writer per strike
+    at a time; a writer that finds the strike busy simply does not add its
+    glyph. Assigning and evicting strikes takes a lock in the shared memory.
+    The lock and each strike record the id of the process holding them, and
+    are only taken over from a process that has exited, never from a slow
+    one, so the processes sharing a store must be able to see each other's
+    ids. A process taking the lock over evicts every strike that no live
+    process is writing to, since the holder may have left the lists half
+    updated.
+
+    An SkSharedGlyphStore object is a view of the memory for one process; it
+    does not own the memory.
+*/
+class SkSharedGlyphStore : public SkRefCnt {
+public:
+    /** Returns a view of the store in memory, which must be 4-byte aligned,
+        and either filled with zeros or already holding a store of the same
+        size. The first process to see zeros formats the memory. Returns NULL
+        if the memory is too small or holds something else.
+    */
+    static SkSharedGlyphStore* Create(void* memory, size_t size);
+
+    /** Returns the smallest block of memory that Create() accepts.
+    */
+    static size_t MinSize();
+
+    /** Identifies a strike of the store, as of when it was found. Once the
+        strike is evicted, the handle no longer finds any glyphs.
+    */
+    struct Strike {
+        int         fIndex;
+        int32_t     fSeq;
+
+        Strike() : fIndex(-1), fSeq(0) {}
+        bool isValid() const { return fIndex >= 0; }
+    };
+
+    /** Finds the strike for the descriptor, or assigns one to it, evicting
+        the least recently used strike if they are all taken. Returns false if
+        the descriptor cannot be stored.
+    */
+    bool findStrike(const SkDescriptor& key, Strike*);
+
+    /** If the strike holds the glyph with the same fID, sets the metrics of
+        glyph from it and returns true.
+    */
+    bool findGlyph(const Strike&, SkGlyph* glyph);
+
+    /** If the strike holds the image of the glyph, copies it into dst, whose
+        size is glyph.computeImageSize(), and returns true. The mask format of
+        the glyph is updated to the one of the stored image.
+    */
+    bool findImage(const Strike&, SkGlyph* glyph, void* dst);
+
+    /** Adds the metrics of the glyph, which must be full metrics.
+    */
+    void addGlyph(const Strike&, const SkGlyph& glyph);
+
+    /** Adds the image of the glyph, whose metrics must have been added.
+    */
+    void addImage(const Strike&, const SkGlyph& glyph);
+
+    /** The number of bytes of glyph images the store may hold before it
+        evicts strikes. Limited by the size of the memory.
+    */
+    size_t getByteLimit() const;
+    void setByteLimit(size_t limit);
+
+    size_t getBytesUsed() const;
+    int countStrikes() const;
+
+    /** Evicts every strike. Other processes see the glyphs disappear.
+    */
+    void purgeAll();
+
+    /** The number of glyph metrics and images this process found in the
+        store, and the number it looked for and did not find.
+    */
+    int getHitCount() const { return fHitCount; }
+    int getMissCount() const { return fMissCount; }
+
+    virtual ~SkSharedGlyphStore();
+
+private:
+    struct Header;
+    struct StrikeRec;
+    struct Entry;
+
+    SkSharedGlyphStore(void* memory, size_t size);
+
+    static size_t StrikesOffset();
+    static size_t ChunkLinksOffset();
+    static size_t ChunksOffset(int chunkCount);
+    static int    CountChunks(size_t size);
+
+    StrikeRec*  strikeRec(const Strike&) const;
+    void        lock();
+    void        unlock();
+    bool        acquireWriter(StrikeRec*);
+    void        releaseWriter(StrikeRec*);
+
+    // Must be called with the lock held.
+    void        reset();
+    StrikeRec*  lruStrike(const StrikeRec* except, bool needChunks) const;
+    bool        evictStrike(StrikeRec*);
+    int32_t     allocChunk(StrikeRec* except);
+    void*       allocImage(StrikeRec*, size_t size, int32_t* offset);
+
+    bool        validate(const Strike&, const StrikeRec*) const;
+    Entry*      findEntry(StrikeRec*, uint32_t id) const;
+    void        recordHit(bool hit);
+
+    Header*     fHeader;
+    char*       fBase;
+    size_t      fSize;
+    int32_t     fHitCount;
+    int32_t     fMissCount;
+
+    typedef SkRefCnt INHERITED;
+};
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkStrokeCache.h"
+
+#include "SkChecksum.h"
+#include "SkGraphics.h"
+#include "SkLazyPtr.h"
+#include "SkPaint.h"
+#include "SkPathEffect.h"
+#include "SkStrokeRec.h"
+
+#ifndef SK_DEFAULT_STROKE_CACHE_LIMIT
+    #define SK_DEFAULT_STROKE_CACHE_LIMIT     (2 * 1024 * 1024)
+#endif
+
+bool SkStrokeCache::Key::init(const SkPath& src, const SkPaint& paint, const SkRect* cullRect) {
+    sk_bzero(this, sizeof(Key));
+
+    int intervalCount = 0;
+    SkPathEffect* effect = paint.getPathEffect();
+    if (effect) {
+        SkPathEffect::DashInfo info;
+        if (SkPathEffect::kDash_DashType != effect->asADash(&info) ||
+            info.fCount > kMaxIntervals) {
+            return false;
+        }
+        // The dash of a line is clipped to the cull rect.
+        if (cullRect && src.isLine(NULL)) {
+            return false;
+        }
+        info.fIntervals = fIntervals;
+        effect->asADash(&info);
+        intervalCount = info.fCount;
+        fPhase = info.fPhase;
+    }
+
+    const SkStrokeRec rec(paint);
+    if (0 == intervalCount && !rec.needToApply()) {
+        return false;
+    }
+    fGenID = src.getGenerationID();
+    fFlags = src.getFillType()
+           | (rec.getStyle() << 2)
+           | (rec.getCap() << 4)
+           | (rec.getJoin() << 6)
+           | (intervalCount << 8);
+    fWidth = rec.getWidth();
+    fMiter = rec.getMiter();
+    return true;
+}
+
+uint32_t SkStrokeCache::Key::hash() const {
+    SK_COMPILE_ASSERT(SkIsAlign4(sizeof(Key)), key_must_be_words);
+    return SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(this), sizeof(Key));
+}
+
+struct SkStrokeCache::Entry {
+    Key     fKey;
+    SkPath  fPath;
+    bool    fFill;
+    size_t  fBytes;
+
+    static const Key& GetKey(const Entry& entry) { return entry.fKey; }
+    static uint32_t Hash(const Key& key) { return key.hash(); }
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+};
+
+static size_t path_bytes(const SkPath& path) {
+    return path.countPoints() * sizeof(SkPoint) + path.countVerbs();
+}
+
+SkStrokeCache& SkStrokeCache::Get() {
+    SK_DECLARE_STATIC_LAZY_PTR(SkStrokeCache, cache);
+    return *cache.get();
+}
+
+SkStrokeCache::SkStrokeCache()
+    : fBytesUsed(0)
+    , fByteLimit(SK_DEFAULT_STROKE_CACHE_LIMIT)
+    , fHitCount(0)
+    , fMissCount(0) {
+    sk_bzero(fRecent, sizeof(fRecent));
+}
+
+SkStrokeCache::~SkStrokeCache() {
+    this->purgeAll();
+}
+
+bool SkStrokeCache::find(const Key& key, SkPath* dst, bool* fill) {
+    SkAutoMutexAcquire ac(fMutex);
+    Entry* entry = fHash.find(key);
+    if (NULL == entry) {
+        fMissCount += 1;
+        return false;
+    }
+    fHitCount += 1;
+    if (fLRU.head() != entry) {
+        fLRU.remove(entry);
+        fLRU.addToHead(entry);
+    }
+    // The copy shares the points, so the entry may be purged.
+    *dst = entry->fPath;
+    *fill = entry->fFill;
+    return true;
+}
+
+void SkStrokeCache::add(const Key& key, const SkPath& dst, bool fill) {
+    const uint32_t hash = key.hash();
+    SkAutoMutexAcquire ac(fMutex);
+    if (0 == fByteLimit) {
+        return;
+    }
+    uint32_t* recent = &fRecent[hash & (kRecentCount - 1)];
+    if (*recent != hash) {
+        *recent = hash;
+        return;
+    }
+    if (fHash.find(key)) {
+        // another thread added it
+        return;
+    }
+    Entry* entry = SkNEW(Entry);
+    entry->fKey = key;
+    entry->fPath = dst;
+    entry->fFill = fill;
+    entry->fBytes = sizeof(Entry) + path_bytes(dst);
+    fHash.add(entry);
+    fLRU.addToHead(entry);
+    fBytesUsed += entry->fBytes;
+    this->purgeToLimit();
+}
+
+void SkStrokeCache::remove(Entry* entry) {
+    fHash.remove(entry->fKey);
+    fLRU.remove(entry);
+    fBytesUsed -= entry->fBytes;
+    SkDELETE(entry);
+}
+
+void SkStrokeCache::purgeToLimit() {
+    while (fBytesUsed > fByteLimit) {
+        this->remove(fLRU.tail());
+    }
+}
+
+size_t SkStrokeCache::getByteLimit() const {
+    SkAutoMutexAcquire ac(fMutex);
+    return fByteLimit;
+}
+
+void SkStrokeCache::setByteLimit(size_t limit) {
+    SkAutoMutexAcquire ac(fMutex);
+    fByteLimit = limit;
+    this->purgeToLimit();
+}
+
+size_t SkStrokeCache::getBytesUsed() const {
+    SkAutoMutexAcquire ac(fMutex);
+    return fBytesUsed;
+}
+
+int SkStrokeCache::count() const {
+    SkAutoMutexAcquire ac(fMutex);
+    return fHash.count();
+}
+
+int SkStrokeCache::getHitCount() const {
+    SkAutoMutexAcquire ac(fMutex);
+    return fHitCount;
+}
+
+int SkStrokeCache::getMissCount() const {
+    SkAutoMutexAcquire ac(fMutex);
+    return fMissCount;
+}
+
+void SkStrokeCache::purgeAll() {
+    SkAutoMutexAcquire ac(fMutex);
+    while (Entry* entry = fLRU.head()) {
+        this->remove(entry);
+    }
+    sk_bzero(fRecent, sizeof(fRecent));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t SkGraphics::GetStrokeCacheBytesUsed() {
+    return SkStrokeCache::Get().getBytesUsed();
+}
+
+size_t SkGraphics::GetStrokeCacheByteLimit() {
+    return SkStrokeCache::Get().getByteLimit();
+}
+
+size_t SkGraphics::SetStrokeCacheByteLimit(size_t newLimit) {
+    SkStrokeCache& cache = SkStrokeCache::Get();
+    size_t prevLimit = cache.getByteLimit();
+    cache.setByteLimit(newLimit);
+    return prevLimit;
+}
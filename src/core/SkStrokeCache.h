@@ -0,0 +1,116 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkStrokeCache_DEFINED
+#define SkStrokeCache_DEFINED
+
+#include "SkPath.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
+#include "SkThread.h"
+
+class SkPaint;
+
+/** \class SkStrokeCache
+
+    The outlines that SkPaint::getFillPath() made of recently stroked and
+    dashed paths, so that drawing the same path with the same stroke and dash
+    again (chart gridlines, borders) copies the outline instead of stroking
+    or dashing it again. They are keyed by the generation ID of the path's
+    points and verbs, its fill type, the stroke and the dash intervals.
+
+    The outlines do not depend on the matrix: strokes are made in the path's
+    own coordinates, and the matrix is applied to the outline.
+
+    A path's outline is kept the second time it is stroked, so that paths
+    made for a single draw do not push out the others. The cache is
+    thread-safe, and evicts the least recently used outlines to stay within
+    its byte limit.
+*/
+class SkStrokeCache : SkNoncopyable {
+public:
+    // Dashes with more intervals are not cached.
+    static const int kMaxIntervals = 8;
+
+    class Key {
+    public:
+        /** Makes the key for getting the fill path of src with the paint.
+            Returns false if its fill path cannot be cached: if the paint
+            neither strokes nor dashes, if it has another path effect, or if
+            the dash would be culled to cullRect.
+        */
+        bool init(const SkPath& src, const SkPaint&, const SkRect* cullRect);
+
+        bool operator==(const Key& other) const {
+            return 0 == memcmp(this, &other, sizeof(Key));
+        }
+
+        uint32_t hash() const;
+
+    private:
+        uint32_t    fGenID;
+        uint32_t    fFlags;     // fill type, stroke style, cap, join and interval count
+        SkScalar    fWidth;
+        SkScalar    fMiter;
+        SkScalar    fPhase;
+        SkScalar    fIntervals[kMaxIntervals];
+    };
+
+    /** The process-wide cache.
+    */
+    static SkStrokeCache& Get();
+
+    SkStrokeCache();
+    ~SkStrokeCache();
+
+    /** If the fill path for the key is cached, sets dst to it and fill to
+        whether it is to be filled (rather than hairlined), and returns true.
+    */
+    bool find(const Key&, SkPath* dst, bool* fill);
+
+    /** Adds the fill path for the key, if the key was looked for before.
+    */
+    void add(const Key&, const SkPath& dst, bool fill);
+
+    size_t getByteLimit() const;
+    void setByteLimit(size_t limit);
+
+    size_t getBytesUsed() const;
+    int count() const;
+
+    void purgeAll();
+
+    /** The number of fill paths found in the cache, and the number not.
+    */
+    int getHitCount() const;
+    int getMissCount() const;
+
+private:
+    struct Entry;
+
+    // Must be called with the mutex held.
+    void remove(Entry*);
+    void purgeToLimit();
+
+    // The hashes of keys that were looked for and not found. A key is only
+    // added if its hash is here, so a path stroked once is not.
+    enum {
+        kRecentBits = 8,
+        kRecentCount = 1 << kRecentBits,
+    };
+
+    mutable SkMutex                 fMutex;
+    SkTDynamicHash<Entry, Key>      fHash;
+    SkTInternalLList<Entry>         fLRU;       // most recently used first
+    uint32_t                        fRecent[kRecentCount];
+    size_t                          fBytesUsed;
+    size_t                          fByteLimit;
+    int32_t                         fHitCount;
+    int32_t                         fMissCount;
+};
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTextBlob.h"
+
+#include "SkGlyphCache.h"
+
+// The flags of the paint that the blob takes over when it is drawn.
+static const uint32_t kFontFlagsMask = SkPaint::kAntiAlias_Flag |
+                                       SkPaint::kFakeBoldText_Flag |
+                                       SkPaint::kLinearText_Flag |
+                                       SkPaint::kSubpixelText_Flag |
+                                       SkPaint::kDevKernText_Flag |
+                                       SkPaint::kLCDRenderText_Flag |
+                                       SkPaint::kEmbeddedBitmapText_Flag |
+                                       SkPaint::kAutoHinting_Flag |
+                                       SkPaint::kVerticalText_Flag |
+                                       SkPaint::kGenA8FromLCD_Flag |
+                                       SkPaint::kDistanceFieldTextTEMP_Flag;
+
+static uint32_t next_blob_id() {
+    static int32_t gNextID;
+    int32_t id;
+    do {
+        id = sk_atomic_inc(&gNextID) + 1;
+    } while (0 == id);
+    return id;
+}
+
+SkTextBlob::SkTextBlob(int count, const SkPaint& paint)
+    : fCount(count)
+    , fGlyphs(count)
+    , fPositions(count)
+    , fUniqueID(next_blob_id())
+    , fStrikeGlyphs(NULL) {
+    fBounds.setEmpty();
+    fFont.setTypeface(paint.getTypeface());
+    fFont.setTextSize(paint.getTextSize());
+    fFont.setTextScaleX(paint.getTextScaleX());
+    fFont.setTextSkewX(paint.getTextSkewX());
+    fFont.setHinting(paint.getHinting());
+    fFont.setFlags(paint.getFlags() & kFontFlagsMask);
+    fFont.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+}
+
+SkTextBlob::~SkTextBlob() {
+    SkSafeUnref(fStrikeGlyphs);
+}
+
+void SkTextBlob::applyFontToPaint(SkPaint* paint) const {
+    paint->setTypeface(fFont.getTypeface());
+    paint->setTextSize(fFont.getTextSize());
+    paint->setTextScaleX(fFont.getTextScaleX());
+    paint->setTextSkewX(fFont.getTextSkewX());
+    paint->setHinting(fFont.getHinting());
+    paint->setFlags((paint->getFlags() & ~kFontFlagsMask) | fFont.getFlags());
+    paint->setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    paint->setTextAlign(SkPaint::kLeft_Align);
+}
+
+SkTextBlob* SkTextBlob::CreateFromGlyphs(const SkPaint& paint, int count,
+                                         const uint16_t glyphs[], const SkPoint pos[],
+                                         const SkRect bounds[]) {
+    SkTextBlob* blob = SkNEW_ARGS(SkTextBlob, (count, paint));
+    memcpy(blob->fGlyphs.get(), glyphs, count * sizeof(uint16_t));
+    memcpy(blob->fPositions.get(), pos, count * sizeof(SkPoint));
+    for (int i = 0; i < count; ++i) {
+        if (!bounds[i].isEmpty()) {
+            blob->fBounds.join(bounds[i].makeOffset(pos[i].fX, pos[i].fY));
+        }
+    }
+    return blob;
+}
+
+// Converts the text to glyphs, and measures them.
+static int text_to_glyphs(const void* text, size_t byteLength, const SkPaint& paint,
+                          SkAutoSTMalloc<64, uint16_t>* glyphs,
+                          SkAutoSTMalloc<64, SkScalar>* widths,
+                          SkAutoSTMalloc<64, SkRect>* bounds) {
+    const int count = paint.countText(text, byteLength);
+    glyphs->reset(count);
+    widths->reset(count);
+    bounds->reset(count);
+    paint.textToGlyphs(text, byteLength, glyphs->get());
+
+    SkPaint glyphPaint(paint);
+    glyphPaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    glyphPaint.getTextWidths(glyphs->get(), count * sizeof(uint16_t), widths->get(),
+                             bounds->get());
+    return count;
+}
+
+SkTextBlob* SkTextBlob::Create(const void* text, size_t byteLength, const SkPaint& paint) {
+    SkAutoSTMalloc<64, uint16_t> glyphs;
+    SkAutoSTMalloc<64, SkScalar> widths;
+    SkAutoSTMalloc<64, SkRect> bounds;
+    const int count = text_to_glyphs(text, byteLength, paint, &glyphs, &widths, &bounds);
+
+    SkScalar total = 0;
+    for (int i = 0; i < count; ++i) {
+        total += widths[i];
+    }
+    SkScalar advance = 0;
+    if (SkPaint::kCenter_Align == paint.getTextAlign()) {
+        advance = -SkScalarHalf(total);
+    } else if (SkPaint::kRight_Align == paint.getTextAlign()) {
+        advance = -total;
+    }
+
+    SkAutoSTMalloc<64, SkPoint> pos(count);
+    for (int i = 0; i < count; ++i) {
+        if (paint.isVerticalText()) {
+            pos[i].set(0, advance);
+        } else {
+            pos[i].set(advance, 0);
+        }
+        advance += widths[i];
+    }
+    return CreateFromGlyphs(paint, count, glyphs.get(), pos.get(), bounds.get());
+}
+
+SkTextBlob* SkTextBlob::CreatePos(const void* text, size_t byteLength,
+                                  const SkPoint pos[], const SkPaint& paint) {
+    SkAutoSTMalloc<64, uint16_t> glyphs;
+    SkAutoSTMalloc<64, SkScalar> widths;
+    SkAutoSTMalloc<64, SkRect> bounds;
+    const int count = text_to_glyphs(text, byteLength, paint, &glyphs, &widths, &bounds);
+
+    SkScalar alignScale = 0;
+    if (SkPaint::kCenter_Align == paint.getTextAlign()) {
+        alignScale = SK_ScalarHalf;
+    } else if (SkPaint::kRight_Align == paint.getTextAlign()) {
+        alignScale = SK_Scalar1;
+    }
+
+    SkAutoSTMalloc<64, SkPoint> leftPos(count);
+    for (int i = 0; i < count; ++i) {
+        const SkScalar shift = SkScalarMul(widths[i], alignScale);
+        if (paint.isVerticalText()) {
+            leftPos[i].set(pos[i].fX, pos[i].fY - shift);
+        } else {
+            leftPos[i].set(pos[i].fX - shift, pos[i].fY);
+        }
+    }
+    return CreateFromGlyphs(paint, count, glyphs.get(), leftPos.get(), bounds.get());
+}
+
+SkTextBlob::StrikeGlyphs* SkTextBlob::refStrikeGlyphs(SkGlyphCache* cache) const {
+    SkASSERT(!cache->isSubpixel());
+    const uint32_t cacheID = cache->getUniqueID();
+    {
+        SkAutoMutexAcquire ac(fStrikeMutex);
+        if (fStrikeGlyphs && fStrikeGlyphs->fCacheID == cacheID) {
+            return SkRef(fStrikeGlyphs);
+        }
+    }
+
+    StrikeGlyphs* strike = SkNEW_ARGS(StrikeGlyphs, (fCount, cacheID));
+    for (int i = 0; i < fCount; ++i) {
+        strike->fGlyphs[i] = &cache->getGlyphIDMetrics(fGlyphs[i]);
+    }
+
+    SkAutoMutexAcquire ac(fStrikeMutex);
+    SkRefCnt_SafeAssign(fStrikeGlyphs, strike);
+    return strike;
+}
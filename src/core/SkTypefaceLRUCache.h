@@ -0,0 +1,95 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTypefaceLRUCache_DEFINED
+#define SkTypefaceLRUCache_DEFINED
+
+#include "SkRefCnt.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
+
+/** \class SkTypefaceLRUCache
+
+    Keeps the values computed for the kMaxCount most recently used typefaces,
+    e.g. their metrics, so that they are computed once per typeface rather
+    than once per use. It may be used from any thread.
+
+    K identifies the typeface, by its unique ID and whatever else the value
+    depends on, and is compared with ==. V is ref counted; a NULL value may be
+    kept, to remember that there is none.
+
+    Typeface IDs are never reused, so the value of a typeface that is gone is
+    only kept until it is evicted.
+*/
+template <typename K, typename V, int kMaxCount>
+class SkTypefaceLRUCache : SkNoncopyable {
+public:
+    SkTypefaceLRUCache() {}
+
+    ~SkTypefaceLRUCache() {
+        for (int i = 0; i < fRecs.count(); i++) {
+            SkSafeUnref(fRecs[i].fValue);
+        }
+    }
+
+    /** Returns true, and a reference to the value (which may be NULL), if the
+        value of the key is kept.
+    */
+    bool find(const K& key, V** value) {
+        SkAutoMutexAcquire lock(fMutex);
+        const int index = this->findIndex(key);
+        if (index < 0) {
+            return false;
+        }
+        const Rec rec = fRecs[index];
+        fRecs.remove(index);
+        fRecs.push(rec);
+        *value = SkSafeRef(rec.fValue);
+        return true;
+    }
+
+    /** Keeps the value for the key, evicting the least recently used one if
+        the cache is full. Returns a reference to the value kept, which is an
+        earlier one if another thread added one first.
+    */
+    V* add(const K& key, V* value) {
+        SkAutoMutexAcquire lock(fMutex);
+        const int index = this->findIndex(key);
+        if (index >= 0) {
+            return SkSafeRef(fRecs[index].fValue);
+        }
+        if (fRecs.count() == kMaxCount) {
+            SkSafeUnref(fRecs[0].fValue);
+            fRecs.remove(0);
+        }
+        Rec* rec = fRecs.append();
+        rec->fKey = key;
+        rec->fValue = SkSafeRef(value);
+        return SkSafeRef(value);
+    }
+
+private:
+    // The most recently used is last.
+    struct Rec {
+        K   fKey;
+        V*  fValue;
+    };
+
+    int findIndex(const K& key) const {
+        for (int i = fRecs.count() - 1; i >= 0; i--) {
+            if (fRecs[i].fKey == key) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    SkMutex         fMutex;
+    SkTDArray<Rec>  fRecs;
+};
+
+#endif
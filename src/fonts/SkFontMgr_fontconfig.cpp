@@ -9,14 +9,18 @@
 #include "SkFontStyle.h"
 #include "SkFontConfigInterface.h"
 #include "SkFontConfigTypeface.h"
+#include "SkFontIndex.h"
 #include "SkMath.h"
+#include "SkStream.h"
 #include "SkString.h"
 #include "SkTDArray.h"
 #include "SkThread.h"
+#include "SkTypefaceCache.h"
 
 // for now we pull these in directly. eventually we will solely rely on the
 // SkFontConfigInterface instance.
 #include <fontconfig/fontconfig.h>
+#include <stdlib.h>
 #include <unistd.h>
 
 namespace {
@@ -142,6 +146,40 @@ static FcPattern** MatchFont(FcFontSet* font_set,
     return firstIter;
 }
 
+struct IdentityRec {
+    const char* fPath;
+    int         fTTCIndex;
+};
+
+static bool find_by_identity_proc(SkTypeface* face, SkTypeface::Style, void* ctx) {
+    const SkFontConfigInterface::FontIdentity& identity =
+            static_cast<FontConfigTypeface*>(face)->getIdentity();
+    const IdentityRec* rec = static_cast<const IdentityRec*>(ctx);
+    return identity.fTTCIndex == rec->fTTCIndex && identity.fString.equals(rec->fPath);
+}
+
+// Returns the typeface of the face of a font file, sharing it with earlier
+// callers through the typeface cache.
+static SkTypeface* create_typeface(const char path[], int ttcIndex, const SkFontStyle& style,
+                                   const char familyName[]) {
+    IdentityRec rec = { path, ttcIndex };
+    SkTypeface* face = SkTypefaceCache::FindByProcAndRef(find_by_identity_proc, &rec);
+    if (face) {
+        return face;
+    }
+
+    SkFontConfigInterface::FontIdentity identity;
+    identity.fString.set(path);
+    identity.fTTCIndex = ttcIndex;
+    identity.fStyle = style;
+    const unsigned oldStyle = (style.weight() >= SkFontStyle::kSemiBold_Weight ?
+                                   SkTypeface::kBold : SkTypeface::kNormal) |
+                              (style.isItalic() ? SkTypeface::kItalic : SkTypeface::kNormal);
+    face = FontConfigTypeface::Create((SkTypeface::Style)oldStyle, identity, SkString(familyName));
+    SkTypefaceCache::Add(face, (SkTypeface::Style)oldStyle);
+    return face;
+}
+
 class SkFontStyleSet_FC : public SkFontStyleSet {
 public:
     SkFontStyleSet_FC(FcPattern** matches, int count);
@@ -156,10 +194,12 @@ private:
     struct Rec {
         SkString    fStyleName;
         SkString    fFileName;
+        int         fTTCIndex;
         SkFontStyle fStyle;
     };
-    Rec* fRecs;
-    int  fRecCount;
+    SkString fFamilyName;
+    Rec*     fRecs;
+    int      fRecCount;
 };
 
 static int map_range(int value,
@@ -186,9 +226,13 @@ static SkFontStyle make_fontconfig_style(FcPattern* match) {
 SkFontStyleSet_FC::SkFontStyleSet_FC(FcPattern** matches, int count) {
     fRecCount = count;
     fRecs = SkNEW_ARRAY(Rec, count);
+    if (count > 0) {
+        fFamilyName.set(get_name(matches[0], FC_FAMILY));
+    }
     for (int i = 0; i < count; ++i) {
         fRecs[i].fStyleName.set(get_name(matches[i], FC_STYLE));
         fRecs[i].fFileName.set(get_name(matches[i], FC_FILE));
+        fRecs[i].fTTCIndex = SkTMax(get_int(matches[i], FC_INDEX), 0);
         fRecs[i].fStyle = make_fontconfig_style(matches[i]);
     }
 }
@@ -209,46 +253,115 @@ void SkFontStyleSet_FC::getStyle(int index, SkFontStyle* style,
 }
 
 SkTypeface* SkFontStyleSet_FC::createTypeface(int index) {
-    return NULL;
+    SkASSERT((unsigned)index < (unsigned)fRecCount);
+    return create_typeface(fRecs[index].fFileName.c_str(), fRecs[index].fTTCIndex,
+                           fRecs[index].fStyle, fFamilyName.c_str());
 }
 
 SkTypeface* SkFontStyleSet_FC::matchStyle(const SkFontStyle& pattern) {
-    return NULL;
+    if (0 == fRecCount) {
+        return NULL;
+    }
+    int best = 0;
+    int bestDistance = SK_MaxS32;
+    for (int i = 0; i < fRecCount; ++i) {
+        const int distance = SkFontIndex::StyleDistance(pattern, fRecs[i].fStyle);
+        if (distance < bestDistance) {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+    return this->createTypeface(best);
 }
 
+// The faces of a family of the font index.
+class SkFontStyleSet_Index : public SkFontStyleSet {
+public:
+    SkFontStyleSet_Index(SkFontIndex* index, int familyIndex)
+        : fIndex(SkRef(index))
+        , fFamilyIndex(familyIndex) {}
+
+    virtual int count() SK_OVERRIDE { return fIndex->countFaces(fFamilyIndex); }
+
+    virtual void getStyle(int index, SkFontStyle* style, SkString* styleName) SK_OVERRIDE {
+        SkFontIndex::Face face;
+        fIndex->getFace(fFamilyIndex, index, &face);
+        if (style) {
+            *style = face.fStyle;
+        }
+        if (styleName) {
+            styleName->set(face.fStyleName);
+        }
+    }
+
+    virtual SkTypeface* createTypeface(int index) SK_OVERRIDE {
+        SkFontIndex::Face face;
+        fIndex->getFace(fFamilyIndex, index, &face);
+        return create_typeface(face.fPath, face.fTTCIndex, face.fStyle,
+                               fIndex->getFamilyName(fFamilyIndex));
+    }
+
+    virtual SkTypeface* matchStyle(const SkFontStyle& pattern) SK_OVERRIDE {
+        return this->createTypeface(fIndex->matchStyle(fFamilyIndex, pattern));
+    }
+
+private:
+    SkAutoTUnref<SkFontIndex>   fIndex;
+    const int                   fFamilyIndex;
+};
+
+/**
+ *  Answers queries from the font index when there is an up to date one, and
+ *  from fontconfig otherwise. Names the index does not have, such as
+ *  fontconfig's aliases (e.g. "sans-serif"), are passed on to fontconfig.
+ */
 class SkFontMgr_fontconfig : public SkFontMgr {
     SkAutoTUnref<SkFontConfigInterface> fFCI;
+    SkFontIndex* fIndex;
     SkDataTable* fFamilyNames;
 
 
 public:
-    SkFontMgr_fontconfig(SkFontConfigInterface* fci)
+    SkFontMgr_fontconfig(SkFontConfigInterface* fci, SkFontIndex* index)
         : fFCI(fci)
-        , fFamilyNames(fFCI->getFamilyNames()) {}
+        , fIndex(SkSafeRef(index))
+        , fFamilyNames(index ? NULL : fFCI->getFamilyNames()) {}
 
     virtual ~SkFontMgr_fontconfig() {
+        SkSafeUnref(fIndex);
         SkSafeUnref(fFamilyNames);
     }
 
 protected:
     virtual int onCountFamilies() const SK_OVERRIDE {
-        return fFamilyNames->count();
+        return fIndex ? fIndex->countFamilies() : fFamilyNames->count();
     }
 
     virtual void onGetFamilyName(int index, SkString* familyName) const SK_OVERRIDE {
-        familyName->set(fFamilyNames->atStr(index));
+        familyName->set(fIndex ? fIndex->getFamilyName(index) : fFamilyNames->atStr(index));
     }
 
     virtual SkFontStyleSet* onCreateStyleSet(int index) const SK_OVERRIDE {
+        if (fIndex) {
+            return SkNEW_ARGS(SkFontStyleSet_Index, (fIndex, index));
+        }
         return this->onMatchFamily(fFamilyNames->atStr(index));
     }
 
     virtual SkFontStyleSet* onMatchFamily(const char familyName[]) const SK_OVERRIDE {
+        const int familyIndex = fIndex ? fIndex->findFamily(familyName) : -1;
+        if (familyIndex >= 0) {
+            return SkNEW_ARGS(SkFontStyleSet_Index, (fIndex, familyIndex));
+        }
+
         FCLocker lock;
 
         FcPattern* pattern = FcPatternCreate();
 
-        FcPatternAddString(pattern, FC_FAMILY, (FcChar8*)familyName);
+        // Without a name, fontconfig substitutes its default family.
+        if (familyName) {
+            FcPatternAddString(pattern, FC_FAMILY, (FcChar8*)familyName);
+        }
 #if 0
         FcPatternAddBool(pattern, FC_SCALABLE, FcTrue);
 #endif
@@ -289,7 +402,73 @@ protected:
     }
 
     virtual SkTypeface* onMatchFamilyStyle(const char familyName[],
-                                           const SkFontStyle&) const SK_OVERRIDE { return NULL; }
+                                           const SkFontStyle& style) const SK_OVERRIDE {
+        const int familyIndex = fIndex ? fIndex->findFamily(familyName) : -1;
+        if (familyIndex >= 0) {
+            SkFontIndex::Face face;
+            fIndex->getFace(familyIndex, fIndex->matchStyle(familyIndex, style), &face);
+            return create_typeface(face.fPath, face.fTTCIndex, face.fStyle,
+                                   fIndex->getFamilyName(familyIndex));
+        }
+
+        SkAutoTUnref<SkFontStyleSet> sset(this->onMatchFamily(familyName));
+        return sset.get() ? sset->matchStyle(style) : NULL;
+    }
+
+    virtual SkTypeface* onMatchFamilyStyleCharacter(const char familyName[],
+                                                    const SkFontStyle& style,
+                                                    const char bpc47[],
+                                                    uint32_t character) const SK_OVERRIDE {
+        int familyIndex = fIndex ? fIndex->findFamily(familyName) : -1;
+        // Only fontconfig knows the fallbacks of its aliases.
+        if (fIndex && (NULL == familyName || familyIndex >= 0)) {
+            // the requested family if it has the character, else the first one that does, in
+            // fontconfig's order of preference
+            int faceIndex = familyIndex >= 0 ? fIndex->matchStyle(familyIndex, style) : -1;
+            if ((familyIndex < 0 || !fIndex->hasCharacter(familyIndex, faceIndex, character)) &&
+                !fIndex->matchCharacter(character, style, bpc47, &familyIndex, &faceIndex)) {
+                return NULL;
+            }
+            SkFontIndex::Face face;
+            fIndex->getFace(familyIndex, faceIndex, &face);
+            return create_typeface(face.fPath, face.fTTCIndex, face.fStyle,
+                                   fIndex->getFamilyName(familyIndex));
+        }
+
+        FCLocker lock;
+
+        FcPattern* pattern = FcPatternCreate();
+        if (familyName) {
+            FcPatternAddString(pattern, FC_FAMILY, (FcChar8*)familyName);
+        }
+        if (bpc47 && *bpc47) {
+            FcPatternAddString(pattern, FC_LANG, (const FcChar8*)bpc47);
+        }
+        FcCharSet* charset = FcCharSetCreate();
+        FcCharSetAddChar(charset, character);
+        FcPatternAddCharSet(pattern, FC_CHARSET, charset);
+        FcCharSetDestroy(charset);
+        FcConfigSubstitute(NULL, pattern, FcMatchPattern);
+        FcDefaultSubstitute(pattern);
+
+        FcResult result;
+        FcPattern* match = FcFontMatch(NULL, pattern, &result);
+        FcPatternDestroy(pattern);
+        if (NULL == match) {
+            return NULL;
+        }
+
+        SkTypeface* face = NULL;
+        FcCharSet* matchCharset;
+        if (valid_pattern(match) &&
+            FcPatternGetCharSet(match, FC_CHARSET, 0, &matchCharset) == FcResultMatch &&
+            FcCharSetHasChar(matchCharset, character)) {
+            face = create_typeface(get_name(match, FC_FILE), SkTMax(get_int(match, FC_INDEX), 0),
+                                   make_fontconfig_style(match), get_name(match, FC_FAMILY));
+        }
+        FcPatternDestroy(match);
+        return face;
+    }
     virtual SkTypeface* onMatchFaceStyle(const SkTypeface*,
                                          const SkFontStyle&) const SK_OVERRIDE { return NULL; }
 
@@ -328,7 +507,37 @@ protected:
     }
 };
 
+// The path of the font index, if there is one, from the environment or the
+// build.
+static const char* font_index_path() {
+    const char* path = getenv("SK_FONT_INDEX_PATH");
+#ifdef SK_FONT_INDEX_PATH
+    if (NULL == path) {
+        path = SK_FONT_INDEX_PATH;
+    }
+#endif
+    return path;
+}
+
+// Returns the font index, if it is up to date. Otherwise fontconfig answers,
+// until the index is rebuilt by tools/build_font_index.cpp.
+static SkFontIndex* load_font_index() {
+    const char* path = font_index_path();
+    if (NULL == path) {
+        return NULL;
+    }
+    SkAutoTUnref<SkFontIndex> index(SkFontIndex::CreateFromFile(path));
+    if (NULL == index.get() || index->isStale()) {
+        return NULL;
+    }
+    return index.detach();
+}
+
 SkFontMgr* SkFontMgr::Factory() {
     SkFontConfigInterface* fci = RefFCI();
-    return fci ? SkNEW_ARGS(SkFontMgr_fontconfig, (fci)) : NULL;
+    if (NULL == fci) {
+        return NULL;
+    }
+    SkAutoTUnref<SkFontIndex> index(load_font_index());
+    return SkNEW_ARGS(SkFontMgr_fontconfig, (fci, index));
 }
@@ -20,6 +20,7 @@ static int g_UploadCount = 0;
 #endif
 
 GrPlot::GrPlot() : fDrawToken(NULL, 0)
+                 , fGenID(0)
                  , fTexture(NULL)
                  , fRects(NULL)
                  , fAtlasMgr(NULL)
@@ -139,6 +140,7 @@ void GrPlot::uploadToTexture() {
 void GrPlot::resetRects() {
     SkASSERT(NULL != fRects);
     fRects->reset();
+    ++fGenID;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
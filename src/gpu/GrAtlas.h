@@ -42,6 +42,10 @@ public:
 
     void uploadToTexture();
 
+    // Changes whenever the plot's subimages are dropped, so that what was in it can be found to
+    // be gone.
+    uint32_t genID() const { return fGenID; }
+
     void resetRects();
 
 private:
@@ -52,6 +56,7 @@ private:
 
     // for recycling
     GrDrawTarget::DrawToken fDrawToken;
+    uint32_t                fGenID;
 
     unsigned char*          fPlotData;
     GrTexture*              fTexture;
@@ -25,6 +25,7 @@
 #include "SkGlyphCache.h"
 #include "SkGpuDevice.h"
 #include "SkGr.h"
+#include "SkTextBlob.h"
 #include "SkTextMapStateProc.h"
 
 SK_CONF_DECLARE(bool, c_DumpFontCache, "gpu.dumpFontCache", false,
@@ -61,6 +62,8 @@ GrBitmapTextContext::GrBitmapTextContext(GrContext* context,
     fMaxVertices = 0;
 
     fVertexBounds.setLargestInverted();
+
+    fBlob = NULL;
 }
 
 GrBitmapTextContext::~GrBitmapTextContext() {
@@ -419,6 +422,91 @@ void GrBitmapTextContext::drawPosText(const GrPaint& paint, const SkPaint& skPai
     this->finish();
 }
 
+void GrBitmapTextContext::drawTextBlob(const GrPaint& paint, const SkPaint& skPaint,
+                                       const SkTextBlob* blob, SkScalar x, SkScalar y) {
+    // Subpixel glyphs depend on the fraction of their positions, so their quads cannot be
+    // reused at another translation.
+    if (skPaint.isSubpixelText() || fContext->getMatrix().hasPerspective()) {
+        this->INHERITED::drawTextBlob(paint, skPaint, blob, x, y);
+        return;
+    }
+
+    const int count = blob->count();
+    if (0 == count) {
+        return;
+    }
+
+    this->init(paint, skPaint);
+
+    SkAutoGlyphCache    autoCache(fSkPaint, &fDeviceProperties, &fContext->getMatrix());
+    SkGlyphCache*       cache = autoCache.getCache();
+    GrFontScaler*       fontScaler = GetGrFontScaler(cache);
+    GrFontCache*        fontCache = fContext->getFontCache();
+
+    fStrike = fontCache->getStrike(fontScaler, false);
+
+    // store original matrix before we reset, so we can use it to transform positions
+    SkMatrix ctm = fContext->getMatrix();
+    GrContext::AutoMatrix  autoMatrix;
+    autoMatrix.setIdentity(fContext, &fPaint);
+
+    // If the glyphs of the last draw are still in the atlas, their quads are drawn again.
+    GrTextBlobCache* blobCache = fontCache->getBlobCache();
+    GrTextBlobCache::Blob* cached = blobCache->find(blob->uniqueID());
+    SkVector offset;
+    if (NULL != cached && cached->isValid(fStrike->getUniqueID()) &&
+        cached->canDraw(ctm, x, y, fClipRect, &offset)) {
+        const GrTextBlobCache::Quad* quads = cached->quads();
+        const int quadCount = cached->countQuads();
+        for (int i = 0; i < quadCount; ++i) {
+            const GrTextBlobCache::Quad& quad = quads[i];
+            // rounded as below
+            SkFixed fx = SkScalarToFixed(quad.fOrigin.fX + offset.fX) + SK_FixedHalf;
+            SkFixed fy = SkScalarToFixed(quad.fOrigin.fY + offset.fY) + SK_FixedHalf;
+            SkFixed vx = SkFixedFloorToFixed(fx) + SkIntToFixed(quad.fBounds.fLeft);
+            SkFixed vy = SkFixedFloorToFixed(fy) + SkIntToFixed(quad.fBounds.fTop);
+
+            SkRect r;
+            r.fLeft = SkFixedToFloat(vx);
+            r.fTop = SkFixedToFloat(vy);
+            r.fRight = SkFixedToFloat(vx + SkIntToFixed(quad.fBounds.width()));
+            r.fBottom = SkFixedToFloat(vy + SkIntToFixed(quad.fBounds.height()));
+            this->appendQuad(cached->plotAt(quad.fPlotIndex), r, quad.fTexCoords);
+        }
+        this->finish();
+        return;
+    }
+
+    // Otherwise the glyphs are drawn as drawPosText() would, and their quads kept.
+    fBlob = blobCache->findOrCreate(blob->uniqueID());
+    fBlob->reset(fStrike->getUniqueID(), ctm, x, y, fClipRect);
+
+    SkAutoTUnref<SkTextBlob::StrikeGlyphs> strikeGlyphs(blob->refStrikeGlyphs(cache));
+    const SkGlyph* const* glyphs = strikeGlyphs->glyphs();
+    const SkPoint* pos = blob->positions();
+    for (int i = 0; i < count; ++i) {
+        const SkGlyph& glyph = *glyphs[i];
+        if (glyph.fWidth) {
+            SkPoint& loc = fBlobGlyphOrigin;
+            ctm.mapXY(pos[i].fX + x, pos[i].fY + y, &loc);
+
+            SkFixed fx = SkScalarToFixed(loc.fX) + SK_FixedHalf;
+            SkFixed fy = SkScalarToFixed(loc.fY) + SK_FixedHalf;
+            this->drawPackedGlyph(GrGlyph::Pack(glyph.getGlyphID(),
+                                                glyph.getSubXFixed(),
+                                                glyph.getSubYFixed()),
+                                  SkFixedFloorToFixed(fx),
+                                  SkFixedFloorToFixed(fy),
+                                  fontScaler);
+        }
+    }
+
+    blobCache->didGenerate(fBlob);
+    fBlob = NULL;
+
+    this->finish();
+}
+
 void GrBitmapTextContext::drawPackedGlyph(GrGlyph::PackedID packed,
                                           SkFixed vx, SkFixed vy,
                                           GrFontScaler* scaler) {
@@ -448,6 +536,9 @@ void GrBitmapTextContext::drawPackedGlyph(GrGlyph::PackedID packed,
         int y = vy >> 16;
         if (fClipRect.quickReject(x, y, x + width, y + height)) {
 //            SkCLZ(3);    // so we can set a break-point in the debugger
+            if (NULL != fBlob) {
+                fBlob->setClipped();
+            }
             return;
         }
     }
@@ -479,6 +570,11 @@ void GrBitmapTextContext::drawPackedGlyph(GrGlyph::PackedID packed,
             goto HAS_ATLAS;
         }
 
+        // the atlas is full, so this blob's glyphs cannot all be drawn from it
+        if (NULL != fBlob) {
+            fBlob->setIncomplete();
+        }
+
         if (NULL == glyph->fPath) {
             SkPath* path = SkNEW(SkPath);
             if (!scaler->getGlyphPath(glyph->glyphID(), path)) {
@@ -502,8 +598,6 @@ void GrBitmapTextContext::drawPackedGlyph(GrGlyph::PackedID packed,
 
 HAS_ATLAS:
     SkASSERT(glyph->fPlot);
-    GrDrawTarget::DrawToken drawToken = fDrawTarget->getCurrentDrawToken();
-    glyph->fPlot->setDrawToken(drawToken);
 
     // now promote them to fixed (TODO: Rethink using fixed pt).
     width = SkIntToFixed(width);
@@ -512,6 +606,34 @@ HAS_ATLAS:
     GrTexture* texture = glyph->fPlot->texture();
     SkASSERT(texture);
 
+    SkFixed tx = SkIntToFixed(glyph->fAtlasLocation.fX);
+    SkFixed ty = SkIntToFixed(glyph->fAtlasLocation.fY);
+
+    SkRect r;
+    r.fLeft = SkFixedToFloat(vx);
+    r.fTop = SkFixedToFloat(vy);
+    r.fRight = SkFixedToFloat(vx + width);
+    r.fBottom = SkFixedToFloat(vy + height);
+
+    SkRect texCoords;
+    texCoords.fLeft = SkFixedToFloat(texture->normalizeFixedX(tx));
+    texCoords.fTop = SkFixedToFloat(texture->normalizeFixedY(ty));
+    texCoords.fRight = SkFixedToFloat(texture->normalizeFixedX(tx + width));
+    texCoords.fBottom = SkFixedToFloat(texture->normalizeFixedY(ty + height));
+
+    if (NULL != fBlob) {
+        fBlob->addQuad(glyph->fPlot, fBlobGlyphOrigin, glyph->fBounds, texCoords);
+    }
+    this->appendQuad(glyph->fPlot, r, texCoords);
+}
+
+void GrBitmapTextContext::appendQuad(GrPlot* plot, const SkRect& r, const SkRect& texCoords) {
+    GrDrawTarget::DrawToken drawToken = fDrawTarget->getCurrentDrawToken();
+    plot->setDrawToken(drawToken);
+
+    GrTexture* texture = plot->texture();
+    SkASSERT(texture);
+
     if (fCurrTexture != texture || fCurrVertex + 4 > fMaxVertices) {
         this->flushGlyphs();
         fCurrTexture = texture;
@@ -561,15 +683,6 @@ HAS_ATLAS:
         GrAlwaysAssert(success);
     }
 
-    SkFixed tx = SkIntToFixed(glyph->fAtlasLocation.fX);
-    SkFixed ty = SkIntToFixed(glyph->fAtlasLocation.fY);
-
-    SkRect r;
-    r.fLeft = SkFixedToFloat(vx);
-    r.fTop = SkFixedToFloat(vy);
-    r.fRight = SkFixedToFloat(vx + width);
-    r.fBottom = SkFixedToFloat(vy + height);
-
     fVertexBounds.growToInclude(r);
 
     size_t vertSize = useColorVerts ? (2 * sizeof(SkPoint) + sizeof(GrColor)) :
@@ -584,10 +697,8 @@ HAS_ATLAS:
     // The texture coords are last in both the with and without color vertex layouts.
     SkPoint* textureCoords = reinterpret_cast<SkPoint*>(
             reinterpret_cast<intptr_t>(positions) + vertSize  - sizeof(SkPoint));
-    textureCoords->setRectFan(SkFixedToFloat(texture->normalizeFixedX(tx)),
-                              SkFixedToFloat(texture->normalizeFixedY(ty)),
-                              SkFixedToFloat(texture->normalizeFixedX(tx + width)),
-                              SkFixedToFloat(texture->normalizeFixedY(ty + height)),
+    textureCoords->setRectFan(texCoords.fLeft, texCoords.fTop,
+                              texCoords.fRight, texCoords.fBottom,
                               vertSize);
     if (useColorVerts) {
         // color comes after position.
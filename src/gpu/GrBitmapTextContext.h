@@ -9,9 +9,11 @@
 #define GrBitmapTextContext_DEFINED
 
 #include "GrTextContext.h"
+#include "GrTextBlobCache.h"
 
 class GrTextStrike;
 class GrAtlasMgr;
+class GrPlot;
 
 /*
  * This class implements GrTextContext using standard bitmap fonts
@@ -27,6 +29,10 @@ public:
                              const char text[], size_t byteLength,
                              const SkScalar pos[], SkScalar constY,
                              int scalarsPerPosition) SK_OVERRIDE;
+    // Keeps the glyph quads of the blob in the font cache's GrTextBlobCache, and draws them
+    // from there while they are valid.
+    virtual void drawTextBlob(const GrPaint&, const SkPaint&, const SkTextBlob*,
+                              SkScalar x, SkScalar y) SK_OVERRIDE;
 
     virtual bool canDraw(const SkPaint& paint) SK_OVERRIDE;
 
@@ -35,6 +41,7 @@ private:
 
     void init(const GrPaint&, const SkPaint&);
     void drawPackedGlyph(GrGlyph::PackedID, SkFixed left, SkFixed top, GrFontScaler*);
+    void appendQuad(GrPlot*, const SkRect& position, const SkRect& texCoords);
     void flushGlyphs();                 // automatically called by destructor
     void finish();
 
@@ -50,6 +57,10 @@ private:
     GrTexture*              fCurrTexture;
     int                     fCurrVertex;
     SkRect                  fVertexBounds;
+    GrTextBlobCache::Blob*  fBlob;              // the blob whose quads are being generated
+    SkPoint                 fBlobGlyphOrigin;   // and the device origin of its current glyph
+
+    typedef GrTextContext INHERITED;
 };
 
 #endif
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrTextBlobCache.h"
+#include "GrAtlas.h"
+
+GrTextBlobCache::Blob::Blob(uint32_t blobID)
+    : fBlobID(blobID)
+    , fStrikeID(0)
+    , fClipped(false)
+    , fComplete(false) {
+}
+
+bool GrTextBlobCache::Blob::isValid(uint32_t strikeID) const {
+    if (!fComplete || fStrikeID != strikeID) {
+        return false;
+    }
+    for (int i = 0; i < fPlots.count(); ++i) {
+        if (fPlots[i].fPlot->genID() != fPlots[i].fGenID) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GrTextBlobCache::Blob::canDraw(const SkMatrix& matrix, SkScalar x, SkScalar y,
+                                    const SkIRect& clipRect, SkVector* offset) const {
+    if (matrix.getScaleX() != fScaleX || matrix.getSkewX() != fSkewX ||
+        matrix.getSkewY() != fSkewY || matrix.getScaleY() != fScaleY) {
+        return false;
+    }
+    SkPoint origin;
+    matrix.mapXY(x, y, &origin);
+    offset->set(origin.fX - fOrigin.fX, origin.fY - fOrigin.fY);
+    // Glyphs that were clipped out are missing, so they must stay out.
+    return !fClipped || (offset->isZero() && clipRect == fClipRect);
+}
+
+void GrTextBlobCache::Blob::reset(uint32_t strikeID, const SkMatrix& matrix,
+                                  SkScalar x, SkScalar y, const SkIRect& clipRect) {
+    SkASSERT(!matrix.hasPerspective());
+    fStrikeID = strikeID;
+    fScaleX = matrix.getScaleX();
+    fSkewX = matrix.getSkewX();
+    fSkewY = matrix.getSkewY();
+    fScaleY = matrix.getScaleY();
+    matrix.mapXY(x, y, &fOrigin);
+    fClipRect = clipRect;
+    fClipped = false;
+    fComplete = true;
+    fPlots.rewind();
+    fQuads.rewind();
+}
+
+void GrTextBlobCache::Blob::addQuad(GrPlot* plot, const SkPoint& origin,
+                                    const GrIRect16& bounds, const SkRect& texCoords) {
+    // A blob's glyphs are in a few plots at most, and mostly in the last one added.
+    int plotIndex = fPlots.count() - 1;
+    while (plotIndex >= 0 && fPlots[plotIndex].fPlot != plot) {
+        --plotIndex;
+    }
+    if (plotIndex < 0) {
+        plotIndex = fPlots.count();
+        PlotRef* ref = fPlots.append();
+        ref->fPlot = plot;
+        ref->fGenID = plot->genID();
+    }
+
+    Quad* quad = fQuads.append();
+    quad->fOrigin = origin;
+    quad->fBounds = bounds;
+    quad->fTexCoords = texCoords;
+    quad->fPlotIndex = plotIndex;
+}
+
+size_t GrTextBlobCache::Blob::bytesUsed() const {
+    return sizeof(Blob) + fPlots.reserved() * sizeof(PlotRef) + fQuads.reserved() * sizeof(Quad);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+GrTextBlobCache::GrTextBlobCache() : fBytesUsed(0) {
+}
+
+GrTextBlobCache::~GrTextBlobCache() {
+    this->freeAll();
+}
+
+GrTextBlobCache::Blob* GrTextBlobCache::find(uint32_t blobID) {
+    Blob* blob = fHash.find(blobID);
+    if (NULL != blob && fLRU.head() != blob) {
+        fLRU.remove(blob);
+        fLRU.addToHead(blob);
+    }
+    return blob;
+}
+
+GrTextBlobCache::Blob* GrTextBlobCache::findOrCreate(uint32_t blobID) {
+    Blob* blob = this->find(blobID);
+    if (NULL != blob) {
+        // It is counted again once it has been regenerated.
+        fBytesUsed -= blob->bytesUsed();
+        return blob;
+    }
+    blob = SkNEW_ARGS(Blob, (blobID));
+    fHash.add(blob);
+    fLRU.addToHead(blob);
+    return blob;
+}
+
+void GrTextBlobCache::didGenerate(Blob* blob) {
+    fBytesUsed += blob->bytesUsed();
+    if (!blob->isComplete()) {
+        this->remove(blob);
+        return;
+    }
+    while (fBytesUsed > kMaxBytes) {
+        Blob* tail = fLRU.tail();
+        if (tail == blob) {
+            break;
+        }
+        this->remove(tail);
+    }
+}
+
+void GrTextBlobCache::remove(Blob* blob) {
+    fBytesUsed -= blob->bytesUsed();
+    fHash.remove(blob->fBlobID);
+    fLRU.remove(blob);
+    SkDELETE(blob);
+}
+
+void GrTextBlobCache::freeAll() {
+    while (Blob* blob = fLRU.head()) {
+        this->remove(blob);
+    }
+    SkASSERT(0 == fHash.count());
+    SkASSERT(0 == fBytesUsed);
+}
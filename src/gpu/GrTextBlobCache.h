@@ -0,0 +1,141 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrTextBlobCache_DEFINED
+#define GrTextBlobCache_DEFINED
+
+#include "GrRect.h"
+#include "SkMatrix.h"
+#include "SkRect.h"
+#include "SkTDArray.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
+
+class GrPlot;
+
+/**
+ *  The glyph quads of the most recently drawn SkTextBlobs, as GrBitmapTextContext generated them
+ *  the last time each was drawn: the device space origin and bounds of each glyph and its atlas
+ *  texture coordinates. Drawing a blob again with the same strike and a translation of the same
+ *  matrix copies its quads instead of looking up, placing and atlasing each glyph. A blob's quads
+ *  are regenerated when one of the plots its glyphs were in has been evicted from the atlas since.
+ */
+class GrTextBlobCache : SkNoncopyable {
+public:
+    struct Quad {
+        SkPoint     fOrigin;        // in device space, before it is rounded to a pixel
+        GrIRect16   fBounds;        // of the glyph, relative to its rounded origin
+        SkRect      fTexCoords;
+        int         fPlotIndex;     // into the blob's plots
+    };
+
+    class Blob {
+    public:
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Blob);
+
+        static const uint32_t& GetKey(const Blob& blob) { return blob.fBlobID; }
+        static uint32_t Hash(const uint32_t& blobID) { return blobID; }
+
+        /**
+         *  Returns true if the quads were generated with the strike and none of their plots has
+         *  been evicted since.
+         */
+        bool isValid(uint32_t strikeID) const;
+
+        /**
+         *  Returns true if the quads can be drawn with the matrix and origin of the blob, and
+         *  if so, the device space offset of their origins. The linear part of the matrix must be
+         *  the same. The clip is the conservative device space clip, which matters only if some
+         *  of the glyphs were clipped out when the quads were generated.
+         */
+        bool canDraw(const SkMatrix&, SkScalar x, SkScalar y, const SkIRect& clipRect,
+                     SkVector* offset) const;
+
+        const Quad* quads() const { return fQuads.begin(); }
+        int countQuads() const { return fQuads.count(); }
+        GrPlot* plotAt(int index) const { return fPlots[index].fPlot; }
+
+        /**
+         *  Starts generating the quads again, for drawing the blob with the strike, matrix and
+         *  clip.
+         */
+        void reset(uint32_t strikeID, const SkMatrix&, SkScalar x, SkScalar y,
+                   const SkIRect& clipRect);
+
+        void addQuad(GrPlot*, const SkPoint& origin, const GrIRect16& bounds,
+                     const SkRect& texCoords);
+
+        /**
+         *  Records that a glyph was clipped out, so the quads are for this clip only.
+         */
+        void setClipped() { fClipped = true; }
+
+        /**
+         *  Records that a glyph could not be put in the atlas, so the quads are not reusable.
+         */
+        void setIncomplete() { fComplete = false; }
+        bool isComplete() const { return fComplete; }
+
+        size_t bytesUsed() const;
+
+    private:
+        explicit Blob(uint32_t blobID);
+
+        struct PlotRef {
+            GrPlot*     fPlot;
+            uint32_t    fGenID;
+        };
+
+        const uint32_t      fBlobID;
+        uint32_t            fStrikeID;
+        SkScalar            fScaleX, fSkewX, fSkewY, fScaleY;
+        SkPoint             fOrigin;
+        SkIRect             fClipRect;
+        bool                fClipped;
+        bool                fComplete;
+        SkTDArray<PlotRef>  fPlots;
+        SkTDArray<Quad>     fQuads;
+
+        friend class GrTextBlobCache;
+    };
+
+    GrTextBlobCache();
+    ~GrTextBlobCache();
+
+    /**
+     *  Returns the quads of the blob, or NULL if they are not cached.
+     */
+    Blob* find(uint32_t blobID);
+
+    /**
+     *  Returns the (empty) quads of the blob, to be generated. The caller then calls
+     *  didGenerate() with them.
+     */
+    Blob* findOrCreate(uint32_t blobID);
+
+    /**
+     *  Drops the quads of a blob if they are not reusable, and the least recently used blobs'
+     *  if the cache is over budget.
+     */
+    void didGenerate(Blob*);
+
+    void freeAll();
+
+    int count() const { return fHash.count(); }
+
+private:
+    void remove(Blob*);
+
+    // Quads are 36 bytes, so this is enough for several screens of text.
+    static const size_t kMaxBytes = 1 << 20;
+
+    SkTDynamicHash<Blob, uint32_t>  fHash;
+    SkTInternalLList<Blob>          fLRU;       // most recently used first
+    size_t                          fBytesUsed;
+};
+
+#endif
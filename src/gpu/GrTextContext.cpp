@@ -11,6 +11,7 @@
 #include "SkAutoKern.h"
 #include "SkGlyphCache.h"
 #include "SkGr.h"
+#include "SkTextBlob.h"
 
 GrTextContext::GrTextContext(GrContext* context, const SkDeviceProperties& properties) :
                             fContext(context), fDeviceProperties(properties), fDrawTarget(NULL) {
@@ -35,6 +36,18 @@ void GrTextContext::init(const GrPaint& grPaint, const SkPaint& skPaint) {
     fSkPaint = skPaint;
 }
 
+void GrTextContext::drawTextBlob(const GrPaint& paint, const SkPaint& skPaint,
+                                 const SkTextBlob* blob, SkScalar x, SkScalar y) {
+    const int count = blob->count();
+    SkAutoSTMalloc<64, SkPoint> pos(count);
+    const SkPoint* blobPos = blob->positions();
+    for (int i = 0; i < count; ++i) {
+        pos[i].set(blobPos[i].fX + x, blobPos[i].fY + y);
+    }
+    this->drawPosText(paint, skPaint, (const char*)blob->glyphs(), count * sizeof(uint16_t),
+                      &pos[0].fX, 0, 2);
+}
+
 //*** change to output positions?
 void GrTextContext::MeasureText(SkGlyphCache* cache, SkDrawCacheProc glyphCacheProc,
                                 const char text[], size_t byteLength, SkVector* stopVector) {
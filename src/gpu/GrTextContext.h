@@ -17,6 +17,7 @@
 class GrContext;
 class GrDrawTarget;
 class GrFontScaler;
+class SkTextBlob;
 
 /*
  * This class wraps the state for a single text render
@@ -30,6 +31,10 @@ public:
                              const char text[], size_t byteLength,
                              const SkScalar pos[], SkScalar constY,
                              int scalarsPerPosition) = 0;
+    // The paint has the font of the blob applied. By default this draws the blob's glyphs with
+    // drawPosText().
+    virtual void drawTextBlob(const GrPaint&, const SkPaint&, const SkTextBlob*,
+                              SkScalar x, SkScalar y);
 
     virtual bool canDraw(const SkPaint& paint) = 0;
 
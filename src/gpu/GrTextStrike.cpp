@@ -29,7 +29,7 @@
 static int g_PurgeCount = 0;
 #endif
 
-GrFontCache::GrFontCache(GrGpu* gpu) : fGpu(gpu) {
+GrFontCache::GrFontCache(GrGpu* gpu) : fGpu(gpu), fNextStrikeID(1) {
     gpu->ref();
     for (int i = 0; i < kAtlasCount; ++i) {
         fAtlasMgr[i] = NULL;
@@ -90,6 +90,7 @@ GrTextStrike* GrFontCache::generateStrike(GrFontScaler* scaler,
     }
     GrTextStrike* strike = SkNEW_ARGS(GrTextStrike,
                                       (this, scaler->getKey(), format, fAtlasMgr[atlasIndex]));
+    strike->fUniqueID = fNextStrikeID++;
     fCache.insert(key, strike);
 
     if (fHead) {
@@ -106,6 +107,7 @@ GrTextStrike* GrFontCache::generateStrike(GrFontScaler* scaler,
 }
 
 void GrFontCache::freeAll() {
+    fBlobCache.freeAll();
     fCache.deleteAll();
     for (int i = 0; i < kAtlasCount; ++i) {
         delete fAtlasMgr[i];
@@ -230,6 +232,7 @@ GrTextStrike::GrTextStrike(GrFontCache* cache, const GrKey* key,
     fAtlasMgr = atlasMgr;   // no need to ref, it won't go away before we do
 
     fMaskFormat = format;
+    fUniqueID = 0;          // set by the cache
 
 #ifdef SK_DEBUG
 //    GrPrintf(" GrTextStrike %p %d\n", this, gCounter);
@@ -17,6 +17,7 @@
 #include "GrGlyph.h"
 #include "GrDrawTarget.h"
 #include "GrAtlas.h"
+#include "GrTextBlobCache.h"
 
 class GrFontCache;
 class GrGpu;
@@ -35,6 +36,9 @@ public:
     GrFontCache* getFontCache() const { return fFontCache; }
     GrMaskFormat getMaskFormat() const { return fMaskFormat; }
 
+    // Unique among the strikes of the font cache, even those purged.
+    uint32_t getUniqueID() const { return fUniqueID; }
+
     inline GrGlyph* getGlyph(GrGlyph::PackedID, GrFontScaler*);
     bool addGlyphToAtlas(GrGlyph*, GrFontScaler*);
 
@@ -62,6 +66,7 @@ private:
     GrAtlasMgr*     fAtlasMgr;
     GrMaskFormat    fMaskFormat;
     bool            fUseDistanceField;
+    uint32_t        fUniqueID;
 
     GrAtlas         fAtlas;
 
@@ -79,6 +84,9 @@ public:
 
     void freeAll();
 
+    // the glyph quads of recently drawn text blobs, which refer to the strikes and plots here
+    GrTextBlobCache* getBlobCache() { return &fBlobCache; }
+
     // make an unused plot available
     bool freeUnusedPlot(GrTextStrike* preserveStrike);
 
@@ -125,6 +133,9 @@ private:
 
     GrGpu*      fGpu;
     GrAtlasMgr* fAtlasMgr[kAtlasCount];
+    uint32_t    fNextStrikeID;
+
+    GrTextBlobCache fBlobCache;
 
     GrTextStrike* generateStrike(GrFontScaler*, const Key&);
     inline void detachStrikeFromList(GrTextStrike*);
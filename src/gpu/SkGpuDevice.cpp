@@ -1735,6 +1735,30 @@ void SkGpuDevice::drawPosText(const SkDraw& draw, const void* text,
     }
 }
 
+void SkGpuDevice::drawTextBlob(const SkDraw& draw, const SkTextBlob* blob,
+                               SkScalar x, SkScalar y, const SkPaint& paint) {
+    CHECK_SHOULD_DRAW(draw, false);
+
+    if (fMainTextContext->canDraw(paint)) {
+        GrPaint grPaint;
+        SkPaint2GrPaintShader(this->context(), paint, true, &grPaint);
+
+        SkDEBUGCODE(this->validate();)
+
+        fMainTextContext->drawTextBlob(grPaint, paint, blob, x, y);
+    } else if (fFallbackTextContext && fFallbackTextContext->canDraw(paint)) {
+        GrPaint grPaint;
+        SkPaint2GrPaintShader(this->context(), paint, true, &grPaint);
+
+        SkDEBUGCODE(this->validate();)
+
+        fFallbackTextContext->drawTextBlob(grPaint, paint, blob, x, y);
+    } else {
+        // drawPosText() draws them as paths
+        this->SkBaseDevice::drawTextBlob(draw, blob, x, y, paint);
+    }
+}
+
 void SkGpuDevice::drawTextOnPath(const SkDraw& draw, const void* text,
                                 size_t len, const SkPath& path,
                                 const SkMatrix* m, const SkPaint& paint) {
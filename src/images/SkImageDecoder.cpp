@@ -25,8 +25,10 @@ SkImageDecoder::SkImageDecoder()
     , fDitherImage(true)
     , fUsePrefTable(false)
     , fSkipWritingZeroes(false)
+    , fIncrementalDecodeActive(false)
     , fPreferQualityOverSpeed(false)
-    , fRequireUnpremultipliedColors(false) {
+    , fRequireUnpremultipliedColors(false)
+    , fThreadCount(1) {
 }
 
 SkImageDecoder::~SkImageDecoder() {
@@ -56,6 +58,7 @@ void SkImageDecoder::copyFieldsToOther(SkImageDecoder* other) {
     other->setSkipWritingZeroes(fSkipWritingZeroes);
     other->setPreferQualityOverSpeed(fPreferQualityOverSpeed);
     other->setRequireUnpremultipliedColors(fRequireUnpremultipliedColors);
+    other->setThreadCount(fThreadCount);
 }
 
 SkImageDecoder::Format SkImageDecoder::getFormat() const {
@@ -138,6 +141,21 @@ bool SkImageDecoder::allocPixelRef(SkBitmap* bitmap,
     return bitmap->allocPixels(fAllocator, ctable);
 }
 
+bool SkImageDecoder::allocIncrementalPixelRef(SkBitmap* bitmap,
+                                              SkColorTable* ctable) const {
+    if (!this->allocPixelRef(bitmap, ctable)) {
+        return false;
+    }
+    // eraseColor() does not support every colortype (e.g. kIndex_8), so clear
+    // the memory directly.
+    SkAutoLockPixels alp(*bitmap);
+    if (NULL == bitmap->getPixels()) {
+        return false;
+    }
+    memset(bitmap->getPixels(), 0, bitmap->getSize());
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkImageDecoder::setPrefConfigTable(const PrefConfigTable& prefTable) {
@@ -197,6 +215,39 @@ bool SkImageDecoder::decodeSubset(SkBitmap* bm, const SkIRect& rect, SkColorType
     return this->onDecodeSubset(bm, rect);
 }
 
+bool SkImageDecoder::startIncrementalDecode(SkBitmap* bm, SkColorType pref) {
+    SkASSERT(bm);
+    // we reset this to false before calling onStartIncrementalDecode
+    fShouldCancelDecode = false;
+    // assign this, for use by getPrefColorType(), in case fUsePrefTable is false
+    fDefaultPref = pref;
+
+    bm->reset();
+    fIncrementalDecodeActive = this->onStartIncrementalDecode(bm);
+    return fIncrementalDecodeActive;
+}
+
+SkImageDecoder::IncrementalResult SkImageDecoder::appendData(const void* data, size_t length,
+                                                             int* startRow, int* endRow) {
+    int start = 0;
+    int end = 0;
+    IncrementalResult result = kFailure_IncrementalResult;
+    if (fIncrementalDecodeActive) {
+        result = this->onAppendData(data, length, &start, &end);
+        if (kPartial_IncrementalResult != result) {
+            fIncrementalDecodeActive = false;
+        }
+    }
+    SkASSERT(start <= end);
+    if (startRow) {
+        *startRow = start;
+    }
+    if (endRow) {
+        *endRow = end;
+    }
+    return result;
+}
+
 bool SkImageDecoder::buildTileIndex(SkStreamRewindable* stream, int *width, int *height) {
     // we reset this to false before calling onBuildTileIndex
     fShouldCancelDecode = false;
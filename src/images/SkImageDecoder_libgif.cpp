@@ -12,6 +12,7 @@
 #include "SkRTConf.h"
 #include "SkScaledBitmapSampler.h"
 #include "SkStream.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
 
@@ -23,10 +24,24 @@ public:
         return kGIF_Format;
     }
 
+    SkGIFImageDecoder()
+        : fIncrementalBitmap(NULL)
+        , fLastDecodeSize(0) {}
+
 protected:
     virtual bool onDecode(SkStream* stream, SkBitmap* bm, Mode mode) SK_OVERRIDE;
+    virtual bool onStartIncrementalDecode(SkBitmap* bitmap) SK_OVERRIDE;
+    virtual IncrementalResult onAppendData(const void* data, size_t length,
+                                           int* startRow, int* endRow) SK_OVERRIDE;
 
 private:
+    // giflib cannot suspend a decode when it runs out of data, so an
+    // incremental decode buffers the data and decodes all of it again each
+    // time enough new data has arrived.
+    SkBitmap*           fIncrementalBitmap;
+    SkTDArray<uint8_t>  fIncrementalData;
+    size_t              fLastDecodeSize;
+
     typedef SkImageDecoder INHERITED;
 };
 
@@ -505,6 +520,103 @@ bool SkGIFImageDecoder::onDecode(SkStream* sk_stream, SkBitmap* bm, Mode mode) {
     return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+/**
+ *  Memory stream that remembers whether a read asked for more data than it
+ *  had, which tells us that a failed (or partial) decode ran out of data
+ *  rather than finding an error in it.
+ */
+class GifIncrementalStream : public SkMemoryStream {
+public:
+    GifIncrementalStream(const void* data, size_t length)
+        : INHERITED(data, length, false)
+        , fRanOutOfData(false) {}
+
+    virtual size_t read(void* buffer, size_t size) SK_OVERRIDE {
+        size_t bytesRead = this->INHERITED::read(buffer, size);
+        if (bytesRead < size) {
+            fRanOutOfData = true;
+        }
+        return bytesRead;
+    }
+
+    bool ranOutOfData() const { return fRanOutOfData; }
+
+private:
+    bool fRanOutOfData;
+
+    typedef SkMemoryStream INHERITED;
+};
+}
+
+// The byte that ends a GIF stream.
+static const uint8_t kGIFTrailer = 0x3B;
+
+bool SkGIFImageDecoder::onStartIncrementalDecode(SkBitmap* bm) {
+    fIncrementalBitmap = bm;
+    fIncrementalData.reset();
+    fLastDecodeSize = 0;
+    return true;
+}
+
+SkImageDecoder::IncrementalResult SkGIFImageDecoder::onAppendData(const void* data,
+                                                                  size_t length,
+                                                                  int* startRow,
+                                                                  int* endRow) {
+    fIncrementalData.append(SkToInt(length), (const uint8_t*)data);
+    const size_t size = fIncrementalData.count();
+
+    // Decoding again is only worth it once the data has grown by a reasonable
+    // fraction, which keeps the total work linear in the size of the image.
+    // The trailer is (very likely) the end of the data, so don't wait then.
+    const bool sawTrailer = size > 0 && kGIFTrailer == fIncrementalData[size - 1];
+    if (!sawTrailer && size - fLastDecodeSize < SkTMax<size_t>(fLastDecodeSize >> 3, 1)) {
+        return kPartial_IncrementalResult;
+    }
+    fLastDecodeSize = size;
+
+    GifIncrementalStream stream(fIncrementalData.begin(), size);
+    SkBitmap decoded;
+    if (!this->onDecode(&stream, &decoded, kDecodePixels_Mode)) {
+        if (stream.ranOutOfData() && fIncrementalBitmap->isNull()) {
+            // Still waiting for the header.
+            return kPartial_IncrementalResult;
+        }
+        fIncrementalData.reset();
+        return kFailure_IncrementalResult;
+    }
+
+    SkBitmap* bm = fIncrementalBitmap;
+    if (bm->isNull()) {
+        *bm = decoded;
+    } else {
+        if (bm->info() != decoded.info()) {
+            // A truncated image should not change its header.
+            fIncrementalData.reset();
+            return kFailure_IncrementalResult;
+        }
+        SkAutoLockPixels alp(*bm);
+        SkAutoLockPixels alpDecoded(decoded);
+        if (NULL == bm->getPixels() || NULL == decoded.getPixels()) {
+            fIncrementalData.reset();
+            return kFailure_IncrementalResult;
+        }
+        memcpy(bm->getPixels(), decoded.getPixels(), bm->getSize());
+        bm->notifyPixelsChanged();
+    }
+    // Without knowing how far the decode got, report every row.
+    JoinRowRange(0, startRow, endRow);
+    JoinRowRange(bm->height() - 1, startRow, endRow);
+
+    if (stream.ranOutOfData()) {
+        return kPartial_IncrementalResult;
+    }
+    fIncrementalData.reset();
+    return kComplete_IncrementalResult;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 DEFINE_DECODER_CREATOR(GIFImageDecoder);
 ///////////////////////////////////////////////////////////////////////////////
@@ -13,7 +13,9 @@
 #include "SkDither.h"
 #include "SkScaledBitmapSampler.h"
 #include "SkStream.h"
+#include "SkStreamHelpers.h"
 #include "SkTemplates.h"
+#include "SkThreadPool.h"
 #include "SkTime.h"
 #include "SkUtils.h"
 #include "SkRTConf.h"
@@ -80,7 +82,7 @@ static void do_nothing_output_message(j_common_ptr) {
     /* do nothing */
 }
 
-static void initialize_info(jpeg_decompress_struct* cinfo, skjpeg_source_mgr* src_mgr) {
+static void initialize_info(jpeg_decompress_struct* cinfo, jpeg_source_mgr* src_mgr) {
     SkASSERT(cinfo != NULL);
     SkASSERT(src_mgr != NULL);
     jpeg_create_decompress(cinfo);
@@ -215,6 +217,60 @@ private:
 };
 #endif
 
+/**
+ *  State for an incremental decode, where the data is pushed to us through
+ *  appendData() rather than read from a stream. libjpeg suspends whenever it
+ *  runs out of data, and fState records where to resume. Progressive images
+ *  are decoded in buffered-image mode, so that each completed scan produces
+ *  an output pass over the whole bitmap.
+ */
+class SkJPEGIncrementalState {
+public:
+    enum State {
+        kReadHeader_State,
+        kStartDecompress_State,
+        kStartOutputPass_State,     // buffered-image mode only
+        kReadScanlines_State,
+        kFinishOutputPass_State,    // buffered-image mode only
+        kFinishDecompress_State,
+    };
+
+    SkJPEGIncrementalState(SkBitmap* bitmap)
+        : fBitmap(bitmap)
+        , fState(kReadHeader_State)
+        , fLastCompletedScan(0)
+        , fColorType(kUnknown_SkColorType)
+        , fPixelsLocked(false) {
+        // jpeg_destroy_decompress is a no-op on a zeroed struct.
+        sk_bzero(&fCInfo, sizeof(fCInfo));
+    }
+
+    ~SkJPEGIncrementalState() {
+        // Safe to call even if skjpeg_error_exit already destroyed fCInfo.
+        jpeg_destroy_decompress(&fCInfo);
+        if (fPixelsLocked) {
+            fBitmap->unlockPixels();
+        }
+    }
+
+    void lockPixels() {
+        SkASSERT(!fPixelsLocked);
+        fBitmap->lockPixels();
+        fPixelsLocked = true;
+    }
+
+    jpeg_decompress_struct                  fCInfo;
+    skjpeg_error_mgr                        fErrorManager;
+    skjpeg_incremental_source_mgr           fSrcMgr;
+    SkBitmap*                               fBitmap;
+    SkAutoTDelete<SkScaledBitmapSampler>    fSampler;
+    SkAutoMalloc                            fSrcRow;
+    State                                   fState;
+    int                                     fLastCompletedScan;
+    SkColorType                             fColorType;
+    bool                                    fPixelsLocked;
+};
+
 class SkJPEGImageDecoder : public SkImageDecoder {
 public:
 #ifdef SK_BUILD_FOR_ANDROID
@@ -239,6 +295,9 @@ protected:
     virtual bool onDecodeSubset(SkBitmap* bitmap, const SkIRect& rect) SK_OVERRIDE;
 #endif
     virtual bool onDecode(SkStream* stream, SkBitmap* bm, Mode) SK_OVERRIDE;
+    virtual bool onStartIncrementalDecode(SkBitmap* bitmap) SK_OVERRIDE;
+    virtual IncrementalResult onAppendData(const void* data, size_t length,
+                                           int* startRow, int* endRow) SK_OVERRIDE;
 
 private:
 #ifdef SK_BUILD_FOR_ANDROID
@@ -246,6 +305,35 @@ private:
     int fImageWidth;
     int fImageHeight;
 #endif
+    SkAutoTDelete<SkJPEGIncrementalState> fIncrementalState;
+
+    enum BandResult {
+        kSuccess_BandResult,
+        kCancelled_BandResult,
+        kUnsupported_BandResult,
+    };
+
+    /**
+     *  Decode a baseline JPEG that has restart markers at the end of MCU rows
+     *  by splitting it into bands of restart intervals, and decoding (and
+     *  sampling) the bands concurrently on a thread pool.
+     *
+     *  cinfo holds the same data, and has been set up and started by
+     *  onDecode(). If any band cannot be decoded, kUnsupported_BandResult is
+     *  returned, and the caller should decode serially with cinfo, which
+     *  overwrites every row of bm.
+     */
+    BandResult decodeInBands(const uint8_t* data, size_t size,
+                             const jpeg_decompress_struct& cinfo, SkBitmap* bm,
+                             int sampleSize, SkScaledBitmapSampler::SrcConfig sc,
+                             int srcBytesPerPixel, int threadCount);
+
+    /**
+     *  Steps of an incremental decode that run once enough data has arrived.
+     *  Each returns false if the image cannot be decoded.
+     */
+    bool setupIncrementalDecompress(SkJPEGIncrementalState*);
+    bool allocIncrementalBitmap(SkJPEGIncrementalState*);
 
     /**
      *  Determine the appropriate bitmap colortype and out_color_space based on
@@ -536,6 +624,24 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
 
     JPEGAutoClean autoClean;
 
+    // Splitting the decode into bands requires all of the data up front.
+    int threadCount = this->getThreadCount();
+    if (threadCount < 0) {
+        threadCount = num_cores();
+    }
+    SkAutoMalloc encodedStorage;
+    size_t encodedSize = 0;
+    SkAutoTUnref<SkMemoryStream> encodedStream;
+    if (threadCount > 1 && SkImageDecoder::kDecodePixels_Mode == mode) {
+        encodedSize = CopyStreamToStorage(&encodedStorage, stream);
+        if (0 == encodedSize) {
+            return false;
+        }
+        encodedStream.reset(SkNEW_ARGS(SkMemoryStream,
+                                       (encodedStorage.get(), encodedSize, false)));
+        stream = encodedStream.get();
+    }
+
     jpeg_decompress_struct  cinfo;
     skjpeg_source_mgr       srcManager(stream, this);
 
@@ -636,6 +742,24 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
 
     SkAutoLockPixels alp(*bm);
 
+    if (encodedSize > 0) {
+        SkScaledBitmapSampler::SrcConfig bandConfig;
+        int bandBytesPerPixel;
+        if (get_src_config(cinfo, &bandConfig, &bandBytesPerPixel)) {
+            switch (this->decodeInBands((const uint8_t*)encodedStorage.get(), encodedSize,
+                                        cinfo, bm, sampleSize, bandConfig, bandBytesPerPixel,
+                                        threadCount)) {
+                case kSuccess_BandResult:
+                    return true;
+                case kCancelled_BandResult:
+                    return return_false(cinfo, *bm, "shouldCancelDecode");
+                case kUnsupported_BandResult:
+                    // Decode serially below.
+                    break;
+            }
+        }
+    }
+
 #ifdef ANDROID_RGB
     /* short-circuit the SkScaledBitmapSampler when possible, as this gives
        a significant performance boost.
@@ -726,6 +850,519 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
     return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ *  Where the restart markers split the entropy-coded data of a single-scan
+ *  JPEG. Restart interval i runs from the end of marker i - 1 (or fScanStart)
+ *  to marker i (or fScanEnd).
+ */
+struct SkJPEGRestartLayout {
+    size_t              fSOFOffset;     // offset of the SOF0/SOF1 marker
+    size_t              fScanStart;     // first byte of entropy-coded data
+    size_t              fScanEnd;       // offset of the EOI marker
+    SkTDArray<size_t>   fMarkers;       // offset of each RSTn marker
+};
+
+static inline unsigned read_u16(const uint8_t* p) {
+    return (p[0] << 8) | p[1];
+}
+
+/**
+ *  Find the restart markers in a baseline or extended sequential JPEG with
+ *  a single (interleaved) scan. Returns false for any other layout, or if the
+ *  data is truncated.
+ */
+static bool find_restart_markers(const uint8_t* data, size_t size,
+                                 SkJPEGRestartLayout* layout) {
+    if (size < 4 || 0xFF != data[0] || 0xD8 != data[1]) {
+        return false;
+    }
+    bool foundSOF = false;
+    size_t offset = 2;
+    for (;;) {
+        // Every marker segment before the scan has a length.
+        if (offset + 4 > size || 0xFF != data[offset]) {
+            return false;
+        }
+        const uint8_t marker = data[offset + 1];
+        if (0xFF == marker) {
+            // Fill byte.
+            offset += 1;
+            continue;
+        }
+        const size_t length = read_u16(data + offset + 2);
+        if (length < 2 || offset + 2 + length > size) {
+            return false;
+        }
+        if (0xC0 == marker || 0xC1 == marker) {
+            if (length < 8) {
+                return false;
+            }
+            layout->fSOFOffset = offset;
+            foundSOF = true;
+        } else if (marker >= 0xC2 && marker <= 0xCF &&
+                   0xC4 != marker && 0xC8 != marker && 0xCC != marker) {
+            // Progressive, lossless or arithmetic coded.
+            return false;
+        } else if (0xDA == marker) {
+            if (!foundSOF) {
+                return false;
+            }
+            // Every component must be in this scan, or there are more scans.
+            const uint8_t frameComponents = data[layout->fSOFOffset + 9];
+            if (data[offset + 4] != frameComponents) {
+                return false;
+            }
+            offset += 2 + length;
+            break;
+        }
+        offset += 2 + length;
+    }
+
+    layout->fScanStart = offset;
+    layout->fMarkers.rewind();
+    while (offset + 1 < size) {
+        const uint8_t* ff = (const uint8_t*)memchr(data + offset, 0xFF, size - 1 - offset);
+        if (NULL == ff) {
+            return false;
+        }
+        offset = ff - data;
+        const uint8_t next = data[offset + 1];
+        if (0x00 == next) {
+            // A stuffed 0xFF data byte.
+            offset += 2;
+        } else if (0xFF == next) {
+            // Fill byte.
+            offset += 1;
+        } else if (next >= 0xD0 && next <= 0xD7) {
+            *layout->fMarkers.append() = offset;
+            offset += 2;
+        } else if (0xD9 == next) {
+            layout->fScanEnd = offset;
+            return true;
+        } else {
+            // DNL, or the start of another scan.
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ *  The divisor libjpeg applied to the image dimensions for its DCT scaling,
+ *  or 0 if it is not a simple reduction.
+ */
+static int output_divisor(const jpeg_decompress_struct& cinfo) {
+    for (int d = 1; d <= DCTSIZE; d <<= 1) {
+        if (SkToU32((cinfo.image_width + d - 1) / d) == cinfo.output_width &&
+                SkToU32((cinfo.image_height + d - 1) / d) == cinfo.output_height) {
+            return d;
+        }
+    }
+    return 0;
+}
+
+namespace {
+// State shared by the bands of one decodeInBands() call.
+struct JPEGBandContext {
+    const uint8_t*                      fData;
+    const SkJPEGRestartLayout*          fLayout;
+    const jpeg_decompress_struct*       fCInfo;
+    const SkImageDecoder*               fDecoder;
+    SkBitmap*                           fBitmap;
+    int                                 fSampleSize;
+    SkScaledBitmapSampler::SrcConfig    fSrcConfig;
+    int                                 fSrcBytesPerPixel;
+    int                                 fDivisor;
+    int                                 fIntervalPixelRows;
+};
+}
+
+SkJPEGImageDecoder::BandResult SkJPEGImageDecoder::decodeInBands(
+        const uint8_t* data, size_t size, const jpeg_decompress_struct& cinfo, SkBitmap* bm,
+        int sampleSize, SkScaledBitmapSampler::SrcConfig sc, int srcBytesPerPixel,
+        int threadCount) {
+    if (cinfo.progressive_mode || cinfo.buffered_image || 0 == cinfo.restart_interval ||
+            cinfo.comps_in_scan != cinfo.num_components) {
+        return kUnsupported_BandResult;
+    }
+    // Each restart interval must hold whole MCU rows, so that a band of
+    // intervals covers whole rows of the image.
+    if (0 != cinfo.restart_interval % cinfo.MCUs_per_row) {
+        return kUnsupported_BandResult;
+    }
+    const int divisor = output_divisor(cinfo);
+    if (0 == divisor) {
+        return kUnsupported_BandResult;
+    }
+
+    SkJPEGRestartLayout layout;
+    if (!find_restart_markers(data, size, &layout)) {
+        return kUnsupported_BandResult;
+    }
+    const int mcuPixelRows = cinfo.max_v_samp_factor * DCTSIZE;
+    const int intervalPixelRows = mcuPixelRows * (cinfo.restart_interval / cinfo.MCUs_per_row);
+    const int intervalCount = layout.fMarkers.count() + 1;
+    if (intervalCount != SkToInt((cinfo.image_height + intervalPixelRows - 1) /
+                                 intervalPixelRows)) {
+        return kUnsupported_BandResult;
+    }
+    const int bandCount = SkMin32(threadCount, intervalCount);
+    if (bandCount < 2) {
+        return kUnsupported_BandResult;
+    }
+
+    JPEGBandContext context;
+    context.fData = data;
+    context.fLayout = &layout;
+    context.fCInfo = &cinfo;
+    context.fDecoder = this;
+    context.fBitmap = bm;
+    context.fSampleSize = sampleSize;
+    context.fSrcConfig = sc;
+    context.fSrcBytesPerPixel = srcBytesPerPixel;
+    context.fDivisor = divisor;
+    context.fIntervalPixelRows = intervalPixelRows;
+
+    // Decodes restart intervals [fFirstInterval, fEndInterval) as a JPEG of
+    // their own: the original headers with the height patched to that of
+    // the band, followed by the intervals' data (with the restart markers
+    // renumbered to start from RST0) and an EOI marker.
+    class BandProc : public SkRunnable {
+    public:
+        BandProc() : fContext(NULL), fFirstInterval(0), fEndInterval(0),
+                     fResult(kUnsupported_BandResult) {}
+
+        virtual void run() SK_OVERRIDE {
+            fResult = this->decode();
+        }
+
+        BandResult decode() {
+            const JPEGBandContext& ctx = *fContext;
+            const SkJPEGRestartLayout& layout = *ctx.fLayout;
+            const jpeg_decompress_struct& mainInfo = *ctx.fCInfo;
+            const int intervalCount = layout.fMarkers.count() + 1;
+
+            const int firstPixelRow = fFirstInterval * ctx.fIntervalPixelRows;
+            const int endPixelRow = SkMin32(fEndInterval * ctx.fIntervalPixelRows,
+                                            mainInfo.image_height);
+            const size_t start = 0 == fFirstInterval ? layout.fScanStart :
+                                 layout.fMarkers[fFirstInterval - 1] + 2;
+            const size_t end = intervalCount == fEndInterval ? layout.fScanEnd :
+                               layout.fMarkers[fEndInterval - 1];
+
+            const size_t headerSize = layout.fScanStart;
+            const size_t bandSize = headerSize + (end - start) + 2;
+            SkAutoMalloc bandStorage(bandSize);
+            uint8_t* band = (uint8_t*)bandStorage.get();
+            memcpy(band, ctx.fData, headerSize);
+            memcpy(band + headerSize, ctx.fData + start, end - start);
+            band[bandSize - 2] = 0xFF;
+            band[bandSize - 1] = 0xD9;
+
+            const int bandHeight = endPixelRow - firstPixelRow;
+            band[layout.fSOFOffset + 5] = (uint8_t)(bandHeight >> 8);
+            band[layout.fSOFOffset + 6] = (uint8_t)bandHeight;
+            for (int i = fFirstInterval; i < fEndInterval - 1; ++i) {
+                band[headerSize + layout.fMarkers[i] - start + 1] =
+                        0xD0 + ((i - fFirstInterval) & 7);
+            }
+
+            SkMemoryStream stream(band, bandSize, false);
+            JPEGAutoClean autoClean;
+            jpeg_decompress_struct cinfo;
+            skjpeg_source_mgr srcManager(&stream, NULL);
+            skjpeg_error_mgr errorManager;
+            set_error_mgr(&cinfo, &errorManager);
+            SkAutoMalloc srcStorage(mainInfo.output_width * ctx.fSrcBytesPerPixel);
+
+            if (setjmp(errorManager.fJmpBuf)) {
+                return kUnsupported_BandResult;
+            }
+
+            initialize_info(&cinfo, &srcManager);
+            autoClean.set(&cinfo);
+            if (JPEG_HEADER_OK != jpeg_read_header(&cinfo, true)) {
+                return kUnsupported_BandResult;
+            }
+
+            // Match the settings of the main decode.
+            cinfo.scale_num = mainInfo.scale_num;
+            cinfo.scale_denom = mainInfo.scale_denom;
+            cinfo.dct_method = mainInfo.dct_method;
+            cinfo.do_fancy_upsampling = mainInfo.do_fancy_upsampling;
+            cinfo.do_block_smoothing = mainInfo.do_block_smoothing;
+            cinfo.out_color_space = mainInfo.out_color_space;
+            cinfo.dither_mode = mainInfo.dither_mode;
+
+            if (!jpeg_start_decompress(&cinfo)) {
+                return kUnsupported_BandResult;
+            }
+            const int firstRow = firstPixelRow / ctx.fDivisor;
+            if (cinfo.output_width != mainInfo.output_width ||
+                    SkToInt(cinfo.output_height) !=
+                        (bandHeight + ctx.fDivisor - 1) / ctx.fDivisor) {
+                return kUnsupported_BandResult;
+            }
+
+            SkScaledBitmapSampler sampler(mainInfo.output_width, mainInfo.output_height,
+                                          ctx.fSampleSize);
+            if (!sampler.begin(ctx.fBitmap, ctx.fSrcConfig, *ctx.fDecoder)) {
+                return kUnsupported_BandResult;
+            }
+
+            uint8_t* srcRow = (uint8_t*)srcStorage.get();
+            while (cinfo.output_scanline < cinfo.output_height) {
+                const int srcY = firstRow + cinfo.output_scanline;
+                JSAMPLE* rowptr = (JSAMPLE*)srcRow;
+                if (0 == jpeg_read_scanlines(&cinfo, &rowptr, 1)) {
+                    return kUnsupported_BandResult;
+                }
+                if (static_cast<const SkJPEGImageDecoder*>(ctx.fDecoder)->shouldCancelDecode()) {
+                    return kCancelled_BandResult;
+                }
+                if (sampler.srcYToDstY(srcY) < 0) {
+                    continue;
+                }
+                if (JCS_CMYK == cinfo.out_color_space) {
+                    convert_CMYK_to_RGB(srcRow, cinfo.output_width);
+                }
+                sampler.sampleInterlaced(srcRow, srcY);
+            }
+            jpeg_finish_decompress(&cinfo);
+            return kSuccess_BandResult;
+        }
+
+        const JPEGBandContext*  fContext;
+        int                     fFirstInterval;
+        int                     fEndInterval;
+        BandResult              fResult;
+    };
+
+    SkAutoTArray<BandProc> bands(bandCount);
+    {
+        SkThreadPool pool(bandCount);
+        for (int i = 0; i < bandCount; ++i) {
+            bands[i].fContext = &context;
+            bands[i].fFirstInterval = i * intervalCount / bandCount;
+            bands[i].fEndInterval = (i + 1) * intervalCount / bandCount;
+            pool.add(&bands[i]);
+        }
+        pool.wait();
+    }
+
+    BandResult result = kSuccess_BandResult;
+    for (int i = 0; i < bandCount; ++i) {
+        if (kCancelled_BandResult == bands[i].fResult) {
+            return kCancelled_BandResult;
+        }
+        if (kSuccess_BandResult != bands[i].fResult) {
+            result = kUnsupported_BandResult;
+        }
+    }
+    return result;
+}
+
+bool SkJPEGImageDecoder::onStartIncrementalDecode(SkBitmap* bm) {
+    SkAutoTDelete<SkJPEGIncrementalState> state(SkNEW_ARGS(SkJPEGIncrementalState, (bm)));
+    jpeg_decompress_struct* cinfo = &state->fCInfo;
+    set_error_mgr(cinfo, &state->fErrorManager);
+
+    if (setjmp(state->fErrorManager.fJmpBuf)) {
+        return false;
+    }
+
+    initialize_info(cinfo, &state->fSrcMgr);
+    fIncrementalState.reset(state.detach());
+    return true;
+}
+
+bool SkJPEGImageDecoder::setupIncrementalDecompress(SkJPEGIncrementalState* state) {
+    jpeg_decompress_struct* cinfo = &state->fCInfo;
+
+    set_dct_method(*this, cinfo);
+
+    SkASSERT(1 == cinfo->scale_num);
+    cinfo->scale_denom = this->getSampleSize();
+
+    turn_off_visual_optimizations(cinfo);
+
+    state->fColorType = this->getBitmapColorType(cinfo);
+    adjust_out_color_space_and_dither(cinfo, state->fColorType, *this);
+
+    // Decode each scan of a progressive image as it arrives, rather than
+    // waiting for the final one.
+    cinfo->buffered_image = jpeg_has_multiple_scans(cinfo);
+    return true;
+}
+
+bool SkJPEGImageDecoder::allocIncrementalBitmap(SkJPEGIncrementalState* state) {
+    jpeg_decompress_struct* cinfo = &state->fCInfo;
+    const int sampleSize = recompute_sampleSize(this->getSampleSize(), *cinfo);
+
+#ifdef SK_SUPPORT_LEGACY_IMAGEDECODER_CHOOSER
+    if (!this->chooseFromOneChoice(state->fColorType, cinfo->output_width,
+                                   cinfo->output_height)) {
+        return false;
+    }
+#endif
+
+    SkScaledBitmapSampler::SrcConfig sc;
+    int srcBytesPerPixel;
+    if (!get_src_config(*cinfo, &sc, &srcBytesPerPixel)) {
+        return false;
+    }
+
+    state->fSampler.reset(SkNEW_ARGS(SkScaledBitmapSampler,
+                                     (cinfo->output_width, cinfo->output_height, sampleSize)));
+    SkScaledBitmapSampler* sampler = state->fSampler.get();
+
+    // See onDecode for why A8 is not marked opaque.
+    const SkAlphaType alphaType = kAlpha_8_SkColorType == state->fColorType ?
+                                      kPremul_SkAlphaType : kOpaque_SkAlphaType;
+    SkBitmap* bm = state->fBitmap;
+    bm->setInfo(SkImageInfo::Make(sampler->scaledWidth(), sampler->scaledHeight(),
+                                  state->fColorType, alphaType));
+    if (!this->allocIncrementalPixelRef(bm, NULL)) {
+        return false;
+    }
+
+    // The pixels stay locked until the decode is finished, since the sampler
+    // holds on to their address.
+    state->lockPixels();
+    if (!sampler->begin(bm, sc, *this)) {
+        return false;
+    }
+    state->fSrcRow.reset(cinfo->output_width * srcBytesPerPixel);
+    return true;
+}
+
+SkImageDecoder::IncrementalResult SkJPEGImageDecoder::onAppendData(const void* data,
+                                                                   size_t length,
+                                                                   int* startRow,
+                                                                   int* endRow) {
+    SkJPEGIncrementalState* state = fIncrementalState.get();
+    if (NULL == state) {
+        return kFailure_IncrementalResult;
+    }
+    jpeg_decompress_struct* cinfo = &state->fCInfo;
+    SkBitmap* bm = state->fBitmap;
+
+    state->fSrcMgr.append(data, length);
+
+    if (setjmp(state->fErrorManager.fJmpBuf)) {
+        return_false(*cinfo, *bm, "setjmp");
+        fIncrementalState.free();
+        return kFailure_IncrementalResult;
+    }
+
+    // Each case either advances fState, or returns because libjpeg suspended
+    // waiting for data (in which case we pick up at the same state next time).
+    for (;;) {
+        switch (state->fState) {
+            case SkJPEGIncrementalState::kReadHeader_State:
+                if (JPEG_SUSPENDED == jpeg_read_header(cinfo, true)) {
+                    return kPartial_IncrementalResult;
+                }
+                if (!this->setupIncrementalDecompress(state)) {
+                    break;
+                }
+                state->fState = SkJPEGIncrementalState::kStartDecompress_State;
+                continue;
+
+            case SkJPEGIncrementalState::kStartDecompress_State:
+                if (!jpeg_start_decompress(cinfo)) {
+                    return kPartial_IncrementalResult;
+                }
+                if (!this->allocIncrementalBitmap(state)) {
+                    break;
+                }
+                state->fState = cinfo->buffered_image ?
+                                    SkJPEGIncrementalState::kStartOutputPass_State :
+                                    SkJPEGIncrementalState::kReadScanlines_State;
+                continue;
+
+            case SkJPEGIncrementalState::kStartOutputPass_State: {
+                // Absorb all of the data we have, remembering the last scan
+                // that was completely read.
+                int status;
+                do {
+                    status = jpeg_consume_input(cinfo);
+                    if (JPEG_SCAN_COMPLETED == status) {
+                        state->fLastCompletedScan = cinfo->input_scan_number;
+                    }
+                } while (JPEG_SUSPENDED != status && JPEG_REACHED_EOI != status);
+
+                int scan;
+                if (jpeg_input_complete(cinfo)) {
+                    scan = cinfo->input_scan_number;
+                } else if (state->fLastCompletedScan > cinfo->output_scan_number) {
+                    scan = state->fLastCompletedScan;
+                } else {
+                    // Nothing new to show yet.
+                    return kPartial_IncrementalResult;
+                }
+                if (!jpeg_start_output(cinfo, scan)) {
+                    return kPartial_IncrementalResult;
+                }
+                state->fState = SkJPEGIncrementalState::kReadScanlines_State;
+                continue;
+            }
+
+            case SkJPEGIncrementalState::kReadScanlines_State: {
+                uint8_t* srcRow = (uint8_t*)state->fSrcRow.get();
+                while (cinfo->output_scanline < cinfo->output_height) {
+                    const int srcY = cinfo->output_scanline;
+                    JSAMPLE* rowptr = (JSAMPLE*)srcRow;
+                    if (0 == jpeg_read_scanlines(cinfo, &rowptr, 1)) {
+                        return kPartial_IncrementalResult;
+                    }
+                    if (this->shouldCancelDecode()) {
+                        fIncrementalState.free();
+                        return kFailure_IncrementalResult;
+                    }
+                    const int dstY = state->fSampler->srcYToDstY(srcY);
+                    if (dstY < 0) {
+                        continue;
+                    }
+                    if (JCS_CMYK == cinfo->out_color_space) {
+                        convert_CMYK_to_RGB(srcRow, cinfo->output_width);
+                    }
+                    state->fSampler->sampleInterlaced(srcRow, srcY);
+                    JoinRowRange(dstY, startRow, endRow);
+                }
+                state->fState = cinfo->buffered_image ?
+                                    SkJPEGIncrementalState::kFinishOutputPass_State :
+                                    SkJPEGIncrementalState::kFinishDecompress_State;
+                continue;
+            }
+
+            case SkJPEGIncrementalState::kFinishOutputPass_State:
+                if (!jpeg_finish_output(cinfo)) {
+                    return kPartial_IncrementalResult;
+                }
+                if (jpeg_input_complete(cinfo) &&
+                        cinfo->output_scan_number == cinfo->input_scan_number) {
+                    state->fState = SkJPEGIncrementalState::kFinishDecompress_State;
+                } else {
+                    state->fState = SkJPEGIncrementalState::kStartOutputPass_State;
+                }
+                continue;
+
+            case SkJPEGIncrementalState::kFinishDecompress_State:
+                if (!jpeg_finish_decompress(cinfo)) {
+                    return kPartial_IncrementalResult;
+                }
+                fIncrementalState.free();
+                return kComplete_IncrementalResult;
+        }
+        // Only reached if one of the setup steps failed.
+        fIncrementalState.free();
+        return kFailure_IncrementalResult;
+    }
+}
+
 #ifdef SK_BUILD_FOR_ANDROID
 bool SkJPEGImageDecoder::onBuildTileIndex(SkStreamRewindable* stream, int *width, int *height) {
 
@@ -1169,6 +1806,7 @@ protected:
 
         jpeg_set_defaults(&cinfo);
         jpeg_set_quality(&cinfo, quality, TRUE /* limit to baseline-JPEG values */);
+        cinfo.restart_in_rows = this->getJPEGRestartRows();
 #ifdef DCT_IFAST_SUPPORTED
         cinfo.dct_method = JDCT_IFAST;
 #endif
@@ -15,10 +15,16 @@
 #include "SkScaledBitmapSampler.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
+#include "SkThreadPool.h"
 #include "SkUtils.h"
 #include "transform_scanline.h"
 extern "C" {
 #include "png.h"
+#ifdef SK_ZLIB_INCLUDE
+#include SK_ZLIB_INCLUDE
+#else
+#include "zlib.h"
+#endif
 }
 
 /* These were dropped in libpng >= 1.4 */
@@ -73,6 +79,56 @@ public:
     SkColorType                         fColorType;
 };
 
+/**
+ *  State for an incremental decode, driven by libpng's progressive reader.
+ *  The callbacks registered with png_set_progressive_read_fn find it through
+ *  png_get_progressive_ptr().
+ */
+class SkPNGIncrementalState {
+public:
+    SkPNGIncrementalState(SkImageDecoder* decoder, SkBitmap* bitmap,
+                          png_structp png_ptr, png_infop info_ptr)
+        : fDecoder(decoder)
+        , fBitmap(bitmap)
+        , fPng_ptr(png_ptr)
+        , fInfo_ptr(info_ptr)
+        , fTranspColor(0)
+        , fReallyHasAlpha(false)
+        , fPixelsLocked(false)
+        , fColorsLocked(false)
+        , fComplete(false)
+        , fStartRow(NULL)
+        , fEndRow(NULL) {}
+
+    ~SkPNGIncrementalState() {
+        png_destroy_read_struct(&fPng_ptr, &fInfo_ptr, png_infopp_NULL);
+        if (fPixelsLocked) {
+            fBitmap->unlockPixels();
+        }
+        if (fColorsLocked) {
+            fColorTable->unlockColors();
+        }
+    }
+
+    SkImageDecoder*                         fDecoder;
+    SkBitmap*                               fBitmap;
+    png_structp                             fPng_ptr;
+    png_infop                               fInfo_ptr;
+    SkAutoTDelete<SkScaledBitmapSampler>    fSampler;
+    SkAutoTUnref<SkColorTable>              fColorTable;
+    // Holds the whole image while an interlaced image is being combined.
+    SkAutoMalloc                            fInterlaceStorage;
+    size_t                                  fSrcRowBytes;
+    SkPMColor                               fTranspColor;
+    bool                                    fReallyHasAlpha;
+    bool                                    fPixelsLocked;
+    bool                                    fColorsLocked;
+    bool                                    fComplete;
+    // The row range reported by the current call to onAppendData.
+    int*                                    fStartRow;
+    int*                                    fEndRow;
+};
+
 class SkPNGImageDecoder : public SkImageDecoder {
 public:
     SkPNGImageDecoder() {
@@ -92,9 +148,18 @@ protected:
     virtual bool onDecodeSubset(SkBitmap* bitmap, const SkIRect& region) SK_OVERRIDE;
 #endif
     virtual bool onDecode(SkStream* stream, SkBitmap* bm, Mode) SK_OVERRIDE;
+    virtual bool onStartIncrementalDecode(SkBitmap* bitmap) SK_OVERRIDE;
+    virtual IncrementalResult onAppendData(const void* data, size_t length,
+                                           int* startRow, int* endRow) SK_OVERRIDE;
 
 private:
     SkPNGImageIndex* fImageIndex;
+    SkAutoTDelete<SkPNGIncrementalState> fIncrementalState;
+
+    static void IncrementalInfoCallback(png_structp, png_infop);
+    static void IncrementalRowCallback(png_structp, png_bytep, png_uint_32 rowNum, int pass);
+    static void IncrementalEndCallback(png_structp, png_infop);
+    bool beginIncrementalImage(SkPNGIncrementalState*);
 
     bool onDecodeInit(SkStream* stream, png_structp *png_ptrp, png_infop *info_ptrp);
     bool decodePalette(png_structp png_ptr, png_infop info_ptr,
@@ -212,8 +277,10 @@ void do_nothing_warning_fn(png_structp, png_const_charp) {
     /* do nothing */
 }
 
-bool SkPNGImageDecoder::onDecodeInit(SkStream* sk_stream, png_structp *png_ptrp,
-                                     png_infop *info_ptrp) {
+/*  Create and initialize the png_struct and png_info used to read an image.
+    Returns false (and sets neither pointer) if they could not be created.
+ */
+static bool create_read_struct(png_structp* png_ptrp, png_infop* info_ptrp) {
     /* Create and initialize the png_struct with the desired error handler
     * functions.  If you want to use the default stderr and longjump method,
     * you can supply NULL for the last three parameters.  We also supply the
@@ -236,14 +303,49 @@ bool SkPNGImageDecoder::onDecodeInit(SkStream* sk_stream, png_structp *png_ptrp,
         return false;
     }
 
-    *png_ptrp = png_ptr;
-
     /* Allocate/initialize the memory for image information. */
     png_infop info_ptr = png_create_info_struct(png_ptr);
     if (info_ptr == NULL) {
         png_destroy_read_struct(&png_ptr, png_infopp_NULL, png_infopp_NULL);
         return false;
     }
+    *png_ptrp = png_ptr;
+    *info_ptrp = info_ptr;
+    return true;
+}
+
+/*  Set up the transformations that every decode wants, once the IHDR chunk
+    has been read.
+ */
+static void set_up_transforms(png_structp png_ptr, png_infop info_ptr) {
+    png_uint_32 origWidth, origHeight;
+    int bitDepth, colorType;
+    png_get_IHDR(png_ptr, info_ptr, &origWidth, &origHeight, &bitDepth,
+                 &colorType, int_p_NULL, int_p_NULL, int_p_NULL);
+
+    /* tell libpng to strip 16 bit/color files down to 8 bits/color */
+    if (bitDepth == 16) {
+        png_set_strip_16(png_ptr);
+    }
+    /* Extract multiple pixels with bit depths of 1, 2, and 4 from a single
+     * byte into separate bytes (useful for paletted and grayscale images). */
+    if (bitDepth < 8) {
+        png_set_packing(png_ptr);
+    }
+    /* Expand grayscale images to the full 8 bits from 1, 2, or 4 bits/pixel */
+    if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8) {
+        png_set_expand_gray_1_2_4_to_8(png_ptr);
+    }
+}
+
+bool SkPNGImageDecoder::onDecodeInit(SkStream* sk_stream, png_structp *png_ptrp,
+                                     png_infop *info_ptrp) {
+    png_structp png_ptr;
+    png_infop info_ptr;
+    if (!create_read_struct(&png_ptr, &info_ptr)) {
+        return false;
+    }
+    *png_ptrp = png_ptr;
     *info_ptrp = info_ptr;
 
     /* Set error handling if you are using the setjmp/longjmp method (this is
@@ -275,24 +377,7 @@ bool SkPNGImageDecoder::onDecodeInit(SkStream* sk_stream, png_structp *png_ptrp,
     /* The call to png_read_info() gives us all of the information from the
     * PNG file before the first IDAT (image data chunk). */
     png_read_info(png_ptr, info_ptr);
-    png_uint_32 origWidth, origHeight;
-    int bitDepth, colorType;
-    png_get_IHDR(png_ptr, info_ptr, &origWidth, &origHeight, &bitDepth,
-                 &colorType, int_p_NULL, int_p_NULL, int_p_NULL);
-
-    /* tell libpng to strip 16 bit/color files down to 8 bits/color */
-    if (bitDepth == 16) {
-        png_set_strip_16(png_ptr);
-    }
-    /* Extract multiple pixels with bit depths of 1, 2, and 4 from a single
-     * byte into separate bytes (useful for paletted and grayscale images). */
-    if (bitDepth < 8) {
-        png_set_packing(png_ptr);
-    }
-    /* Expand grayscale images to the full 8 bits from 1, 2, or 4 bits/pixel */
-    if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8) {
-        png_set_expand_gray_1_2_4_to_8(png_ptr);
-    }
+    set_up_transforms(png_ptr, info_ptr);
 
     return true;
 }
@@ -724,6 +809,206 @@ bool SkPNGImageDecoder::decodePalette(png_structp png_ptr, png_infop info_ptr,
     return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+bool SkPNGImageDecoder::onStartIncrementalDecode(SkBitmap* bm) {
+    png_structp png_ptr;
+    png_infop info_ptr;
+    if (!create_read_struct(&png_ptr, &info_ptr)) {
+        return false;
+    }
+    SkAutoTDelete<SkPNGIncrementalState> state(
+            SkNEW_ARGS(SkPNGIncrementalState, (this, bm, png_ptr, info_ptr)));
+
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        return false;
+    }
+
+    png_set_progressive_read_fn(png_ptr, state.get(), IncrementalInfoCallback,
+                                IncrementalRowCallback, IncrementalEndCallback);
+
+    // hookup our peeker so we can see any user-chunks the caller may be interested in
+    png_set_keep_unknown_chunks(png_ptr, PNG_HANDLE_CHUNK_ALWAYS, (png_byte*)"", 0);
+    if (this->getPeeker()) {
+        png_set_read_user_chunk_fn(png_ptr, (png_voidp)this->getPeeker(), sk_read_user_chunk);
+    }
+
+    fIncrementalState.reset(state.detach());
+    return true;
+}
+
+// Called once the header chunks (everything before the first IDAT) are read.
+bool SkPNGImageDecoder::beginIncrementalImage(SkPNGIncrementalState* state) {
+    png_structp png_ptr = state->fPng_ptr;
+    png_infop info_ptr = state->fInfo_ptr;
+
+    set_up_transforms(png_ptr, info_ptr);
+
+    png_uint_32 origWidth, origHeight;
+    int bitDepth, pngColorType, interlaceType;
+    png_get_IHDR(png_ptr, info_ptr, &origWidth, &origHeight, &bitDepth,
+                 &pngColorType, &interlaceType, int_p_NULL, int_p_NULL);
+
+    SkColorType colorType;
+    bool hasAlpha = false;
+    if (!this->getBitmapColorType(png_ptr, info_ptr, &colorType, &hasAlpha,
+                                  &state->fTranspColor)) {
+        return false;
+    }
+
+    SkAlphaType alphaType = this->getRequireUnpremultipliedColors() ?
+                                kUnpremul_SkAlphaType : kPremul_SkAlphaType;
+    state->fSampler.reset(SkNEW_ARGS(SkScaledBitmapSampler,
+                                     (origWidth, origHeight, this->getSampleSize())));
+    SkScaledBitmapSampler* sampler = state->fSampler.get();
+    SkBitmap* bm = state->fBitmap;
+    bm->setInfo(SkImageInfo::Make(sampler->scaledWidth(), sampler->scaledHeight(),
+                                  colorType, alphaType));
+
+    SkColorTable* colorTable = NULL;
+    if (pngColorType == PNG_COLOR_TYPE_PALETTE) {
+        this->decodePalette(png_ptr, info_ptr, &hasAlpha, &state->fReallyHasAlpha, &colorTable);
+    }
+    state->fColorTable.reset(colorTable);
+
+    if (!this->allocIncrementalPixelRef(bm,
+                                        kIndex_8_SkColorType == colorType ? colorTable : NULL)) {
+        return false;
+    }
+    // The pixels stay locked until the decode is finished, since the sampler
+    // holds on to their address.
+    bm->lockPixels();
+    state->fPixelsLocked = true;
+
+    const int number_passes = (interlaceType != PNG_INTERLACE_NONE) ?
+                              png_set_interlace_handling(png_ptr) : 1;
+    png_read_update_info(png_ptr, info_ptr);
+
+    SkScaledBitmapSampler::SrcConfig sc;
+    int srcBytesPerPixel = 4;
+    if (colorTable != NULL) {
+        sc = SkScaledBitmapSampler::kIndex;
+        srcBytesPerPixel = 1;
+    } else if (kAlpha_8_SkColorType == colorType) {
+        // A8 is only allowed if the original was GRAY.
+        SkASSERT(PNG_COLOR_TYPE_GRAY == pngColorType);
+        sc = SkScaledBitmapSampler::kGray;
+        srcBytesPerPixel = 1;
+        // See onDecode: an A8 bitmap is assumed to have alpha.
+        state->fReallyHasAlpha = true;
+    } else if (hasAlpha) {
+        sc = SkScaledBitmapSampler::kRGBA;
+    } else {
+        sc = SkScaledBitmapSampler::kRGBX;
+    }
+
+    // The colortable is passed explicitly, as in onDecode. It is not unlocked
+    // until the decode finishes, since the sampler holds on to the colors.
+    const SkPMColor* colors = NULL;
+    if (colorTable != NULL) {
+        colors = colorTable->lockColors();
+        state->fColorsLocked = true;
+    }
+    if (!sampler->begin(bm, sc, *this, colors)) {
+        return false;
+    }
+
+    state->fSrcRowBytes = origWidth * srcBytesPerPixel;
+    if (number_passes > 1) {
+        // Each pass only fills in some of the pixels of a row, so the rows
+        // are combined in a buffer for the whole image, which starts out as
+        // zero, like the bitmap.
+        state->fInterlaceStorage.reset(state->fSrcRowBytes * origHeight);
+        sk_bzero(state->fInterlaceStorage.get(), state->fSrcRowBytes * origHeight);
+    }
+    return true;
+}
+
+void SkPNGImageDecoder::IncrementalInfoCallback(png_structp png_ptr, png_infop) {
+    SkPNGIncrementalState* state = (SkPNGIncrementalState*)png_get_progressive_ptr(png_ptr);
+    SkPNGImageDecoder* decoder = static_cast<SkPNGImageDecoder*>(state->fDecoder);
+    if (!decoder->beginIncrementalImage(state)) {
+        png_error(png_ptr, "Unsupported image");
+    }
+}
+
+void SkPNGImageDecoder::IncrementalRowCallback(png_structp png_ptr, png_bytep newRow,
+                                               png_uint_32 rowNum, int pass) {
+    SkPNGIncrementalState* state = (SkPNGIncrementalState*)png_get_progressive_ptr(png_ptr);
+    if (NULL == newRow) {
+        // Nothing in this row changed during this pass.
+        return;
+    }
+    if (static_cast<SkPNGImageDecoder*>(state->fDecoder)->shouldCancelDecode()) {
+        png_error(png_ptr, "Decode cancelled");
+    }
+    const int dstY = state->fSampler->srcYToDstY(rowNum);
+    if (dstY < 0) {
+        return;
+    }
+    const uint8_t* srcRow = newRow;
+    if (NULL != state->fInterlaceStorage.get()) {
+        uint8_t* combined = (uint8_t*)state->fInterlaceStorage.get() +
+                            rowNum * state->fSrcRowBytes;
+        png_progressive_combine_row(png_ptr, combined, newRow);
+        srcRow = combined;
+    }
+    state->fReallyHasAlpha |= state->fSampler->sampleInterlaced(srcRow, rowNum);
+    SkImageDecoder::JoinRowRange(dstY, state->fStartRow, state->fEndRow);
+}
+
+void SkPNGImageDecoder::IncrementalEndCallback(png_structp png_ptr, png_infop) {
+    SkPNGIncrementalState* state = (SkPNGIncrementalState*)png_get_progressive_ptr(png_ptr);
+    SkBitmap* bm = state->fBitmap;
+
+    if (0 != state->fTranspColor) {
+        if (substituteTranspColor(bm, state->fTranspColor)) {
+            state->fReallyHasAlpha = true;
+            SkImageDecoder::JoinRowRange(0, state->fStartRow, state->fEndRow);
+            SkImageDecoder::JoinRowRange(bm->height() - 1, state->fStartRow, state->fEndRow);
+        }
+    }
+    if (state->fReallyHasAlpha && state->fDecoder->getRequireUnpremultipliedColors()) {
+        switch (bm->colorType()) {
+            case kIndex_8_SkColorType:
+            case kARGB_4444_SkColorType:
+                // We have chosen not to support unpremul for these colortypes.
+                png_error(png_ptr, "Unpremul not supported");
+            default:
+                break;
+        }
+    }
+    if (!state->fReallyHasAlpha) {
+        bm->setAlphaType(kOpaque_SkAlphaType);
+    }
+    state->fComplete = true;
+}
+
+SkImageDecoder::IncrementalResult SkPNGImageDecoder::onAppendData(const void* data,
+                                                                  size_t length,
+                                                                  int* startRow,
+                                                                  int* endRow) {
+    SkPNGIncrementalState* state = fIncrementalState.get();
+    if (NULL == state) {
+        return kFailure_IncrementalResult;
+    }
+    state->fStartRow = startRow;
+    state->fEndRow = endRow;
+
+    if (setjmp(png_jmpbuf(state->fPng_ptr))) {
+        fIncrementalState.free();
+        return kFailure_IncrementalResult;
+    }
+
+    png_process_data(state->fPng_ptr, state->fInfo_ptr, (png_bytep)data, length);
+
+    if (!state->fComplete) {
+        return kPartial_IncrementalResult;
+    }
+    fIncrementalState.free();
+    return kComplete_IncrementalResult;
+}
+
 #ifdef SK_BUILD_FOR_ANDROID
 
 bool SkPNGImageDecoder::onBuildTileIndex(SkStreamRewindable* sk_stream, int *width, int *height) {
@@ -1100,6 +1385,270 @@ static inline int pack_palette(SkColorTable* ctable,
     return num_trans;
 }
 
+SK_COMPILE_ASSERT(SkImageEncoder::kNone_PNGFilterFlag == PNG_FILTER_NONE, filter_none_mismatch);
+SK_COMPILE_ASSERT(SkImageEncoder::kSub_PNGFilterFlag == PNG_FILTER_SUB, filter_sub_mismatch);
+SK_COMPILE_ASSERT(SkImageEncoder::kUp_PNGFilterFlag == PNG_FILTER_UP, filter_up_mismatch);
+SK_COMPILE_ASSERT(SkImageEncoder::kAvg_PNGFilterFlag == PNG_FILTER_AVG, filter_avg_mismatch);
+SK_COMPILE_ASSERT(SkImageEncoder::kPaeth_PNGFilterFlag == PNG_FILTER_PAETH, filter_paeth_mismatch);
+
+static int to_zlib_strategy(SkImageEncoder::ZLibStrategy strategy) {
+    switch (strategy) {
+        case SkImageEncoder::kFiltered_ZLibStrategy:
+            return Z_FILTERED;
+        case SkImageEncoder::kHuffmanOnly_ZLibStrategy:
+            return Z_HUFFMAN_ONLY;
+        case SkImageEncoder::kRLE_ZLibStrategy:
+            return Z_RLE;
+        default:
+            return Z_DEFAULT_STRATEGY;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Compressing bands of rows in parallel.
+//
+// PNG filters each row on its own (using the unfiltered row above it), so
+// bands of rows can be filtered and deflated independently, as long as each
+// band's deflate stream is flushed to a byte boundary without being marked
+// final. The streams are then concatenated into one zlib stream, the way
+// pigz does it, with the Adler-32 checksums of the bands combined at the end.
+
+// Rows per band below which the threads are not worth their overhead.
+static const int kMinRowsPerPNGBand = 32;
+
+namespace {
+
+struct PNGBand {
+    PNGBand() : fStartY(0), fEndY(0), fAdler(0), fLength(0), fSuccess(false) {}
+
+    int                     fStartY;
+    int                     fEndY;
+    SkDynamicMemoryWStream  fOut;       // deflated data
+    uLong                   fAdler;     // checksum of the filtered rows
+    uLong                   fLength;    // length of the filtered rows
+    bool                    fSuccess;
+};
+
+struct PNGBandContext {
+    const SkBitmap*         fBitmap;
+    transform_scanline_proc fProc;
+    int                     fBytesPerPixel;
+    unsigned                fFilters;
+    int                     fLevel;
+    int                     fStrategy;
+};
+
+}  // namespace
+
+static inline int png_paeth(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = SkAbs32(p - a);
+    const int pb = SkAbs32(p - b);
+    const int pc = SkAbs32(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+/**
+ *  Write 'filter' followed by 'row' filtered by it to 'out', and return the
+ *  sum of the absolute values of the filtered bytes (as signed bytes), which
+ *  is libpng's heuristic for choosing a filter.
+ */
+static uint32_t filter_png_row(int filter, const uint8_t* SK_RESTRICT row,
+                               const uint8_t* SK_RESTRICT prior, int rowBytes, int bpp,
+                               uint8_t* SK_RESTRICT out) {
+    *out++ = filter;
+    uint32_t sum = 0;
+    for (int i = 0; i < rowBytes; i++) {
+        const int a = i >= bpp ? row[i - bpp] : 0;
+        const int b = prior[i];
+        const int c = i >= bpp ? prior[i - bpp] : 0;
+        int predicted;
+        switch (filter) {
+            case PNG_FILTER_VALUE_SUB:   predicted = a;                 break;
+            case PNG_FILTER_VALUE_UP:    predicted = b;                 break;
+            case PNG_FILTER_VALUE_AVG:   predicted = (a + b) >> 1;      break;
+            case PNG_FILTER_VALUE_PAETH: predicted = png_paeth(a, b, c); break;
+            default:                     predicted = 0;                 break;
+        }
+        const uint8_t value = row[i] - predicted;
+        out[i] = value;
+        sum += SkAbs32((int8_t)value);
+    }
+    return sum;
+}
+
+class PNGBandProc : public SkRunnable {
+public:
+    PNGBandProc() : fContext(NULL), fBand(NULL), fLast(false) {}
+
+    void init(const PNGBandContext* context, PNGBand* band, bool last) {
+        fContext = context;
+        fBand = band;
+        fLast = last;
+    }
+
+    virtual void run() SK_OVERRIDE {
+        fBand->fSuccess = this->compress();
+    }
+
+private:
+    bool compress() {
+        const SkBitmap& bitmap = *fContext->fBitmap;
+        const int rowBytes = bitmap.width() * fContext->fBytesPerPixel;
+        // The current and prior unfiltered rows, and two filtered rows, each
+        // with the filter type byte.
+        SkAutoMalloc storage(2 * rowBytes + 2 * (rowBytes + 1));
+        uint8_t* row = (uint8_t*)storage.get();
+        uint8_t* prior = row + rowBytes;
+        uint8_t* best = prior + rowBytes;
+        uint8_t* trial = best + rowBytes + 1;
+
+        if (fBand->fStartY > 0) {
+            fContext->fProc((const char*)bitmap.getAddr(0, fBand->fStartY - 1), bitmap.width(),
+                           (char*)prior);
+        } else {
+            memset(prior, 0, rowBytes);
+        }
+
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        // Raw deflate (negative window bits), since the bands share one
+        // zlib header and checksum.
+        if (Z_OK != deflateInit2(&zs, fContext->fLevel, Z_DEFLATED, -MAX_WBITS, 8,
+                                 fContext->fStrategy)) {
+            return false;
+        }
+
+        bool success = true;
+        fBand->fAdler = adler32(0L, Z_NULL, 0);
+        for (int y = fBand->fStartY; y < fBand->fEndY && success; y++) {
+            fContext->fProc((const char*)bitmap.getAddr(0, y), bitmap.width(), (char*)row);
+
+            uint32_t bestSum = SK_MaxU32;
+            for (int filter = PNG_FILTER_VALUE_NONE; filter < PNG_FILTER_VALUE_LAST; filter++) {
+                // PNG_FILTER_NONE is the flag for PNG_FILTER_VALUE_NONE, etc.
+                if (0 == (fContext->fFilters & (PNG_FILTER_NONE << filter))) {
+                    continue;
+                }
+                const uint32_t sum = filter_png_row(filter, row, prior, rowBytes,
+                                                    fContext->fBytesPerPixel, trial);
+                if (sum < bestSum) {
+                    bestSum = sum;
+                    SkTSwap(best, trial);
+                }
+            }
+
+            fBand->fAdler = adler32(fBand->fAdler, best, rowBytes + 1);
+            fBand->fLength += rowBytes + 1;
+            const bool lastRow = y == fBand->fEndY - 1;
+            const int flush = lastRow ? (fLast ? Z_FINISH : Z_SYNC_FLUSH) : Z_NO_FLUSH;
+            success = this->deflate(&zs, best, rowBytes + 1, flush);
+            SkTSwap(row, prior);
+        }
+        deflateEnd(&zs);
+        return success;
+    }
+
+    bool deflate(z_stream* zs, uint8_t* data, int length, int flush) {
+        uint8_t buffer[16384];
+        zs->next_in = data;
+        zs->avail_in = length;
+        int result;
+        do {
+            zs->next_out = buffer;
+            zs->avail_out = sizeof(buffer);
+            result = ::deflate(zs, flush);
+            if (Z_STREAM_ERROR == result) {
+                return false;
+            }
+            if (!fBand->fOut.write(buffer, sizeof(buffer) - zs->avail_out)) {
+                return false;
+            }
+        } while (0 == zs->avail_out);
+        SkASSERT(0 == zs->avail_in);
+        return Z_FINISH != flush || Z_STREAM_END == result;
+    }
+
+    const PNGBandContext*   fContext;
+    PNGBand*                fBand;
+    bool                    fLast;
+};
+
+/**
+ *  Compress the rows of bitmap in bands on up to threadCount threads and
+ *  write them as IDAT chunks. Returns false without writing anything if the
+ *  image is too small to split or compression fails.
+ */
+static bool write_png_bands(png_structp png_ptr, const SkBitmap& bitmap,
+                            transform_scanline_proc proc, int bytesPerPixel,
+                            unsigned filters, int level, int strategy, int threadCount) {
+    if (threadCount < 0) {
+        threadCount = num_cores();
+    }
+    const int bandCount = SkMin32(threadCount, bitmap.height() / kMinRowsPerPNGBand);
+    if (bandCount < 2) {
+        return false;
+    }
+
+    PNGBandContext context;
+    context.fBitmap = &bitmap;
+    context.fProc = proc;
+    context.fBytesPerPixel = bytesPerPixel;
+    context.fFilters = filters;
+    context.fLevel = level;
+    context.fStrategy = strategy;
+
+    SkAutoTArray<PNGBand> bands(bandCount);
+    SkAutoTArray<PNGBandProc> procs(bandCount);
+    {
+        SkThreadPool pool(bandCount);
+        for (int i = 0; i < bandCount; i++) {
+            bands[i].fStartY = bitmap.height() * i / bandCount;
+            bands[i].fEndY = bitmap.height() * (i + 1) / bandCount;
+            procs[i].init(&context, &bands[i], i == bandCount - 1);
+            pool.add(&procs[i]);
+        }
+        pool.wait();
+    }
+
+    uLong adler = bands[0].fAdler;
+    for (int i = 0; i < bandCount; i++) {
+        if (!bands[i].fSuccess) {
+            return false;
+        }
+        if (i > 0) {
+            adler = adler32_combine(adler, bands[i].fAdler, bands[i].fLength);
+        }
+    }
+
+    // The zlib header: deflate with a 32K window, the compression level
+    // hint, and a check value making the pair a multiple of 31.
+    const int levelHint = level < 0 ? 2 : (level < 2 ? 0 : (level < 6 ? 1 : (6 == level ? 2 : 3)));
+    uint8_t header[2] = { 0x78, (uint8_t)(levelHint << 6) };
+    header[1] += 31 - ((header[0] << 8) + header[1]) % 31;
+    const uint8_t trailer[4] = {
+        (uint8_t)(adler >> 24), (uint8_t)(adler >> 16), (uint8_t)(adler >> 8), (uint8_t)adler
+    };
+
+    for (int i = 0; i < bandCount; i++) {
+        const size_t headerSize = 0 == i ? sizeof(header) : 0;
+        const size_t bandSize = bands[i].fOut.bytesWritten();
+        const size_t trailerSize = bandCount - 1 == i ? sizeof(trailer) : 0;
+        SkAutoMalloc idat(headerSize + bandSize + trailerSize);
+        uint8_t* dst = (uint8_t*)idat.get();
+        memcpy(dst, header, headerSize);
+        bands[i].fOut.copyTo(dst + headerSize);
+        memcpy(dst + headerSize + bandSize, trailer, trailerSize);
+        png_write_chunk(png_ptr, (png_bytep)"IDAT", dst, headerSize + bandSize + trailerSize);
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 class SkPNGImageEncoder : public SkImageEncoder {
 protected:
     virtual bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) SK_OVERRIDE;
@@ -1231,22 +1780,49 @@ bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
     }
 
     png_set_sBIT(png_ptr, info_ptr, &sig_bit);
+
+    unsigned filters = this->getPNGFilters();
+    if (kDefault_PNGFilterFlags != filters) {
+        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, filters);
+    } else {
+        // What libpng does by default.
+        filters = kIndex_8_SkColorType == ct ? PNG_FILTER_NONE : PNG_ALL_FILTERS;
+    }
+    const int level = this->getZLibLevel();
+    if (kDefault_ZLibLevel != level) {
+        png_set_compression_level(png_ptr, level);
+    }
+    const int strategy = to_zlib_strategy(this->getZLibStrategy());
+    if (kDefault_ZLibStrategy != this->getZLibStrategy()) {
+        png_set_compression_strategy(png_ptr, strategy);
+    }
+
     png_write_info(png_ptr, info_ptr);
 
-    const char* srcImage = (const char*)bitmap.getPixels();
-    SkAutoSMalloc<1024> rowStorage(bitmap.width() << 2);
-    char* storage = (char*)rowStorage.get();
     transform_scanline_proc proc = choose_proc(ct, hasAlpha);
+    const int bytesPerPixel = kIndex_8_SkColorType == ct ? 1 : (hasAlpha ? 4 : 3);
+
+    if (1 != this->getThreadCount() &&
+            write_png_bands(png_ptr, bitmap, proc, bytesPerPixel, filters,
+                            kDefault_ZLibLevel == level ? Z_DEFAULT_COMPRESSION : level,
+                            strategy, this->getThreadCount())) {
+        // libpng did not see the image data, so png_write_end would fail.
+        png_write_chunk(png_ptr, (png_bytep)"IEND", NULL, 0);
+    } else {
+        const char* srcImage = (const char*)bitmap.getPixels();
+        SkAutoSMalloc<1024> rowStorage(bitmap.width() << 2);
+        char* storage = (char*)rowStorage.get();
+
+        for (int y = 0; y < bitmap.height(); y++) {
+            png_bytep row_ptr = (png_bytep)storage;
+            proc(srcImage, bitmap.width(), storage);
+            png_write_rows(png_ptr, &row_ptr, 1);
+            srcImage += bitmap.rowBytes();
+        }
 
-    for (int y = 0; y < bitmap.height(); y++) {
-        png_bytep row_ptr = (png_bytep)storage;
-        proc(srcImage, bitmap.width(), storage);
-        png_write_rows(png_ptr, &row_ptr, 1);
-        srcImage += bitmap.rowBytes();
+        png_write_end(png_ptr, info_ptr);
     }
 
-    png_write_end(png_ptr, info_ptr);
-
     /* clean up after the write, and free any memory allocated */
     png_destroy_write_struct(&png_ptr, &info_ptr);
     return true;
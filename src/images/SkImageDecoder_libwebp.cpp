@@ -19,6 +19,7 @@
 #include "SkColorPriv.h"
 #include "SkScaledBitmapSampler.h"
 #include "SkStream.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
 
@@ -50,6 +51,16 @@ extern "C" {
 static const size_t WEBP_VP8_HEADER_SIZE = 64;
 static const size_t WEBP_IDECODE_BUFFER_SZ = (1 << 16);
 
+// Sanity check for image size that's about to be decoded.
+static bool webp_is_valid_size(int width, int height) {
+    int64_t size = sk_64_mul(width, height);
+    if (!sk_64_isS32(size)) {
+        return false;
+    }
+    // now check that if we are 4-bytes per pixel, we also don't overflow
+    return sk_64_asS32(size) <= (0x7FFFFFFF >> 2);
+}
+
 // Parse headers of RIFF container, and check for valid Webp (VP8) content.
 static bool webp_parse_header(SkStream* stream, int* width, int* height, int* alpha) {
     unsigned char buffer[WEBP_VP8_HEADER_SIZE];
@@ -78,19 +89,41 @@ static bool webp_parse_header(SkStream* stream, int* width, int* height, int* al
     *height = features.height;
     *alpha = features.has_alpha;
 
-    // sanity check for image size that's about to be decoded.
-    {
-        int64_t size = sk_64_mul(*width, *height);
-        if (!sk_64_isS32(size)) {
-            return false;
+    return webp_is_valid_size(*width, *height);
+}
+
+/**
+ *  State for an incremental decode. Data is buffered until the bitstream
+ *  features (and so the size of the image) are known; from then on it is
+ *  handed straight to libwebp's incremental decoder, which decodes into the
+ *  bitmap's pixels.
+ */
+class SkWEBPIncrementalState {
+public:
+    SkWEBPIncrementalState(SkBitmap* bitmap)
+        : fBitmap(bitmap)
+        , fIDec(NULL)
+        , fLastY(0)
+        , fPixelsLocked(false) {}
+
+    ~SkWEBPIncrementalState() {
+        if (NULL != fIDec) {
+            WebPIDelete(fIDec);
+            WebPFreeDecBuffer(&fConfig.output);
         }
-        // now check that if we are 4-bytes per pixel, we also don't overflow
-        if (sk_64_asS32(size) > (0x7FFFFFFF >> 2)) {
-            return false;
+        if (fPixelsLocked) {
+            fBitmap->unlockPixels();
         }
     }
-    return true;
-}
+
+    SkBitmap*           fBitmap;
+    SkTDArray<uint8_t>  fHeaderData;
+    WebPDecoderConfig   fConfig;
+    WebPIDecoder*       fIDec;
+    // Rows above fLastY have been decoded.
+    int                 fLastY;
+    bool                fPixelsLocked;
+};
 
 class SkWEBPImageDecoder: public SkImageDecoder {
 public:
@@ -112,6 +145,9 @@ protected:
     virtual bool onBuildTileIndex(SkStreamRewindable *stream, int *width, int *height) SK_OVERRIDE;
     virtual bool onDecodeSubset(SkBitmap* bitmap, const SkIRect& rect) SK_OVERRIDE;
     virtual bool onDecode(SkStream* stream, SkBitmap* bm, Mode) SK_OVERRIDE;
+    virtual bool onStartIncrementalDecode(SkBitmap* bitmap) SK_OVERRIDE;
+    virtual IncrementalResult onAppendData(const void* data, size_t length,
+                                           int* startRow, int* endRow) SK_OVERRIDE;
 
 private:
     /**
@@ -125,7 +161,15 @@ private:
 
     bool setDecodeConfig(SkBitmap* decodedBitmap, int width, int height);
 
+    /**
+     *  Called once the buffered data holds the bitstream features. Returns
+     *  NOT_ENOUGH_DATA if it does not yet, and an error if the image cannot
+     *  be decoded.
+     */
+    VP8StatusCode beginIncrementalImage(SkWEBPIncrementalState*);
+
     SkStream* fInputStream;
+    SkAutoTDelete<SkWEBPIncrementalState> fIncrementalState;
     int fOrigWidth;
     int fOrigHeight;
     int fHasAlpha;
@@ -449,6 +493,97 @@ bool SkWEBPImageDecoder::onDecode(SkStream* stream, SkBitmap* decodedBitmap,
     return webp_idecode(stream, &config);
 }
 
+bool SkWEBPImageDecoder::onStartIncrementalDecode(SkBitmap* bm) {
+    fIncrementalState.reset(SkNEW_ARGS(SkWEBPIncrementalState, (bm)));
+    return true;
+}
+
+VP8StatusCode SkWEBPImageDecoder::beginIncrementalImage(SkWEBPIncrementalState* state) {
+    WebPBitstreamFeatures features;
+    VP8StatusCode status = WebPGetFeatures(state->fHeaderData.begin(),
+                                           state->fHeaderData.count(), &features);
+    if (VP8_STATUS_OK != status) {
+        return status;
+    }
+    if (!webp_is_valid_size(features.width, features.height)) {
+        return VP8_STATUS_BITSTREAM_ERROR;
+    }
+    this->fHasAlpha = features.has_alpha;
+
+    SkBitmap* bm = state->fBitmap;
+    SkScaledBitmapSampler sampler(features.width, features.height, this->getSampleSize());
+    if (!setDecodeConfig(bm, sampler.scaledWidth(), sampler.scaledHeight())) {
+        return VP8_STATUS_UNSUPPORTED_FEATURE;
+    }
+    if (!this->allocIncrementalPixelRef(bm, NULL)) {
+        return_false(*bm, "allocPixelRef");
+        return VP8_STATUS_OUT_OF_MEMORY;
+    }
+    // The pixels stay locked until the decode is finished, since libwebp
+    // decodes straight into them.
+    bm->lockPixels();
+    state->fPixelsLocked = true;
+
+    if (!webp_get_config_resize(&state->fConfig, bm, features.width, features.height,
+                                this->shouldPremultiply())) {
+        return VP8_STATUS_UNSUPPORTED_FEATURE;
+    }
+    state->fIDec = WebPIDecode(NULL, 0, &state->fConfig);
+    if (NULL == state->fIDec) {
+        WebPFreeDecBuffer(&state->fConfig.output);
+        return VP8_STATUS_OUT_OF_MEMORY;
+    }
+    return VP8_STATUS_OK;
+}
+
+SkImageDecoder::IncrementalResult SkWEBPImageDecoder::onAppendData(const void* data,
+                                                                   size_t length,
+                                                                   int* startRow,
+                                                                   int* endRow) {
+    SkWEBPIncrementalState* state = fIncrementalState.get();
+    if (NULL == state) {
+        return kFailure_IncrementalResult;
+    }
+
+    VP8StatusCode status;
+    if (NULL == state->fIDec) {
+        state->fHeaderData.append(SkToInt(length), (const uint8_t*)data);
+        status = this->beginIncrementalImage(state);
+        if (VP8_STATUS_NOT_ENOUGH_DATA == status) {
+            return kPartial_IncrementalResult;
+        }
+        if (VP8_STATUS_OK != status) {
+            fIncrementalState.free();
+            return kFailure_IncrementalResult;
+        }
+        status = WebPIAppend(state->fIDec, state->fHeaderData.begin(),
+                             state->fHeaderData.count());
+        state->fHeaderData.reset();
+    } else {
+        status = WebPIAppend(state->fIDec, (const uint8_t*)data, length);
+    }
+
+    if ((VP8_STATUS_OK != status && VP8_STATUS_SUSPENDED != status) ||
+            this->shouldCancelDecode()) {
+        fIncrementalState.free();
+        return kFailure_IncrementalResult;
+    }
+
+    int lastY = state->fLastY;
+    if (NULL != WebPIDecGetRGB(state->fIDec, &lastY, NULL, NULL, NULL) &&
+            lastY > state->fLastY) {
+        JoinRowRange(state->fLastY, startRow, endRow);
+        JoinRowRange(lastY - 1, startRow, endRow);
+        state->fLastY = lastY;
+    }
+
+    if (VP8_STATUS_SUSPENDED == status) {
+        return kPartial_IncrementalResult;
+    }
+    fIncrementalState.free();
+    return kComplete_IncrementalResult;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SkUnPreMultiply.h"
@@ -10,8 +10,39 @@
 #include "SkStream.h"
 #include "SkTemplates.h"
 
+SkImageEncoder::SkImageEncoder()
+    : fPNGFilters(kDefault_PNGFilterFlags)
+    , fZLibLevel(kDefault_ZLibLevel)
+    , fZLibStrategy(kDefault_ZLibStrategy)
+    , fThreadCount(1)
+    , fJPEGRestartRows(0) {
+}
+
 SkImageEncoder::~SkImageEncoder() {}
 
+void SkImageEncoder::setPreset(Preset preset) {
+    switch (preset) {
+        case kDefault_Preset:
+            fPNGFilters = kDefault_PNGFilterFlags;
+            fZLibLevel = kDefault_ZLibLevel;
+            fZLibStrategy = kDefault_ZLibStrategy;
+            break;
+        case kFast_Preset:
+            // The Sub filter is nearly free and helps RLE find runs in
+            // gradients; level 1 with RLE is several times faster than the
+            // default for a modest size increase.
+            fPNGFilters = kSub_PNGFilterFlag;
+            fZLibLevel = 1;
+            fZLibStrategy = kRLE_ZLibStrategy;
+            break;
+        case kSmall_Preset:
+            fPNGFilters = kAll_PNGFilterFlags;
+            fZLibLevel = 9;
+            fZLibStrategy = kFiltered_ZLibStrategy;
+            break;
+    }
+}
+
 bool SkImageEncoder::encodeStream(SkWStream* stream, const SkBitmap& bm,
                                   int quality) {
     quality = SkMin32(100, SkMax32(0, quality));
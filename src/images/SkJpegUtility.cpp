@@ -116,6 +116,61 @@ skjpeg_source_mgr::~skjpeg_source_mgr() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static void sk_init_incremental_source(j_decompress_ptr /*cinfo*/) {}
+
+static boolean sk_fill_incremental_input_buffer(j_decompress_ptr /*cinfo*/) {
+    // Everything we have is already in the buffer, so ask libjpeg to suspend.
+    return FALSE;
+}
+
+static void sk_skip_incremental_input_data(j_decompress_ptr cinfo, long num_bytes) {
+    skjpeg_incremental_source_mgr* src = (skjpeg_incremental_source_mgr*)cinfo->src;
+
+    if (num_bytes <= 0) {
+        return;
+    }
+    if (num_bytes > (long)src->bytes_in_buffer) {
+        src->fBytesToSkip += num_bytes - src->bytes_in_buffer;
+        src->next_input_byte += src->bytes_in_buffer;
+        src->bytes_in_buffer = 0;
+    } else {
+        src->next_input_byte += num_bytes;
+        src->bytes_in_buffer -= num_bytes;
+    }
+}
+
+skjpeg_incremental_source_mgr::skjpeg_incremental_source_mgr()
+    : fBytesToSkip(0) {
+    next_input_byte = NULL;
+    bytes_in_buffer = 0;
+    init_source = sk_init_incremental_source;
+    fill_input_buffer = sk_fill_incremental_input_buffer;
+    skip_input_data = sk_skip_incremental_input_data;
+    resync_to_restart = jpeg_resync_to_restart;
+    term_source = sk_term_source;
+#ifdef SK_BUILD_FOR_ANDROID
+    seek_input_data = NULL;
+    current_offset = 0;
+#endif
+}
+
+void skjpeg_incremental_source_mgr::append(const void* data, size_t length) {
+    // libjpeg only remembers its position through next_input_byte and
+    // bytes_in_buffer (both of which it rewinds on suspension), so the
+    // consumed bytes can be dropped and the rest moved.
+    SkASSERT(bytes_in_buffer <= (size_t)fData.count());
+    fData.remove(0, fData.count() - (int)bytes_in_buffer);
+
+    const size_t skip = SkTMin(fBytesToSkip, length);
+    fBytesToSkip -= skip;
+    fData.append((int)(length - skip), (const uint8_t*)data + skip);
+
+    next_input_byte = (const JOCTET*)fData.begin();
+    bytes_in_buffer = fData.count();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 static void sk_init_destination(j_compress_ptr cinfo) {
     skjpeg_destination_mgr* dest = (skjpeg_destination_mgr*)cinfo->dest;
 
@@ -12,6 +12,7 @@
 
 #include "SkImageDecoder.h"
 #include "SkStream.h"
+#include "SkTDArray.h"
 
 extern "C" {
     #include "jpeglib.h"
@@ -48,6 +49,24 @@ struct skjpeg_source_mgr : jpeg_source_mgr {
     char    fBuffer[kBufferSize];
 };
 
+///////////////////////////////////////////////////////////////////////////
+/* Our source struct for incremental decoding, where the data is pushed to us
+   in pieces instead of being pulled from a stream. When the buffered data
+   runs out, fill_input_buffer returns FALSE, which makes libjpeg suspend and
+   return to the caller; decoding resumes once more data has been appended.
+*/
+struct skjpeg_incremental_source_mgr : jpeg_source_mgr {
+    skjpeg_incremental_source_mgr();
+
+    // Append more data, discarding whatever libjpeg has already consumed.
+    void append(const void* data, size_t length);
+
+    SkTDArray<uint8_t>  fData;
+    // skip_input_data may ask to skip past the data we have so far. The
+    // remainder is dropped from the front of subsequent appends.
+    size_t              fBytesToSkip;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 /* Our destination struct for directing decompressed pixels to our stream
  * object.
@@ -10,6 +10,7 @@
 #include "SkBitmap.h"
 #include "SkColorPriv.h"
 #include "SkDither.h"
+#include "SkScaledBitmapSampler_opts.h"
 #include "SkTypes.h"
 
 // 8888
@@ -578,6 +579,28 @@ get_gray_to_A8_proc(const SkScaledBitmapSampler::Options& opts) {
 }
 
 typedef SkScaledBitmapSampler::RowProc (*RowProcChooser)(const SkScaledBitmapSampler::Options&);
+
+// Returns the platform-specific version of proc, for a source that is read
+// contiguously, or NULL if there is none.
+static SkScaledBitmapSampler::RowProc get_platform_proc(SkScaledBitmapSampler::RowProc proc,
+                                                        int srcPixelSize) {
+    SkSampleRowProcType type;
+    if (Sample_Gray_D8888 == proc) {
+        type = kGray_D8888_SkSampleRowProcType;
+    } else if (Sample_RGBx_D8888 == proc) {
+        type = 3 == srcPixelSize ? kRGB_D8888_SkSampleRowProcType
+                                 : kRGBx_D8888_SkSampleRowProcType;
+    } else if (Sample_RGBA_D8888 == proc) {
+        type = kRGBA_D8888_SkSampleRowProcType;
+    } else if (Sample_RGBA_D8888_SkipZ == proc) {
+        type = kRGBA_D8888_SkipZ_SkSampleRowProcType;
+    } else if (Sample_RGBA_D8888_Unpremul == proc) {
+        type = kRGBA_D8888_Unpremul_SkSampleRowProcType;
+    } else {
+        return NULL;
+    }
+    return SkSampleRowGetPlatformProc(type);
+}
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SkScaledBitmapSampler.h"
@@ -722,6 +745,13 @@ bool SkScaledBitmapSampler::begin(SkBitmap* dst, SrcConfig sc,
     } else {
         fRowProc = chooser(opts);
     }
+    // The platform-specific procs only handle sampling every pixel.
+    if (fRowProc != NULL && 1 == fDX) {
+        RowProc platformProc = get_platform_proc(fRowProc, fSrcPixelSize);
+        if (platformProc != NULL) {
+            fRowProc = platformProc;
+        }
+    }
     fDstRow = (char*)dst->getPixels();
     fDstRowBytes = dst->rowBytes();
     fCurrY = 0;
@@ -769,6 +799,15 @@ bool SkScaledBitmapSampler::sampleInterlaced(const uint8_t* SK_RESTRICT src, int
                     fDX * fSrcPixelSize, dstY, fCTable);
 }
 
+int SkScaledBitmapSampler::srcYToDstY(int srcY) const {
+    const int srcYMinusY0 = srcY - fY0;
+    if (srcYMinusY0 < 0 || srcYMinusY0 % fDY != 0) {
+        return -1;
+    }
+    const int dstY = srcYMinusY0 / fDY;
+    return dstY < fScaledHeight ? dstY : -1;
+}
+
 #ifdef SK_DEBUG
 // The following code is for a test to ensure that changing the method to get the right row proc
 // did not change the row proc unintentionally. Tested by ImageDecodingTest.cpp
@@ -779,6 +818,9 @@ public:
     static SkScaledBitmapSampler::RowProc getRowProc(const SkScaledBitmapSampler& sampler) {
         return sampler.fRowProc;
     }
+    static int getSrcPixelSize(const SkScaledBitmapSampler& sampler) {
+        return sampler.fSrcPixelSize;
+    }
 };
 
 
@@ -865,7 +907,9 @@ void test_row_proc_choice() {
                                   dummyDecoder);
                     SkScaledBitmapSampler::RowProc expected = gTestProcs[procCounter];
                     SkScaledBitmapSampler::RowProc actual = RowProcTester::getRowProc(sampler);
-                    SkASSERT(expected == actual);
+                    // begin() substitutes a platform-specific proc when it can.
+                    SkASSERT(expected == actual || (expected != NULL && actual ==
+                             get_platform_proc(expected, RowProcTester::getSrcPixelSize(sampler))));
                     procCounter++;
                 }
             }
@@ -62,6 +62,10 @@ public:
     // be called for one SkScaledBitmapSampler.
     bool sampleInterlaced(const uint8_t* SK_RESTRICT src, int srcY);
 
+    // Returns the row of the destination that source row srcY is sampled
+    // into, or -1 if srcY is not part of the output sample.
+    int srcYToDstY(int srcY) const;
+
     typedef bool (*RowProc)(void* SK_RESTRICT dstRow,
                             const uint8_t* SK_RESTRICT src,
                             int width, int deltaSrc, int y,
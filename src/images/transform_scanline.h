@@ -16,6 +16,25 @@
 #include "SkPreConfig.h"
 #include "SkUnPreMultiply.h"
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2 && SK_A32_SHIFT == 24 && SK_G32_SHIFT == 8
+    #include <emmintrin.h>
+    #define SK_TRANSFORM_SCANLINE_SSE2
+
+/**
+ * Reorders four SkPMColors to R, G, B, A bytes in memory.
+ */
+static inline __m128i pmcolor_to_rgba_SSE2(__m128i c) {
+#if SK_R32_SHIFT == 0
+    return c;
+#else
+    const __m128i gaMask = _mm_set1_epi32(0xFF00FF00);
+    __m128i rb = _mm_andnot_si128(gaMask, c);
+    rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+    return _mm_or_si128(_mm_and_si128(c, gaMask), rb);
+#endif
+}
+#endif
+
 /**
  * Function template for transforming scanlines.
  * Transform 'width' pixels from 'src' buffer into 'dst' buffer,
@@ -55,7 +74,26 @@ static void transform_scanline_565(const char* SK_RESTRICT src, int width,
 static void transform_scanline_888(const char* SK_RESTRICT src, int width,
                                    char* SK_RESTRICT dst) {
     const SkPMColor* SK_RESTRICT srcP = (const SkPMColor*)src;
-    for (int i = 0; i < width; i++) {
+    int i = 0;
+#ifdef SK_TRANSFORM_SCANLINE_SSE2
+    // Four pixels become 12 bytes: pack the RGB of the two pixels in each
+    // 64 bit half into its low 6 bytes, then join the halves.
+    const __m128i lowMask = _mm_set_epi32(0, 0x00FFFFFF, 0, 0x00FFFFFF);
+    const __m128i highMask = _mm_set_epi32(0x0000FFFF, 0xFF000000, 0x0000FFFF, 0xFF000000);
+    for (; i + 4 <= width; i += 4) {
+        const __m128i rgba = pmcolor_to_rgba_SSE2(_mm_loadu_si128((const __m128i*)srcP));
+        const __m128i halves = _mm_or_si128(_mm_and_si128(rgba, lowMask),
+                                            _mm_and_si128(_mm_srli_epi64(rgba, 8), highMask));
+        const __m128i rgb = _mm_or_si128(_mm_move_epi64(halves),
+                                         _mm_slli_si128(_mm_srli_si128(halves, 8), 6));
+        _mm_storel_epi64((__m128i*)dst, rgb);
+        const int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(rgb, 8));
+        memcpy(dst + 8, &last, 4);
+        srcP += 4;
+        dst += 12;
+    }
+#endif
+    for (; i < width; i++) {
         SkPMColor c = *srcP++;
         *dst++ = SkGetPackedR32(c);
         *dst++ = SkGetPackedG32(c);
@@ -78,6 +116,29 @@ static void transform_scanline_444(const char* SK_RESTRICT src, int width,
     }
 }
 
+/**
+ * Unpremultiply one SkPMColor and write it as 4 bytes of RGBA.
+ */
+static inline void unpremultiply_to_rgba(SkPMColor c,
+                                         const SkUnPreMultiply::Scale* SK_RESTRICT table,
+                                         char* SK_RESTRICT dst) {
+    unsigned a = SkGetPackedA32(c);
+    unsigned r = SkGetPackedR32(c);
+    unsigned g = SkGetPackedG32(c);
+    unsigned b = SkGetPackedB32(c);
+
+    if (0 != a && 255 != a) {
+        SkUnPreMultiply::Scale scale = table[a];
+        r = SkUnPreMultiply::ApplyScale(scale, r);
+        g = SkUnPreMultiply::ApplyScale(scale, g);
+        b = SkUnPreMultiply::ApplyScale(scale, b);
+    }
+    dst[0] = r;
+    dst[1] = g;
+    dst[2] = b;
+    dst[3] = a;
+}
+
 /**
  * Transform from kARGB_8888_Config to 4-bytes-per-pixel RGBA.
  * (This would be the identity transformation, except for byte-order and
@@ -89,23 +150,28 @@ static void transform_scanline_8888(const char* SK_RESTRICT src, int width,
     const SkUnPreMultiply::Scale* SK_RESTRICT table =
                                               SkUnPreMultiply::GetScaleTable();
 
-    for (int i = 0; i < width; i++) {
-        SkPMColor c = *srcP++;
-        unsigned a = SkGetPackedA32(c);
-        unsigned r = SkGetPackedR32(c);
-        unsigned g = SkGetPackedG32(c);
-        unsigned b = SkGetPackedB32(c);
-
-        if (0 != a && 255 != a) {
-            SkUnPreMultiply::Scale scale = table[a];
-            r = SkUnPreMultiply::ApplyScale(scale, r);
-            g = SkUnPreMultiply::ApplyScale(scale, g);
-            b = SkUnPreMultiply::ApplyScale(scale, b);
+    int i = 0;
+#ifdef SK_TRANSFORM_SCANLINE_SSE2
+    // Opaque pixels only need their bytes reordered, so do that four at a
+    // time when all four are opaque, which is the common case.
+    const __m128i alphaMask = _mm_set1_epi32(SK_A32_MASK << SK_A32_SHIFT);
+    for (; i + 4 <= width; i += 4) {
+        const __m128i c = _mm_loadu_si128((const __m128i*)srcP);
+        const __m128i opaque = _mm_cmpeq_epi32(_mm_and_si128(c, alphaMask), alphaMask);
+        if (0xFFFF == _mm_movemask_epi8(opaque)) {
+            _mm_storeu_si128((__m128i*)dst, pmcolor_to_rgba_SSE2(c));
+        } else {
+            for (int j = 0; j < 4; j++) {
+                unpremultiply_to_rgba(srcP[j], table, dst + 4 * j);
+            }
         }
-        *dst++ = r;
-        *dst++ = g;
-        *dst++ = b;
-        *dst++ = a;
+        srcP += 4;
+        dst += 16;
+    }
+#endif
+    for (; i < width; i++) {
+        unpremultiply_to_rgba(*srcP++, table, dst);
+        dst += 4;
     }
 }
 
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkScaledBitmapSampler_opts_DEFINED
+#define SkScaledBitmapSampler_opts_DEFINED
+
+#include "SkColor.h"
+
+// Row procs that have platform-specific versions. Each of these reads its
+// source pixels contiguously (i.e. deltaSrc is the size of one source pixel)
+// and writes kN32_SkColorType.
+enum SkSampleRowProcType {
+    kGray_D8888_SkSampleRowProcType,
+    kRGB_D8888_SkSampleRowProcType,     // 3 bytes per src pixel
+    kRGBx_D8888_SkSampleRowProcType,    // 4 bytes per src pixel, 4th ignored
+    kRGBA_D8888_SkSampleRowProcType,
+    kRGBA_D8888_SkipZ_SkSampleRowProcType,
+    kRGBA_D8888_Unpremul_SkSampleRowProcType,
+};
+
+// Same signature as SkScaledBitmapSampler::RowProc.
+typedef bool (*SkSampleRowProc)(void* SK_RESTRICT dstRow,
+                                const uint8_t* SK_RESTRICT src,
+                                int width, int deltaSrc, int y,
+                                const SkPMColor[]);
+
+// Returns NULL if there is no platform-specific version.
+SkSampleRowProc SkSampleRowGetPlatformProc(SkSampleRowProcType type);
+
+#endif
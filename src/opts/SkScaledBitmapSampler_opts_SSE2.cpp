@@ -0,0 +1,178 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <emmintrin.h>
+#include "SkColorPriv.h"
+#include "SkScaledBitmapSampler_opts_SSE2.h"
+
+/* SSE2 versions of the SkScaledBitmapSampler row procs that convert to
+ * kN32_SkColorType. The portable versions are in
+ * src/images/SkScaledBitmapSampler.cpp. These assume that the source is read
+ * contiguously and that SkPMColor has alpha in the top byte and green in the
+ * second byte, which opts_check_x86.cpp checks before returning them.
+ */
+
+// Converts four pixels with bytes in R, G, B, A order in memory to SkPMColors.
+static inline __m128i rgba_to_pmcolor(__m128i rgba) {
+#if SK_R32_SHIFT == 0
+    return rgba;
+#else
+    // Swap red and blue.
+    const __m128i gaMask = _mm_set1_epi32(0xFF00FF00);
+    __m128i rb = _mm_andnot_si128(gaMask, rgba);
+    rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+    return _mm_or_si128(_mm_and_si128(rgba, gaMask), rb);
+#endif
+}
+
+// Computes SkMulDiv255Round on each 16 bit lane.
+static inline __m128i mul_div_255_round(__m128i x, __m128i y) {
+    __m128i prod = _mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+}
+
+// Premultiplies two pixels, unpacked to 16 bits per component.
+static inline __m128i premultiply_16(__m128i rgba) {
+    __m128i alpha = _mm_shufflelo_epi16(rgba, _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+    // Multiplying alpha by 255 leaves it unchanged.
+    alpha = _mm_or_si128(alpha, _mm_set_epi16(0xFF, 0, 0, 0, 0xFF, 0, 0, 0));
+    return mul_div_255_round(rgba, alpha);
+}
+
+// Premultiplies four pixels with bytes in R, G, B, A order, keeping that order.
+static inline __m128i premultiply(__m128i rgba) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = premultiply_16(_mm_unpacklo_epi8(rgba, zero));
+    __m128i hi = premultiply_16(_mm_unpackhi_epi8(rgba, zero));
+    return _mm_packus_epi16(lo, hi);
+}
+
+// Returns true if all of the alpha bytes in the accumulated pixels are 0xFF.
+static inline bool all_opaque(__m128i accum) {
+    const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(accum, _mm_set1_epi32(0xFFFFFFFF)));
+    return 0x8888 == (mask & 0x8888);
+}
+
+static const uint32_t kOpaqueMask = SK_A32_MASK << SK_A32_SHIFT;
+
+bool Sample_Gray_D8888_SSE2(void* SK_RESTRICT dstRow,
+                            const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(1 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    const __m128i opaque = _mm_set1_epi32(kOpaqueMask);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i gray = _mm_loadu_si128((const __m128i*)(src + x));
+        const __m128i lo = _mm_unpacklo_epi8(gray, gray);
+        const __m128i hi = _mm_unpackhi_epi8(gray, gray);
+        _mm_storeu_si128((__m128i*)(dst + x),
+                         _mm_or_si128(_mm_unpacklo_epi16(lo, lo), opaque));
+        _mm_storeu_si128((__m128i*)(dst + x + 4),
+                         _mm_or_si128(_mm_unpackhi_epi16(lo, lo), opaque));
+        _mm_storeu_si128((__m128i*)(dst + x + 8),
+                         _mm_or_si128(_mm_unpacklo_epi16(hi, hi), opaque));
+        _mm_storeu_si128((__m128i*)(dst + x + 12),
+                         _mm_or_si128(_mm_unpackhi_epi16(hi, hi), opaque));
+    }
+    for (; x < width; x++) {
+        dst[x] = SkPackARGB32(0xFF, src[x], src[x], src[x]);
+    }
+    return false;
+}
+
+bool Sample_RGBx_D8888_SSE2(void* SK_RESTRICT dstRow,
+                            const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(4 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    const __m128i opaque = _mm_set1_epi32(kOpaqueMask);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const __m128i rgba = _mm_loadu_si128((const __m128i*)(src + 4 * x));
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_or_si128(rgba_to_pmcolor(rgba), opaque));
+    }
+    for (; x < width; x++) {
+        const uint8_t* p = src + 4 * x;
+        dst[x] = SkPackARGB32(0xFF, p[0], p[1], p[2]);
+    }
+    return false;
+}
+
+bool Sample_RGBA_D8888_SSE2(void* SK_RESTRICT dstRow,
+                            const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(4 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    __m128i accum = _mm_set1_epi32(0xFFFFFFFF);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const __m128i rgba = _mm_loadu_si128((const __m128i*)(src + 4 * x));
+        accum = _mm_and_si128(accum, rgba);
+        _mm_storeu_si128((__m128i*)(dst + x), rgba_to_pmcolor(premultiply(rgba)));
+    }
+    unsigned alphaMask = all_opaque(accum) ? 0xFF : 0;
+    for (; x < width; x++) {
+        const uint8_t* p = src + 4 * x;
+        dst[x] = SkPreMultiplyARGB(p[3], p[0], p[1], p[2]);
+        alphaMask &= p[3];
+    }
+    return alphaMask != 0xFF;
+}
+
+bool Sample_RGBA_D8888_SkipZ_SSE2(void* SK_RESTRICT dstRow,
+                                  const uint8_t* SK_RESTRICT src,
+                                  int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(4 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    const __m128i zero = _mm_setzero_si128();
+    // Alpha is the top byte of each 32 bit lane of the source.
+    const __m128i srcAlphaMask = _mm_set1_epi32(0xFF000000);
+    __m128i accum = _mm_set1_epi32(0xFFFFFFFF);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const __m128i rgba = _mm_loadu_si128((const __m128i*)(src + 4 * x));
+        accum = _mm_and_si128(accum, rgba);
+        const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(rgba, srcAlphaMask), zero);
+        const __m128i old = _mm_loadu_si128((const __m128i*)(dst + x));
+        const __m128i pm = rgba_to_pmcolor(premultiply(rgba));
+        _mm_storeu_si128((__m128i*)(dst + x),
+                         _mm_or_si128(_mm_and_si128(transparent, old),
+                                      _mm_andnot_si128(transparent, pm)));
+    }
+    unsigned alphaMask = all_opaque(accum) ? 0xFF : 0;
+    for (; x < width; x++) {
+        const uint8_t* p = src + 4 * x;
+        if (0 != p[3]) {
+            dst[x] = SkPreMultiplyARGB(p[3], p[0], p[1], p[2]);
+        }
+        alphaMask &= p[3];
+    }
+    return alphaMask != 0xFF;
+}
+
+bool Sample_RGBA_D8888_Unpremul_SSE2(void* SK_RESTRICT dstRow,
+                                     const uint8_t* SK_RESTRICT src,
+                                     int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(4 == deltaSrc);
+    uint32_t* SK_RESTRICT dst = reinterpret_cast<uint32_t*>(dstRow);
+    __m128i accum = _mm_set1_epi32(0xFFFFFFFF);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const __m128i rgba = _mm_loadu_si128((const __m128i*)(src + 4 * x));
+        accum = _mm_and_si128(accum, rgba);
+        _mm_storeu_si128((__m128i*)(dst + x), rgba_to_pmcolor(rgba));
+    }
+    unsigned alphaMask = all_opaque(accum) ? 0xFF : 0;
+    for (; x < width; x++) {
+        const uint8_t* p = src + 4 * x;
+        dst[x] = SkPackARGB32NoCheck(p[3], p[0], p[1], p[2]);
+        alphaMask &= p[3];
+    }
+    return alphaMask != 0xFF;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkColorPriv.h"
+#include "SkScaledBitmapSampler_opts_SSSE3.h"
+
+/* See SkBitmapProcState_opts_SSSE3.cpp for why the Android framework gets a
+ * stub implementation.
+ */
+#if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+
+#include <tmmintrin.h>  // SSSE3
+
+// Byte indices into 16 bytes of RGB source for the 4 bytes of the i'th
+// SkPMColor. -128 has the high bit set, so pshufb writes zero there (alpha).
+#if SK_R32_SHIFT == 0
+    #define RGB_TO_PMCOLOR_INDICES(i)   3*i, 3*i + 1, 3*i + 2, -128
+#else
+    #define RGB_TO_PMCOLOR_INDICES(i)   3*i + 2, 3*i + 1, 3*i, -128
+#endif
+
+/* Converts RGB with 3 bytes per pixel, which is what libjpeg produces, to
+ * kN32_SkColorType. Reads 16 pixels (48 bytes) at a time, so it never reads
+ * past the end of the source row.
+ */
+bool Sample_RGB_D8888_SSSE3(void* SK_RESTRICT dstRow,
+                            const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(3 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    const __m128i shuffle = _mm_setr_epi8(RGB_TO_PMCOLOR_INDICES(0), RGB_TO_PMCOLOR_INDICES(1),
+                                          RGB_TO_PMCOLOR_INDICES(2), RGB_TO_PMCOLOR_INDICES(3));
+    const __m128i opaque = _mm_set1_epi32(SK_A32_MASK << SK_A32_SHIFT);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8_t* p = src + 3 * x;
+        const __m128i a = _mm_loadu_si128((const __m128i*)p);
+        const __m128i b = _mm_loadu_si128((const __m128i*)(p + 16));
+        const __m128i c = _mm_loadu_si128((const __m128i*)(p + 32));
+        // Bytes 0-11, 12-23, 24-35 and 36-47 hold 4 pixels each.
+        const __m128i p0 = a;
+        const __m128i p1 = _mm_alignr_epi8(b, a, 12);
+        const __m128i p2 = _mm_alignr_epi8(c, b, 8);
+        const __m128i p3 = _mm_srli_si128(c, 4);
+        _mm_storeu_si128((__m128i*)(dst + x),
+                         _mm_or_si128(_mm_shuffle_epi8(p0, shuffle), opaque));
+        _mm_storeu_si128((__m128i*)(dst + x + 4),
+                         _mm_or_si128(_mm_shuffle_epi8(p1, shuffle), opaque));
+        _mm_storeu_si128((__m128i*)(dst + x + 8),
+                         _mm_or_si128(_mm_shuffle_epi8(p2, shuffle), opaque));
+        _mm_storeu_si128((__m128i*)(dst + x + 12),
+                         _mm_or_si128(_mm_shuffle_epi8(p3, shuffle), opaque));
+    }
+    for (; x < width; x++) {
+        const uint8_t* p = src + 3 * x;
+        dst[x] = SkPackARGB32(0xFF, p[0], p[1], p[2]);
+    }
+    return false;
+}
+
+#undef RGB_TO_PMCOLOR_INDICES
+
+#else // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+
+bool Sample_RGB_D8888_SSSE3(void* SK_RESTRICT dstRow,
+                            const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    sk_throw();
+    return false;
+}
+
+#endif
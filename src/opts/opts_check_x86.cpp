@@ -16,6 +16,9 @@
 #include "SkMorphology_opts.h"
 #include "SkMorphology_opts_SSE2.h"
 #include "SkRTConf.h"
+#include "SkScaledBitmapSampler_opts.h"
+#include "SkScaledBitmapSampler_opts_SSE2.h"
+#include "SkScaledBitmapSampler_opts_SSSE3.h"
 #include "SkUtils.h"
 #include "SkUtils_opts_SSE2.h"
 #include "SkXfermode.h"
@@ -333,6 +336,36 @@ SkMorphologyImageFilter::Proc SkMorphologyGetPlatformProc(SkMorphologyProcType t
 
 ////////////////////////////////////////////////////////////////////////////////
 
+SkSampleRowProc SkSampleRowGetPlatformProc(SkSampleRowProcType type) {
+#if SK_A32_SHIFT != 24 || SK_G32_SHIFT != 8
+    // The optimized procs only handle swapping red and blue.
+    return NULL;
+#else
+    if (kRGB_D8888_SkSampleRowProcType == type) {
+        return supports_simd(SK_CPU_SSE_LEVEL_SSSE3) ? Sample_RGB_D8888_SSSE3 : NULL;
+    }
+    if (!supports_simd(SK_CPU_SSE_LEVEL_SSE2)) {
+        return NULL;
+    }
+    switch (type) {
+        case kGray_D8888_SkSampleRowProcType:
+            return Sample_Gray_D8888_SSE2;
+        case kRGBx_D8888_SkSampleRowProcType:
+            return Sample_RGBx_D8888_SSE2;
+        case kRGBA_D8888_SkSampleRowProcType:
+            return Sample_RGBA_D8888_SSE2;
+        case kRGBA_D8888_SkipZ_SkSampleRowProcType:
+            return Sample_RGBA_D8888_SkipZ_SSE2;
+        case kRGBA_D8888_Unpremul_SkSampleRowProcType:
+            return Sample_RGBA_D8888_Unpremul_SSE2;
+        default:
+            return NULL;
+    }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 bool SkBoxBlurGetPlatformProcs(SkBoxBlurProc* boxBlurX,
                                SkBoxBlurProc* boxBlurY,
                                SkBoxBlurProc* boxBlurXY,
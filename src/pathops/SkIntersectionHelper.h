@@ -68,6 +68,11 @@ public:
         fLast = contour->segments().count();
     }
 
+    void init(SkOpContour* contour, int index) {
+        this->init(contour);
+        fIndex = index;
+    }
+
     bool isAdjacent(const SkIntersectionHelper& next) {
         return fContour == next.fContour && fIndex + 1 == next.fIndex;
     }
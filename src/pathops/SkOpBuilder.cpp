@@ -0,0 +1,213 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#include "SkPath.h"
+#include "SkPathOps.h"
+#include "SkPathOpsBounds.h"
+#include "SkPathOpsCommon.h"
+
+void SkOpBuilder::add(const SkPath& path, SkPathOp op) {
+    fPaths.push_back(path);
+    *fOps.append() = op;
+}
+
+static bool any_inverse(const SkTArray<SkPath>& paths) {
+    for (int index = 0; index < paths.count(); ++index) {
+        if (paths[index].isInverseFillType()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void set_empty(SkPath* result) {
+    result->reset();
+    result->setFillType(SkPath::kEvenOdd_FillType);
+}
+
+// Combines the paths with an associative and commutative op in pairs, then the pairs in pairs,
+// and so on, so that each path takes part in log(count) operations, rather than in as many as
+// there are paths after it. The paths are overwritten; the result is the first.
+static bool reduce(SkTArray<SkPath>* paths, SkPathOp op) {
+    int count = paths->count();
+    SkASSERT(count > 0);
+    if (1 == count) {
+        return Simplify((*paths)[0], &(*paths)[0]);
+    }
+    while (count > 1) {
+        int reduced = 0;
+        for (int index = 0; index < count; index += 2) {
+            if (index + 1 < count) {
+                if (!Op((*paths)[index], (*paths)[index + 1], op, &(*paths)[reduced])) {
+                    return false;
+                }
+            } else if (reduced != index) {
+                (*paths)[reduced] = (*paths)[index];
+            }
+            ++reduced;
+        }
+        count = reduced;
+    }
+    return true;
+}
+
+// Groups the paths whose bounds overlap, directly or through other paths.
+static int find_clusters(const SkTArray<SkPath>& paths, SkTDArray<int>* clusters) {
+    const int count = paths.count();
+    SkAutoTArray<SkPathOpsBounds> bounds(count);
+    SkTDArray<const SkPathOpsBounds*> boundsPtrs;
+    boundsPtrs.setCount(count);
+    for (int index = 0; index < count; ++index) {
+        static_cast<SkRect&>(bounds[index]) = paths[index].getBounds();
+        boundsPtrs[index] = &bounds[index];
+    }
+    return GroupOverlappingBounds(boundsPtrs.begin(), count, clusters);
+}
+
+// Unions or exclusive ors the paths. Those that are apart from the others are combined only
+// with those that they overlap; the results are apart, so they are simply appended.
+static bool combine_apart(SkTArray<SkPath>* paths, SkPathOp op, SkPath* result) {
+    SkASSERT(kUnion_PathOp == op || kXOR_PathOp == op);
+    if (any_inverse(*paths)) {
+        if (!reduce(paths, op)) {
+            return false;
+        }
+        *result = (*paths)[0];
+        return true;
+    }
+    SkTDArray<int> clusters;
+    const int clusterCount = find_clusters(*paths, &clusters);
+    if (1 == clusterCount) {
+        if (!reduce(paths, op)) {
+            return false;
+        }
+        *result = (*paths)[0];
+        return true;
+    }
+    SkTArray<SkTArray<SkPath> > members(clusterCount);
+    members.push_back_n(clusterCount);
+    for (int index = 0; index < paths->count(); ++index) {
+        members[clusters[index]].push_back((*paths)[index]);
+    }
+    SkPath combined;
+    combined.setFillType(SkPath::kEvenOdd_FillType);
+    for (int cluster = 0; cluster < clusterCount; ++cluster) {
+        if (!reduce(&members[cluster], op)) {
+            return false;
+        }
+        combined.addPath(members[cluster][0]);
+    }
+    *result = combined;
+    return true;
+}
+
+// Intersects the paths. If they are not inverse filled, the result is empty unless all their
+// bounds overlap.
+static bool intersect_all(SkTArray<SkPath>* paths, SkPath* result) {
+    if (!any_inverse(*paths)) {
+        SkPathOpsBounds common;
+        static_cast<SkRect&>(common) = (*paths)[0].getBounds();
+        for (int index = 1; index < paths->count(); ++index) {
+            SkPathOpsBounds bounds;
+            static_cast<SkRect&>(bounds) = (*paths)[index].getBounds();
+            if (!SkPathOpsBounds::Intersects(common, bounds)) {
+                set_empty(result);
+                return true;
+            }
+            common.fLeft = SkTMax(common.fLeft, bounds.fLeft);
+            common.fTop = SkTMax(common.fTop, bounds.fTop);
+            common.fRight = SkTMin(common.fRight, bounds.fRight);
+            common.fBottom = SkTMin(common.fBottom, bounds.fBottom);
+        }
+    }
+    if (!reduce(paths, kIntersect_PathOp)) {
+        return false;
+    }
+    *result = (*paths)[0];
+    return true;
+}
+
+// Subtracts the union of the subtrahends, leaving out those that are apart from the minuend.
+static bool subtract_all(const SkPath& minuend, const SkPath subtrahends[], int count,
+                         SkPath* result) {
+    SkTArray<SkPath> overlapping;
+    SkPathOpsBounds bounds;
+    static_cast<SkRect&>(bounds) = minuend.getBounds();
+    for (int index = 0; index < count; ++index) {
+        const SkPath& subtrahend = subtrahends[index];
+        if (!minuend.isInverseFillType() && !subtrahend.isInverseFillType()) {
+            SkPathOpsBounds subBounds;
+            static_cast<SkRect&>(subBounds) = subtrahend.getBounds();
+            if (!SkPathOpsBounds::Intersects(bounds, subBounds)) {
+                continue;
+            }
+        }
+        overlapping.push_back(subtrahend);
+    }
+    if (0 == overlapping.count()) {
+        return Simplify(minuend, result);
+    }
+    SkPath subtrahend;
+    if (!combine_apart(&overlapping, kUnion_PathOp, &subtrahend)) {
+        return false;
+    }
+    return Op(minuend, subtrahend, kDifference_PathOp, result);
+}
+
+bool SkOpBuilder::resolve(SkPath* result) {
+    const int count = fPaths.count();
+    SkPath sum;
+    bool success = true;
+    if (0 == count) {
+        set_empty(&sum);
+    } else if (1 == count) {
+        success = Simplify(fPaths[0], &sum);
+    } else {
+        sum = fPaths[0];
+    }
+    // Runs of the same operator are combined at once: unions, intersections and exclusive ors
+    // of the sum so far and the run's paths, or the sum less the union of the run's paths.
+    int index = 1;
+    while (success && index < count) {
+        const SkPathOp op = fOps[index];
+        int end = index + 1;
+        if (kReverseDifference_PathOp != op) {
+            while (end < count && fOps[end] == op) {
+                ++end;
+            }
+        }
+        switch (op) {
+            case kUnion_PathOp:
+            case kXOR_PathOp:
+            case kIntersect_PathOp: {
+                SkTArray<SkPath> operands(end - index + 1);
+                operands.push_back(sum);
+                for (int operand = index; operand < end; ++operand) {
+                    operands.push_back(fPaths[operand]);
+                }
+                success = kIntersect_PathOp == op ? intersect_all(&operands, &sum)
+                        : combine_apart(&operands, op, &sum);
+                break;
+            }
+            case kDifference_PathOp:
+                success = subtract_all(sum, &fPaths[index], end - index, &sum);
+                break;
+            case kReverseDifference_PathOp:
+                success = Op(sum, fPaths[index], kReverseDifference_PathOp, &sum);
+                break;
+            default:
+                SkASSERT(0);
+                success = false;
+        }
+        index = end;
+    }
+    fPaths.reset();
+    fOps.reset();
+    if (success) {
+        *result = sum;
+    }
+    return success;
+}
@@ -8,6 +8,7 @@
 #include "SkOpEdgeBuilder.h"
 #include "SkPathOpsCommon.h"
 #include "SkPathWriter.h"
+#include "SkThreadPool.h"
 #include "SkTSort.h"
 
 static int contourRangeCheckY(const SkTArray<SkOpContour*, true>& contourList, SkOpSegment** currentPtr,
@@ -691,3 +692,153 @@ bool HandleCoincidence(SkTArray<SkOpContour*, true>* contourList, int total) {
 #endif
     return true;
 }
+
+namespace {
+
+struct GroupBounds {
+    const SkPathOpsBounds* fBounds;
+    int fIndex;
+
+    bool operator<(const GroupBounds& rh) const {
+        return fBounds->fLeft < rh.fBounds->fLeft;
+    }
+};
+
+}  // namespace
+
+static int findRoot(SkTDArray<int>& parents, int index) {
+    while (parents[index] != index) {
+        parents[index] = parents[parents[index]];
+        index = parents[index];
+    }
+    return index;
+}
+
+// The bounds are swept from left to right, and each is only tested against those that reach
+// past its left edge.
+int GroupOverlappingBounds(const SkPathOpsBounds* const bounds[], int count,
+                           SkTDArray<int>* groups) {
+    SkTDArray<GroupBounds> sorted;
+    sorted.setCount(count);
+    SkTDArray<int> parents;
+    parents.setCount(count);
+    for (int index = 0; index < count; ++index) {
+        sorted[index].fBounds = bounds[index];
+        sorted[index].fIndex = index;
+        parents[index] = index;
+    }
+    if (count > 1) {
+        SkTQSort<GroupBounds>(sorted.begin(), sorted.end() - 1);
+    }
+    SkTDArray<const GroupBounds*> active;
+    for (int index = 0; index < count; ++index) {
+        const GroupBounds& entry = sorted[index];
+        int kept = 0;
+        for (int activeIndex = 0; activeIndex < active.count(); ++activeIndex) {
+            const GroupBounds* other = active[activeIndex];
+            // lefts are ascending, so bounds that end before this one starts end before the
+            // rest do too
+            if (!AlmostLessOrEqualUlps(entry.fBounds->fLeft, other->fBounds->fRight)) {
+                continue;
+            }
+            active[kept++] = other;
+            if (SkPathOpsBounds::Intersects(*entry.fBounds, *other->fBounds)) {
+                int root = findRoot(parents, entry.fIndex);
+                int otherRoot = findRoot(parents, other->fIndex);
+                parents[SkMax32(root, otherRoot)] = SkMin32(root, otherRoot);
+            }
+        }
+        active.setCount(kept);
+        *active.append() = &entry;
+    }
+    SkTDArray<int> rootGroup;
+    rootGroup.setCount(count);
+    groups->setCount(count);
+    int groupCount = 0;
+    for (int index = 0; index < count; ++index) {
+        int root = findRoot(parents, index);
+        // a root is the smallest index of its group, so it is seen first
+        if (root == index) {
+            rootGroup[index] = groupCount++;
+        }
+        (*groups)[index] = rootGroup[root];
+    }
+    return groupCount;
+}
+
+namespace {
+
+// Resolves one group of contours. No contour of a group can cross or enclose a contour of
+// another, so the groups can be resolved in parallel.
+class ComponentProc : public SkRunnable {
+public:
+    ComponentProc() : fResolver(NULL), fSuccess(false) {}
+
+    virtual void run() SK_OVERRIDE {
+        fSuccess = fResolver->resolve(fContourList, &fResult);
+    }
+
+    const SkOpContourResolver* fResolver;
+    SkTArray<SkOpContour*, true> fContourList;
+    SkPath fResult;
+    bool fSuccess;
+};
+
+}  // namespace
+
+// Fewer contours are resolved together, which costs less than grouping them.
+static const int kMinComponentContours = 16;
+
+bool ResolveContourComponents(SkTArray<SkOpContour*, true>& contourList,
+                              const SkOpContourResolver& resolver, int threadCount,
+                              SkPath* result) {
+    const int count = contourList.count();
+    if (count < kMinComponentContours) {
+        return resolver.resolve(contourList, result);
+    }
+    SkTDArray<const SkPathOpsBounds*> bounds;
+    bounds.setCount(count);
+    for (int index = 0; index < count; ++index) {
+        bounds[index] = &contourList[index]->bounds();
+    }
+    SkTDArray<int> groups;
+    const int groupCount = GroupOverlappingBounds(bounds.begin(), count, &groups);
+    if (groupCount < 2) {
+        return resolver.resolve(contourList, result);
+    }
+    SkAutoTArray<ComponentProc> procs(groupCount);
+    for (int index = 0; index < count; ++index) {
+        // each group's list stays sorted by top
+        procs[groups[index]].fContourList.push_back(contourList[index]);
+    }
+    for (int index = 0; index < groupCount; ++index) {
+        procs[index].fResolver = &resolver;
+    }
+    if (threadCount < 0) {
+        threadCount = num_cores();
+    }
+    threadCount = SkMin32(threadCount, groupCount);
+    if (threadCount < 2) {
+        for (int index = 0; index < groupCount; ++index) {
+            procs[index].run();
+        }
+    } else {
+        SkThreadPool pool(threadCount);
+        for (int index = 0; index < groupCount; ++index) {
+            pool.add(&procs[index]);
+        }
+        pool.wait();
+    }
+    // The results are appended in the order of the groups, so that the output does not depend
+    // on which group finished first.
+    SkPath::FillType fillType = result->getFillType();
+    result->reset();
+    for (int index = 0; index < groupCount; ++index) {
+        if (!procs[index].fSuccess) {
+            return false;
+        }
+        result->addPath(procs[index].fResult);
+    }
+    result->setFillType(fillType);
+    return true;
+}
@@ -13,6 +13,13 @@
 
 class SkPathWriter;
 
+// Intersects a list of contours sorted by their tops, and writes the path that they resolve to.
+class SkOpContourResolver {
+public:
+    virtual ~SkOpContourResolver() {}
+    virtual bool resolve(SkTArray<SkOpContour*, true>& contourList, SkPath* result) const = 0;
+};
+
 void Assemble(const SkPathWriter& path, SkPathWriter* simple);
 // FIXME: find chase uses insert, so it can't be converted to SkTArray yet
 SkOpSegment* FindChase(SkTDArray<SkOpSpan*>* chase, int* tIndex, int* endIndex);
@@ -23,6 +30,15 @@ SkOpSegment* FindUndone(SkTArray<SkOpContour*, true>& contourList, int* start, i
 void MakeContourList(SkTArray<SkOpContour>& contours, SkTArray<SkOpContour*, true>& list,
                      bool evenOdd, bool oppEvenOdd);
 bool HandleCoincidence(SkTArray<SkOpContour*, true>* , int );
+// Numbers the groups of bounds that overlap, directly or through other bounds, in the order of
+// their first member: groups[i] is the group of bounds[i]. Returns the number of groups.
+int GroupOverlappingBounds(const SkPathOpsBounds* const bounds[], int count,
+                           SkTDArray<int>* groups);
+// Resolves the groups of contours that are apart from each other separately, on up to threadCount
+// threads (one per core if negative), and appends their results in the order of their first
+// contours.
+bool ResolveContourComponents(SkTArray<SkOpContour*, true>& contourList,
+                              const SkOpContourResolver& , int threadCount, SkPath* result);
 
 #if DEBUG_ACTIVE_SPANS || DEBUG_ACTIVE_SPANS_FIRST_ONLY
 void DebugShowActiveSpans(SkTArray<SkOpContour*, true>& contourList);
@@ -231,7 +231,70 @@ static const bool gOutInverse[kReverseDifference_PathOp + 1][2][2] = {
     {{ false, true }, { false, false }},  // rev diff
 };
 
-bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result) {
+namespace {
+
+class OpResolver : public SkOpContourResolver {
+public:
+    OpResolver(SkPathOp op, int xorMask, int xorOpMask, SkPath::FillType fillType)
+        : fOp(op)
+        , fXorMask(xorMask)
+        , fXorOpMask(xorOpMask)
+        , fFillType(fillType) {
+    }
+
+    virtual bool resolve(SkTArray<SkOpContour*, true>& contourList,
+                         SkPath* result) const SK_OVERRIDE {
+        result->reset();
+        result->setFillType(fFillType);
+        SkOpContour** currentPtr = contourList.begin();
+        SkOpContour** listEnd = contourList.end();
+        // find all intersections between segments
+        do {
+            SkOpContour** nextPtr = currentPtr;
+            SkOpContour* current = *currentPtr++;
+            if (current->containsCubics()) {
+                AddSelfIntersectTs(current);
+            }
+            SkOpContour* next;
+            do {
+                next = *nextPtr++;
+            } while (AddIntersectTs(current, next) && nextPtr != listEnd);
+        } while (currentPtr != listEnd);
+        // eat through coincident edges
+
+        int total = 0;
+        int index;
+        for (index = 0; index < contourList.count(); ++index) {
+            total += contourList[index]->segments().count();
+        }
+        if (!HandleCoincidence(&contourList, total)) {
+            return false;
+        }
+        // construct closed contours
+        SkPathWriter wrapper(*result);
+        bridgeOp(contourList, fOp, fXorMask, fXorOpMask, &wrapper);
+        {  // if some edges could not be resolved, assemble remaining fragments
+            SkPath temp;
+            temp.setFillType(fFillType);
+            SkPathWriter assembled(temp);
+            Assemble(wrapper, &assembled);
+            *result = *assembled.nativePath();
+            result->setFillType(fFillType);
+        }
+        return true;
+    }
+
+private:
+    const SkPathOp fOp;
+    const int fXorMask;
+    const int fXorOpMask;
+    const SkPath::FillType fFillType;
+};
+
+}  // namespace
+
+bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result,
+        int threadCount) {
 #if DEBUG_SHOW_TEST_NAME
     char* debugName = DEBUG_FILENAME_STRING;
     if (debugName && debugName[0]) {
@@ -267,43 +330,9 @@ bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result) {
     SkTArray<SkOpContour*, true> contourList;
     MakeContourList(contours, contourList, xorMask == kEvenOdd_PathOpsMask,
             xorOpMask == kEvenOdd_PathOpsMask);
-    SkOpContour** currentPtr = contourList.begin();
-    if (!currentPtr) {
+    if (contourList.empty()) {
         return true;
     }
-    SkOpContour** listEnd = contourList.end();
-    // find all intersections between segments
-    do {
-        SkOpContour** nextPtr = currentPtr;
-        SkOpContour* current = *currentPtr++;
-        if (current->containsCubics()) {
-            AddSelfIntersectTs(current);
-        }
-        SkOpContour* next;
-        do {
-            next = *nextPtr++;
-        } while (AddIntersectTs(current, next) && nextPtr != listEnd);
-    } while (currentPtr != listEnd);
-    // eat through coincident edges
-
-    int total = 0;
-    int index;
-    for (index = 0; index < contourList.count(); ++index) {
-        total += contourList[index]->segments().count();
-    }
-    if (!HandleCoincidence(&contourList, total)) {
-        return false;
-    }
-    // construct closed contours
-    SkPathWriter wrapper(*result);
-    bridgeOp(contourList, op, xorMask, xorOpMask, &wrapper);
-    {  // if some edges could not be resolved, assemble remaining fragments
-        SkPath temp;
-        temp.setFillType(fillType);
-        SkPathWriter assembled(temp);
-        Assemble(wrapper, &assembled);
-        *result = *assembled.nativePath();
-        result->setFillType(fillType);
-    }
-    return true;
+    OpResolver resolver(op, xorMask, xorOpMask, fillType);
+    return ResolveContourComponents(contourList, resolver, threadCount, result);
 }
@@ -150,8 +150,60 @@ static bool bridgeXor(SkTArray<SkOpContour*, true>& contourList, SkPathWriter* s
     return closable;
 }
 
+namespace {
+
+class SimplifyResolver : public SkOpContourResolver {
+public:
+    SimplifyResolver(int xorMask, SkPath::FillType fillType)
+        : fXorMask(xorMask)
+        , fFillType(fillType) {
+    }
+
+    virtual bool resolve(SkTArray<SkOpContour*, true>& contourList,
+                         SkPath* result) const SK_OVERRIDE {
+        result->reset();
+        result->setFillType(fFillType);
+        SkOpContour** currentPtr = contourList.begin();
+        SkOpContour** listEnd = contourList.end();
+        // find all intersections between segments
+        do {
+            SkOpContour** nextPtr = currentPtr;
+            SkOpContour* current = *currentPtr++;
+            if (current->containsCubics()) {
+                AddSelfIntersectTs(current);
+            }
+            SkOpContour* next;
+            do {
+                next = *nextPtr++;
+            } while (AddIntersectTs(current, next) && nextPtr != listEnd);
+        } while (currentPtr != listEnd);
+        if (!HandleCoincidence(&contourList, 0)) {
+            return false;
+        }
+        // construct closed contours
+        SkPathWriter simple(*result);
+        if (fXorMask == kWinding_PathOpsMask ? bridgeWinding(contourList, &simple)
+                    : !bridgeXor(contourList, &simple))
+        {  // if some edges could not be resolved, assemble remaining fragments
+            SkPath temp;
+            temp.setFillType(fFillType);
+            SkPathWriter assembled(temp);
+            Assemble(simple, &assembled);
+            *result = *assembled.nativePath();
+            result->setFillType(fFillType);
+        }
+        return true;
+    }
+
+private:
+    const int fXorMask;
+    const SkPath::FillType fFillType;
+};
+
+}  // namespace
+
 // FIXME : add this as a member of SkPath
-bool Simplify(const SkPath& path, SkPath* result) {
+bool Simplify(const SkPath& path, SkPath* result, int threadCount) {
 #if DEBUG_SORT || DEBUG_SWAP_TOP
     SkPathOpsDebug::gSortCount = SkPathOpsDebug::gSortCountDefault;
 #endif
@@ -167,39 +219,11 @@ bool Simplify(const SkPath& path, SkPath* result) {
     }
     SkTArray<SkOpContour*, true> contourList;
     MakeContourList(contours, contourList, false, false);
-    SkOpContour** currentPtr = contourList.begin();
     result->reset();
     result->setFillType(fillType);
-    if (!currentPtr) {
+    if (contourList.empty()) {
         return true;
     }
-    SkOpContour** listEnd = contourList.end();
-    // find all intersections between segments
-    do {
-        SkOpContour** nextPtr = currentPtr;
-        SkOpContour* current = *currentPtr++;
-        if (current->containsCubics()) {
-            AddSelfIntersectTs(current);
-        }
-        SkOpContour* next;
-        do {
-            next = *nextPtr++;
-        } while (AddIntersectTs(current, next) && nextPtr != listEnd);
-    } while (currentPtr != listEnd);
-    if (!HandleCoincidence(&contourList, 0)) {
-        return false;
-    }
-    // construct closed contours
-    SkPathWriter simple(*result);
-    if (builder.xorMask() == kWinding_PathOpsMask ? bridgeWinding(contourList, &simple)
-                : !bridgeXor(contourList, &simple))
-    {  // if some edges could not be resolved, assemble remaining fragments
-        SkPath temp;
-        temp.setFillType(fillType);
-        SkPathWriter assembled(temp);
-        Assemble(simple, &assembled);
-        *result = *assembled.nativePath();
-        result->setFillType(fillType);
-    }
-    return true;
+    SimplifyResolver resolver(builder.xorMask(), fillType);
+    return ResolveContourComponents(contourList, resolver, threadCount, result);
 }
@@ -14,6 +14,8 @@
 #include "SkPDFPage.h"
 #include "SkPDFTypes.h"
 #include "SkStream.h"
+#include "SkTemplates.h"
+#include "SkThreadPool.h"
 #include "SkTSet.h"
 
 static void addResourcesToCatalog(bool firstPage,
@@ -24,6 +26,25 @@ static void addResourcesToCatalog(bool firstPage,
     }
 }
 
+namespace {
+
+// Subsets one font of the document. Building a subset reads the font's tables
+// and computes its glyph widths, which is slow for large fonts, so the fonts
+// are subset in parallel.
+class FontSubsetProc : public SkRunnable {
+public:
+    FontSubsetProc() : fEntry(NULL), fSubset(NULL) {}
+
+    virtual void run() SK_OVERRIDE {
+        fSubset = fEntry->fFont->getFontSubset(fEntry->fGlyphSet);
+    }
+
+    const SkPDFGlyphSetMap::FontGlyphSetPair* fEntry;
+    SkPDFFont* fSubset;
+};
+
+}  // namespace
+
 static void perform_font_subsetting(SkPDFCatalog* catalog,
                                     const SkTDArray<SkPDFPage*>& pages,
                                     SkTDArray<SkPDFObject*>* substitutes) {
@@ -34,17 +55,39 @@ static void perform_font_subsetting(SkPDFCatalog* catalog,
     for (int i = 0; i < pages.count(); ++i) {
         usage.merge(pages[i]->getFontGlyphUsage());
     }
+    SkTDArray<const SkPDFGlyphSetMap::FontGlyphSetPair*> entries;
     SkPDFGlyphSetMap::F2BIter iterator(usage);
     const SkPDFGlyphSetMap::FontGlyphSetPair* entry = iterator.next();
     while (entry) {
-        SkPDFFont* subsetFont =
-            entry->fFont->getFontSubset(entry->fGlyphSet);
-        if (subsetFont) {
-            catalog->setSubstitute(entry->fFont, subsetFont);
-            substitutes->push(subsetFont);  // Transfer ownership to substitutes
-        }
+        entries.push(entry);
         entry = iterator.next();
     }
+
+    SkAutoTArray<FontSubsetProc> procs(entries.count());
+    for (int i = 0; i < entries.count(); ++i) {
+        procs[i].fEntry = entries[i];
+    }
+    const int threadCount = SkMin32(num_cores(), entries.count());
+    if (threadCount < 2) {
+        for (int i = 0; i < entries.count(); ++i) {
+            procs[i].run();
+        }
+    } else {
+        SkThreadPool pool(threadCount);
+        for (int i = 0; i < entries.count(); ++i) {
+            pool.add(&procs[i]);
+        }
+        pool.wait();
+    }
+
+    // The substitutes are made in the order of the fonts, so that the output
+    // does not depend on which subset finished first.
+    for (int i = 0; i < entries.count(); ++i) {
+        if (procs[i].fSubset) {
+            catalog->setSubstitute(entries[i]->fFont, procs[i].fSubset);
+            substitutes->push(procs[i].fSubset);  // Transfer ownership to substitutes
+        }
+    }
 }
 
 SkPDFDocument::SkPDFDocument(Flags flags)
@@ -10,6 +10,7 @@
 #include "SkData.h"
 #include "SkFontHost.h"
 #include "SkGlyphCache.h"
+#include "SkLazyPtr.h"
 #include "SkPaint.h"
 #include "SkPDFCatalog.h"
 #include "SkPDFDevice.h"
@@ -21,6 +22,7 @@
 #include "SkRefCnt.h"
 #include "SkScalar.h"
 #include "SkStream.h"
+#include "SkTypefaceLRUCache.h"
 #include "SkTypefacePriv.h"
 #include "SkTypes.h"
 #include "SkUtils.h"
@@ -827,16 +829,14 @@ SkPDFFont* SkPDFFont::GetFontResource(SkTypeface* typeface, uint16_t glyphID) {
         info = SkTBitOr<SkAdvancedTypefaceMetrics::PerGlyphInfo>(
                   info, SkAdvancedTypefaceMetrics::kHAdvance_PerGlyphInfo);
 #endif
-        fontMetrics.reset(
-            typeface->getAdvancedTypefaceMetrics(info, NULL, 0));
+        fontMetrics.reset(GetTypefaceMetrics(typeface, info));
 #if defined (SK_SFNTLY_SUBSETTER)
         if (fontMetrics.get() &&
             fontMetrics->fType != SkAdvancedTypefaceMetrics::kTrueType_Font) {
             // Font does not support subsetting, get new info with advance.
             info = SkTBitOr<SkAdvancedTypefaceMetrics::PerGlyphInfo>(
                       info, SkAdvancedTypefaceMetrics::kHAdvance_PerGlyphInfo);
-            fontMetrics.reset(
-                typeface->getAdvancedTypefaceMetrics(info, NULL, 0));
+            fontMetrics.reset(GetTypefaceMetrics(typeface, info));
         }
 #endif
     }
@@ -848,6 +848,43 @@ SkPDFFont* SkPDFFont::GetFontResource(SkTypeface* typeface, uint16_t glyphID) {
     return font;  // Return the reference new SkPDFFont() created.
 }
 
+namespace {
+
+// Identifies the metrics of a typeface with some per glyph info.
+struct TypefaceMetricsKey {
+    uint32_t fFontID;
+    SkAdvancedTypefaceMetrics::PerGlyphInfo fInfo;
+
+    bool operator==(const TypefaceMetricsKey& other) const {
+        return fFontID == other.fFontID && fInfo == other.fInfo;
+    }
+};
+
+// With per glyph info the metrics take a lot of memory for large fonts, so
+// only a few are kept.
+typedef SkTypefaceLRUCache<TypefaceMetricsKey, SkAdvancedTypefaceMetrics, 16>
+        TypefaceMetricsCache;
+
+}  // namespace
+
+// static
+SkAdvancedTypefaceMetrics* SkPDFFont::GetTypefaceMetrics(
+        SkTypeface* typeface,
+        SkAdvancedTypefaceMetrics::PerGlyphInfo info) {
+    SK_DECLARE_STATIC_LAZY_PTR(TypefaceMetricsCache, cache);
+    SkAutoResolveDefaultTypeface autoResolve(typeface);
+    typeface = autoResolve.get();
+
+    const TypefaceMetricsKey key = { typeface->uniqueID(), info };
+    SkAdvancedTypefaceMetrics* metrics;
+    if (!cache.get()->find(key, &metrics)) {
+        SkAutoTUnref<SkAdvancedTypefaceMetrics> computed(
+                typeface->getAdvancedTypefaceMetrics(info, NULL, 0));
+        metrics = cache.get()->add(key, computed);
+    }
+    return metrics;
+}
+
 SkPDFFont* SkPDFFont::getFontSubset(const SkPDFGlyphSet*) {
     return NULL;  // Default: no support.
 }
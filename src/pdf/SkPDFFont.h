@@ -124,6 +124,16 @@ public:
     static SkPDFFont* GetFontResource(SkTypeface* typeface,
                                              uint16_t glyphID);
 
+    /** Returns the metrics of the whole typeface with the passed per glyph
+     *  info. They are the same for every document, and slow to compute for
+     *  large fonts, so those of the most recently used typefaces are kept for
+     *  the life of the process. The caller owns a reference to the result,
+     *  which is NULL if the typeface has no metrics.
+     */
+    static SkAdvancedTypefaceMetrics* GetTypefaceMetrics(
+            SkTypeface* typeface,
+            SkAdvancedTypefaceMetrics::PerGlyphInfo info);
+
     /** Subset the font based on usage set. Returns a SkPDFFont instance with
      *  subset.
      *  @param usage  Glyph subset requested.
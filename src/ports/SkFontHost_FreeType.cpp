@@ -16,6 +16,7 @@
 #include "SkFontHost.h"
 #include "SkFontHost_FreeType_common.h"
 #include "SkGlyph.h"
+#include "SkGlyphAdvanceTable.h"
 #include "SkMask.h"
 #include "SkMaskGamma.h"
 #include "SkMatrix22.h"
@@ -98,9 +99,10 @@ static bool isLCD(const SkScalerContext::Rec& rec) {
 
 struct SkFaceRec;
 
+// gFTMutex guards the list of faces and their reference counts, and the LCD
+// globals. Each face has its own FT_Library and mutex, so that glyphs of
+// different faces are generated concurrently.
 SK_DECLARE_STATIC_MUTEX(gFTMutex);
-static int          gFTCount;
-static FT_Library   gFTLibrary;
 static SkFaceRec*   gFaceRecHead;
 static bool         gLCDSupportValid;  // true iff |gLCDSupport| has been set.
 static bool         gLCDSupport;  // true iff LCD is supported by the runtime.
@@ -118,8 +120,8 @@ static int          gLCDExtra;  // number of extra pixels for filtering.
 typedef FT_Error (*FT_Library_SetLcdFilterWeightsProc)(FT_Library, unsigned char*);
 
 // Caller must lock gFTMutex before calling this function.
-static bool InitFreetype() {
-    FT_Error err = FT_Init_FreeType(&gFTLibrary);
+static bool InitFreetype(FT_Library* library) {
+    FT_Error err = FT_Init_FreeType(library);
     if (err) {
         return false;
     }
@@ -128,7 +130,7 @@ static bool InitFreetype() {
 #ifdef FT_LCD_FILTER_H
     // Use default { 0x10, 0x40, 0x70, 0x40, 0x10 }, as it adds up to 0x110, simulating ink spread.
     // SetLcdFilter must be called before SetLcdFilterWeights.
-    err = FT_Library_SetLcdFilter(gFTLibrary, FT_LCD_FILTER_DEFAULT);
+    err = FT_Library_SetLcdFilter(*library, FT_LCD_FILTER_DEFAULT);
     if (0 == err) {
         gLCDSupport = true;
         gLCDExtra = 2; //Using a filter adds one full pixel to each side.
@@ -139,7 +141,7 @@ static bool InitFreetype() {
 
 #if defined(SK_FONTHOST_FREETYPE_RUNTIME_VERSION) && \
             SK_FONTHOST_FREETYPE_RUNTIME_VERSION > 0x020400
-        err = FT_Library_SetLcdFilterWeights(gFTLibrary, gGaussianLikeHeavyWeights);
+        err = FT_Library_SetLcdFilterWeights(*library, gGaussianLikeHeavyWeights);
 #elif defined(SK_CAN_USE_DLOPEN) && SK_CAN_USE_DLOPEN == 1
         //The FreeType library is already loaded, so symbols are available in process.
         void* self = dlopen(NULL, RTLD_LAZY);
@@ -150,7 +152,7 @@ static bool InitFreetype() {
             dlclose(self);
 
             if (NULL != setLcdFilterWeights) {
-                err = setLcdFilterWeights(gFTLibrary, gGaussianLikeHeavyWeights);
+                err = setLcdFilterWeights(*library, gGaussianLikeHeavyWeights);
             }
         }
 #endif
@@ -168,8 +170,10 @@ static bool InitFreetype() {
 static void determine_lcd_support(bool* lcdSupported) {
     if (!gLCDSupportValid) {
         // This will determine LCD support as a side effect.
-        InitFreetype();
-        FT_Done_FreeType(gFTLibrary);
+        FT_Library library;
+        if (InitFreetype(&library)) {
+            FT_Done_FreeType(library);
+        }
     }
     SkASSERT(gLCDSupportValid);
     *lcdSupported = gLCDSupport;
@@ -205,7 +209,7 @@ protected:
     virtual SkUnichar generateGlyphToChar(uint16_t glyph) SK_OVERRIDE;
 
 private:
-    SkFaceRec*  fFaceRec;
+    SkFaceRec*  fFaceRec;           // lock fFaceRec->fMutex to use fFace or fFTSize
     FT_Face     fFace;              // reference to shared face in gFaceRecHead
     FT_Size     fFTSize;            // our own copy
     FT_Int      fStrikeIndex;
@@ -223,9 +227,9 @@ private:
     void getBBoxForCurrentGlyph(SkGlyph* glyph, FT_BBox* bbox,
                                 bool snapToPixelBoundary = false);
     bool getCBoxForLetter(char letter, FT_BBox* bbox);
-    // Caller must lock gFTMutex before calling this function.
+    // Caller must lock fFaceRec->fMutex before calling this function.
     void updateGlyphIfLCD(SkGlyph* glyph);
-    // Caller must lock gFTMutex before calling this function.
+    // Caller must lock fFaceRec->fMutex before calling this function.
     // update FreeType2 glyph slot with glyph emboldened
     void emboldenIfNeeded(FT_Face face, FT_GlyphSlot glyph);
 };
@@ -235,15 +239,25 @@ private:
 
 struct SkFaceRec {
     SkFaceRec*      fNext;
+    // FreeType allows different faces to be used on different threads only
+    // if they belong to different libraries (the rasterizer's memory pool,
+    // for one, belongs to the library), so each face gets its own.
+    FT_Library      fLibrary;
     FT_Face         fFace;
     FT_StreamRec    fFTStream;
     SkStream*       fSkStream;
-    uint32_t        fRefCnt;
+    uint32_t        fRefCnt;    // guarded by gFTMutex
     uint32_t        fFontID;
+    // Guards fFace, its glyph slot and its sizes. Scaler contexts for
+    // different sizes of the same face share it.
+    SkMutex         fMutex;
 
     // assumes ownership of the stream, will call unref() when its done
     SkFaceRec(SkStream* strm, uint32_t fontID);
     ~SkFaceRec() {
+        if (NULL != fLibrary) {
+            FT_Done_FreeType(fLibrary);
+        }
         fSkStream->unref();
     }
 };
@@ -280,7 +294,8 @@ extern "C" {
 }
 
 SkFaceRec::SkFaceRec(SkStream* strm, uint32_t fontID)
-        : fNext(NULL), fSkStream(strm), fRefCnt(1), fFontID(fontID) {
+        : fNext(NULL), fLibrary(NULL), fFace(NULL), fSkStream(strm), fRefCnt(1)
+        , fFontID(fontID) {
 //    SkDEBUGF(("SkFaceRec: opening %s (%p)\n", key.c_str(), strm));
 
     sk_bzero(&fFTStream, sizeof(fFTStream));
@@ -312,6 +327,10 @@ static SkFaceRec* ref_ft_face(const SkTypeface* typeface) {
 
     // this passes ownership of strm to the rec
     rec = SkNEW_ARGS(SkFaceRec, (strm, fontID));
+    if (!InitFreetype(&rec->fLibrary)) {
+        SkDELETE(rec);
+        return NULL;
+    }
 
     FT_Open_Args    args;
     memset(&args, 0, sizeof(args));
@@ -328,7 +347,7 @@ static SkFaceRec* ref_ft_face(const SkTypeface* typeface) {
         args.stream = &rec->fFTStream;
     }
 
-    FT_Error err = FT_Open_Face(gFTLibrary, &args, face_index, &rec->fFace);
+    FT_Error err = FT_Open_Face(rec->fLibrary, &args, face_index, &rec->fFace);
     if (err) {    // bad filename, try the default font
         fprintf(stderr, "ERROR: unable to open font '%x'\n", fontID);
         SkDELETE(rec);
@@ -343,19 +362,19 @@ static SkFaceRec* ref_ft_face(const SkTypeface* typeface) {
 }
 
 // Caller must lock gFTMutex before calling this function.
-static void unref_ft_face(FT_Face face) {
+static void unref_ft_face(SkFaceRec* faceRec) {
     SkFaceRec*  rec = gFaceRecHead;
     SkFaceRec*  prev = NULL;
     while (rec) {
         SkFaceRec* next = rec->fNext;
-        if (rec->fFace == face) {
+        if (rec == faceRec) {
             if (--rec->fRefCnt == 0) {
                 if (prev) {
                     prev->fNext = next;
                 } else {
                     gFaceRecHead = next;
                 }
-                FT_Done_Face(face);
+                FT_Done_Face(rec->fFace);
                 SkDELETE(rec);
             }
             return;
@@ -366,29 +385,26 @@ static void unref_ft_face(FT_Face face) {
     SkDEBUGFAIL("shouldn't get here, face not in list");
 }
 
+// Refs the face of the typeface and locks it for the lifetime of the object.
 class AutoFTAccess {
 public:
     AutoFTAccess(const SkTypeface* tf) : fRec(NULL), fFace(NULL) {
-        gFTMutex.acquire();
-        if (1 == ++gFTCount) {
-            if (!InitFreetype()) {
-                sk_throw();
-            }
+        {
+            SkAutoMutexAcquire  ac(gFTMutex);
+            fRec = ref_ft_face(tf);
         }
-        fRec = ref_ft_face(tf);
         if (fRec) {
+            fRec->fMutex.acquire();
             fFace = fRec->fFace;
         }
     }
 
     ~AutoFTAccess() {
-        if (fFace) {
-            unref_ft_face(fFace);
-        }
-        if (0 == --gFTCount) {
-            FT_Done_FreeType(gFTLibrary);
+        if (fRec) {
+            fRec->fMutex.release();
+            SkAutoMutexAcquire  ac(gFTMutex);
+            unref_ft_face(fRec);
         }
-        gFTMutex.release();
     }
 
     SkFaceRec* rec() { return fRec; }
@@ -460,6 +476,22 @@ static bool getWidthAdvance(FT_Face face, int gId, int16_t* data) {
     return true;
 }
 
+static bool getWidthAdvanceProc(void* face, int gId, int16_t* data) {
+    return getWidthAdvance(static_cast<FT_Face>(face), gId, data);
+}
+
+// Advances read through the typeface's advance table, which gets those it
+// does not have from the face.
+struct CachedWidthAdvances {
+    SkGlyphAdvanceTable* fTable;
+    FT_Face fFace;
+};
+
+static bool getCachedWidthAdvance(void* advances, int gId, int16_t* data) {
+    CachedWidthAdvances* cached = static_cast<CachedWidthAdvances*>(advances);
+    return cached->fTable->getAdvance(gId, &getWidthAdvanceProc, cached->fFace, data);
+}
+
 static void populate_glyph_to_unicode(FT_Face& face,
                                       SkTDArray<SkUnichar>* glyphToUnicode) {
     // Check and see if we have Unicode cmaps.
@@ -517,6 +549,16 @@ SkAdvancedTypefaceMetrics* SkTypeface_FreeType::onGetAdvancedTypefaceMetrics(
 #if defined(SK_BUILD_FOR_MAC)
     return NULL;
 #else
+    // Reading the advances from the font's tables locks the face, so they are
+    // read before it is locked here.
+    SkAutoTUnref<SkGlyphAdvanceTable> advanceTable;
+    if (perGlyphInfo & SkAdvancedTypefaceMetrics::kHAdvance_PerGlyphInfo) {
+        advanceTable.reset(SkGlyphAdvanceTable::RefFor(this));
+        if (advanceTable.get()) {
+            advanceTable->readHorizontalMetrics(this, glyphIDs, glyphIDsCount);
+        }
+    }
+
     AutoFTAccess fta(this);
     FT_Face face = fta.face();
     if (!face) {
@@ -652,6 +694,15 @@ SkAdvancedTypefaceMetrics* SkTypeface_FreeType::onGetAdvancedTypefaceMetrics(
             }
             finishRange(info->fGlyphWidths.get(), face->num_glyphs - 1,
                         SkAdvancedTypefaceMetrics::WidthRange::kRange);
+        } else if (advanceTable.get() &&
+                   advanceTable->countGlyphs() == face->num_glyphs) {
+            CachedWidthAdvances cached = { advanceTable.get(), face };
+            info->fGlyphWidths.reset(
+                getAdvanceData(static_cast<void*>(&cached),
+                               face->num_glyphs,
+                               glyphIDs,
+                               glyphIDsCount,
+                               &getCachedWidthAdvance));
         } else {
             info->fGlyphWidths.reset(
                 getAdvanceData(face,
@@ -830,23 +881,18 @@ static FT_Int chooseBitmapStrike(FT_Face face, SkFixed scaleY) {
 SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
                                                    const SkDescriptor* desc)
         : SkScalerContext_FreeType_Base(typeface, desc) {
-    SkAutoMutexAcquire  ac(gFTMutex);
-
-    if (gFTCount == 0) {
-        if (!InitFreetype()) {
-            sk_throw();
-        }
-    }
-    ++gFTCount;
-
     // load the font file
     fStrikeIndex = -1;
     fFTSize = NULL;
     fFace = NULL;
-    fFaceRec = ref_ft_face(typeface);
+    {
+        SkAutoMutexAcquire  ac(gFTMutex);
+        fFaceRec = ref_ft_face(typeface);
+    }
     if (NULL == fFaceRec) {
         return;
     }
+    SkAutoMutexAcquire  ac(fFaceRec->fMutex);
     fFace = fFaceRec->fFace;
 
     // A is the total matrix.
@@ -1020,18 +1066,14 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
 }
 
 SkScalerContext_FreeType::~SkScalerContext_FreeType() {
-    SkAutoMutexAcquire  ac(gFTMutex);
-
     if (fFTSize != NULL) {
+        SkAutoMutexAcquire  ac(fFaceRec->fMutex);
         FT_Done_Size(fFTSize);
     }
 
-    if (fFace != NULL) {
-        unref_ft_face(fFace);
-    }
-    if (--gFTCount == 0) {
-        FT_Done_FreeType(gFTLibrary);
-        SkDEBUGCODE(gFTLibrary = NULL;)
+    if (fFaceRec != NULL) {
+        SkAutoMutexAcquire  ac(gFTMutex);
+        unref_ft_face(fFaceRec);
     }
 }
 
@@ -1082,7 +1124,7 @@ void SkScalerContext_FreeType::generateAdvance(SkGlyph* glyph) {
     * which are very cheap to compute with some font formats...
     */
     if (fDoLinearMetrics) {
-        SkAutoMutexAcquire  ac(gFTMutex);
+        SkAutoMutexAcquire  ac(fFaceRec->fMutex);
 
         if (this->setupSize()) {
             glyph->zeroMetrics();
@@ -1183,7 +1225,7 @@ inline void scaleGlyphMetrics(SkGlyph& glyph, SkScalar scale) {
 }
 
 void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fMutex);
 
     glyph->fRsbDelta = 0;
     glyph->fLsbDelta = 0;
@@ -1288,7 +1330,7 @@ void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
 
 
 void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fMutex);
 
     FT_Error    err;
 
@@ -1312,7 +1354,7 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
 
 void SkScalerContext_FreeType::generatePath(const SkGlyph& glyph,
                                             SkPath* path) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fMutex);
 
     SkASSERT(&glyph && path);
 
@@ -1354,7 +1396,7 @@ void SkScalerContext_FreeType::generateFontMetrics(SkPaint::FontMetrics* mx,
         return;
     }
 
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fMutex);
 
     if (this->setupSize()) {
         ERROR:
@@ -9,6 +9,7 @@
 #define SkRecords_DEFINED
 
 #include "SkCanvas.h"
+#include "SkTextBlob.h"
 
 namespace SkRecords {
 
@@ -53,6 +54,7 @@ namespace SkRecords {
     M(DrawSprite)                                                   \
     M(DrawText)                                                     \
     M(DrawTextOnPath)                                               \
+    M(DrawTextBlob)                                                 \
     M(DrawVertices)                                                 \
     M(BoundedDrawPosTextH)    /*From SkRecordBoundDrawPosTextH*/
 
@@ -241,6 +243,22 @@ RECORD5(DrawTextOnPath, SkPaint, paint,
                         SkPath, path,
                         Optional<SkMatrix>, matrix);
 
+// The blob is immutable, so we just hold a ref.
+struct DrawTextBlob {
+    static const Type kType = DrawTextBlob_Type;
+
+    DrawTextBlob(const SkPaint& paint, const SkTextBlob* blob, SkScalar x, SkScalar y)
+        : paint(paint)
+        , blob(SkRef(blob))
+        , x(x)
+        , y(y) {}
+
+    SkPaint paint;
+    SkAutoTUnref<const SkTextBlob> blob;
+    SkScalar x;
+    SkScalar y;
+};
+
 // This guy is so ugly we just write it manually.
 struct DrawVertices {
     static const Type kType = DrawVertices_Type;
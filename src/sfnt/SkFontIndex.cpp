@@ -0,0 +1,848 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkFontIndex.h"
+
+#include "SkEndian.h"
+#include "SkOTTable_OS_2.h"
+#include "SkOTTable_cmap.h"
+#include "SkOTTable_name.h"
+#include "SkOTTable_post.h"
+#include "SkSFNTHeader.h"
+#include "SkTDArray.h"
+#include "SkTSort.h"
+#include "SkTTCFHeader.h"
+#include "SkTemplates.h"
+
+#include <sys/stat.h>
+
+static const uint32_t kMagic = SkSetFourByteTag('s', 'k', 'f', 'i');
+static const uint32_t kVersion = 2;
+
+// Coverage is kept in pages of 256 code points, 8 words each.
+static const int kPageShift = 8;
+static const int kWordsPerPage = (1 << kPageShift) / 32;
+static const SkUnichar kMaxUnichar = 0x10FFFF;
+static const int kUnicodeWords = (kMaxUnichar + 1) / 32;
+
+// The image is native endian, and laid out as the header, then each table in
+// this order, then the strings. Every string ends with a 0, and so does the
+// image.
+struct SkFontIndex::Header {
+    uint32_t fMagic;
+    uint32_t fVersion;
+    uint32_t fSize;
+    uint32_t fDirectoryCount;
+    uint32_t fDirectoriesOffset;
+    uint32_t fFamilyCount;
+    uint32_t fFamiliesOffset;
+    uint32_t fFaceCount;
+    uint32_t fFacesOffset;
+    uint32_t fPageCount;
+    uint32_t fPageKeysOffset;   // the page number of each page, sorted for each face
+    uint32_t fPageBitsOffset;   // kWordsPerPage words for each page
+    uint32_t fFallbackOffset;   // the families in the order fallback tries them
+};
+
+struct SkFontIndex::Directory {
+    uint32_t    fPath;
+    uint32_t    fPad;
+    int64_t     fModified;      // -1 if the directory did not exist
+};
+
+struct SkFontIndex::Family {
+    uint32_t    fName;
+    uint32_t    fFirstFace;
+    uint32_t    fFaceCount;
+};
+
+struct SkFontIndex::FaceRec {
+    enum {
+        kItalic_Flag        = 1 << 0,
+        kFixedPitch_Flag    = 1 << 1,
+    };
+    uint32_t    fPath;
+    uint32_t    fStyleName;
+    uint32_t    fLanguages;
+    uint32_t    fTTCIndex;
+    uint16_t    fWeight;
+    uint8_t     fWidth;
+    uint8_t     fFlags;
+    uint32_t    fFirstPage;
+    uint32_t    fPageCount;
+};
+
+static int64_t modified_time(const char path[]) {
+    struct stat status;
+    if (0 != stat(path, &status)) {
+        return -1;
+    }
+    return status.st_mtime;
+}
+
+static int compare_names(const char a[], const char b[]) {
+    for (;; ++a, ++b) {
+        int ca = (*a >= 'A' && *a <= 'Z') ? *a + ('a' - 'A') : *a;
+        int cb = (*b >= 'A' && *b <= 'Z') ? *b + ('a' - 'A') : *b;
+        if (ca != cb || 0 == ca) {
+            return ca - cb;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint16_t read_be16(const uint8_t* p) {
+    return (p[0] << 8) | p[1];
+}
+
+static uint32_t read_be32(const uint8_t* p) {
+    return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+namespace {
+
+// The bytes of a font file, and the bounds of a table in it.
+struct Table {
+    const uint8_t*  fData;
+    size_t          fLength;
+
+    template <typename T> const T* at(size_t offset, size_t count = 1) const {
+        if (offset > fLength || count > (fLength - offset) / sizeof(T)) {
+            return NULL;
+        }
+        return reinterpret_cast<const T*>(fData + offset);
+    }
+};
+
+struct ParsedFace {
+    SkString            fFamilyName;
+    SkString            fStyleName;
+    int                 fFile;          // the index of the file, and its rank for fallback
+    int                 fTTCIndex;
+    int                 fWeight;
+    int                 fWidth;
+    bool                fItalic;
+    bool                fFixedPitch;
+    SkTDArray<uint32_t> fPageKeys;
+    SkTDArray<uint32_t> fPageBits;
+};
+
+struct ParsedFaceLT {
+    bool operator()(const ParsedFace* a, const ParsedFace* b) const {
+        return compare_names(a->fFamilyName.c_str(), b->fFamilyName.c_str()) < 0;
+    }
+};
+
+} // namespace
+
+static bool find_table(const Table& file, size_t faceOffset, SK_OT_ULONG tag, Table* table) {
+    const SkSFNTHeader* header = file.at<SkSFNTHeader>(faceOffset);
+    if (NULL == header) {
+        return false;
+    }
+    const int count = SkEndian_SwapBE16(header->numTables);
+    const SkSFNTHeader::TableDirectoryEntry* entries =
+            file.at<SkSFNTHeader::TableDirectoryEntry>(faceOffset + sizeof(SkSFNTHeader), count);
+    if (NULL == entries) {
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (entries[i].tag == tag) {
+            const size_t offset = SkEndian_SwapBE32(entries[i].offset);
+            const size_t length = SkEndian_SwapBE32(entries[i].logicalLength);
+            if (NULL == file.at<uint8_t>(offset, length)) {
+                return false;
+            }
+            table->fData = file.fData + offset;
+            table->fLength = length;
+            return true;
+        }
+    }
+    return false;
+}
+
+// SkOTTableName::Iterator trusts the table, so check every record first.
+static bool valid_name_table(const Table& table) {
+    const SkOTTableName* name = table.at<SkOTTableName>(0);
+    if (NULL == name) {
+        return false;
+    }
+    const int count = SkEndian_SwapBE16(name->count);
+    const SkOTTableName::Record* records =
+            table.at<SkOTTableName::Record>(sizeof(SkOTTableName), count);
+    if (NULL == records) {
+        return false;
+    }
+    const size_t stringOffset = SkEndian_SwapBE16(name->stringOffset);
+    for (int i = 0; i < count; ++i) {
+        if (SkEndian_SwapBE16(records[i].platformID.value) > 3 ||
+            NULL == table.at<uint8_t>(stringOffset + SkEndian_SwapBE16(records[i].offset),
+                                      SkEndian_SwapBE16(records[i].length))) {
+            return false;
+        }
+    }
+    if (SkOTTableName::format_1 == name->format) {
+        const size_t extOffset = sizeof(SkOTTableName) + count * sizeof(SkOTTableName::Record);
+        const SkOTTableName::Format1Ext* ext = table.at<SkOTTableName::Format1Ext>(extOffset);
+        if (NULL == ext) {
+            return false;
+        }
+        const int tagCount = SkEndian_SwapBE16(ext->langTagCount);
+        const SkOTTableName::Format1Ext::LangTagRecord* tags =
+                table.at<SkOTTableName::Format1Ext::LangTagRecord>(
+                        extOffset + sizeof(SkOTTableName::Format1Ext), tagCount);
+        if (NULL == tags) {
+            return false;
+        }
+        for (int i = 0; i < tagCount; ++i) {
+            if (NULL == table.at<uint8_t>(stringOffset + SkEndian_SwapBE16(tags[i].offset),
+                                          SkEndian_SwapBE16(tags[i].length))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The name in US English, or else the first one.
+static bool find_name(const SkOTTableName& table,
+                      SkOTTableName::Record::NameID::Predefined::Value type, SkString* name) {
+    SkOTTableName::Iterator iter(table, type);
+    SkOTTableName::Iterator::Record record;
+    name->reset();
+    while (iter.next(record)) {
+        if (record.name.isEmpty()) {
+            continue;
+        }
+        if (record.language.equals("en-US")) {
+            *name = record.name;
+            break;
+        }
+        if (name->isEmpty()) {
+            *name = record.name;
+        }
+    }
+    return !name->isEmpty();
+}
+
+static void set_coverage(uint32_t bits[], SkUnichar uni) {
+    bits[uni >> 5] |= 1 << (uni & 31);
+}
+
+static bool read_cmap_format4(const Table& subtable, uint32_t bits[]) {
+    typedef SkOTTableCharacterToGlyphIndexMapping::Format4 Format4;
+    const Format4* format4 = subtable.at<Format4>(0);
+    if (NULL == format4) {
+        return false;
+    }
+    const int segCount = SkEndian_SwapBE16(format4->segCountX2) / 2;
+    const uint8_t* endCounts = subtable.at<uint8_t>(sizeof(Format4), 8 * segCount + 2);
+    if (NULL == endCounts) {
+        return false;
+    }
+    const uint8_t* startCounts = endCounts + 2 * segCount + 2;
+    const uint8_t* idDeltas = startCounts + 2 * segCount;
+    const uint8_t* idRangeOffsets = idDeltas + 2 * segCount;
+    for (int i = 0; i < segCount; ++i) {
+        const int start = read_be16(startCounts + 2 * i);
+        const int end = SkTMin<int>(read_be16(endCounts + 2 * i), 0xFFFE);
+        const uint16_t delta = read_be16(idDeltas + 2 * i);
+        const int rangeOffset = read_be16(idRangeOffsets + 2 * i);
+        for (int uni = start; uni <= end; ++uni) {
+            uint16_t glyph;
+            if (0 == rangeOffset) {
+                glyph = uni + delta;
+            } else {
+                // idRangeOffset is relative to its own place in the table
+                const size_t offset = (idRangeOffsets + 2 * i - subtable.fData) +
+                                      rangeOffset + 2 * (uni - start);
+                const uint8_t* glyphID = subtable.at<uint8_t>(offset, 2);
+                if (NULL == glyphID) {
+                    break;
+                }
+                glyph = read_be16(glyphID);
+                if (glyph) {
+                    glyph += delta;
+                }
+            }
+            if (glyph) {
+                set_coverage(bits, uni);
+            }
+        }
+    }
+    return true;
+}
+
+static bool read_cmap_format12(const Table& subtable, uint32_t bits[]) {
+    typedef SkOTTableCharacterToGlyphIndexMapping::Format12 Format12;
+    const Format12* format12 = subtable.at<Format12>(0);
+    if (NULL == format12) {
+        return false;
+    }
+    const int count = SkEndian_SwapBE32(format12->numGroups);
+    const Format12::SequentialMapGroup* groups =
+            subtable.at<Format12::SequentialMapGroup>(sizeof(Format12), count);
+    if (NULL == groups) {
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        const SkUnichar start = SkEndian_SwapBE32(groups[i].startCharCode);
+        const SkUnichar end = SkTMin<SkUnichar>(SkEndian_SwapBE32(groups[i].endCharCode),
+                                                kMaxUnichar);
+        for (SkUnichar uni = start; uni <= end; ++uni) {
+            // only the first character of a group starting at glyph 0 is missing
+            if (uni != start || 0 != groups[i].startGlyphID) {
+                set_coverage(bits, uni);
+            }
+        }
+    }
+    return true;
+}
+
+// Reads the Unicode subtable of the cmap, preferring the one for all of
+// Unicode to the one for the BMP.
+static bool read_cmap(const Table& table, uint32_t bits[]) {
+    typedef SkOTTableCharacterToGlyphIndexMapping Cmap;
+    const Cmap* cmap = table.at<Cmap>(0);
+    if (NULL == cmap) {
+        return false;
+    }
+    const int count = SkEndian_SwapBE16(cmap->numTables);
+    const Cmap::EncodingRecord* records = table.at<Cmap::EncodingRecord>(sizeof(Cmap), count);
+    if (NULL == records) {
+        return false;
+    }
+    Table best = { NULL, 0 };
+    SK_OT_USHORT bestFormat = 0;
+    for (int i = 0; i < count; ++i) {
+        const bool unicode = Cmap::EncodingRecord::platformID_Unicode == records[i].platformID ||
+            (Cmap::EncodingRecord::platformID_Windows == records[i].platformID &&
+             (Cmap::EncodingRecord::encodingID_WindowsUnicodeBMP == records[i].encodingID ||
+              Cmap::EncodingRecord::encodingID_WindowsUnicodeFull == records[i].encodingID));
+        const size_t offset = SkEndian_SwapBE32(records[i].offset);
+        const SK_OT_USHORT* format = table.at<SK_OT_USHORT>(offset);
+        if (!unicode || NULL == format) {
+            continue;
+        }
+        if ((Cmap::Format12::format_12 == *format && Cmap::Format12::format_12 != bestFormat) ||
+            (Cmap::Format4::format_4 == *format && 0 == bestFormat)) {
+            best.fData = table.fData + offset;
+            best.fLength = table.fLength - offset;
+            bestFormat = *format;
+        }
+    }
+    if (Cmap::Format12::format_12 == bestFormat) {
+        return read_cmap_format12(best, bits);
+    }
+    if (Cmap::Format4::format_4 == bestFormat) {
+        return read_cmap_format4(best, bits);
+    }
+    return false;
+}
+
+static bool parse_face(const Table& file, size_t faceOffset, ParsedFace* face) {
+    Table table;
+    if (!find_table(file, faceOffset, SkOTTableName::TAG, &table) ||
+        !valid_name_table(table) ||
+        !find_name(*table.at<SkOTTableName>(0),
+                   SkOTTableName::Record::NameID::Predefined::FontFamilyName,
+                   &face->fFamilyName)) {
+        return false;
+    }
+    find_name(*table.at<SkOTTableName>(0),
+              SkOTTableName::Record::NameID::Predefined::FontSubfamilyName, &face->fStyleName);
+
+    face->fWeight = SkFontStyle::kNormal_Weight;
+    face->fWidth = SkFontStyle::kNormal_Width;
+    face->fItalic = false;
+    if (find_table(file, faceOffset, SkOTTableOS2::TAG, &table)) {
+        const SkOTTableOS2_VA* os2 = table.at<SkOTTableOS2_VA>(0);
+        if (os2) {
+            int weight = SkEndian_SwapBE16(os2->usWeightClass.value);
+            // some old fonts use 1 to 9
+            if (weight < 10) {
+                weight *= 100;
+            }
+            face->fWeight = SkPin32(weight, 1, 1000);
+            face->fWidth = SkPin32(SkEndian_SwapBE16(os2->usWidthClass.value),
+                                   SkFontStyle::kUltraCondensed_Width,
+                                   SkFontStyle::kUltaExpanded_Width);
+            face->fItalic = SkToBool(os2->fsSelection.raw.value &
+                                     SkOTTableOS2_VA::Selection::Raw::ItalicMask);
+        }
+    }
+
+    face->fFixedPitch = false;
+    if (find_table(file, faceOffset, SkOTTablePostScript::TAG, &table)) {
+        const SkOTTablePostScript* post = table.at<SkOTTablePostScript>(0);
+        face->fFixedPitch = post && 0 != post->isFixedPitch;
+    }
+
+    SkAutoTMalloc<uint32_t> bits(kUnicodeWords);
+    sk_bzero(bits.get(), kUnicodeWords * sizeof(uint32_t));
+    if (find_table(file, faceOffset, SkOTTableCharacterToGlyphIndexMapping::TAG, &table)) {
+        read_cmap(table, bits.get());
+    }
+    for (uint32_t page = 0; page < kUnicodeWords / kWordsPerPage; ++page) {
+        const uint32_t* pageBits = bits.get() + page * kWordsPerPage;
+        for (int i = 0; i < kWordsPerPage; ++i) {
+            if (pageBits[i]) {
+                *face->fPageKeys.append() = page;
+                face->fPageBits.append(kWordsPerPage, pageBits);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+static void parse_file(const SkString& path, int fileIndex, SkTArray<ParsedFace>* faces) {
+    SkAutoTUnref<SkData> data(SkData::NewFromFileName(path.c_str()));
+    if (NULL == data.get()) {
+        return;
+    }
+    const Table file = { data->bytes(), data->size() };
+    const SkTTCFHeader* ttcHeader = file.at<SkTTCFHeader>(0);
+    if (NULL == ttcHeader) {
+        return;
+    }
+
+    SkTDArray<uint32_t> faceOffsets;
+    if (SkTTCFHeader::TAG == ttcHeader->ttcTag) {
+        const int count = SkEndian_SwapBE32(ttcHeader->numOffsets);
+        const uint8_t* offsets = file.at<uint8_t>(sizeof(SkTTCFHeader), 4 * count);
+        for (int i = 0; offsets && i < count; ++i) {
+            *faceOffsets.append() = read_be32(offsets + 4 * i);
+        }
+    } else {
+        *faceOffsets.append() = 0;
+    }
+
+    for (int i = 0; i < faceOffsets.count(); ++i) {
+        ParsedFace& face = faces->push_back();
+        face.fFile = fileIndex;
+        face.fTTCIndex = i;
+        if (!parse_face(file, faceOffsets[i], &face)) {
+            faces->pop_back();
+        }
+    }
+}
+
+static void add_directory(const SkString& path, SkTArray<SkString>* directories) {
+    for (int i = 0; i < directories->count(); ++i) {
+        if ((*directories)[i] == path) {
+            return;
+        }
+    }
+    directories->push_back(path);
+}
+
+namespace {
+
+// A family and the best rank of its files.
+struct FallbackRec {
+    int fRank;
+    int fFamily;
+};
+
+struct FallbackRecLT {
+    bool operator()(const FallbackRec& a, const FallbackRec& b) const {
+        return a.fRank < b.fRank || (a.fRank == b.fRank && a.fFamily < b.fFamily);
+    }
+};
+
+} // namespace
+
+SkData* SkFontIndex::Build(const SkTArray<SkString>& fontFiles,
+                           const SkTArray<SkString>& extraDirectories,
+                           const SkTArray<SkString>* languages) {
+    SkASSERT(NULL == languages || languages->count() == fontFiles.count());
+    SkTArray<ParsedFace> faces;
+    SkTArray<SkString> directories;
+    for (int i = 0; i < fontFiles.count(); ++i) {
+        const SkString& path = fontFiles[i];
+        parse_file(path, i, &faces);
+        const char* slash = strrchr(path.c_str(), '/');
+        if (slash) {
+            add_directory(SkString(path.c_str(), slash - path.c_str()), &directories);
+        }
+    }
+    if (faces.empty()) {
+        return NULL;
+    }
+    for (int i = 0; i < extraDirectories.count(); ++i) {
+        add_directory(extraDirectories[i], &directories);
+    }
+
+    SkAutoTMalloc<ParsedFace*> sorted(faces.count());
+    for (int i = 0; i < faces.count(); ++i) {
+        sorted[i] = &faces[i];
+    }
+    SkTQSort(sorted.get(), sorted.get() + faces.count() - 1, ParsedFaceLT());
+
+    int familyCount = 0;
+    int pageCount = 0;
+    size_t stringsSize = 0;
+    for (int i = 0; i < faces.count(); ++i) {
+        if (0 == i || 0 != compare_names(sorted[i - 1]->fFamilyName.c_str(),
+                                         sorted[i]->fFamilyName.c_str())) {
+            familyCount += 1;
+            stringsSize += sorted[i]->fFamilyName.size() + 1;
+        }
+        stringsSize += sorted[i]->fStyleName.size() + 1;
+        pageCount += sorted[i]->fPageKeys.count();
+    }
+    for (int i = 0; i < fontFiles.count(); ++i) {
+        stringsSize += fontFiles[i].size() + 1;
+        stringsSize += (languages ? (*languages)[i].size() : 0) + 1;
+    }
+    for (int i = 0; i < directories.count(); ++i) {
+        stringsSize += directories[i].size() + 1;
+    }
+
+    Header header;
+    header.fMagic = kMagic;
+    header.fVersion = kVersion;
+    header.fDirectoryCount = directories.count();
+    header.fDirectoriesOffset = SkAlign8(sizeof(Header));
+    header.fFamilyCount = familyCount;
+    header.fFamiliesOffset = header.fDirectoriesOffset + directories.count() * sizeof(Directory);
+    header.fFaceCount = faces.count();
+    header.fFacesOffset = header.fFamiliesOffset + familyCount * sizeof(Family);
+    header.fPageCount = pageCount;
+    header.fPageKeysOffset = header.fFacesOffset + faces.count() * sizeof(FaceRec);
+    header.fPageBitsOffset = header.fPageKeysOffset + pageCount * sizeof(uint32_t);
+    header.fFallbackOffset = header.fPageBitsOffset +
+                             pageCount * kWordsPerPage * sizeof(uint32_t);
+    const uint32_t stringsOffset = header.fFallbackOffset + familyCount * sizeof(uint32_t);
+    header.fSize = SkToU32(stringsOffset + stringsSize);
+
+    uint8_t* image = (uint8_t*)sk_calloc_throw(header.fSize);
+    memcpy(image, &header, sizeof(Header));
+    char* strings = (char*)image + stringsOffset;
+    Directory* outDirectories = (Directory*)(image + header.fDirectoriesOffset);
+    Family* outFamilies = (Family*)(image + header.fFamiliesOffset);
+    FaceRec* outFaces = (FaceRec*)(image + header.fFacesOffset);
+    uint32_t* outPageKeys = (uint32_t*)(image + header.fPageKeysOffset);
+    uint32_t* outPageBits = (uint32_t*)(image + header.fPageBitsOffset);
+    uint32_t* outFallback = (uint32_t*)(image + header.fFallbackOffset);
+
+    // Appends a string, and returns its offset in the image.
+    struct Strings {
+        uint8_t* fImage;
+        char*    fNext;
+        uint32_t add(const SkString& string) {
+            const uint32_t offset = SkToU32(fNext - (char*)fImage);
+            memcpy(fNext, string.c_str(), string.size() + 1);
+            fNext += string.size() + 1;
+            return offset;
+        }
+    } stringWriter = { image, strings };
+
+    for (int i = 0; i < directories.count(); ++i) {
+        outDirectories[i].fPath = stringWriter.add(directories[i]);
+        outDirectories[i].fModified = modified_time(directories[i].c_str());
+    }
+
+    // Each face refers to its file's path and languages by the offsets they
+    // were written at.
+    SkAutoTMalloc<uint32_t> pathOffsets(fontFiles.count());
+    SkAutoTMalloc<uint32_t> languageOffsets(fontFiles.count());
+    for (int i = 0; i < fontFiles.count(); ++i) {
+        pathOffsets[i] = stringWriter.add(fontFiles[i]);
+        languageOffsets[i] = stringWriter.add(languages ? (*languages)[i] : SkString());
+    }
+
+    SkAutoTMalloc<FallbackRec> fallback(familyCount);
+    Family* family = outFamilies - 1;
+    int page = 0;
+    for (int i = 0; i < faces.count(); ++i) {
+        const ParsedFace& face = *sorted[i];
+        if (0 == i || 0 != compare_names(sorted[i - 1]->fFamilyName.c_str(),
+                                         face.fFamilyName.c_str())) {
+            ++family;
+            family->fName = stringWriter.add(face.fFamilyName);
+            family->fFirstFace = i;
+            const int familyIndex = SkToInt(family - outFamilies);
+            fallback[familyIndex].fRank = face.fFile;
+            fallback[familyIndex].fFamily = familyIndex;
+        }
+        family->fFaceCount += 1;
+        FallbackRec& familyFallback = fallback[SkToInt(family - outFamilies)];
+        familyFallback.fRank = SkTMin(familyFallback.fRank, face.fFile);
+
+        FaceRec& rec = outFaces[i];
+        rec.fPath = pathOffsets[face.fFile];
+        rec.fStyleName = stringWriter.add(face.fStyleName);
+        rec.fLanguages = languageOffsets[face.fFile];
+        rec.fTTCIndex = face.fTTCIndex;
+        rec.fWeight = face.fWeight;
+        rec.fWidth = face.fWidth;
+        rec.fFlags = (face.fItalic ? FaceRec::kItalic_Flag : 0) |
+                     (face.fFixedPitch ? FaceRec::kFixedPitch_Flag : 0);
+        rec.fFirstPage = page;
+        rec.fPageCount = face.fPageKeys.count();
+        memcpy(outPageKeys + page, face.fPageKeys.begin(), face.fPageKeys.count() * sizeof(uint32_t));
+        memcpy(outPageBits + page * kWordsPerPage, face.fPageBits.begin(),
+               face.fPageBits.count() * sizeof(uint32_t));
+        page += face.fPageKeys.count();
+    }
+    SkASSERT(stringWriter.fNext == (char*)image + header.fSize);
+
+    SkTQSort(fallback.get(), fallback.get() + familyCount - 1, FallbackRecLT());
+    for (int i = 0; i < familyCount; ++i) {
+        outFallback[i] = fallback[i].fFamily;
+    }
+
+    return SkData::NewFromMalloc(image, header.fSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Returns true if count records of type T at offset fit in the image.
+template <typename T> static bool valid_table(const SkData* image, uint32_t offset,
+                                              uint32_t count) {
+    return 0 == offset % sizeof(uint32_t) && offset <= image->size() &&
+           count <= (image->size() - offset) / sizeof(T);
+}
+
+SkFontIndex* SkFontIndex::Create(SkData* image) {
+    if (NULL == image || image->size() < sizeof(Header) ||
+        0 != image->bytes()[image->size() - 1] ||
+        0 != reinterpret_cast<uintptr_t>(image->data()) % sizeof(int64_t)) {
+        return NULL;
+    }
+    const Header* header = static_cast<const Header*>(image->data());
+    if (kMagic != header->fMagic || kVersion != header->fVersion ||
+        header->fSize != image->size() || 0 != header->fDirectoriesOffset % sizeof(int64_t) ||
+        !valid_table<Directory>(image, header->fDirectoriesOffset, header->fDirectoryCount) ||
+        !valid_table<Family>(image, header->fFamiliesOffset, header->fFamilyCount) ||
+        !valid_table<FaceRec>(image, header->fFacesOffset, header->fFaceCount) ||
+        !valid_table<uint32_t>(image, header->fPageKeysOffset, header->fPageCount) ||
+        header->fPageCount > SK_MaxU32 / kWordsPerPage ||
+        !valid_table<uint32_t>(image, header->fPageBitsOffset,
+                               header->fPageCount * kWordsPerPage) ||
+        !valid_table<uint32_t>(image, header->fFallbackOffset, header->fFamilyCount)) {
+        return NULL;
+    }
+
+    const uint8_t* base = image->bytes();
+    const Directory* directories = (const Directory*)(base + header->fDirectoriesOffset);
+    for (uint32_t i = 0; i < header->fDirectoryCount; ++i) {
+        if (directories[i].fPath >= header->fSize) {
+            return NULL;
+        }
+    }
+    const Family* families = (const Family*)(base + header->fFamiliesOffset);
+    for (uint32_t i = 0; i < header->fFamilyCount; ++i) {
+        if (families[i].fName >= header->fSize || 0 == families[i].fFaceCount ||
+            families[i].fFirstFace > header->fFaceCount ||
+            families[i].fFaceCount > header->fFaceCount - families[i].fFirstFace) {
+            return NULL;
+        }
+    }
+    const uint32_t* fallback = (const uint32_t*)(base + header->fFallbackOffset);
+    for (uint32_t i = 0; i < header->fFamilyCount; ++i) {
+        if (fallback[i] >= header->fFamilyCount) {
+            return NULL;
+        }
+    }
+    const FaceRec* faces = (const FaceRec*)(base + header->fFacesOffset);
+    for (uint32_t i = 0; i < header->fFaceCount; ++i) {
+        if (faces[i].fPath >= header->fSize || faces[i].fStyleName >= header->fSize ||
+            faces[i].fLanguages >= header->fSize ||
+            faces[i].fFirstPage > header->fPageCount ||
+            faces[i].fPageCount > header->fPageCount - faces[i].fFirstPage) {
+            return NULL;
+        }
+    }
+    return SkNEW_ARGS(SkFontIndex, (image));
+}
+
+SkFontIndex* SkFontIndex::CreateFromFile(const char path[]) {
+    SkAutoTUnref<SkData> image(SkData::NewFromFileName(path));
+    return Create(image);
+}
+
+SkFontIndex::SkFontIndex(SkData* image) : fImage(SkRef(image)) {
+    const uint8_t* base = image->bytes();
+    fHeader = (const Header*)base;
+    fDirectories = (const Directory*)(base + fHeader->fDirectoriesOffset);
+    fFamilies = (const Family*)(base + fHeader->fFamiliesOffset);
+    fFaces = (const FaceRec*)(base + fHeader->fFacesOffset);
+    fPageKeys = (const uint32_t*)(base + fHeader->fPageKeysOffset);
+    fPageBits = (const uint32_t*)(base + fHeader->fPageBitsOffset);
+    fFallbackFamilies = (const uint32_t*)(base + fHeader->fFallbackOffset);
+    fFamilyCount = fHeader->fFamilyCount;
+}
+
+SkFontIndex::~SkFontIndex() {}
+
+const char* SkFontIndex::getString(uint32_t offset) const {
+    return (const char*)fImage->bytes() + offset;
+}
+
+bool SkFontIndex::isStale() const {
+    for (uint32_t i = 0; i < fHeader->fDirectoryCount; ++i) {
+        if (modified_time(this->getString(fDirectories[i].fPath)) != fDirectories[i].fModified) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* SkFontIndex::getFamilyName(int familyIndex) const {
+    SkASSERT((unsigned)familyIndex < (unsigned)fFamilyCount);
+    return this->getString(fFamilies[familyIndex].fName);
+}
+
+int SkFontIndex::findFamily(const char familyName[]) const {
+    if (NULL == familyName) {
+        return -1;
+    }
+    int lo = 0;
+    int hi = fFamilyCount - 1;
+    while (lo <= hi) {
+        const int mid = (lo + hi) >> 1;
+        const int cmp = compare_names(familyName, this->getFamilyName(mid));
+        if (0 == cmp) {
+            return mid;
+        }
+        if (cmp < 0) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return -1;
+}
+
+int SkFontIndex::countFaces(int familyIndex) const {
+    SkASSERT((unsigned)familyIndex < (unsigned)fFamilyCount);
+    return fFamilies[familyIndex].fFaceCount;
+}
+
+const SkFontIndex::FaceRec& SkFontIndex::getFaceRec(int familyIndex, int faceIndex) const {
+    SkASSERT((unsigned)faceIndex < (unsigned)this->countFaces(familyIndex));
+    return fFaces[fFamilies[familyIndex].fFirstFace + faceIndex];
+}
+
+static SkFontStyle face_style(int weight, int width, bool italic) {
+    return SkFontStyle(weight, width, italic ? SkFontStyle::kItalic_Slant
+                                             : SkFontStyle::kUpright_Slant);
+}
+
+void SkFontIndex::getFace(int familyIndex, int faceIndex, Face* face) const {
+    const FaceRec& rec = this->getFaceRec(familyIndex, faceIndex);
+    face->fPath = this->getString(rec.fPath);
+    face->fStyleName = this->getString(rec.fStyleName);
+    face->fTTCIndex = rec.fTTCIndex;
+    face->fStyle = face_style(rec.fWeight, rec.fWidth, SkToBool(rec.fFlags & FaceRec::kItalic_Flag));
+    face->fFixedPitch = SkToBool(rec.fFlags & FaceRec::kFixedPitch_Flag);
+}
+
+static int sqr(int value) {
+    return value * value;
+}
+
+int SkFontIndex::StyleDistance(const SkFontStyle& a, const SkFontStyle& b) {
+    return sqr(a.weight() - b.weight()) +
+           sqr((a.width() - b.width()) * 100) +
+           sqr((a.isItalic() != b.isItalic()) * 900);
+}
+
+int SkFontIndex::matchStyle(int familyIndex, const SkFontStyle& pattern) const {
+    int best = 0;
+    int bestDistance = SK_MaxS32;
+    for (int i = 0; i < this->countFaces(familyIndex); ++i) {
+        const FaceRec& rec = this->getFaceRec(familyIndex, i);
+        const SkFontStyle style = face_style(rec.fWeight, rec.fWidth,
+                                             SkToBool(rec.fFlags & FaceRec::kItalic_Flag));
+        const int distance = StyleDistance(pattern, style);
+        if (distance < bestDistance) {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+bool SkFontIndex::hasCharacter(int familyIndex, int faceIndex, SkUnichar uni) const {
+    if ((unsigned)uni > (unsigned)kMaxUnichar) {
+        return false;
+    }
+    const FaceRec& rec = this->getFaceRec(familyIndex, faceIndex);
+    const uint32_t page = uni >> kPageShift;
+    const uint32_t* keys = fPageKeys + rec.fFirstPage;
+    int lo = 0;
+    int hi = rec.fPageCount - 1;
+    while (lo <= hi) {
+        const int mid = (lo + hi) >> 1;
+        if (keys[mid] == page) {
+            const uint32_t* bits = fPageBits + (rec.fFirstPage + mid) * kWordsPerPage;
+            return SkToBool(bits[(uni >> 5) & (kWordsPerPage - 1)] & (1 << (uni & 31)));
+        }
+        if (keys[mid] > page) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return false;
+}
+
+// The length of the language subtag of a tag, e.g. 2 for "zh-TW".
+static size_t language_length(const char tag[], size_t length) {
+    size_t i = 0;
+    while (i < length && '-' != tag[i] && '_' != tag[i]) {
+        ++i;
+    }
+    return i;
+}
+
+// Returns true if one of the '|' separated languages has the language of the
+// BCP 47 tag, whatever its region or script.
+static bool supports_language(const char languages[], const char bcp47[]) {
+    const size_t wanted = language_length(bcp47, strlen(bcp47));
+    if (0 == wanted) {
+        return false;
+    }
+    while (*languages) {
+        const char* end = strchr(languages, '|');
+        const size_t length = end ? end - languages : strlen(languages);
+        if (language_length(languages, length) == wanted &&
+            0 == strncasecmp(languages, bcp47, wanted)) {
+            return true;
+        }
+        if (NULL == end) {
+            break;
+        }
+        languages = end + 1;
+    }
+    return false;
+}
+
+bool SkFontIndex::matchCharacter(SkUnichar uni, const SkFontStyle& style, const char bcp47[],
+                                 int* familyIndex, int* faceIndex) const {
+    // The first pass only tries the faces with the language, if there is one.
+    for (int pass = (bcp47 && *bcp47) ? 0 : 1; pass < 2; ++pass) {
+        for (int i = 0; i < fFamilyCount; ++i) {
+            const int family = fFallbackFamilies[i];
+            const int face = this->matchStyle(family, style);
+            if ((0 == pass && !supports_language(
+                        this->getString(this->getFaceRec(family, face).fLanguages), bcp47)) ||
+                !this->hasCharacter(family, face, uni)) {
+                continue;
+            }
+            *familyIndex = family;
+            *faceIndex = face;
+            return true;
+        }
+    }
+    return false;
+}
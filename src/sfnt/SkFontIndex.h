@@ -0,0 +1,131 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkFontIndex_DEFINED
+#define SkFontIndex_DEFINED
+
+#include "SkData.h"
+#include "SkFontStyle.h"
+#include "SkRefCnt.h"
+#include "SkString.h"
+#include "SkTArray.h"
+
+/** \class SkFontIndex
+
+    A prebuilt index of the fonts installed on the system, so that a font
+    manager can enumerate and match them without asking the system (e.g.
+    fontconfig) at run time.
+
+    The index is built once from the font files, by reading their 'name',
+    'OS/2' and 'cmap' tables, into a single flat image that can be written to
+    disk and later mapped back in. It holds the families sorted by name, the
+    style of each face, and the characters each face covers, as a bitmap for
+    each block of 256 code points it has glyphs in.
+
+    Building reads every font file, so it is meant to be done ahead of time,
+    e.g. by tools/build_font_index.cpp, not while an application starts.
+
+    An index is immutable, so it may be queried from any thread without
+    locking. It records the modification times of the directories the fonts
+    were found in; if any of them has changed since, the index is stale and
+    the caller should ask the system instead, until the index is rebuilt.
+*/
+class SkFontIndex : public SkRefCnt {
+public:
+    SK_DECLARE_INST_COUNT(SkFontIndex)
+
+    /** Returns the image of an index of these font files (each face of a
+        collection is indexed), or NULL if none of them could be read.
+        Besides the directories of the files, the directories listed are
+        checked for changes by isStale().
+
+        The files are listed in the order fallback should try them, e.g. as
+        the system sorts them for its default pattern. If languages is not
+        NULL, it holds for each file the languages it supports, separated by
+        '|' (e.g. "en|fr|zh-tw"), which fallback prefers for text in them.
+    */
+    static SkData* Build(const SkTArray<SkString>& fontFiles,
+                         const SkTArray<SkString>& directories,
+                         const SkTArray<SkString>* languages = NULL);
+
+    /** Returns an index of an image made by Build(), or NULL if the image is
+        not a valid index.
+    */
+    static SkFontIndex* Create(SkData* image);
+
+    /** Maps the image at path, and returns an index of it, or NULL if the
+        file does not exist or is not a valid index.
+    */
+    static SkFontIndex* CreateFromFile(const char path[]);
+
+    struct Face {
+        const char* fPath;
+        const char* fStyleName;
+        int         fTTCIndex;
+        SkFontStyle fStyle;
+        bool        fFixedPitch;
+    };
+
+    virtual ~SkFontIndex();
+
+    /** Returns true if a directory of the index has been changed, added to
+        or removed since the index was built.
+    */
+    bool isStale() const;
+
+    int countFamilies() const { return fFamilyCount; }
+    const char* getFamilyName(int familyIndex) const;
+
+    /** Returns the index of the family with this name (ignoring ASCII case),
+        or -1 if there is none or the name is NULL.
+    */
+    int findFamily(const char familyName[]) const;
+
+    int countFaces(int familyIndex) const;
+    void getFace(int familyIndex, int faceIndex, Face*) const;
+
+    /** Returns the face of the family closest to the style. */
+    int matchStyle(int familyIndex, const SkFontStyle&) const;
+
+    bool hasCharacter(int familyIndex, int faceIndex, SkUnichar) const;
+
+    /** Finds a face with a glyph for the character, for fallback. The face of
+        each family closest to the style is tried, in the order the files were
+        given to Build(); if bcp47 is not NULL, the faces supporting its
+        language are tried first. Returns false if no font has the character.
+    */
+    bool matchCharacter(SkUnichar, const SkFontStyle&, const char bcp47[],
+                        int* familyIndex, int* faceIndex) const;
+
+    /** How far apart two styles are, for picking the closest face. */
+    static int StyleDistance(const SkFontStyle&, const SkFontStyle&);
+
+private:
+    struct Header;
+    struct Directory;
+    struct Family;
+    struct FaceRec;
+
+    explicit SkFontIndex(SkData* image);
+
+    const char* getString(uint32_t offset) const;
+    const FaceRec& getFaceRec(int familyIndex, int faceIndex) const;
+
+    SkAutoTUnref<SkData>    fImage;
+    const Header*           fHeader;
+    const Directory*        fDirectories;
+    const Family*           fFamilies;
+    const FaceRec*          fFaces;
+    const uint32_t*         fPageKeys;
+    const uint32_t*         fPageBits;
+    const uint32_t*         fFallbackFamilies;
+    int                     fFamilyCount;
+
+    typedef SkRefCnt INHERITED;
+};
+
+#endif
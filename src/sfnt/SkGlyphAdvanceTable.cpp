@@ -0,0 +1,157 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGlyphAdvanceTable.h"
+
+#include "SkLazyPtr.h"
+#include "SkOTTable_hhea.h"
+#include "SkOTTable_hmtx.h"
+#include "SkTypeface.h"
+#include "SkTypefaceLRUCache.h"
+
+template <typename T> static SkFontTableTag table_tag() {
+    return SkSetFourByteTag(T::TAG0, T::TAG1, T::TAG2, T::TAG3);
+}
+
+SkGlyphAdvanceTable::SkGlyphAdvanceTable(const SkTypeface* typeface, int glyphCount)
+    : fGlyphCount(glyphCount)
+    , fHMetricCount(0)
+    , fLastHAdvance(0)
+    , fAdvances(glyphCount)
+    , fPageFilled(this->countPages()) {
+    sk_bzero(fPageFilled.get(), this->countPages() * sizeof(int32_t));
+
+    // Glyphs past the last full metric have its advance, so only the full
+    // metrics need to be read.
+    SkOTTableHorizontalHeader hhea;
+    const SkFontTableTag hmtxTag = table_tag<SkOTTableHorizontalMetrics>();
+    if (sizeof(hhea) != typeface->getTableData(table_tag<SkOTTableHorizontalHeader>(), 0,
+                                               sizeof(hhea), &hhea)) {
+        return;
+    }
+    const int hMetricCount = SkEndian_SwapBE16(hhea.numberOfHMetrics);
+    SkOTTableHorizontalMetrics::FullMetric last;
+    if (hMetricCount <= 0 ||
+        typeface->getTableSize(hmtxTag) < hMetricCount * sizeof(last) ||
+        sizeof(last) != typeface->getTableData(hmtxTag, (hMetricCount - 1) * sizeof(last),
+                                               sizeof(last), &last)) {
+        return;
+    }
+    fHMetricCount = SkMin32(hMetricCount, glyphCount);
+    fLastHAdvance = SkEndian_SwapBE16(last.advanceWidth);
+}
+
+SkGlyphAdvanceTable::~SkGlyphAdvanceTable() {}
+
+void SkGlyphAdvanceTable::readPages(const SkTypeface* typeface, int startPage, int stopPage) {
+    const int start = startPage << kPageShift;
+    const int stop = SkMin32(stopPage << kPageShift, fGlyphCount);
+
+    // The table is read without holding the lock, so that it is never held
+    // while the typeface is.
+    const int metricStop = SkMax32(start, SkMin32(stop, fHMetricCount));
+    SkAutoSTMalloc<kPageSize, SkOTTableHorizontalMetrics::FullMetric> metrics(metricStop - start);
+    const size_t size = (metricStop - start) * sizeof(metrics[0]);
+    if (size > 0 && size != typeface->getTableData(table_tag<SkOTTableHorizontalMetrics>(),
+                                                   start * sizeof(metrics[0]), size,
+                                                   metrics.get())) {
+        return;  // Leave them for the scaler.
+    }
+
+    SkAutoMutexAcquire lock(fMutex);
+    for (int page = startPage; page < stopPage; page++) {
+        if (fPageFilled[page]) {
+            continue;  // Filled by another thread meanwhile.
+        }
+        const int pageStop = SkMin32((page + 1) << kPageShift, stop);
+        for (int glyphID = page << kPageShift; glyphID < pageStop; glyphID++) {
+            fAdvances[glyphID] = glyphID < metricStop
+                               ? SkEndian_SwapBE16(metrics[glyphID - start].advanceWidth)
+                               : fLastHAdvance;
+        }
+        sk_release_store(&fPageFilled[page], 1);
+    }
+}
+
+void SkGlyphAdvanceTable::readHorizontalMetrics(const SkTypeface* typeface,
+                                                const uint32_t glyphIDs[], int count) {
+    if (!this->hasHorizontalMetrics()) {
+        return;
+    }
+
+    // Runs of pages that have not been read are read together.
+    const int pageCount = this->countPages();
+    int runStart = -1;
+    int i = 0;
+    for (int page = 0; page <= pageCount; page++) {
+        bool wanted = false;
+        if (page < pageCount && !this->isPageFilled(page)) {
+            if (NULL == glyphIDs) {
+                wanted = true;
+            } else {
+                // The glyph IDs are sorted.
+                while (i < count && (int)(glyphIDs[i] >> kPageShift) < page) {
+                    i++;
+                }
+                wanted = i < count && (int)(glyphIDs[i] >> kPageShift) == page;
+            }
+        }
+        if (wanted && runStart < 0) {
+            runStart = page;
+        } else if (!wanted && runStart >= 0) {
+            this->readPages(typeface, runStart, page);
+            runStart = -1;
+        }
+    }
+}
+
+bool SkGlyphAdvanceTable::getAdvance(int glyphID, ScalerProc proc, void* context,
+                                     int16_t* advance) {
+    if (glyphID < 0 || glyphID >= fGlyphCount) {
+        return false;
+    }
+    const int page = glyphID >> kPageShift;
+    if (!this->isPageFilled(page)) {
+        if (NULL == proc) {
+            return false;
+        }
+        SkAutoMutexAcquire lock(fMutex);
+        if (!fPageFilled[page]) {
+            const int stop = SkMin32((page + 1) << kPageShift, fGlyphCount);
+            for (int i = page << kPageShift; i < stop; i++) {
+                if (!proc(context, i, &fAdvances[i])) {
+                    return false;
+                }
+            }
+            sk_release_store(&fPageFilled[page], 1);
+        }
+    }
+    *advance = fAdvances[glyphID];
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Large fonts take two bytes a glyph, 128KB at most.
+typedef SkTypefaceLRUCache<SkFontID, SkGlyphAdvanceTable, 32> AdvanceTableCache;
+
+SkGlyphAdvanceTable* SkGlyphAdvanceTable::RefFor(const SkTypeface* typeface) {
+    SK_DECLARE_STATIC_LAZY_PTR(AdvanceTableCache, cache);
+
+    const SkFontID fontID = typeface->uniqueID();
+    SkGlyphAdvanceTable* table;
+    if (cache.get()->find(fontID, &table)) {
+        return table;
+    }
+    const int glyphCount = typeface->countGlyphs();
+    if (glyphCount <= 0) {
+        return NULL;
+    }
+    SkAutoTUnref<SkGlyphAdvanceTable> newTable(SkNEW_ARGS(SkGlyphAdvanceTable,
+                                                          (typeface, glyphCount)));
+    return cache.get()->add(fontID, newTable);
+}
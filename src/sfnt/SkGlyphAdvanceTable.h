@@ -0,0 +1,89 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGlyphAdvanceTable_DEFINED
+#define SkGlyphAdvanceTable_DEFINED
+
+#include "SkRefCnt.h"
+#include "SkTemplates.h"
+#include "SkThread.h"
+
+class SkTypeface;
+
+/** \class SkGlyphAdvanceTable
+
+    The horizontal advances, in font units, of the glyphs of a typeface, for
+    the per glyph advances of SkAdvancedTypefaceMetrics. They are filled a
+    page of glyphs at a time, as they are asked for: from the font's 'hmtx'
+    table when it has one, which is a few bytes a glyph to read, and from the
+    scaler otherwise.
+
+    The tables of the most recently used typefaces are kept for the process,
+    so asking for the metrics of a font again (for every document that uses
+    it, say) does not ask the scaler again. A table may be used from any
+    thread.
+*/
+class SkGlyphAdvanceTable : public SkRefCnt {
+public:
+    SK_DECLARE_INST_COUNT(SkGlyphAdvanceTable)
+
+    /** Gets the advance of a glyph from the scaler, returning false if it
+        cannot.
+    */
+    typedef bool (*ScalerProc)(void* context, int glyphID, int16_t* advance);
+
+    /** Returns the process-wide table of the typeface's advances, or NULL if
+        it has no glyphs. The caller owns a reference to the result.
+    */
+    static SkGlyphAdvanceTable* RefFor(const SkTypeface*);
+
+    virtual ~SkGlyphAdvanceTable();
+
+    int countGlyphs() const { return fGlyphCount; }
+
+    /** Returns true if the advances are read from the font's 'hmtx' table.
+    */
+    bool hasHorizontalMetrics() const { return fHMetricCount > 0; }
+
+    /** Reads the advances of the glyphs (of every glyph if glyphIDs is NULL)
+        from the 'hmtx' table of the table's typeface, if it has one and they
+        have not been read already. This reads the font's data through the
+        typeface, which the port may lock, so ports call it before locking
+        their scaler.
+    */
+    void readHorizontalMetrics(const SkTypeface*, const uint32_t glyphIDs[], int count);
+
+    /** Gets the advance of a glyph. If it has not been read, its page is
+        filled with proc, or if proc is NULL, this returns false.
+    */
+    bool getAdvance(int glyphID, ScalerProc proc, void* context, int16_t* advance);
+
+private:
+    enum {
+        kPageShift = 7,
+        kPageSize = 1 << kPageShift
+    };
+
+    SkGlyphAdvanceTable(const SkTypeface*, int glyphCount);
+
+    int countPages() const { return (fGlyphCount + kPageSize - 1) >> kPageShift; }
+    bool isPageFilled(int page) { return 0 != sk_acquire_load(&fPageFilled[page]); }
+
+    // Reads the pages [startPage, stopPage) from the 'hmtx' table.
+    void readPages(const SkTypeface*, int startPage, int stopPage);
+
+    const int               fGlyphCount;
+    int                     fHMetricCount;
+    int16_t                 fLastHAdvance;
+    SkMutex                 fMutex;
+    SkAutoTMalloc<int16_t>  fAdvances;
+    SkAutoTMalloc<int32_t>  fPageFilled;
+
+    typedef SkRefCnt INHERITED;
+};
+
+#endif
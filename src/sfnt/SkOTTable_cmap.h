@@ -0,0 +1,85 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkOTTable_cmap_DEFINED
+#define SkOTTable_cmap_DEFINED
+
+#include "SkEndian.h"
+#include "SkOTTableTypes.h"
+
+#pragma pack(push, 1)
+
+struct SkOTTableCharacterToGlyphIndexMapping {
+    static const SK_OT_CHAR TAG0 = 'c';
+    static const SK_OT_CHAR TAG1 = 'm';
+    static const SK_OT_CHAR TAG2 = 'a';
+    static const SK_OT_CHAR TAG3 = 'p';
+    static const SK_OT_ULONG TAG = SkOTTableTAG<SkOTTableCharacterToGlyphIndexMapping>::value;
+
+    SK_OT_USHORT version;
+    static const SK_OT_USHORT version_0 = SkTEndian_SwapBE16(0);
+
+    SK_OT_USHORT numTables;
+
+    struct EncodingRecord {
+        SK_OT_USHORT platformID;
+        static const SK_OT_USHORT platformID_Unicode = SkTEndian_SwapBE16(0);
+        static const SK_OT_USHORT platformID_Windows = SkTEndian_SwapBE16(3);
+
+        SK_OT_USHORT encodingID;
+        static const SK_OT_USHORT encodingID_WindowsSymbol = SkTEndian_SwapBE16(0);
+        static const SK_OT_USHORT encodingID_WindowsUnicodeBMP = SkTEndian_SwapBE16(1);
+        static const SK_OT_USHORT encodingID_WindowsUnicodeFull = SkTEndian_SwapBE16(10);
+
+        /** Offset of the subtable from the start of the table. */
+        SK_OT_ULONG offset;
+    }; //encodingRecords[numTables]
+
+    /** Segment mapping to delta values, for the BMP. */
+    struct Format4 {
+        SK_OT_USHORT format;
+        static const SK_OT_USHORT format_4 = SkTEndian_SwapBE16(4);
+        SK_OT_USHORT length;
+        SK_OT_USHORT language;
+        SK_OT_USHORT segCountX2;
+        SK_OT_USHORT searchRange;
+        SK_OT_USHORT entrySelector;
+        SK_OT_USHORT rangeShift;
+        //SK_OT_USHORT endCount[segCount];
+        //SK_OT_USHORT reservedPad;
+        //SK_OT_USHORT startCount[segCount];
+        //SK_OT_SHORT idDelta[segCount];
+        //SK_OT_USHORT idRangeOffset[segCount];
+        //SK_OT_USHORT glyphIdArray[];
+    };
+
+    /** Segmented coverage, for all of Unicode. */
+    struct Format12 {
+        SK_OT_USHORT format;
+        static const SK_OT_USHORT format_12 = SkTEndian_SwapBE16(12);
+        SK_OT_USHORT reserved;
+        SK_OT_ULONG length;
+        SK_OT_ULONG language;
+        SK_OT_ULONG numGroups;
+
+        struct SequentialMapGroup {
+            SK_OT_ULONG startCharCode;
+            SK_OT_ULONG endCharCode;
+            SK_OT_ULONG startGlyphID;
+        }; //groups[numGroups]
+    };
+};
+
+#pragma pack(pop)
+
+
+SK_COMPILE_ASSERT(sizeof(SkOTTableCharacterToGlyphIndexMapping) == 4, sizeof_SkOTTableCharacterToGlyphIndexMapping_not_4);
+SK_COMPILE_ASSERT(sizeof(SkOTTableCharacterToGlyphIndexMapping::EncodingRecord) == 8, sizeof_SkOTTableCharacterToGlyphIndexMapping_EncodingRecord_not_8);
+SK_COMPILE_ASSERT(sizeof(SkOTTableCharacterToGlyphIndexMapping::Format4) == 14, sizeof_SkOTTableCharacterToGlyphIndexMapping_Format4_not_14);
+SK_COMPILE_ASSERT(sizeof(SkOTTableCharacterToGlyphIndexMapping::Format12) == 16, sizeof_SkOTTableCharacterToGlyphIndexMapping_Format12_not_16);
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkOTTable_hmtx_DEFINED
+#define SkOTTable_hmtx_DEFINED
+
+#include "SkEndian.h"
+#include "SkOTTableTypes.h"
+
+#pragma pack(push, 1)
+
+struct SkOTTableHorizontalMetrics {
+    static const SK_OT_CHAR TAG0 = 'h';
+    static const SK_OT_CHAR TAG1 = 'm';
+    static const SK_OT_CHAR TAG2 = 't';
+    static const SK_OT_CHAR TAG3 = 'x';
+    static const SK_OT_ULONG TAG = SkOTTableTAG<SkOTTableHorizontalMetrics>::value;
+
+    struct FullMetric {
+        SK_OT_USHORT advanceWidth;
+        SK_OT_SHORT lsb;
+    } longHorMetric[1/*hhea::numberOfHMetrics*/];
+    /* The glyphs after the first numberOfHMetrics have the advance of the
+     * last full metric, and only their left side bearings follow.
+    SK_OT_SHORT leftSideBearing[maxp::numGlyphs - hhea::numberOfHMetrics];
+    */
+};
+
+#pragma pack(pop)
+
+
+#include <stddef.h>
+SK_COMPILE_ASSERT(sizeof(SkOTTableHorizontalMetrics::FullMetric) == 4, sizeof_SkOTTableHorizontalMetrics_FullMetric_not_4);
+
+#endif
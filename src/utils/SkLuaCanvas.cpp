@@ -268,6 +268,11 @@ void SkLuaCanvas::onDrawTextOnPath(const void* text, size_t byteLength, const Sk
     lua.pushPaint(paint, "paint");
 }
 
+void SkLuaCanvas::onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                                 const SkPaint& paint) {
+    this->drawTextBlobAsPosText(blob, x, y, paint);
+}
+
 void SkLuaCanvas::onDrawPicture(const SkPicture* picture) {
     AUTO_LUA("drawPicture");
     // call through so we can see the nested picture ops
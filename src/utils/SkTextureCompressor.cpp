@@ -7,9 +7,19 @@
 
 #include "SkTextureCompressor.h"
 
+#include "SkTextureCompressor_ASTC.h"
+#include "SkTextureCompressor_R11EAC.h"
+
 #include "SkBitmap.h"
+#include "SkBlitter.h"
+#include "SkColorPriv.h"
 #include "SkData.h"
 #include "SkEndian.h"
+#include "SkThreadPool.h"
+
+#ifndef SK_IGNORE_ETC1_SUPPORT
+#  include "etc1.h"
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////
 //
@@ -143,68 +153,334 @@ static uint64_t compress_latc_block(uint8_t block[16]) {
     return SkEndian_SwapLE64(result);
 }
 
-static SkData *compress_a8_to_latc(const SkBitmap &bm) {
-    // LATC compressed texels down into square 4x4 blocks
-    static const int kLATCBlockSize = 4;
+static void compress_a8_block_to_latc(uint8_t* dst, const uint8_t* src, size_t rowBytes) {
+    uint8_t block[16];
+    memcpy(block, src, 4);
+    memcpy(block + 4, src + rowBytes, 4);
+    memcpy(block + 8, src + 2*rowBytes, 4);
+    memcpy(block + 12, src + 3*rowBytes, 4);
+
+    const uint64_t encoded = compress_latc_block(block);
+    memcpy(dst, &encoded, sizeof(encoded));
+}
 
-    // Make sure that our data is well-formed enough to be
-    // considered for LATC compression
-    if (bm.width() == 0 || bm.height() == 0 ||
-        (bm.width() % kLATCBlockSize) != 0 ||
-        (bm.height() % kLATCBlockSize) != 0 ||
-        (bm.colorType() != kAlpha_8_SkColorType)) {
-        return NULL;
+////////////////////////////////////////////////////////////////////////////////
+//
+// ETC1 compressor
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SK_IGNORE_ETC1_SUPPORT
+
+// ETC1 has no alpha, so the (premultiplied) color channels are compressed
+// as they are.
+static void compress_n32_block_to_etc1(uint8_t* dst, const uint8_t* src, size_t rowBytes) {
+    etc1_byte block[ETC1_DECODED_BLOCK_SIZE];
+    for (int y = 0; y < 4; ++y) {
+        const SkPMColor* row = reinterpret_cast<const SkPMColor*>(src + y * rowBytes);
+        for (int x = 0; x < 4; ++x) {
+            etc1_byte* pixel = block + 3 * (x + 4 * y);
+            pixel[0] = SkGetPackedR32(row[x]);
+            pixel[1] = SkGetPackedG32(row[x]);
+            pixel[2] = SkGetPackedB32(row[x]);
+        }
     }
+    etc1_encode_block(block, 0xFFFF, dst);
+}
 
-    // The LATC format is 64 bits per 4x4 block.
-    static const int kLATCEncodedBlockSize = 8;
+#endif  // SK_IGNORE_ETC1_SUPPORT
 
-    int blocksX = bm.width() / kLATCBlockSize;
-    int blocksY = bm.height() / kLATCBlockSize;
+////////////////////////////////////////////////////////////////////////////////
+//
+// Block compression
+//
+////////////////////////////////////////////////////////////////////////////////
 
-    int compressedDataSize = blocksX * blocksY * kLATCEncodedBlockSize;
-    uint64_t* dst = reinterpret_cast<uint64_t*>(sk_malloc_throw(compressedDataSize));
+// Compresses the block of pixels whose top left pixel is src to dst.
+typedef void (*CompressBlockProc)(uint8_t* dst, const uint8_t* src, size_t rowBytes);
+
+struct FormatInfo {
+    int fBlockDimX;
+    int fBlockDimY;
+    int fEncodedBlockSize;
+};
+
+// Indexed by SkTextureCompressor::Format.
+static const FormatInfo kFormatInfo[] = {
+    {  4,  4,  8 },  // kLATC_Format
+    {  4,  4,  8 },  // kR11_EAC_Format
+    { 12, 12, 16 },  // kASTC_12x12_Format
+    {  4,  4,  8 },  // kETC1_Format
+};
+SK_COMPILE_ASSERT(SK_ARRAY_COUNT(kFormatInfo) == SkTextureCompressor::kFormatCnt,
+                  format_info_count_mismatch);
+
+static CompressBlockProc choose_block_proc(SkColorType colorType,
+                                           SkTextureCompressor::Format format) {
+    switch (format) {
+        case SkTextureCompressor::kLATC_Format:
+            return kAlpha_8_SkColorType == colorType ? compress_a8_block_to_latc : NULL;
+        case SkTextureCompressor::kR11_EAC_Format:
+            return kAlpha_8_SkColorType == colorType ?
+                SkTextureCompressor::CompressA8BlockToR11EAC : NULL;
+        case SkTextureCompressor::kASTC_12x12_Format:
+            return kAlpha_8_SkColorType == colorType ?
+                SkTextureCompressor::CompressA8BlockToASTC12x12 : NULL;
+        case SkTextureCompressor::kETC1_Format:
+#ifndef SK_IGNORE_ETC1_SUPPORT
+            return kN32_SkColorType == colorType ? compress_n32_block_to_etc1 : NULL;
+#else
+            return NULL;
+#endif
+    }
+    SkDEBUGFAIL("Unknown format");
+    return NULL;
+}
 
-    uint8_t block[16];
-    const uint8_t* row = reinterpret_cast<const uint8_t*>(bm.getPixels());
-    uint64_t* encPtr = dst;
-    for (int y = 0; y < blocksY; ++y) {
-        for (int x = 0; x < blocksX; ++x) {
-            memcpy(block, row + (kLATCBlockSize * x), 4);
-            memcpy(block + 4, row + bm.rowBytes() + (kLATCBlockSize * x), 4);
-            memcpy(block + 8, row + 2*bm.rowBytes() + (kLATCBlockSize * x), 4);
-            memcpy(block + 12, row + 3*bm.rowBytes() + (kLATCBlockSize * x), 4);
-
-            *encPtr = compress_latc_block(block);
-            ++encPtr;
+// What compress_block_rows needs to compress any row of blocks of an image.
+struct BlockRowsRec {
+    uint8_t*            fDst;
+    const uint8_t*      fSrc;
+    size_t              fRowBytes;
+    int                 fBytesPerPixel;
+    int                 fBlocksX;
+    CompressBlockProc   fProc;
+    FormatInfo          fInfo;
+};
+
+static void compress_block_rows(const BlockRowsRec& rec, int startBlockY, int endBlockY) {
+    const size_t dstRowBytes = rec.fBlocksX * rec.fInfo.fEncodedBlockSize;
+    uint8_t* dst = rec.fDst + startBlockY * dstRowBytes;
+    for (int blockY = startBlockY; blockY < endBlockY; ++blockY) {
+        const uint8_t* src = rec.fSrc + blockY * rec.fInfo.fBlockDimY * rec.fRowBytes;
+        for (int blockX = 0; blockX < rec.fBlocksX; ++blockX) {
+            rec.fProc(dst, src, rec.fRowBytes);
+            dst += rec.fInfo.fEncodedBlockSize;
+            src += rec.fInfo.fBlockDimX * rec.fBytesPerPixel;
         }
-        row += kLATCBlockSize * bm.rowBytes();
     }
-
-    return SkData::NewFromMalloc(dst, compressedDataSize);
 }
 
+class CompressBlockRowsProc : public SkRunnable {
+public:
+    CompressBlockRowsProc() : fRec(NULL), fStartBlockY(0), fEndBlockY(0) {}
+
+    void init(const BlockRowsRec* rec, int startBlockY, int endBlockY) {
+        fRec = rec;
+        fStartBlockY = startBlockY;
+        fEndBlockY = endBlockY;
+    }
+
+    virtual void run() SK_OVERRIDE {
+        compress_block_rows(*fRec, fStartBlockY, fEndBlockY);
+    }
+
+private:
+    const BlockRowsRec* fRec;
+    int                 fStartBlockY;
+    int                 fEndBlockY;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Compressed blitter
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// Collects the coverage of one row of blocks at a time in an A8 buffer, and
+// compresses it once the scan converter moves past it.
+class CompressedA8Blitter : public SkBlitter {
+public:
+    CompressedA8Blitter(int width, int height, uint8_t* dst, CompressBlockProc proc,
+                        const FormatInfo& info)
+        : fHeight(height)
+        , fBandY(0)
+        , fBand(width * info.fBlockDimY) {
+        fRec.fDst = dst;
+        fRec.fSrc = fBand.get();
+        fRec.fRowBytes = width;
+        fRec.fBytesPerPixel = 1;
+        fRec.fBlocksX = width / info.fBlockDimX;
+        fRec.fProc = proc;
+        fRec.fInfo = info;
+        memset(fBand.get(), 0, width * info.fBlockDimY);
+    }
+
+    virtual ~CompressedA8Blitter() {
+        while (fBandY < fHeight) {
+            this->flushBand();
+        }
+    }
+
+    virtual void blitH(int x, int y, int width) SK_OVERRIDE {
+        uint8_t* row = this->row(y);
+        if (NULL != row) {
+            memset(row + x, 0xFF, width);
+        }
+    }
+
+    virtual void blitAntiH(int x, int y, const SkAlpha antialias[],
+                           const int16_t runs[]) SK_OVERRIDE {
+        uint8_t* row = this->row(y);
+        if (NULL == row) {
+            return;
+        }
+        for (;;) {
+            const int count = runs[0];
+            SkASSERT(count >= 0);
+            if (count <= 0) {
+                break;
+            }
+            memset(row + x, antialias[0], count);
+            runs += count;
+            antialias += count;
+            x += count;
+        }
+    }
+
+    virtual void blitV(int x, int y, int height, SkAlpha alpha) SK_OVERRIDE {
+        for (int i = 0; i < height; ++i) {
+            uint8_t* row = this->row(y + i);
+            if (NULL != row) {
+                row[x] = alpha;
+            }
+        }
+    }
+
+    virtual void blitRect(int x, int y, int width, int height) SK_OVERRIDE {
+        for (int i = 0; i < height; ++i) {
+            this->blitH(x, y + i, width);
+        }
+    }
+
+    virtual void blitMask(const SkMask& mask, const SkIRect& clip) SK_OVERRIDE {
+        if (SkMask::kA8_Format != mask.fFormat) {
+            this->INHERITED::blitMask(mask, clip);
+            return;
+        }
+        for (int y = clip.fTop; y < clip.fBottom; ++y) {
+            uint8_t* row = this->row(y);
+            if (NULL != row) {
+                memcpy(row + clip.fLeft, mask.getAddr8(clip.fLeft, y), clip.width());
+            }
+        }
+    }
+
+private:
+    // Returns the buffer for row y, after compressing the rows of blocks
+    // above it, or NULL if those were already compressed.
+    uint8_t* row(int y) {
+        SkASSERT(y < fHeight);
+        if (y < fBandY) {
+            SkDEBUGFAIL("Rows must be blitted in increasing order");
+            return NULL;
+        }
+        while (y >= fBandY + fRec.fInfo.fBlockDimY) {
+            this->flushBand();
+        }
+        return fBand.get() + (y - fBandY) * fRec.fRowBytes;
+    }
+
+    void flushBand() {
+        const int blockY = fBandY / fRec.fInfo.fBlockDimY;
+        BlockRowsRec band = fRec;
+        band.fDst += blockY * fRec.fBlocksX * fRec.fInfo.fEncodedBlockSize;
+        compress_block_rows(band, 0, 1);
+        memset(fBand.get(), 0, fRec.fRowBytes * fRec.fInfo.fBlockDimY);
+        fBandY += fRec.fInfo.fBlockDimY;
+    }
+
+    const int               fHeight;
+    int                     fBandY;
+    SkAutoTArray<uint8_t>   fBand;
+    BlockRowsRec            fRec;
+
+    typedef SkBlitter INHERITED;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace SkTextureCompressor {
 
-typedef SkData *(*CompressBitmapProc)(const SkBitmap &bitmap);
+void GetBlockDimensions(Format format, int* dimX, int* dimY) {
+    *dimX = kFormatInfo[format].fBlockDimX;
+    *dimY = kFormatInfo[format].fBlockDimY;
+}
 
-SkData *CompressBitmapToFormat(const SkBitmap &bitmap, Format format) {
-    SkAutoLockPixels alp(bitmap);
+int GetCompressedDataSize(Format format, int width, int height) {
+    const FormatInfo& info = kFormatInfo[format];
+    if (width <= 0 || height <= 0 ||
+        (width % info.fBlockDimX) != 0 || (height % info.fBlockDimY) != 0) {
+        return -1;
+    }
+    return (width / info.fBlockDimX) * (height / info.fBlockDimY) * info.fEncodedBlockSize;
+}
 
-    CompressBitmapProc kProcMap[kLastEnum_SkColorType + 1][kFormatCnt];
-    memset(kProcMap, 0, sizeof(kProcMap));
+bool CompressBufferToFormat(uint8_t* dst, const uint8_t* src, SkColorType srcColorType,
+                            int width, int height, size_t rowBytes, Format format,
+                            int threadCount) {
+    CompressBlockProc proc = choose_block_proc(srcColorType, format);
+    if (NULL == proc || GetCompressedDataSize(format, width, height) < 0) {
+        return false;
+    }
 
-    // Map available bitmap configs to compression functions
-    kProcMap[kAlpha_8_SkColorType][kLATC_Format] = compress_a8_to_latc;
+    BlockRowsRec rec;
+    rec.fDst = dst;
+    rec.fSrc = src;
+    rec.fRowBytes = rowBytes;
+    rec.fBytesPerPixel = SkColorTypeBytesPerPixel(srcColorType);
+    rec.fBlocksX = width / kFormatInfo[format].fBlockDimX;
+    rec.fProc = proc;
+    rec.fInfo = kFormatInfo[format];
+
+    const int blocksY = height / rec.fInfo.fBlockDimY;
+    if (threadCount < 0) {
+        threadCount = num_cores();
+    }
+    const int bandCount = SkMin32(threadCount, blocksY);
+    if (bandCount < 2) {
+        compress_block_rows(rec, 0, blocksY);
+        return true;
+    }
 
-    CompressBitmapProc proc = kProcMap[bitmap.colorType()][format];
-    if (NULL != proc) {
-        return proc(bitmap);
+    SkAutoTArray<CompressBlockRowsProc> procs(bandCount);
+    SkThreadPool pool(bandCount);
+    for (int i = 0; i < bandCount; ++i) {
+        procs[i].init(&rec, blocksY * i / bandCount, blocksY * (i + 1) / bandCount);
+        pool.add(&procs[i]);
     }
+    pool.wait();
+    return true;
+}
 
-    return NULL;
+SkData *CompressBitmapToFormat(const SkBitmap &bitmap, Format format, int threadCount) {
+    SkAutoLockPixels alp(bitmap);
+
+    const int compressedDataSize = GetCompressedDataSize(format, bitmap.width(),
+                                                         bitmap.height());
+    if (compressedDataSize < 0 || NULL == bitmap.getPixels()) {
+        return NULL;
+    }
+
+    uint8_t* dst = reinterpret_cast<uint8_t*>(sk_malloc_throw(compressedDataSize));
+    if (!CompressBufferToFormat(dst, reinterpret_cast<const uint8_t*>(bitmap.getPixels()),
+                                bitmap.colorType(), bitmap.width(), bitmap.height(),
+                                bitmap.rowBytes(), format, threadCount)) {
+        sk_free(dst);
+        return NULL;
+    }
+    return SkData::NewFromMalloc(dst, compressedDataSize);
+}
+
+SkBlitter* CreateBlitterForFormat(int width, int height, void* compressedBuffer,
+                                  Format format) {
+    CompressBlockProc proc = choose_block_proc(kAlpha_8_SkColorType, format);
+    if (NULL == proc || GetCompressedDataSize(format, width, height) < 0) {
+        return NULL;
+    }
+    return SkNEW_ARGS(CompressedA8Blitter, (width, height,
+                                            reinterpret_cast<uint8_t*>(compressedBuffer),
+                                            proc, kFormatInfo[format]));
 }
 
 }  // namespace SkTextureCompressor
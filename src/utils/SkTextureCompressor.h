@@ -8,24 +8,65 @@
 #ifndef SkTextureCompressor_DEFINED
 #define SkTextureCompressor_DEFINED
 
+#include "SkImageInfo.h"
+
 class SkBitmap;
+class SkBlitter;
 class SkData;
 
 namespace SkTextureCompressor {
     // Various texture compression formats that we support.
     enum Format {
-        // Alpha only format.
-        kLATC_Format,
+        // Alpha only formats.
+        kLATC_Format,       // 4x4 blocks, compresses A8
+        kR11_EAC_Format,    // 4x4 blocks, compresses A8
+        kASTC_12x12_Format, // 12x12 blocks, compresses A8
+
+        // RGB formats.
+        kETC1_Format,       // 4x4 blocks, compresses N32
 
-        kLast_Format = kLATC_Format
+        kLast_Format = kETC1_Format
     };
     static const int kFormatCnt = kLast_Format + 1;
 
+    // Returns the width and height, in pixels, of the blocks of the format.
+    // Images compressed to the format must have dimensions that are a
+    // multiple of these.
+    void GetBlockDimensions(Format format, int* dimX, int* dimY);
+
+    // Returns the number of bytes needed to hold an image of the given
+    // dimensions compressed to the format, or -1 if the dimensions are not
+    // a multiple of the block dimensions.
+    int GetCompressedDataSize(Format format, int width, int height);
+
     // Returns an SkData holding a blob of compressed data that corresponds
-    // to the bitmap. If the bitmap colorType cannot be compressed using the 
+    // to the bitmap. If the bitmap colorType cannot be compressed using the
     // associated format, then we return NULL. The caller is responsible for
     // calling unref() on the returned data.
-    SkData* CompressBitmapToFormat(const SkBitmap& bitmap, Format format);
+    //
+    // Rows of blocks are independent, so they are compressed in parallel on
+    // up to threadCount threads. SkThreadPool::kThreadPerCore uses one
+    // thread per core.
+    SkData* CompressBitmapToFormat(const SkBitmap& bitmap, Format format,
+                                   int threadCount = 1);
+
+    // Compresses the pixels in src, which have the given color type and
+    // dimensions, into dst, which must hold GetCompressedDataSize() bytes.
+    // Returns false if the color type cannot be compressed using the format
+    // or the dimensions are not a multiple of its block dimensions.
+    bool CompressBufferToFormat(uint8_t* dst, const uint8_t* src, SkColorType srcColorType,
+                                int width, int height, size_t rowBytes, Format format,
+                                int threadCount = 1);
+
+    // Returns a blitter that compresses the A8 coverage it is given into
+    // compressedBuffer, which must hold GetCompressedDataSize() bytes, one
+    // row of blocks at a time, without ever holding the whole A8 mask. The
+    // rows must be blitted in increasing order, as the scan converters do.
+    // Pixels that are never blitted are zero. The buffer is complete once
+    // the blitter is deleted. Returns NULL if the format does not compress
+    // A8 or the dimensions are not a multiple of its block dimensions.
+    SkBlitter* CreateBlitterForFormat(int width, int height, void* compressedBuffer,
+                                      Format format);
 }
 
 #endif
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTextureCompressor_ASTC.h"
+
+#include "SkEndian.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ASTC compressor
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// ASTC has many block modes. For A8 masks we always use the same one, which
+// keeps the encoder simple and fast:
+//
+// - a single partition with LDR luminance endpoints (color endpoint mode 0),
+// - a 6x5 grid of weights, each quantized to 3 bits,
+// - two 8-bit endpoints, which fit in the bits the weights leave over.
+//
+// The 128 bits of a block, little endian, are then:
+//
+// bits 0-10:    block mode (see kBlockMode)
+// bits 11-12:   partition count - 1 = 0
+// bits 13-16:   color endpoint mode = 0
+// bits 17-24:   endpoint 0
+// bits 25-32:   endpoint 1
+// bits 38-127:  the 30 weights, with their bits in reverse order, starting
+//               from bit 127
+//
+// The decoder infills the weight grid bilinearly to the 12x12 texels, so we
+// choose each weight by sampling the block at the position of the weight in
+// the grid.
+
+static const int kBlockDim = 12;
+static const int kWeightGridX = 6;
+static const int kWeightGridY = 5;
+static const int kWeightCount = kWeightGridX * kWeightGridY;
+static const int kWeightBits = 3;
+SK_COMPILE_ASSERT(17 + 16 + kWeightCount * kWeightBits <= 128, ASTC_weights_fit);
+
+// Block mode bits, from the most significant:
+// D=0 (single plane), H=0, B=2 (width B+4=6), A=3 (height A+2=5),
+// R=0b111 (weights range 0..7) split as R0 in bit 4 and R2R1 in bits 0-1,
+// and 00 in bits 2-3, which selects the B+4 x A+2 layout.
+static const int kBlockMode = (2 << 7) | (3 << 5) | (1 << 4) | 3;
+
+// The unquantized values of the 3-bit weights, out of 64.
+static const int kWeightValues[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+
+static int quantize_weight(int weight64) {
+    int best = 0;
+    for (int i = 1; i < 8; ++i) {
+        if (SkAbs32(kWeightValues[i] - weight64) < SkAbs32(kWeightValues[best] - weight64)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Sets bits [start, start + count) of the little endian 128-bit block.
+static void write_bits(uint64_t block[2], int start, int count, uint64_t value) {
+    SkASSERT(start + count <= 128);
+    for (int i = 0; i < count; ++i) {
+        const int bit = start + i;
+        block[bit >> 6] |= ((value >> i) & 1) << (bit & 63);
+    }
+}
+
+namespace SkTextureCompressor {
+
+void CompressA8BlockToASTC12x12(uint8_t* dst, const uint8_t* src, size_t rowBytes) {
+    int minVal = 255;
+    int maxVal = 0;
+    for (int y = 0; y < kBlockDim; ++y) {
+        for (int x = 0; x < kBlockDim; ++x) {
+            minVal = SkMin32(minVal, src[y * rowBytes + x]);
+            maxVal = SkMax32(maxVal, src[y * rowBytes + x]);
+        }
+    }
+
+    uint64_t block[2] = { 0, 0 };
+    write_bits(block, 0, 11, kBlockMode);
+    write_bits(block, 17, 8, minVal);
+    write_bits(block, 25, 8, maxVal);
+
+    if (minVal != maxVal) {
+        const int range = maxVal - minVal;
+        for (int j = 0; j < kWeightGridY; ++j) {
+            // The position of the weight in the block, in 16.16 fixed point.
+            const int fy = j * ((kBlockDim - 1) << 16) / (kWeightGridY - 1);
+            const int y0 = fy >> 16;
+            const int y1 = SkMin32(y0 + 1, kBlockDim - 1);
+            const int wy = (fy >> 8) & 0xFF;
+            for (int i = 0; i < kWeightGridX; ++i) {
+                const int fx = i * ((kBlockDim - 1) << 16) / (kWeightGridX - 1);
+                const int x0 = fx >> 16;
+                const int x1 = SkMin32(x0 + 1, kBlockDim - 1);
+                const int wx = (fx >> 8) & 0xFF;
+
+                const uint8_t* row0 = src + y0 * rowBytes;
+                const uint8_t* row1 = src + y1 * rowBytes;
+                const int top = row0[x0] * (256 - wx) + row0[x1] * wx;
+                const int bottom = row1[x0] * (256 - wx) + row1[x1] * wx;
+                const int value = top * (256 - wy) + bottom * wy;  // value * 2^16
+
+                const int weight64 = (((value >> 8) - (minVal << 8)) * 64 / range + 128) >> 8;
+                const int weight = quantize_weight(weight64);
+
+                // The weights are stored from the top of the block down, with
+                // their bits reversed, so reverse the bits here too.
+                const int index = j * kWeightGridX + i;
+                for (int b = 0; b < kWeightBits; ++b) {
+                    write_bits(block, 127 - (index * kWeightBits + b), 1, (weight >> b) & 1);
+                }
+            }
+        }
+    }
+    // else all the weights are zero, and the block decodes to endpoint 0.
+
+    block[0] = SkEndian_SwapLE64(block[0]);
+    block[1] = SkEndian_SwapLE64(block[1]);
+    memcpy(dst, block, sizeof(block));
+}
+
+}  // namespace SkTextureCompressor
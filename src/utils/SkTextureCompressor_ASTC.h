@@ -0,0 +1,20 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTextureCompressor_ASTC_DEFINED
+#define SkTextureCompressor_ASTC_DEFINED
+
+#include "SkTypes.h"
+
+namespace SkTextureCompressor {
+
+    // Compresses the 12x12 block of A8 pixels whose top left pixel is src
+    // into the 16 bytes of LDR ASTC at dst.
+    void CompressA8BlockToASTC12x12(uint8_t* dst, const uint8_t* src, size_t rowBytes);
+}
+
+#endif  // SkTextureCompressor_ASTC_DEFINED
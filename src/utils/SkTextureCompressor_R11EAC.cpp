@@ -0,0 +1,215 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTextureCompressor_R11EAC.h"
+
+#include "SkEndian.h"
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// R11 EAC compressor
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// An R11 EAC block is 64 bits, stored big endian:
+//
+// bits 63-56: base codeword
+// bits 55-52: multiplier
+// bits 51-48: modifier table index
+// bits 47-0:  sixteen 3-bit indices into the modifier table, for the pixels
+//             in column-major order: (0,0), (0,1), ..., (3,3)
+//
+// Each pixel decodes to the 11 bit value
+//
+// clamp(base*8 + 4 + modifier*multiplier*8, 0, 2047), if multiplier != 0
+// clamp(base*8 + 4 + modifier, 0, 2047),              if multiplier == 0
+//
+// where modifier = kModifierTable[table index][pixel index].
+
+static const int kModifierTable[16][8] = {
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 },
+};
+
+// Indices of the most negative and the most positive modifier in each table.
+static const int kMinModifierIndex = 3;
+static const int kMaxModifierIndex = 7;
+
+static const int kR11Max = 2047;
+
+// Widen to 11 bits by replicating the high bits, so that 0 and 255 map to 0
+// and 2047.
+static inline int16_t a8_to_r11(uint8_t a) {
+    return (a << 3) | (a >> 5);
+}
+
+static void compute_palette(int base, int multiplier, int table, int16_t palette[8]) {
+    const int base11 = base * 8 + 4;
+    for (int i = 0; i < 8; ++i) {
+        const int modifier = kModifierTable[table][i];
+        const int value = multiplier ? base11 + modifier * multiplier * 8 : base11 + modifier;
+        palette[i] = SkPin32(value, 0, kR11Max);
+    }
+}
+
+// Find the palette entry nearest to each of the 16 pixels and store its index
+// in indices. Return the sum of the squared errors.
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+static uint32_t find_indices(const int16_t pixels[16], const int16_t palette[8],
+                             uint8_t indices[16]) {
+    const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+    const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 8));
+    __m128i best0 = _mm_set1_epi16(0x7FFF);
+    __m128i best1 = best0;
+    __m128i index0 = _mm_setzero_si128();
+    __m128i index1 = index0;
+    for (int i = 0; i < 8; ++i) {
+        const __m128i value = _mm_set1_epi16(palette[i]);
+        const __m128i i16 = _mm_set1_epi16(i);
+        // The values are 11 bits, so the differences cannot overflow.
+        const __m128i diff0 = _mm_max_epi16(_mm_sub_epi16(p0, value), _mm_sub_epi16(value, p0));
+        const __m128i diff1 = _mm_max_epi16(_mm_sub_epi16(p1, value), _mm_sub_epi16(value, p1));
+        const __m128i better0 = _mm_cmplt_epi16(diff0, best0);
+        const __m128i better1 = _mm_cmplt_epi16(diff1, best1);
+        best0 = _mm_min_epi16(diff0, best0);
+        best1 = _mm_min_epi16(diff1, best1);
+        index0 = _mm_or_si128(_mm_andnot_si128(better0, index0), _mm_and_si128(better0, i16));
+        index1 = _mm_or_si128(_mm_andnot_si128(better1, index1), _mm_and_si128(better1, i16));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), _mm_packus_epi16(index0, index1));
+
+    // Each squared error fits in 22 bits, so the sums fit in 32.
+    __m128i error = _mm_add_epi32(_mm_madd_epi16(best0, best0), _mm_madd_epi16(best1, best1));
+    error = _mm_add_epi32(error, _mm_srli_si128(error, 8));
+    error = _mm_add_epi32(error, _mm_srli_si128(error, 4));
+    return _mm_cvtsi128_si32(error);
+}
+#else
+static uint32_t find_indices(const int16_t pixels[16], const int16_t palette[8],
+                             uint8_t indices[16]) {
+    uint32_t error = 0;
+    for (int p = 0; p < 16; ++p) {
+        int best = SkAbs32(pixels[p] - palette[0]);
+        int bestIndex = 0;
+        for (int i = 1; i < 8; ++i) {
+            const int diff = SkAbs32(pixels[p] - palette[i]);
+            if (diff < best) {
+                best = diff;
+                bestIndex = i;
+            }
+        }
+        indices[p] = bestIndex;
+        error += best * best;
+    }
+    return error;
+}
+#endif
+
+static uint64_t pack_r11eac_block(int base, int multiplier, int table, const uint8_t indices[16]) {
+    uint64_t block = (static_cast<uint64_t>(base) << 56) |
+                     (static_cast<uint64_t>(multiplier) << 52) |
+                     (static_cast<uint64_t>(table) << 48);
+    for (int i = 0; i < 16; ++i) {
+        block |= static_cast<uint64_t>(indices[i]) << (45 - 3 * i);
+    }
+    return SkEndian_SwapBE64(block);
+}
+
+// For each modifier table, we choose the multipliers that stretch the table
+// across the range of the block, and the base that centers it, and keep the
+// combination with the smallest error. Most blocks of a mask are entirely
+// transparent or opaque, so those get a canned encoding.
+static uint64_t compress_r11eac_block(const int16_t pixels[16]) {
+    int minVal = kR11Max;
+    int maxVal = 0;
+    for (int i = 0; i < 16; ++i) {
+        minVal = SkMin32(minVal, pixels[i]);
+        maxVal = SkMax32(maxVal, pixels[i]);
+    }
+
+    uint8_t indices[16];
+    if (minVal == maxVal && (0 == minVal || kR11Max == minVal)) {
+        // The extreme modifiers of table 0, times eight, overshoot either end.
+        memset(indices, 0 == minVal ? kMinModifierIndex : kMaxModifierIndex, sizeof(indices));
+        return pack_r11eac_block(0 == minVal ? 0 : 255, 1, 0, indices);
+    }
+
+    const int range = maxVal - minVal;
+    const int mid = (minVal + maxVal + 1) >> 1;
+
+    uint32_t bestError = SK_MaxU32;
+    int bestBase = 0;
+    int bestMultiplier = 0;
+    int bestTable = 0;
+    uint8_t bestIndices[16];
+    int16_t palette[8];
+    for (int table = 0; table < 16 && bestError > 0; ++table) {
+        const int lo = kModifierTable[table][kMinModifierIndex];
+        const int hi = kModifierTable[table][kMaxModifierIndex];
+        const int stretch = range / ((hi - lo) * 8);
+
+        int multipliers[3];
+        int multiplierCount = 0;
+        if (range <= hi - lo) {
+            // Without a multiplier the modifiers are single steps.
+            multipliers[multiplierCount++] = 0;
+        }
+        multipliers[multiplierCount++] = SkPin32(stretch, 1, 15);
+        if (stretch + 1 <= 15) {
+            multipliers[multiplierCount++] = SkMax32(stretch + 1, 2);
+        }
+
+        for (int m = 0; m < multiplierCount; ++m) {
+            const int multiplier = multipliers[m];
+            const int center = multiplier ? (lo + hi) * multiplier * 4 : (lo + hi) / 2;
+            const int base = SkPin32((mid - center) >> 3, 0, 255);
+            compute_palette(base, multiplier, table, palette);
+            const uint32_t error = find_indices(pixels, palette, indices);
+            if (error < bestError) {
+                bestError = error;
+                bestBase = base;
+                bestMultiplier = multiplier;
+                bestTable = table;
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+        }
+    }
+    return pack_r11eac_block(bestBase, bestMultiplier, bestTable, bestIndices);
+}
+
+namespace SkTextureCompressor {
+
+void CompressA8BlockToR11EAC(uint8_t* dst, const uint8_t* src, size_t rowBytes) {
+    int16_t pixels[16];
+    for (int x = 0; x < 4; ++x) {
+        for (int y = 0; y < 4; ++y) {
+            pixels[4 * x + y] = a8_to_r11(src[y * rowBytes + x]);
+        }
+    }
+    const uint64_t block = compress_r11eac_block(pixels);
+    memcpy(dst, &block, sizeof(block));
+}
+
+}  // namespace SkTextureCompressor
@@ -0,0 +1,20 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTextureCompressor_R11EAC_DEFINED
+#define SkTextureCompressor_R11EAC_DEFINED
+
+#include "SkTypes.h"
+
+namespace SkTextureCompressor {
+
+    // Compresses the 4x4 block of A8 pixels whose top left pixel is src into
+    // the 8 bytes of R11 EAC at dst.
+    void CompressA8BlockToR11EAC(uint8_t* dst, const uint8_t* src, size_t rowBytes);
+}
+
+#endif  // SkTextureCompressor_R11EAC_DEFINED
@@ -362,6 +362,8 @@ static void did_dx_affect(skiatest::Reporter* reporter, const SkScalar dx[],
         rc1.op(r, SkRegion::kIntersect_Op, true);
         r.offset(-2*dx[i], 0);
         rc2.op(r, SkRegion::kIntersect_Op, true);
+        rc1.realize();
+        rc2.realize();
 
         REPORTER_ASSERT(reporter, changed != (rc0 == rc1));
         REPORTER_ASSERT(reporter, changed != (rc0 == rc2));
@@ -382,6 +384,141 @@ static void test_nearly_integral(skiatest::Reporter* reporter) {
     did_dx_affect(reporter, gUnsafeX, SK_ARRAY_COUNT(gUnsafeX), true);
 }
 
+static SkRRect rect_rrect(const SkRect& r) {
+    SkRRect rrect;
+    rrect.setRect(r);
+    return rrect;
+}
+
+static void make_shape_clip(const SkRRect& shape, bool doAA, SkRasterClip* rc) {
+    SkPath path;
+    path.addRRect(shape);
+    rc->setPath(path, SkIRect::MakeWH(100, 100), doAA);
+}
+
+// Makes the clip of intersecting a and b by combining their clips.
+static void make_combined_clip(const SkRRect& a, bool aIsAA, const SkRRect& b, bool bIsAA,
+                               SkRasterClip* rc) {
+    SkRasterClip other;
+    make_shape_clip(a, aIsAA, rc);
+    make_shape_clip(b, bIsAA, &other);
+    rc->op(other, SkRegion::kIntersect_Op);
+}
+
+// Clipping to rects and round rects that reduce to one shape makes the clip
+// of that shape alone, which is the clip that combining them makes.
+static void test_reduced_shapes(skiatest::Reporter* reporter) {
+    const SkIRect device = SkIRect::MakeWH(100, 100);
+    SkRasterClip rc(device);
+    SkRRect shape;
+    bool doAA;
+    REPORTER_ASSERT(reporter, rc.getShape(&shape, &doAA));
+    REPORTER_ASSERT(reporter, shape.isRect() && !doAA);
+    REPORTER_ASSERT(reporter, shape.rect() == SkRect::Make(device));
+
+    // two AA rects with edges in the same pixels multiply their coverages
+    const SkRect a = SkRect::MakeLTRB(10.25f, 10.5f, 80.5f, 70.75f);
+    const SkRect b = SkRect::MakeLTRB(20.5f, 5.25f, 90.25f, 60.5f);
+    SkRasterClip expected;
+    rc.op(a, SkRegion::kIntersect_Op, true);
+    REPORTER_ASSERT(reporter, !rc.quickIntersect(rect_rrect(b), true));
+    rc.op(b, SkRegion::kIntersect_Op, true);
+    REPORTER_ASSERT(reporter, !rc.getShape(&shape, &doAA));
+    make_combined_clip(rect_rrect(a), true, rect_rrect(b), true, &expected);
+    REPORTER_ASSERT(reporter, rc == expected);
+
+    // as do an AA rect and an AA rect inside it with an edge in the same pixel
+    const SkRect inA = SkRect::MakeLTRB(10.75f, 20.5f, 60.5f, 50.5f);
+    rc.setRect(device);
+    rc.op(a, SkRegion::kIntersect_Op, true);
+    REPORTER_ASSERT(reporter, !rc.quickIntersect(rect_rrect(inA), true));
+    rc.realize();
+    make_combined_clip(rect_rrect(a), true, rect_rrect(inA), true, &expected);
+    rc.op(inA, SkRegion::kIntersect_Op, true);
+    REPORTER_ASSERT(reporter, rc == expected);
+
+    // an AA rect and a BW rect reduce to their intersection
+    const SkRect bwB = SkRect::MakeLTRB(20, 5, 90, 60);
+    SkRect ab;
+    ab.intersect(a, bwB);
+    rc.setRect(device);
+    rc.op(a, SkRegion::kIntersect_Op, true);
+    REPORTER_ASSERT(reporter, rc.quickIntersect(rect_rrect(bwB), false));
+    REPORTER_ASSERT(reporter, rc.getShape(&shape, &doAA));
+    REPORTER_ASSERT(reporter, shape.isRect() && doAA && shape.rect() == ab);
+    rc.realize();
+    make_combined_clip(rect_rrect(a), true, rect_rrect(bwB), false, &expected);
+    REPORTER_ASSERT(reporter, rc == expected);
+
+    // a round rect containing the pixels of the clip leaves it
+    SkRRect outer;
+    outer.setRectXY(SkRect::MakeLTRB(0, 0, 100, 100), 10, 10);
+    REPORTER_ASSERT(reporter, rc.quickIntersect(outer, true));
+    REPORTER_ASSERT(reporter, rc == expected);
+
+    // a round rect inside the clip replaces it
+    SkRRect inner;
+    inner.setRectXY(SkRect::MakeLTRB(25.5f, 15.5f, 75.5f, 55.5f), 8, 8);
+    REPORTER_ASSERT(reporter, rc.quickIntersect(inner, true));
+    REPORTER_ASSERT(reporter, rc.getShape(&shape, &doAA));
+    REPORTER_ASSERT(reporter, shape == inner && doAA);
+    rc.realize();
+    make_combined_clip(rect_rrect(ab), true, inner, true, &expected);
+    REPORTER_ASSERT(reporter, rc == expected);
+    make_shape_clip(inner, true, &expected);
+    REPORTER_ASSERT(reporter, rc == expected);
+
+    SkRasterClip bw(device);
+    REPORTER_ASSERT(reporter, bw.quickIntersect(inner, false));
+    bw.realize();
+    make_shape_clip(inner, false, &expected);
+    REPORTER_ASSERT(reporter, bw == expected);
+
+    // a rect inside the round rect replaces it
+    const SkRect c = SkRect::MakeLTRB(30.5f, 25.5f, 70.5f, 45.5f);
+    rc.op(c, SkRegion::kIntersect_Op, true);
+    REPORTER_ASSERT(reporter, rc.getShape(&shape, &doAA));
+    REPORTER_ASSERT(reporter, shape.rect() == c && doAA);
+    rc.realize();
+    make_combined_clip(inner, true, rect_rrect(c), true, &expected);
+    REPORTER_ASSERT(reporter, rc == expected);
+
+    // the shape moves with the clip
+    SkRasterClip moved;
+    rc.translate(3, -4, &moved);
+    REPORTER_ASSERT(reporter, moved.getShape(&shape, &doAA));
+    REPORTER_ASSERT(reporter, shape.rect() == c.makeOffset(3, -4));
+
+    // a copy made before the clip is realized realizes to the same clip
+    rc.setRect(device);
+    REPORTER_ASSERT(reporter, rc.quickIntersect(inner, true));
+    SkRasterClip copy(rc);
+    copy.realize();
+    make_shape_clip(inner, true, &expected);
+    REPORTER_ASSERT(reporter, copy == expected);
+
+    // round rects that only overlap are not reduced
+    SkRRect overlap;
+    overlap.setRectXY(SkRect::MakeLTRB(50.5f, 40.5f, 95.5f, 95.5f), 8, 8);
+    REPORTER_ASSERT(reporter, !rc.quickIntersect(overlap, true));
+
+    // nor are BW and AA round rects
+    REPORTER_ASSERT(reporter, !rc.quickIntersect(outer, false));
+    rc.realize();
+    REPORTER_ASSERT(reporter, rc == expected);
+
+    // other ops lose the shape
+    rc.op(SkIRect::MakeLTRB(40, 30, 50, 40), SkRegion::kDifference_Op);
+    REPORTER_ASSERT(reporter, !rc.getShape(&shape, &doAA));
+    REPORTER_ASSERT(reporter, !rc.quickIntersect(outer, true));
+
+    // disjoint rects
+    rc.setRect(device);
+    rc.op(a, SkRegion::kIntersect_Op, true);
+    rc.op(SkRect::MakeLTRB(85.5f, 5, 95, 95), SkRegion::kIntersect_Op, true);
+    REPORTER_ASSERT(reporter, rc.isEmpty());
+}
+
 static void test_regressions() {
     // these should not assert in the debug build
     // bug was introduced in rev. 3209
@@ -404,4 +541,5 @@ DEF_TEST(AAClip, reporter) {
     test_path_with_hole(reporter);
     test_regressions();
     test_nearly_integral(reporter);
+    test_reduced_shapes(reporter);
 }
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkPath.h"
+#include "Test.h"
+
+static const int kSize = 64;
+
+static void make_paths(SkPath paths[3]) {
+    for (int i = 0; i < 3; ++i) {
+        paths[i].reset();
+    }
+    paths[0].addCircle(32, 32, 28.5f);
+    paths[1].addRoundRect(SkRect::MakeLTRB(8.5f, 12.25f, 50.75f, 44.5f), 6, 6);
+    paths[2].moveTo(4, 60);
+    paths[2].lineTo(33.5f, 2.5f);
+    paths[2].lineTo(60, 58.75f);
+    paths[2].close();
+}
+
+// Clips to each path in turn, nested, and fills inside each.
+static void draw(SkCanvas* canvas, const SkPath paths[3], const SkMatrix& matrix, bool doAA) {
+    canvas->clear(SK_ColorWHITE);
+    SkPaint paint;
+    canvas->save();
+    canvas->concat(matrix);
+    for (int i = 0; i < 3; ++i) {
+        canvas->save();
+        canvas->clipPath(paths[i], SkRegion::kIntersect_Op, doAA);
+        paint.setColor(0xFF000000 | (0x3F << (8 * i)));
+        canvas->drawPaint(paint);
+    }
+    for (int i = 0; i < 3; ++i) {
+        canvas->restore();
+    }
+    // clipping to the same path from another clip
+    canvas->clipPath(paths[1], SkRegion::kReplace_Op, doAA);
+    canvas->clipPath(paths[0], SkRegion::kDifference_Op, doAA);
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawPaint(paint);
+
+    // clipping to the same path from clips with the same bounds
+    const SkRect bounds = SkRect::MakeLTRB(10.5f, 10.5f, 54.5f, 54.5f);
+    canvas->clipRect(bounds, SkRegion::kReplace_Op, doAA);
+    canvas->clipPath(paths[2], SkRegion::kIntersect_Op, doAA);
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawPaint(paint);
+    SkPath oval;
+    oval.addOval(bounds);
+    canvas->clipPath(oval, SkRegion::kReplace_Op, doAA);
+    canvas->clipPath(paths[2], SkRegion::kIntersect_Op, doAA);
+    paint.setColor(SK_ColorRED);
+    canvas->drawPaint(paint);
+    canvas->restore();
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a), alpb(b);
+    return 0 == memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+static void check(skiatest::Reporter* reporter, SkCanvas* canvas, const SkBitmap& bitmap,
+                  const SkPath paths[3], const SkMatrix& matrix, bool doAA) {
+    draw(canvas, paths, matrix, doAA);
+
+    // draw again with new paths, which the canvas has not clipped to
+    SkPath freshPaths[3];
+    for (int i = 0; i < 3; ++i) {
+        freshPaths[i].addPath(paths[i]);
+        freshPaths[i].setFillType(paths[i].getFillType());
+    }
+    SkBitmap expected;
+    expected.allocN32Pixels(kSize, kSize);
+    SkCanvas expectedCanvas(expected);
+    draw(&expectedCanvas, freshPaths, matrix, doAA);
+
+    REPORTER_ASSERT(reporter, same_pixels(bitmap, expected));
+}
+
+// Clipping to the same paths again shares the clips made the first times,
+// which must be the clips the paths make.
+DEF_TEST(ClipPathCache, reporter) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(kSize, kSize);
+    SkCanvas canvas(bitmap);
+
+    SkMatrix rotate;
+    rotate.setRotate(20, 32, 32);
+
+    for (int aa = 0; aa < 2; ++aa) {
+        SkPath paths[3];
+        make_paths(paths);
+        for (int i = 0; i < 4; ++i) {
+            check(reporter, &canvas, bitmap, paths, SkMatrix::I(), SkToBool(aa));
+        }
+        for (int i = 0; i < 3; ++i) {
+            check(reporter, &canvas, bitmap, paths, rotate, SkToBool(aa));
+        }
+
+        // a path changed after its clip was kept
+        paths[1].lineTo(2, 2);
+        for (int i = 0; i < 3; ++i) {
+            check(reporter, &canvas, bitmap, paths, SkMatrix::I(), SkToBool(aa));
+        }
+        paths[0].setFillType(SkPath::kInverseWinding_FillType);
+        for (int i = 0; i < 3; ++i) {
+            check(reporter, &canvas, bitmap, paths, SkMatrix::I(), SkToBool(aa));
+        }
+    }
+}
+
+static void clip_and_fill(SkCanvas* canvas, const SkPath& path) {
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    canvas->clear(SK_ColorWHITE);
+    canvas->save();
+    canvas->clipPath(path, SkRegion::kIntersect_Op, true);
+    canvas->drawPaint(paint);
+    canvas->restore();
+}
+
+// Clips whose runs take more than the cache keeps are evicted, and clipping
+// to their paths again makes them again.
+DEF_TEST(ClipPathCache_Budget, reporter) {
+    static const int kWidth = 32;
+    static const int kHeight = 2560;
+    static const int kPathCount = 16;
+    SkBitmap bitmap, expected;
+    bitmap.allocN32Pixels(kWidth, kHeight);
+    expected.allocN32Pixels(kWidth, kHeight);
+    SkCanvas canvas(bitmap);
+    SkCanvas expectedCanvas(expected);
+
+    // many slanted stripes, so that each row of the clip has many runs and
+    // differs from the one above
+    static const SkScalar kSlant = SkIntToScalar(kHeight / 4);
+    SkPath paths[kPathCount];
+    for (int i = 0; i < kPathCount; ++i) {
+        for (int x = -kHeight / 4; x < kWidth; x += 4) {
+            const SkScalar left = x + 0.125f * i;
+            paths[i].moveTo(left, 0);
+            paths[i].lineTo(left + 1.5f, 0);
+            paths[i].lineTo(left + 1.5f + kSlant, SkIntToScalar(kHeight));
+            paths[i].lineTo(left + kSlant, SkIntToScalar(kHeight));
+            paths[i].close();
+        }
+    }
+
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 1; i < kPathCount; ++i) {
+            // the first path is clipped to often enough to stay kept
+            const int indices[] = { 0, i };
+            for (size_t j = 0; j < SK_ARRAY_COUNT(indices); ++j) {
+                const SkPath& path = paths[indices[j]];
+                clip_and_fill(&canvas, path);
+                SkPath freshPath;
+                freshPath.addPath(path);
+                clip_and_fill(&expectedCanvas, freshPath);
+                REPORTER_ASSERT(reporter, same_pixels(bitmap, expected));
+            }
+        }
+    }
+}
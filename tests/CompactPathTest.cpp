@@ -0,0 +1,233 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkBlitter.h"
+#include "SkCanvas.h"
+#include "SkCompactPath.h"
+#include "SkPath.h"
+#include "SkRandom.h"
+#include "SkRasterClip.h"
+#include "SkScan.h"
+#include "Test.h"
+
+static const int kSize = 64;
+
+static SkPoint random_point(SkRandom* rand) {
+    return SkPoint::Make(rand->nextRangeScalar(-4, kSize + 4),
+                         rand->nextRangeScalar(-4, kSize + 4));
+}
+
+// A path with contours of each kind of segment, some closed.
+static void make_path(SkRandom* rand, SkPath* path) {
+    path->reset();
+    for (int contour = 0; contour < 3; ++contour) {
+        path->moveTo(random_point(rand));
+        for (int i = 0; i < 4; ++i) {
+            switch (rand->nextULessThan(4)) {
+                case 0:
+                    path->lineTo(random_point(rand));
+                    break;
+                case 1:
+                    path->quadTo(random_point(rand), random_point(rand));
+                    break;
+                case 2:
+                    path->conicTo(random_point(rand), random_point(rand),
+                                  rand->nextRangeScalar(0.25f, 2));
+                    break;
+                case 3:
+                    path->cubicTo(random_point(rand), random_point(rand), random_point(rand));
+                    break;
+            }
+        }
+        if (rand->nextBool()) {
+            path->close();
+        }
+    }
+}
+
+static void make_polygon(SkRandom* rand, SkPath* path) {
+    path->reset();
+    path->moveTo(random_point(rand));
+    for (int i = 0; i < 8; ++i) {
+        path->lineTo(random_point(rand));
+    }
+    path->close();
+}
+
+// The compact path holds the verbs of the path, and its points to within half
+// a step of the grid they are rounded to.
+static void test_round_trip(skiatest::Reporter* reporter, const SkPath& path) {
+    SkAutoTUnref<SkCompactPath> compact(SkCompactPath::Create(path));
+    REPORTER_ASSERT(reporter, compact.get());
+    SkPath rounded;
+    compact->toPath(&rounded);
+
+    REPORTER_ASSERT(reporter, rounded.getFillType() == path.getFillType());
+    REPORTER_ASSERT(reporter, rounded.countVerbs() == path.countVerbs());
+    REPORTER_ASSERT(reporter, rounded.countPoints() == path.countPoints());
+    REPORTER_ASSERT(reporter, compact->countVerbs() == path.countVerbs());
+    REPORTER_ASSERT(reporter, compact->countPoints() == path.countPoints());
+    REPORTER_ASSERT(reporter, compact->getBounds() == rounded.getBounds());
+    REPORTER_ASSERT(reporter, compact->isConvex() == rounded.isConvex());
+
+    const SkRect& bounds = path.getBounds();
+    const SkScalar tolX = bounds.width() / 0xFFFF;
+    const SkScalar tolY = bounds.height() / 0xFFFF;
+    SkPath::RawIter iter(path);
+    SkPath::RawIter roundedIter(rounded);
+    SkPoint pts[4], roundedPts[4];
+    SkPath::Verb verb;
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        REPORTER_ASSERT(reporter, verb == roundedIter.next(roundedPts));
+        int count = 0;
+        switch (verb) {
+            case SkPath::kMove_Verb:  count = 1; break;
+            case SkPath::kLine_Verb:  count = 2; break;
+            case SkPath::kQuad_Verb:  count = 3; break;
+            case SkPath::kConic_Verb:
+                REPORTER_ASSERT(reporter, iter.conicWeight() == roundedIter.conicWeight());
+                count = 3;
+                break;
+            case SkPath::kCubic_Verb: count = 4; break;
+            default: break;
+        }
+        for (int i = 0; i < count; ++i) {
+            REPORTER_ASSERT(reporter, SkScalarAbs(pts[i].fX - roundedPts[i].fX) <= tolX);
+            REPORTER_ASSERT(reporter, SkScalarAbs(pts[i].fY - roundedPts[i].fY) <= tolY);
+        }
+    }
+}
+
+// SkCompactPath::Iter gives the verbs and points that SkPath::Iter gives for
+// the rounded path.
+static void test_iter(skiatest::Reporter* reporter, const SkPath& path, bool forceClose) {
+    SkAutoTUnref<SkCompactPath> compact(SkCompactPath::Create(path));
+    SkPath rounded;
+    compact->toPath(&rounded);
+
+    SkPath::Iter pathIter(rounded, forceClose);
+    SkCompactPath::Iter compactIter(*compact, forceClose);
+    SkPoint pts[4], compactPts[4];
+    SkPath::Verb verb;
+    do {
+        verb = pathIter.next(pts, false);
+        REPORTER_ASSERT(reporter, verb == compactIter.next(compactPts));
+        int count = 0;
+        switch (verb) {
+            case SkPath::kMove_Verb:  count = 1; break;
+            case SkPath::kLine_Verb:  count = 2; break;
+            case SkPath::kQuad_Verb:  count = 3; break;
+            case SkPath::kConic_Verb:
+                REPORTER_ASSERT(reporter, pathIter.conicWeight() == compactIter.conicWeight());
+                count = 3;
+                break;
+            case SkPath::kCubic_Verb: count = 4; break;
+            default: break;
+        }
+        REPORTER_ASSERT(reporter, 0 == memcmp(pts, compactPts, count * sizeof(SkPoint)));
+    } while (verb != SkPath::kDone_Verb);
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpa(a), alpb(b);
+    return 0 == memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+// Filling the compact path draws exactly what filling the rounded path does.
+static void test_fill(skiatest::Reporter* reporter, const SkPath& path, bool doAA) {
+    SkAutoTUnref<SkCompactPath> compact(SkCompactPath::Create(path));
+    SkPath rounded;
+    compact->toPath(&rounded);
+
+    SkBitmap expected, actual;
+    expected.allocPixels(SkImageInfo::MakeA8(kSize, kSize));
+    actual.allocPixels(SkImageInfo::MakeA8(kSize, kSize));
+    expected.eraseColor(0);
+    actual.eraseColor(0);
+
+    SkPaint paint;
+    paint.setAntiAlias(doAA);
+    SkCanvas canvas(expected);
+    canvas.drawPath(rounded, paint);
+
+    SkTBlitterAllocator allocator;
+    SkBlitter* blitter = SkBlitter::Choose(actual, SkMatrix::I(), paint, &allocator);
+    SkRasterClip clip(SkIRect::MakeWH(kSize, kSize));
+    if (doAA) {
+        SkScan::AntiFillPath(*compact, clip, blitter);
+    } else {
+        SkScan::FillPath(*compact, clip, blitter);
+    }
+
+    REPORTER_ASSERT(reporter, same_pixels(expected, actual));
+}
+
+static void test_pool(skiatest::Reporter* reporter) {
+    SkRandom rand;
+    SkPath a, b;
+    make_polygon(&rand, &a);
+    make_polygon(&rand, &b);
+
+    SkCompactPathPool pool;
+    SkAutoTUnref<SkCompactPath> compactA(pool.add(a));
+    SkAutoTUnref<SkCompactPath> compactB(pool.add(b));
+    REPORTER_ASSERT(reporter, compactA.get() != compactB.get());
+
+    // a path built again the same way shares the compact copy
+    SkRandom sameRand;
+    SkPath sameA;
+    make_polygon(&sameRand, &sameA);
+    SkAutoTUnref<SkCompactPath> compactSameA(pool.add(sameA));
+    REPORTER_ASSERT(reporter, compactA.get() == compactSameA.get());
+    REPORTER_ASSERT(reporter, 2 == pool.count());
+
+    sameA.setFillType(SkPath::kEvenOdd_FillType);
+    SkAutoTUnref<SkCompactPath> compactEvenOdd(pool.add(sameA));
+    REPORTER_ASSERT(reporter, compactA.get() != compactEvenOdd.get());
+    REPORTER_ASSERT(reporter, 3 == pool.count());
+
+    SkPath infinite;
+    infinite.moveTo(0, 0);
+    infinite.lineTo(SK_ScalarInfinity, 0);
+    REPORTER_ASSERT(reporter, NULL == pool.add(infinite));
+    REPORTER_ASSERT(reporter, 3 == pool.count());
+}
+
+DEF_TEST(CompactPath, reporter) {
+    SkRandom rand;
+    for (int i = 0; i < 50; ++i) {
+        SkPath path;
+        if (i & 1) {
+            make_path(&rand, &path);
+        } else {
+            make_polygon(&rand, &path);
+        }
+        if (i % 3 == 0) {
+            path.setFillType(SkPath::kEvenOdd_FillType);
+        }
+        if (i % 5 == 0) {
+            path.toggleInverseFillType();
+        }
+        test_round_trip(reporter, path);
+        test_iter(reporter, path, false);
+        test_iter(reporter, path, true);
+        test_fill(reporter, path, false);
+        test_fill(reporter, path, true);
+    }
+
+    SkPath empty;
+    test_round_trip(reporter, empty);
+    test_iter(reporter, empty, true);
+    SkPath rect;
+    rect.addRect(SkRect::MakeLTRB(10.25f, 20.5f, 40.75f, 21));
+    test_round_trip(reporter, rect);
+    test_fill(reporter, rect, false);
+    test_fill(reporter, rect, true);
+
+    test_pool(reporter);
+}
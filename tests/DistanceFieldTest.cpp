@@ -0,0 +1,203 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkDistanceFieldGen.h"
+#include "SkMask.h"
+#include "SkMatrix.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
+#include "SkTemplates.h"
+#include "Test.h"
+
+// Antialiased discs at random places, overlapping.
+static void make_image(unsigned char* image, int width, int height, int count, SkRandom* rand) {
+    memset(image, 0, width * height);
+    for (int i = 0; i < count; ++i) {
+        const float cx = rand->nextRangeF(0, SkIntToScalar(width));
+        const float cy = rand->nextRangeF(0, SkIntToScalar(height));
+        const float radius = rand->nextRangeF(1, 30);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const float dx = x + 0.5f - cx;
+                const float dy = y + 0.5f - cy;
+                const float coverage = SkScalarPin(radius + 0.5f - sqrtf(dx*dx + dy*dy), 0, 1);
+                const int alpha = image[y*width + x] + (int)(coverage * 255);
+                image[y*width + x] = SkToU8(SkMin32(alpha, 255));
+            }
+        }
+    }
+}
+
+// The field of a symmetric image is symmetric.
+DEF_TEST(DistanceField_Symmetric, reporter) {
+    static const int kWidth = 9;
+    static const int kHeight = 7;
+    unsigned char image[kWidth * kHeight];
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            const bool inside = x >= 2 && x < kWidth - 2 && y >= 2 && y < kHeight - 2;
+            image[y*kWidth + x] = inside ? 255 : 0;
+        }
+    }
+
+    const int fieldWidth = kWidth + 2*SK_DistanceFieldPad;
+    const int fieldHeight = kHeight + 2*SK_DistanceFieldPad;
+    SkAutoTMalloc<unsigned char> field(SkComputeDistanceFieldSize(kWidth, kHeight));
+    SkGenerateDistanceFieldFromA8Image(field.get(), image, kWidth, kHeight, kWidth);
+
+    bool symmetric = true;
+    for (int y = 0; y < fieldHeight; ++y) {
+        for (int x = 0; x < fieldWidth; ++x) {
+            const unsigned char val = field[y*fieldWidth + x];
+            symmetric &= val == field[y*fieldWidth + fieldWidth - 1 - x];
+            symmetric &= val == field[(fieldHeight - 1 - y)*fieldWidth + x];
+        }
+    }
+    REPORTER_ASSERT(reporter, symmetric);
+
+    // inside is above the zero threshold of 128, outside below
+    REPORTER_ASSERT(reporter, field[(fieldHeight/2)*fieldWidth + fieldWidth/2] > 128);
+    REPORTER_ASSERT(reporter, field[(fieldHeight/2)*fieldWidth + 2] < 128);
+    REPORTER_ASSERT(reporter, 0 == field[0]);
+}
+
+// Rows generated in bands match the rows of the whole field.
+DEF_TEST(DistanceField_Bands, reporter) {
+    SkRandom rand;
+    static const int kBandRows = 17;
+    for (int i = 0; i < 4; ++i) {
+        const int width = 20 + rand.nextU() % 60;
+        // tall enough that the whole field is generated in bands too
+        const int height = i < 2 ? 20 + rand.nextU() % 60 : 300 + rand.nextU() % 200;
+        SkAutoTMalloc<unsigned char> image(width * height);
+        make_image(image.get(), width, height, 8, &rand);
+
+        const size_t size = SkComputeDistanceFieldSize(width, height);
+        const int fieldWidth = width + 2*SK_DistanceFieldPad;
+        const int fieldHeight = height + 2*SK_DistanceFieldPad;
+        SkAutoTMalloc<unsigned char> whole(size);
+        SkAutoTMalloc<unsigned char> oneBand(size);
+        SkAutoTMalloc<unsigned char> bands(size);
+        SkGenerateDistanceFieldFromA8Image(whole.get(), image.get(), width, height, width);
+        SkGenerateDistanceFieldRowsFromA8Image(oneBand.get(), image.get(), width, height, width,
+                                               0, fieldHeight);
+        for (int row = 0; row < fieldHeight; row += kBandRows) {
+            SkGenerateDistanceFieldRowsFromA8Image(bands.get() + row*fieldWidth, image.get(),
+                                                   width, height, width, row,
+                                                   SkMin32(kBandRows, fieldHeight - row));
+        }
+
+        if (fieldHeight <= 256) {
+            REPORTER_ASSERT(reporter, 0 == memcmp(whole.get(), oneBand.get(), size));
+        }
+        // The transform is not exact, so the distances found far from an edge may
+        // depend on where the band starts; those are only slightly off.
+        int maxDiff = 0;
+        for (size_t j = 0; j < size; ++j) {
+            maxDiff = SkMax32(maxDiff, SkAbs32(oneBand[j] - bands[j]));
+            maxDiff = SkMax32(maxDiff, SkAbs32(oneBand[j] - whole[j]));
+        }
+        REPORTER_ASSERT(reporter, maxDiff <= 8);
+    }
+}
+
+// Rendering a field at its own size gives back the image it was made from.
+DEF_TEST(DistanceField_ToA8, reporter) {
+    static const int kSize = 40;
+    SkRandom rand;
+    unsigned char image[kSize * kSize];
+    make_image(image, kSize, kSize, 3, &rand);
+
+    const int fieldSize = kSize + 2*SK_DistanceFieldPad;
+    SkAutoTMalloc<unsigned char> field(SkComputeDistanceFieldSize(kSize, kSize));
+    SkGenerateDistanceFieldFromA8Image(field.get(), image, kSize, kSize, kSize);
+
+    uint8_t pixels[kSize * kSize];
+    SkMask mask;
+    mask.fFormat = SkMask::kA8_Format;
+    mask.fBounds.set(0, 0, kSize, kSize);
+    mask.fRowBytes = kSize;
+    mask.fImage = pixels;
+    SkMatrix deviceToField;
+    deviceToField.setTranslate(SkIntToScalar(SK_DistanceFieldPad),
+                               SkIntToScalar(SK_DistanceFieldPad));
+    SkDistanceFieldToA8Mask(mask, field.get(), fieldSize, fieldSize, deviceToField, SK_Scalar1);
+
+    int totalDiff = 0;
+    int wrongSide = 0;
+    for (int i = 0; i < kSize * kSize; ++i) {
+        totalDiff += SkAbs32(image[i] - pixels[i]);
+        if ((image[i] < 32 && pixels[i] > 224) || (image[i] > 224 && pixels[i] < 32)) {
+            ++wrongSide;
+        }
+    }
+    REPORTER_ASSERT(reporter, 0 == wrongSide);
+    REPORTER_ASSERT(reporter, totalDiff < 8 * kSize * kSize);
+}
+
+static int count_dark(const SkBitmap& bitmap) {
+    SkAutoLockPixels alp(bitmap);
+    int dark = 0;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            dark += 255 - SkColorGetG(bitmap.getColor(x, y));
+        }
+    }
+    return dark;
+}
+
+// Large distance field text draws (nearly) the same glyphs as mask text.
+DEF_TEST(DistanceField_Text, reporter) {
+    static const char kText[] = "Hamburgefons";
+    static const size_t kTextLen = sizeof(kText) - 1;
+
+    SkBitmap maskBitmap, fieldBitmap;
+    maskBitmap.allocN32Pixels(640, 160);
+    fieldBitmap.allocN32Pixels(640, 160);
+    SkCanvas maskCanvas(maskBitmap);
+    SkCanvas fieldCanvas(fieldBitmap);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setLinearText(true);
+    paint.setHinting(SkPaint::kNo_Hinting);
+
+    const SkScalar sizes[] = { 40, 72, 100, 150 };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(sizes); ++i) {
+        paint.setTextSize(sizes[i]);
+        paint.setDistanceFieldTextTEMP(false);
+        maskCanvas.clear(SK_ColorWHITE);
+        maskCanvas.drawText(kText, kTextLen, 10, 130, paint);
+
+        paint.setDistanceFieldTextTEMP(true);
+        fieldCanvas.clear(SK_ColorWHITE);
+        fieldCanvas.drawText(kText, kTextLen, 10, 130, paint);
+
+        // same amount of ink, to within a few percent
+        const int maskDark = count_dark(maskBitmap);
+        const int fieldDark = count_dark(fieldBitmap);
+        REPORTER_ASSERT(reporter, maskDark > 0);
+        REPORTER_ASSERT(reporter, SkAbs32(maskDark - fieldDark) < maskDark / 20);
+
+        // in the same places
+        SkAutoLockPixels alpMask(maskBitmap);
+        SkAutoLockPixels alpField(fieldBitmap);
+        int wrongSide = 0;
+        for (int y = 0; y < maskBitmap.height(); ++y) {
+            for (int x = 0; x < maskBitmap.width(); ++x) {
+                const int m = SkColorGetG(maskBitmap.getColor(x, y));
+                const int f = SkColorGetG(fieldBitmap.getColor(x, y));
+                if ((m < 32 && f > 224) || (m > 224 && f < 32)) {
+                    ++wrongSide;
+                }
+            }
+        }
+        REPORTER_ASSERT(reporter, wrongSide < 20);
+    }
+}
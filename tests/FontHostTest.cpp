@@ -5,11 +5,16 @@
  * found in the LICENSE file.
  */
 
+#include "SkBitmap.h"
+#include "SkCanvas.h"
 #include "SkEndian.h"
 #include "SkFontStream.h"
+#include "SkGraphics.h"
 #include "SkOSFile.h"
 #include "SkPaint.h"
+#include "SkRunnable.h"
 #include "SkStream.h"
+#include "SkThreadPool.h"
 #include "SkTypeface.h"
 #include "Test.h"
 
@@ -305,4 +310,64 @@ DEF_TEST(FontHost, reporter) {
     test_advances(reporter);
 }
 
+static void draw_text(const SkPaint& paint, SkBitmap* bitmap) {
+    bitmap->allocN32Pixels(400, 40);
+    bitmap->eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(*bitmap);
+    const char text[] = "The quick brown fox jumps over the lazy dog.";
+    canvas.drawText(text, strlen(text), 0, SkIntToScalar(30), paint);
+}
+
+class DrawTextProc : public SkRunnable {
+public:
+    DrawTextProc(const SkPaint& paint, SkBitmap* bitmap) : fPaint(paint), fBitmap(bitmap) {}
+
+    virtual void run() SK_OVERRIDE {
+        draw_text(fPaint, fBitmap);
+    }
+
+private:
+    const SkPaint&  fPaint;
+    SkBitmap*       fBitmap;
+};
+
+/*
+ * Glyphs of different typefaces, and of different sizes of the same
+ * typeface, generated concurrently must match those generated serially.
+ */
+DEF_TEST(FontHost_threaded, reporter) {
+    static const char* const faces[] = { NULL, "serif", "sans-serif", "monospace" };
+    static const int kSizes[] = { 13, 24 };
+    static const int kCount = SK_ARRAY_COUNT(faces) * SK_ARRAY_COUNT(kSizes);
+
+    SkPaint paints[kCount];
+    SkBitmap expected[kCount];
+    for (int i = 0; i < kCount; ++i) {
+        SkAutoTUnref<SkTypeface> face(SkTypeface::CreateFromName(
+            faces[i % SK_ARRAY_COUNT(faces)], SkTypeface::kNormal));
+        paints[i].setTypeface(face);
+        paints[i].setAntiAlias(true);
+        paints[i].setTextSize(SkIntToScalar(kSizes[i / SK_ARRAY_COUNT(faces)]));
+        draw_text(paints[i], &expected[i]);
+    }
+
+    // Generate the glyphs again, this time all at once.
+    SkGraphics::PurgeFontCache();
+    SkBitmap actual[kCount];
+    {
+        SkThreadPool pool(kCount);
+        for (int i = 0; i < kCount; ++i) {
+            pool.add(SkNEW_ARGS(DrawTextProc, (paints[i], &actual[i])));
+        }
+        pool.wait();
+    }
+
+    for (int i = 0; i < kCount; ++i) {
+        SkAutoLockPixels alpe(expected[i]);
+        SkAutoLockPixels alpa(actual[i]);
+        REPORTER_ASSERT(reporter, 0 == memcmp(expected[i].getPixels(), actual[i].getPixels(),
+                                              expected[i].getSize()));
+    }
+}
+
 // need tests for SkStrSearch
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkFontIndex.h"
+#include "SkOSFile.h"
+#include "SkStream.h"
+#include "SkTypeface.h"
+#include "Test.h"
+
+static SkData* build_resource_index(const char* const names[], int count,
+                                    const SkTArray<SkString>& directories,
+                                    const SkTArray<SkString>* languages = NULL) {
+    SkString resourcePath = skiatest::Test::GetResourcePath();
+    if (resourcePath.isEmpty()) {
+        return NULL;
+    }
+    SkTArray<SkString> files;
+    for (int i = 0; i < count; ++i) {
+        files.push_back(SkOSPath::SkPathJoin(resourcePath.c_str(), names[i]));
+    }
+    return SkFontIndex::Build(files, directories, languages);
+}
+
+// The index has the families, faces and characters of the fonts.
+DEF_TEST(FontIndex_Build, reporter) {
+    static const char* const kFonts[] = { "Funkster.ttf", "test.ttc", "no_such_font.ttf" };
+    SkAutoTUnref<SkData> image(build_resource_index(kFonts, SK_ARRAY_COUNT(kFonts),
+                                                    SkTArray<SkString>()));
+    if (NULL == image.get()) {
+        SkDebugf("Could not run FontIndex test because the fonts were not found.\n");
+        return;
+    }
+    SkAutoTUnref<SkFontIndex> index(SkFontIndex::Create(image));
+    REPORTER_ASSERT(reporter, index.get());
+    if (NULL == index.get()) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, !index->isStale());
+    REPORTER_ASSERT(reporter, index->countFamilies() >= 2);
+
+    int faceCount = 0;
+    for (int i = 0; i < index->countFamilies(); ++i) {
+        // the families are sorted, and found whatever the case of the name
+        const char* name = index->getFamilyName(i);
+        REPORTER_ASSERT(reporter, i == index->findFamily(name));
+        SkString upper(name);
+        for (size_t j = 0; j < upper.size(); ++j) {
+            if (upper[j] >= 'a' && upper[j] <= 'z') {
+                upper[j] += 'A' - 'a';
+            }
+        }
+        REPORTER_ASSERT(reporter, i == index->findFamily(upper.c_str()));
+        if (i > 0) {
+            REPORTER_ASSERT(reporter, strcasecmp(index->getFamilyName(i - 1), name) < 0);
+        }
+        faceCount += index->countFaces(i);
+    }
+    // Funkster, and the two faces of the collection
+    REPORTER_ASSERT(reporter, 3 == faceCount);
+    REPORTER_ASSERT(reporter, -1 == index->findFamily("No Such Family"));
+    REPORTER_ASSERT(reporter, -1 == index->findFamily(NULL));
+
+    const int funkster = index->findFamily("Funkster");
+    REPORTER_ASSERT(reporter, funkster >= 0);
+    if (funkster < 0) {
+        return;
+    }
+    SkFontIndex::Face face;
+    index->getFace(funkster, 0, &face);
+    REPORTER_ASSERT(reporter, strstr(face.fPath, "Funkster.ttf"));
+    REPORTER_ASSERT(reporter, 0 == face.fTTCIndex);
+
+    // The coverage matches the font's own character map.
+    SkAutoTUnref<SkTypeface> typeface(SkTypeface::CreateFromFile(face.fPath));
+    if (typeface.get()) {
+        for (SkUnichar uni = 0; uni < 0x3000; ++uni) {
+            uint16_t glyph;
+            typeface->charsToGlyphs(&uni, SkTypeface::kUTF32_Encoding, &glyph, 1);
+            REPORTER_ASSERT(reporter, (0 != glyph) == index->hasCharacter(funkster, 0, uni));
+        }
+    }
+    REPORTER_ASSERT(reporter, !index->hasCharacter(funkster, 0, 0x10FFFF));
+    REPORTER_ASSERT(reporter, !index->hasCharacter(funkster, 0, -1));
+
+    int family, faceIndex;
+    const SkFontStyle normal;
+    REPORTER_ASSERT(reporter, index->matchCharacter('A', normal, NULL, &family, &faceIndex));
+    REPORTER_ASSERT(reporter, index->hasCharacter(family, faceIndex, 'A'));
+    REPORTER_ASSERT(reporter, !index->matchCharacter(0x10FFFD, normal, NULL, &family, &faceIndex));
+}
+
+// Returns the position in names of the file of the face, or -1.
+static int file_position(const SkFontIndex& index, int family, int faceIndex,
+                         const char* const names[], int count) {
+    SkFontIndex::Face face;
+    index.getFace(family, faceIndex, &face);
+    for (int i = 0; i < count; ++i) {
+        if (strstr(face.fPath, names[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Fallback tries the files in the order they were given, whatever the names
+// of their families, and tries the files with the language first.
+DEF_TEST(FontIndex_Fallback, reporter) {
+    static const char* const kOrders[][2] = {
+        { "Funkster.ttf", "test.ttc" },
+        { "test.ttc", "Funkster.ttf" },
+    };
+    SkTArray<SkString> languages;
+    languages.push_back().set("en|fr");
+    languages.push_back().set("ja");
+    const SkFontStyle normal;
+    for (size_t order = 0; order < SK_ARRAY_COUNT(kOrders); ++order) {
+        SkAutoTUnref<SkData> image(build_resource_index(kOrders[order], 2,
+                                                        SkTArray<SkString>(), &languages));
+        SkAutoTUnref<SkFontIndex> index(SkFontIndex::Create(image));
+        if (NULL == index.get()) {
+            return;
+        }
+        // the first file, and the first file in Japanese, with the character
+        int first = -1;
+        int firstJapanese = -1;
+        for (int i = 0; i < index->countFamilies(); ++i) {
+            const int face = index->matchStyle(i, normal);
+            if (index->hasCharacter(i, face, 'A')) {
+                const int position = file_position(*index, i, face, kOrders[order], 2);
+                first = (first < 0) ? position : SkTMin(first, position);
+                if (1 == position) {
+                    firstJapanese = position;
+                }
+            }
+        }
+        if (first < 0) {
+            continue;
+        }
+        if (firstJapanese < 0) {
+            firstJapanese = first;
+        }
+        int family, faceIndex;
+        REPORTER_ASSERT(reporter, index->matchCharacter('A', normal, NULL, &family, &faceIndex));
+        REPORTER_ASSERT(reporter, first == file_position(*index, family, faceIndex,
+                                                         kOrders[order], 2));
+        REPORTER_ASSERT(reporter, index->matchCharacter('A', normal, "ja-JP",
+                                                        &family, &faceIndex));
+        REPORTER_ASSERT(reporter, firstJapanese == file_position(*index, family, faceIndex,
+                                                                 kOrders[order], 2));
+        REPORTER_ASSERT(reporter, index->matchCharacter('A', normal, "fr",
+                                                        &family, &faceIndex));
+        REPORTER_ASSERT(reporter, first == file_position(*index, family, faceIndex,
+                                                         kOrders[order], 2));
+    }
+}
+
+DEF_TEST(FontIndex_MatchStyle, reporter) {
+    static const char* const kFonts[] = { "test.ttc" };
+    SkAutoTUnref<SkData> image(build_resource_index(kFonts, SK_ARRAY_COUNT(kFonts),
+                                                    SkTArray<SkString>()));
+    SkAutoTUnref<SkFontIndex> index(SkFontIndex::Create(image));
+    if (NULL == index.get()) {
+        return;
+    }
+    for (int i = 0; i < index->countFamilies(); ++i) {
+        // each face is the best match for its own style
+        for (int j = 0; j < index->countFaces(i); ++j) {
+            SkFontIndex::Face face;
+            index->getFace(i, j, &face);
+            SkFontIndex::Face match;
+            index->getFace(i, index->matchStyle(i, face.fStyle), &match);
+            REPORTER_ASSERT(reporter, match.fStyle == face.fStyle);
+            REPORTER_ASSERT(reporter, face.fTTCIndex >= 0 && face.fTTCIndex < 2);
+        }
+    }
+}
+
+// Damaged images are rejected.
+DEF_TEST(FontIndex_Create, reporter) {
+    static const char* const kFonts[] = { "Funkster.ttf" };
+    SkAutoTUnref<SkData> image(build_resource_index(kFonts, SK_ARRAY_COUNT(kFonts),
+                                                    SkTArray<SkString>()));
+    if (NULL == image.get()) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, NULL == SkFontIndex::Create(NULL));
+
+    SkAutoTUnref<SkData> truncated(SkData::NewWithCopy(image->data(), image->size() - 4));
+    REPORTER_ASSERT(reporter, NULL == SkFontIndex::Create(truncated));
+
+    SkAutoTMalloc<uint32_t> words((image->size() + 3) / sizeof(uint32_t));
+    for (size_t i = 0; i < 13; ++i) {
+        memcpy(words.get(), image->data(), image->size());
+        // every field of the header is checked
+        words[i] = 0xFFFFFF00;
+        SkAutoTUnref<SkData> damaged(SkData::NewWithCopy(words.get(), image->size()));
+        REPORTER_ASSERT(reporter, NULL == SkFontIndex::Create(damaged));
+    }
+
+    SkAutoTUnref<SkFontIndex> index(SkFontIndex::Create(image));
+    REPORTER_ASSERT(reporter, index.get());
+    REPORTER_ASSERT(reporter, NULL == SkFontIndex::CreateFromFile("no_such_index"));
+}
+
+// The index is written out and mapped back in, and is stale once one of its
+// directories changes.
+DEF_TEST(FontIndex_File, reporter) {
+    SkString tmpDir = skiatest::Test::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString fontDir = SkOSPath::SkPathJoin(tmpDir.c_str(), "font_index_test");
+    SkTArray<SkString> directories;
+    directories.push_back(fontDir);
+    static const char* const kFonts[] = { "Funkster.ttf" };
+    SkAutoTUnref<SkData> image(build_resource_index(kFonts, SK_ARRAY_COUNT(kFonts),
+                                                    directories));
+    if (NULL == image.get()) {
+        return;
+    }
+
+    SkString path = SkOSPath::SkPathJoin(tmpDir.c_str(), "font_index");
+    {
+        SkFILEWStream writer(path.c_str());
+        if (!writer.isValid()) {
+            ERRORF(reporter, "Failed to create tmp file %s\n", path.c_str());
+            return;
+        }
+        writer.write(image->data(), image->size());
+    }
+    SkAutoTUnref<SkFontIndex> index(SkFontIndex::CreateFromFile(path.c_str()));
+    REPORTER_ASSERT(reporter, index.get());
+    if (NULL == index.get()) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, index->findFamily("Funkster") >= 0);
+
+    // the directory did not exist when the index was built
+    if (!sk_exists(fontDir.c_str())) {
+        REPORTER_ASSERT(reporter, !index->isStale());
+        sk_mkdir(fontDir.c_str());
+        REPORTER_ASSERT(reporter, index->isStale());
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGlyphAdvanceTable.h"
+#include "SkPaint.h"
+#include "SkTypeface.h"
+#include "Test.h"
+
+// Gets advances, in font units, from the scaler at a size of one unit per
+// pixel.
+static void get_scaler_advances(SkTypeface* typeface, int glyphCount, SkScalar advances[]) {
+    SkPaint paint;
+    paint.setTypeface(typeface);
+    paint.setTextSize(SkIntToScalar(typeface->getUnitsPerEm()));
+    paint.setHinting(SkPaint::kNo_Hinting);
+    paint.setLinearText(true);
+    paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    SkAutoTMalloc<uint16_t> glyphs(glyphCount);
+    for (int i = 0; i < glyphCount; i++) {
+        glyphs[i] = SkToU16(i);
+    }
+    paint.getTextWidths(glyphs.get(), glyphCount * sizeof(uint16_t), advances);
+}
+
+static bool fail_proc(void*, int, int16_t*) {
+    return false;
+}
+
+DEF_TEST(GlyphAdvanceTable, reporter) {
+    static const char* const kFamilies[] = { "serif", "sans-serif", "monospace" };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kFamilies); i++) {
+        SkAutoTUnref<SkTypeface> typeface(SkTypeface::CreateFromName(kFamilies[i],
+                                                                     SkTypeface::kNormal));
+        if (NULL == typeface.get()) {
+            typeface.reset(SkTypeface::RefDefault());
+        }
+        SkAutoTUnref<SkGlyphAdvanceTable> table(SkGlyphAdvanceTable::RefFor(typeface));
+        if (NULL == table.get()) {
+            continue;  // No glyphs.
+        }
+        REPORTER_ASSERT(reporter, table->countGlyphs() == typeface->countGlyphs());
+
+        // Tables are shared.
+        SkAutoTUnref<SkGlyphAdvanceTable> again(SkGlyphAdvanceTable::RefFor(typeface));
+        REPORTER_ASSERT(reporter, table.get() == again.get());
+
+        if (!table->hasHorizontalMetrics()) {
+            continue;
+        }
+
+        // Reading a few glyphs reads their pages, and no others.
+        const uint32_t firstLast[] = { 0, SkToU32(table->countGlyphs() - 1) };
+        table->readHorizontalMetrics(typeface, firstLast, SK_ARRAY_COUNT(firstLast));
+        int16_t advance;
+        REPORTER_ASSERT(reporter, table->getAdvance(0, NULL, NULL, &advance));
+        REPORTER_ASSERT(reporter, table->getAdvance(table->countGlyphs() - 1, NULL, NULL,
+                                                    &advance));
+        REPORTER_ASSERT(reporter, !table->getAdvance(table->countGlyphs(), NULL, NULL,
+                                                     &advance));
+
+        // The advances from 'hmtx' are those of the scaler.
+        table->readHorizontalMetrics(typeface, NULL, 0);
+        const int glyphCount = table->countGlyphs();
+        SkAutoTMalloc<SkScalar> expected(glyphCount);
+        get_scaler_advances(typeface, glyphCount, expected.get());
+        int mismatches = 0;
+        for (int glyphID = 0; glyphID < glyphCount; glyphID++) {
+            // Every page has been read, so the scaler is not asked.
+            if (!table->getAdvance(glyphID, &fail_proc, NULL, &advance) ||
+                advance != SkScalarRoundToInt(expected[glyphID])) {
+                mismatches++;
+            }
+        }
+        REPORTER_ASSERT(reporter, 0 == mismatches);
+    }
+}
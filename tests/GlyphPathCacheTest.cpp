@@ -0,0 +1,163 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGlyphCache.h"
+#include "SkGlyphPathCache.h"
+#include "SkGraphics.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkTypeface.h"
+#include "Test.h"
+
+static const char kText[] = "Hamburgefons";
+static const size_t kTextLen = sizeof(kText) - 1;
+
+static void get_glyph_paths(const SkPaint& paint, const SkMatrix& matrix,
+                            const uint16_t glyphs[], SkPath paths[]) {
+    SkAutoGlyphCache autoCache(paint, NULL, &matrix);
+    SkGlyphCache* cache = autoCache.getCache();
+    for (size_t i = 0; i < kTextLen; ++i) {
+        const SkPath* path = cache->findPath(cache->getGlyphIDMetrics(glyphs[i]));
+        paths[i] = path ? *path : SkPath();
+    }
+}
+
+static bool nearly_equal(const SkPath& a, const SkPath& b, SkScalar tolerance) {
+    if (a.countVerbs() != b.countVerbs() || a.countPoints() != b.countPoints()) {
+        return false;
+    }
+    for (int i = 0; i < a.countPoints(); ++i) {
+        const SkPoint delta = a.getPoint(i) - b.getPoint(i);
+        if (SkScalarAbs(delta.fX) > tolerance || SkScalarAbs(delta.fY) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The paths made from the shared outlines match the ones the font makes at
+// each size and transform.
+DEF_TEST(GlyphPathCache_MatchesFont, reporter) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setHinting(SkPaint::kNo_Hinting);
+    uint16_t glyphs[kTextLen];
+    paint.textToGlyphs(kText, kTextLen, glyphs);
+
+    const SkScalar sizes[] = { 10, 37, 64, 100, 300 };
+    const SkScalar degrees[] = { 0, 30 };
+    SkGlyphPathCache& pathCache = SkGlyphPathCache::Get();
+    const size_t limit = pathCache.getByteLimit();
+    for (size_t i = 0; i < SK_ARRAY_COUNT(sizes); ++i) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(degrees); ++j) {
+            paint.setTextSize(sizes[i]);
+            SkMatrix matrix;
+            matrix.setRotate(degrees[j]);
+
+            SkPath fontPaths[kTextLen], sharedPaths[kTextLen];
+            SkGraphics::PurgeFontCache();
+            pathCache.setByteLimit(0);
+            get_glyph_paths(paint, matrix, glyphs, fontPaths);
+            SkGraphics::PurgeFontCache();
+            pathCache.setByteLimit(limit);
+            get_glyph_paths(paint, matrix, glyphs, sharedPaths);
+
+            for (size_t k = 0; k < kTextLen; ++k) {
+                // the font rounds its points to 1/64 of a pixel
+                REPORTER_ASSERT(reporter, nearly_equal(fontPaths[k], sharedPaths[k], 0.05f));
+            }
+        }
+    }
+}
+
+// An outline is made once for all sizes, and used as is at kOutlineSize.
+DEF_TEST(GlyphPathCache_Shared, reporter) {
+    SkAutoTUnref<SkTypeface> typeface(SkTypeface::RefDefault());
+    SkPaint paint;
+    paint.setTypeface(typeface);
+    uint16_t glyph;
+    paint.textToGlyphs("H", 1, &glyph);
+
+    SkGlyphPathCache cache;
+    SkPath first, second;
+    REPORTER_ASSERT(reporter, cache.findOutline(typeface, glyph, &first));
+    REPORTER_ASSERT(reporter, cache.findOutline(typeface, glyph, &second));
+    REPORTER_ASSERT(reporter, 1 == cache.getMissCount());
+    REPORTER_ASSERT(reporter, 1 == cache.getHitCount());
+    REPORTER_ASSERT(reporter, 1 == cache.countTypefaces());
+    REPORTER_ASSERT(reporter, !first.isEmpty());
+    REPORTER_ASSERT(reporter, first.getGenerationID() == second.getGenerationID());
+
+    // the outline is kOutlineSize high
+    SkPaint::FontMetrics metrics;
+    paint.setTextSize(SkIntToScalar(SkGlyphPathCache::kOutlineSize));
+    paint.getFontMetrics(&metrics);
+    REPORTER_ASSERT(reporter, first.getBounds().fTop >= metrics.fTop);
+    REPORTER_ASSERT(reporter, first.getBounds().height() > metrics.fXHeight);
+
+    // Two strikes at kOutlineSize, without hinting, share the outline.
+    paint.setHinting(SkPaint::kNo_Hinting);
+    SkPath aaPath, bwPath;
+    {
+        paint.setAntiAlias(true);
+        SkAutoGlyphCache autoCache(paint, NULL, NULL);
+        aaPath = *autoCache.getCache()->findPath(autoCache.getCache()->getGlyphIDMetrics(glyph));
+    }
+    {
+        paint.setAntiAlias(false);
+        SkAutoGlyphCache autoCache(paint, NULL, NULL);
+        bwPath = *autoCache.getCache()->findPath(autoCache.getCache()->getGlyphIDMetrics(glyph));
+    }
+    REPORTER_ASSERT(reporter, aaPath.getGenerationID() == bwPath.getGenerationID());
+}
+
+DEF_TEST(GlyphPathCache_Budget, reporter) {
+    SkAutoTUnref<SkTypeface> typeface(SkTypeface::RefDefault());
+    SkPaint paint;
+    paint.setTypeface(typeface);
+    uint16_t glyphs[kTextLen];
+    paint.textToGlyphs(kText, kTextLen, glyphs);
+
+    SkGlyphPathCache cache;
+    SkPath path;
+    for (size_t i = 0; i < kTextLen; ++i) {
+        REPORTER_ASSERT(reporter, cache.findOutline(typeface, glyphs[i], &path));
+    }
+    const size_t used = cache.getBytesUsed();
+    REPORTER_ASSERT(reporter, used > 0 && used <= cache.getByteLimit());
+
+    // Over the limit, the typeface is purged, but the caller's path stays valid.
+    cache.setByteLimit(used / 2);
+    REPORTER_ASSERT(reporter, 0 == cache.countTypefaces());
+    REPORTER_ASSERT(reporter, 0 == cache.getBytesUsed());
+    REPORTER_ASSERT(reporter, cache.findOutline(typeface, glyphs[0], &path));
+    REPORTER_ASSERT(reporter, !path.isEmpty());
+    REPORTER_ASSERT(reporter, cache.getBytesUsed() <= used / 2);
+
+    cache.setByteLimit(0);
+    REPORTER_ASSERT(reporter, !cache.findOutline(typeface, glyphs[0], &path));
+
+    // The paths of hinted glyphs come from the font.
+    SkGraphics::PurgeFontCache();
+    SkPaint hintedPaint;
+    hintedPaint.setTextSize(SkIntToScalar(20));
+    hintedPaint.setHinting(SkPaint::kNormal_Hinting);
+    SkPath paths[kTextLen];
+    get_glyph_paths(hintedPaint, SkMatrix::I(), glyphs, paths);
+    REPORTER_ASSERT(reporter, !paths[0].isEmpty());
+    REPORTER_ASSERT(reporter, 0 == SkGlyphPathCache::Get().getBytesUsed());
+
+    // The shared outlines are part of the font cache.
+    SkPaint textPaint;
+    textPaint.setTextSize(SkIntToScalar(400));
+    textPaint.getTextPath(kText, kTextLen, 0, 0, &path);
+    REPORTER_ASSERT(reporter, SkGlyphPathCache::Get().getBytesUsed() > 0);
+    REPORTER_ASSERT(reporter, SkGraphics::GetFontCacheUsed() >=
+                              SkGlyphPathCache::Get().getBytesUsed());
+    SkGraphics::PurgeFontCache();
+    REPORTER_ASSERT(reporter, 0 == SkGlyphPathCache::Get().getBytesUsed());
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#if SK_SUPPORT_GPU
+
+#include "GrContext.h"
+#include "GrContextFactory.h"
+#include "GrTextBlobCache.h"
+#include "GrTextStrike.h"
+#include "SkCanvas.h"
+#include "SkGpuDevice.h"
+#include "SkPaint.h"
+#include "SkTextBlob.h"
+#include "Test.h"
+
+static const char kText[] = "Hamburgefons";
+
+static void test_blob_cache(skiatest::Reporter* reporter, GrContext* context) {
+    const int W = 256;
+    const int H = 64;
+
+    GrTextureDesc desc;
+    desc.fConfig = kSkia8888_GrPixelConfig;
+    desc.fFlags = kRenderTarget_GrTextureFlagBit;
+    desc.fWidth = W;
+    desc.fHeight = H;
+    SkAutoTUnref<GrTexture> texture(context->createUncachedTexture(desc, NULL, 0));
+    if (NULL == texture.get()) {
+        return;
+    }
+    SkAutoTUnref<SkGpuDevice> device(SkNEW_ARGS(SkGpuDevice, (context, texture.get())));
+    SkCanvas canvas(device.get());
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(20));
+    SkAutoTUnref<SkTextBlob> blob(SkTextBlob::Create(kText, sizeof(kText) - 1, paint));
+
+    context->freeGpuResources();
+    GrFontCache* fontCache = context->getFontCache();
+    GrTextBlobCache* blobCache = fontCache->getBlobCache();
+    REPORTER_ASSERT(reporter, 0 == blobCache->count());
+
+    // The first draw keeps the quads of the glyphs.
+    canvas.drawTextBlob(blob, SkIntToScalar(10), SkIntToScalar(30), paint);
+    context->flush();
+    REPORTER_ASSERT(reporter, 1 == blobCache->count());
+    GrTextBlobCache::Blob* cached = blobCache->find(blob->uniqueID());
+    REPORTER_ASSERT(reporter, NULL != cached);
+    if (NULL == cached) {
+        return;
+    }
+    const GrTextStrike* strike = fontCache->getHeadStrike();
+    REPORTER_ASSERT(reporter, NULL != strike && cached->isValid(strike->getUniqueID()));
+    REPORTER_ASSERT(reporter, cached->countQuads() > 0 &&
+                              cached->countQuads() <= (int)sizeof(kText) - 1);
+
+    // They are reusable at translations of the same matrix only.
+    const SkIRect clipRect = SkIRect::MakeWH(W, H);
+    SkMatrix matrix;
+    SkVector offset;
+    matrix.setTranslate(SkIntToScalar(3), SkIntToScalar(-2));
+    REPORTER_ASSERT(reporter, cached->canDraw(matrix, SkIntToScalar(10), SkIntToScalar(30),
+                                              clipRect, &offset));
+    REPORTER_ASSERT(reporter, offset == SkVector::Make(SkIntToScalar(3), SkIntToScalar(-2)));
+    matrix.setTranslate(SK_ScalarHalf, 0);
+    REPORTER_ASSERT(reporter, cached->canDraw(matrix, SkIntToScalar(10), SkIntToScalar(30),
+                                              clipRect, &offset));
+    REPORTER_ASSERT(reporter, offset == SkVector::Make(SK_ScalarHalf, 0));
+    matrix.setScale(2, 2);
+    REPORTER_ASSERT(reporter, !cached->canDraw(matrix, SkIntToScalar(10), SkIntToScalar(30),
+                                               clipRect, &offset));
+
+    // Drawing the blob again, elsewhere, keeps its quads.
+    const int quadCount = cached->countQuads();
+    canvas.drawTextBlob(blob, SkIntToScalar(50), SkIntToScalar(40), paint);
+    context->flush();
+    REPORTER_ASSERT(reporter, 1 == blobCache->count());
+    REPORTER_ASSERT(reporter, cached == blobCache->find(blob->uniqueID()));
+    REPORTER_ASSERT(reporter, quadCount == cached->countQuads());
+
+    // Drawing it at another size makes new quads, for the new strike.
+    canvas.scale(2, 2);
+    canvas.drawTextBlob(blob, SkIntToScalar(10), SkIntToScalar(20), paint);
+    context->flush();
+    REPORTER_ASSERT(reporter, 1 == blobCache->count());
+    strike = fontCache->getHeadStrike();
+    REPORTER_ASSERT(reporter, NULL != strike && cached->isValid(strike->getUniqueID()));
+
+    // They go with the atlases.
+    context->freeGpuResources();
+    REPORTER_ASSERT(reporter, 0 == blobCache->count());
+}
+
+DEF_GPUTEST(GpuTextBlob, reporter, factory) {
+    // No pixels are read, so this runs on the null and debug GL interfaces too.
+    for (int type = 0; type < GrContextFactory::kGLContextTypeCnt; ++type) {
+        GrContextFactory::GLContextType glType = static_cast<GrContextFactory::GLContextType>(type);
+        GrContext* context = factory->get(glType);
+        if (NULL == context) {
+            continue;
+        }
+        test_blob_cache(reporter, context);
+    }
+}
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkData.h"
+#include "SkForceLinking.h"
+#include "SkImageDecoder.h"
+#include "SkOSFile.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "Test.h"
+
+__SK_FORCE_IMAGE_DECODER_LINKING;
+
+// Images that should decode identically whether they are decoded from a
+// stream or incrementally. These include a progressive JPEG and an
+// interlaced PNG, which take the multi-pass paths.
+static const char* const kIncrementalImages[] = {
+    "randPixels.jpg",
+    "progressive.jpg",
+    "CMYK.jpg",
+    "randPixels.png",
+    "interlaced.png",
+    "mandrill_16.png",
+    "randPixels.gif",
+    "box.gif",
+    "randPixels.webp",
+    "baby_tux.webp",
+};
+
+static bool bitmaps_equal(const SkBitmap& a, const SkBitmap& b) {
+    if (a.info() != b.info()) {
+        return false;
+    }
+    SkAutoLockPixels alpA(a);
+    SkAutoLockPixels alpB(b);
+    for (int y = 0; y < a.height(); ++y) {
+        if (0 != memcmp(a.getAddr(0, y), b.getAddr(0, y), a.info().minRowBytes())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ *  Feed data to decoder chunkSize bytes at a time, checking the reported row
+ *  ranges along the way. Returns the result of the final call to appendData.
+ */
+static SkImageDecoder::IncrementalResult append_in_chunks(skiatest::Reporter* reporter,
+                                                          SkImageDecoder* decoder,
+                                                          const SkBitmap& bm,
+                                                          const SkData* data,
+                                                          size_t chunkSize) {
+    const uint8_t* bytes = data->bytes();
+    size_t remaining = data->size();
+    SkImageDecoder::IncrementalResult result = SkImageDecoder::kPartial_IncrementalResult;
+    while (remaining > 0 && SkImageDecoder::kPartial_IncrementalResult == result) {
+        const size_t length = SkTMin(chunkSize, remaining);
+        int startRow = -1;
+        int endRow = -1;
+        result = decoder->appendData(bytes, length, &startRow, &endRow);
+        REPORTER_ASSERT(reporter, 0 <= startRow && startRow <= endRow);
+        REPORTER_ASSERT(reporter, endRow <= bm.height());
+        if (startRow != endRow) {
+            // Rows can only have changed once the bitmap is set up.
+            REPORTER_ASSERT(reporter, !bm.isNull());
+        }
+        bytes += length;
+        remaining -= length;
+    }
+    return result;
+}
+
+static void test_incremental_decode(skiatest::Reporter* reporter, const SkString& path) {
+    SkAutoTUnref<SkData> data(SkData::NewFromFileName(path.c_str()));
+    if (NULL == data.get()) {
+        SkDebugf("Could not read %s\n", path.c_str());
+        return;
+    }
+
+    SkMemoryStream stream(data);
+    SkAutoTDelete<SkImageDecoder> decoder(SkImageDecoder::Factory(&stream));
+    if (NULL == decoder.get()) {
+        // The decoder for this format was not built.
+        return;
+    }
+    stream.rewind();
+    SkBitmap expected;
+    if (!decoder->decode(&stream, &expected, kN32_SkColorType,
+                         SkImageDecoder::kDecodePixels_Mode)) {
+        ERRORF(reporter, "Failed to decode %s", path.c_str());
+        return;
+    }
+
+    // Feed the data one byte at a time, which stops the decoder at every
+    // possible point, and also in larger chunks.
+    const size_t kChunkSizes[] = { 1, 100, data->size() };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kChunkSizes); ++i) {
+        SkBitmap bm;
+        REPORTER_ASSERT(reporter, decoder->startIncrementalDecode(&bm, kN32_SkColorType));
+        REPORTER_ASSERT(reporter, bm.isNull());
+
+        SkImageDecoder::IncrementalResult result =
+                append_in_chunks(reporter, decoder.get(), bm, data, kChunkSizes[i]);
+        if (SkImageDecoder::kComplete_IncrementalResult != result) {
+            ERRORF(reporter, "Incremental decode of %s with %d byte chunks did not complete",
+                   path.c_str(), SkToInt(kChunkSizes[i]));
+            continue;
+        }
+        if (!bitmaps_equal(expected, bm)) {
+            ERRORF(reporter, "Incremental decode of %s with %d byte chunks does not match",
+                   path.c_str(), SkToInt(kChunkSizes[i]));
+        }
+
+        // The decode is finished, so more data is ignored.
+        REPORTER_ASSERT(reporter, SkImageDecoder::kFailure_IncrementalResult ==
+                        decoder->appendData(data->data(), data->size()));
+    }
+
+    // Without the last byte, the decode may or may not be able to finish
+    // (GIF does not need its trailer), but the bitmap must be set up.
+    SkBitmap bm;
+    REPORTER_ASSERT(reporter, decoder->startIncrementalDecode(&bm, kN32_SkColorType));
+    REPORTER_ASSERT(reporter, SkImageDecoder::kFailure_IncrementalResult !=
+                    decoder->appendData(data->data(), data->size() - 1));
+    REPORTER_ASSERT(reporter, bm.width() == expected.width());
+    REPORTER_ASSERT(reporter, bm.height() == expected.height());
+}
+
+DEF_TEST(IncrementalDecode, reporter) {
+    SkString resourcePath = skiatest::Test::GetResourcePath();
+    if (resourcePath.isEmpty()) {
+        SkDebugf("Could not run IncrementalDecode test because resourcePath not specified.");
+        return;
+    }
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kIncrementalImages); ++i) {
+        SkString path = SkOSPath::SkPathJoin(resourcePath.c_str(), kIncrementalImages[i]);
+        test_incremental_decode(reporter, path);
+    }
+}
+
+// Garbage data makes an incremental decode fail rather than wait for more.
+DEF_TEST(IncrementalDecode_invalid, reporter) {
+    SkString resourcePath = skiatest::Test::GetResourcePath();
+    if (resourcePath.isEmpty()) {
+        SkDebugf("Could not run IncrementalDecode test because resourcePath not specified.");
+        return;
+    }
+
+    SkString path = SkOSPath::SkPathJoin(resourcePath.c_str(), "randPixels.png");
+    SkAutoTUnref<SkData> data(SkData::NewFromFileName(path.c_str()));
+    if (NULL == data.get()) {
+        return;
+    }
+    SkMemoryStream stream(data);
+    SkAutoTDelete<SkImageDecoder> decoder(SkImageDecoder::Factory(&stream));
+    if (NULL == decoder.get()) {
+        return;
+    }
+
+    SkBitmap bm;
+    REPORTER_ASSERT(reporter, decoder->startIncrementalDecode(&bm, kN32_SkColorType));
+    SkAutoMalloc garbage(data->size());
+    memset(garbage.get(), 0xA5, data->size());
+    REPORTER_ASSERT(reporter, SkImageDecoder::kFailure_IncrementalResult ==
+                    decoder->appendData(garbage.get(), data->size()));
+}
@@ -6,10 +6,13 @@
  */
 
 #include "SkBitmap.h"
+#include "SkColorPriv.h"
 #include "SkData.h"
 #include "SkForceLinking.h"
 #include "SkImage.h"
 #include "SkImageDecoder.h"
+#include "SkImageEncoder.h"
+#include "SkRandom.h"
 #include "SkStream.h"
 #include "Test.h"
 
@@ -447,3 +450,91 @@ DEF_TEST(Jpeg, reporter) {
     SkASSERT(writeSuccess);
     #endif
 }
+
+static bool decode_jpeg(SkData* data, SkBitmap* bm, SkColorType colorType,
+                        int sampleSize, int threadCount) {
+    SkMemoryStream stream(data);
+    SkAutoTDelete<SkImageDecoder> decoder(SkImageDecoder::Factory(&stream));
+    if (NULL == decoder.get()) {
+        return false;
+    }
+    stream.rewind();
+    decoder->setSampleSize(sampleSize);
+    decoder->setThreadCount(threadCount);
+    return decoder->decode(&stream, bm, colorType, SkImageDecoder::kDecodePixels_Mode);
+}
+
+// Whether the JPEG has a DRI (define restart interval) marker. 0xFF bytes in
+// the entropy-coded data are followed by 0x00, so this only finds markers.
+static bool has_restart_interval(SkData* data) {
+    const uint8_t* bytes = data->bytes();
+    for (size_t i = 0; i + 1 < data->size(); ++i) {
+        if (0xFF == bytes[i] && 0xDD == bytes[i + 1]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    if (a.info() != b.info()) {
+        return false;
+    }
+    SkAutoLockPixels alpA(a);
+    SkAutoLockPixels alpB(b);
+    for (int y = 0; y < a.height(); ++y) {
+        if (0 != memcmp(a.getAddr(0, y), b.getAddr(0, y), a.info().minRowBytes())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+  Decoding with several threads (which splits a JPEG with restart markers
+  into bands) must give exactly the same pixels as decoding on one thread.
+*/
+DEF_TEST(Jpeg_threaded, reporter) {
+    // Odd dimensions, so that the last band and the sampling are uneven.
+    SkBitmap src;
+    src.allocN32Pixels(301, 517);
+    SkRandom rand;
+    for (int y = 0; y < src.height(); ++y) {
+        for (int x = 0; x < src.width(); ++x) {
+            *src.getAddr32(x, y) = SkPackARGB32(0xFF, x & 0xFF, y & 0xFF,
+                                                rand.nextU() & 0x3F);
+        }
+    }
+    SkAutoTDelete<SkImageEncoder> encoder(SkImageEncoder::Create(SkImageEncoder::kJPEG_Type));
+    if (NULL == encoder.get()) {
+        return;
+    }
+    // Restart markers are only written when asked for.
+    SkAutoTUnref<SkData> plain(encoder->encodeData(src, 90));
+    REPORTER_ASSERT(reporter, plain.get() && !has_restart_interval(plain));
+    encoder->setJPEGRestartRows(1);
+    SkAutoTUnref<SkData> encoded(encoder->encodeData(src, 90));
+    REPORTER_ASSERT(reporter, encoded.get() && has_restart_interval(encoded));
+    // Also check that an image without restart markers falls back to decoding
+    // on one thread.
+    SkAutoTUnref<SkData> noRestarts(SkData::NewWithCopy(goodJpegImage,
+                                                        sizeof(goodJpegImage)));
+    SkData* images[] = { encoded.get(), noRestarts.get() };
+
+    const SkColorType colorTypes[] = { kN32_SkColorType, kRGB_565_SkColorType };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(images); ++i) {
+        if (NULL == images[i]) {
+            continue;
+        }
+        for (size_t c = 0; c < SK_ARRAY_COUNT(colorTypes); ++c) {
+            for (int sampleSize = 1; sampleSize <= 4; ++sampleSize) {
+                SkBitmap serial, threaded;
+                REPORTER_ASSERT(reporter, decode_jpeg(images[i], &serial, colorTypes[c],
+                                                      sampleSize, 1));
+                REPORTER_ASSERT(reporter, decode_jpeg(images[i], &threaded, colorTypes[c],
+                                                      sampleSize, 4));
+                REPORTER_ASSERT(reporter, equal_pixels(serial, threaded));
+            }
+        }
+    }
+}
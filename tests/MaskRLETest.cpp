@@ -0,0 +1,194 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkBlitter.h"
+#include "SkCanvas.h"
+#include "SkGlyphImageStore.h"
+#include "SkGraphics.h"
+#include "SkMask.h"
+#include "SkMaskRLE.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
+#include "Test.h"
+
+// A mask like a glyph's: solid in the middle of each row, and empty outside,
+// with a few partially covered pixels in between.
+static void make_glyph_mask(SkRandom& rand, int width, int height, size_t rowBytes,
+                            uint8_t* mask) {
+    for (int y = 0; y < height; ++y) {
+        uint8_t* row = mask + y * rowBytes;
+        memset(row, 0, rowBytes);
+        const int left = rand.nextULessThan(width);
+        const int right = left + rand.nextULessThan(width - left + 1);
+        for (int x = left; x < right; ++x) {
+            row[x] = 0xFF;
+        }
+        for (int i = 0; i < 3; ++i) {
+            row[rand.nextULessThan(width)] = rand.nextU() & 0xFF;
+        }
+    }
+}
+
+// Accumulates the coverage blitted into a width x height mask.
+class CoverageBlitter : public SkBlitter {
+public:
+    CoverageBlitter(int width, int height) : fWidth(width), fCoverage(width * height) {
+        memset(fCoverage.get(), 0, width * height);
+    }
+
+    virtual void blitH(int x, int y, int width) SK_OVERRIDE {
+        memset(this->addr(x, y), 0xFF, width);
+    }
+
+    virtual void blitAntiH(int x, int y, const SkAlpha alpha[],
+                           const int16_t runs[]) SK_OVERRIDE {
+        for (;;) {
+            const int n = runs[0];
+            if (0 == n) {
+                break;
+            }
+            memset(this->addr(x, y), alpha[0], n);
+            x += n;
+            runs += n;
+            alpha += n;
+        }
+    }
+
+    const uint8_t* coverage() const { return fCoverage.get(); }
+
+private:
+    uint8_t* addr(int x, int y) { return fCoverage.get() + y * fWidth + x; }
+
+    const int               fWidth;
+    SkAutoTMalloc<uint8_t>  fCoverage;
+};
+
+DEF_TEST(MaskRLE_RoundTrip, reporter) {
+    SkRandom rand;
+    // widths around the longest run
+    static const int kWidths[] = { 1, 2, 3, 7, 63, 64, 65, 130, 300 };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kWidths); ++i) {
+        const int width = kWidths[i];
+        const int height = 1 + rand.nextULessThan(40);
+        const size_t rowBytes = SkAlign4(width);
+        SkAutoTMalloc<uint8_t> mask(rowBytes * height);
+        make_glyph_mask(rand, width, height, rowBytes, mask.get());
+
+        const size_t maxSize = SkMaskRLE::ComputeMaxSize(width, height);
+        SkAutoTMalloc<uint8_t> encoded(maxSize);
+        const size_t size = SkMaskRLE::Encode(mask.get(), rowBytes, width, height,
+                                              encoded.get());
+        REPORTER_ASSERT(reporter, size > 0 && size <= maxSize);
+
+        SkAutoTMalloc<uint8_t> decoded(rowBytes * height);
+        memset(decoded.get(), 0, rowBytes * height);
+        SkMaskRLE::Decode(encoded.get(), width, height, decoded.get(), rowBytes);
+        REPORTER_ASSERT(reporter, 0 == memcmp(mask.get(), decoded.get(), rowBytes * height));
+    }
+
+    // a row of noise is no more than a byte per 64 pixels larger
+    uint8_t noise[200], encoded[204];
+    for (size_t i = 0; i < sizeof(noise); ++i) {
+        noise[i] = (uint8_t)(1 + i % 254);
+    }
+    REPORTER_ASSERT(reporter, SkMaskRLE::ComputeMaxSize(200, 1) <= sizeof(encoded));
+    REPORTER_ASSERT(reporter, 204 == SkMaskRLE::Encode(noise, 200, 200, 1, encoded));
+    // and a solid mask takes a byte per 64 pixels
+    memset(noise, 0xFF, sizeof(noise));
+    REPORTER_ASSERT(reporter, 4 == SkMaskRLE::Encode(noise, 200, 200, 1, encoded));
+}
+
+// Blitting the encoding covers the same pixels as blitting the mask.
+DEF_TEST(MaskRLE_Blit, reporter) {
+    SkRandom rand;
+    const int width = 90, height = 30;
+    SkMask mask;
+    mask.fFormat = SkMask::kA8_Format;
+    mask.fBounds.setXYWH(5, 7, width, height);
+    mask.fRowBytes = SkAlign4(width);
+    SkAutoTMalloc<uint8_t> pixels(mask.computeImageSize());
+    mask.fImage = pixels.get();
+    make_glyph_mask(rand, width, height, mask.fRowBytes, pixels.get());
+
+    SkAutoTMalloc<uint8_t> encoded(SkMaskRLE::ComputeMaxSize(width, height));
+    SkMaskRLE::Encode(pixels.get(), mask.fRowBytes, width, height, encoded.get());
+
+    const SkIRect clips[] = {
+        mask.fBounds,
+        SkIRect::MakeLTRB(5, 7, 6, 8),
+        SkIRect::MakeLTRB(40, 10, 94, 37),
+        SkIRect::MakeLTRB(20, 20, 30, 21),
+    };
+    const int deviceWidth = mask.fBounds.fRight, deviceHeight = mask.fBounds.fBottom;
+    for (size_t i = 0; i < SK_ARRAY_COUNT(clips); ++i) {
+        CoverageBlitter expected(deviceWidth, deviceHeight);
+        expected.blitMask(mask, clips[i]);
+        CoverageBlitter actual(deviceWidth, deviceHeight);
+        SkMaskRLE::Blit(encoded.get(), mask.fBounds, clips[i], &actual);
+        REPORTER_ASSERT(reporter, 0 == memcmp(expected.coverage(), actual.coverage(),
+                                              deviceWidth * deviceHeight));
+    }
+}
+
+static void draw_text(const SkPaint& paint, SkBitmap* bitmap) {
+    bitmap->allocN32Pixels(300, 100);
+    SkCanvas canvas(*bitmap);
+    canvas.clear(SK_ColorWHITE);
+    canvas.drawText("Hamburgefons", 12, 10, 40, paint);
+    // clipped to a rect, and to a complex region
+    canvas.clipRect(SkRect::MakeLTRB(35, 50, 200, 80));
+    canvas.drawText("Hamburgefons", 12, 10, 75, paint);
+    canvas.clipRect(SkRect::MakeLTRB(100, 0, 120, 100), SkRegion::kDifference_Op);
+    canvas.drawText("Hamburgefons", 12, 20, 65, paint);
+}
+
+// Text draws the same from encoded glyph images, which are shared between
+// strikes.
+DEF_TEST(MaskRLE_GlyphCache, reporter) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(30));
+
+    const bool compress = SkGraphics::GetFontCacheCompression();
+    SkGraphics::SetFontCacheCompression(false);
+    SkGraphics::PurgeFontCache();
+    SkBitmap expected;
+    draw_text(paint, &expected);
+    const size_t uncompressedUsed = SkGraphics::GetFontCacheUsed();
+
+    SkGraphics::SetFontCacheCompression(true);
+    REPORTER_ASSERT(reporter, SkGraphics::GetFontCacheCompression());
+    SkGraphics::PurgeFontCache();
+    SkGlyphImageStore& store = SkGlyphImageStore::Get();
+    REPORTER_ASSERT(reporter, 0 == store.countImages());
+    SkBitmap actual;
+    draw_text(paint, &actual);
+    REPORTER_ASSERT(reporter, store.countImages() > 0);
+    REPORTER_ASSERT(reporter, SkGraphics::GetFontCacheUsed() < uncompressedUsed);
+    REPORTER_ASSERT(reporter, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                          expected.getSize()));
+
+    // A strike that differs only in ways that do not change the masks shares
+    // their images, which the font cache counts once.
+    const int images = store.countImages();
+    const int hits = store.getHitCount();
+    const size_t storeUsed = store.getBytesUsed();
+    const size_t used = SkGraphics::GetFontCacheUsed();
+    paint.setDevKernText(true);
+    draw_text(paint, &actual);
+    REPORTER_ASSERT(reporter, images == store.countImages());
+    REPORTER_ASSERT(reporter, hits < store.getHitCount());
+    REPORTER_ASSERT(reporter, storeUsed == store.getBytesUsed());
+    // the new strike costs what the first one does without the images
+    REPORTER_ASSERT(reporter, SkGraphics::GetFontCacheUsed() - used == used - storeUsed);
+
+    SkGraphics::PurgeFontCache();
+    REPORTER_ASSERT(reporter, 0 == store.countImages());
+    REPORTER_ASSERT(reporter, 0 == store.getBytesUsed());
+    SkGraphics::SetFontCacheCompression(compress);
+}
@@ -696,6 +696,46 @@ static void test_matrix_homogeneous(skiatest::Reporter* reporter) {
 
 }
 
+// Mapping many points at once must give the same points as mapping them one
+// at a time, whatever the count, and in place.
+static void test_matrix_map_points(skiatest::Reporter* reporter) {
+    SkMatrix mats[6];
+    mats[0].setTranslate(10.5f, -3.25f);
+    mats[1].setScale(1.5f, -2.25f);
+    mats[2].setScale(0.75f, 3.5f, 12.f, -7.f);
+    mats[3].setRotate(33.f);
+    mats[4].setRotate(-71.f, 20.f, 40.f);
+    mats[4].preScale(1.25f, 0.5f);
+    mats[5].setRotate(20.f, 10.f, 10.f);
+    mats[5].setPerspX(1.f / 1024);
+    mats[5].setPerspY(-1.f / 512);
+
+    const int kPointCount = 37;
+    SkRandom rand;
+    SkPoint src[kPointCount];
+    for (int i = 0; i < kPointCount; ++i) {
+        src[i].set(rand.nextRangeF(-500.f, 500.f), rand.nextRangeF(-500.f, 500.f));
+    }
+    // the perspective divide of a point on the vanishing line is skipped
+    src[kPointCount - 2].set(0, 512.f);
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(mats); ++i) {
+        SkPoint expected[kPointCount];
+        for (int j = 0; j < kPointCount; ++j) {
+            mats[i].mapPoints(&expected[j], &src[j], 1);
+        }
+        for (int count = 0; count <= kPointCount; ++count) {
+            SkPoint dst[kPointCount];
+            mats[i].mapPoints(dst, src, count);
+            REPORTER_ASSERT(reporter, 0 == memcmp(dst, expected, count * sizeof(SkPoint)));
+
+            memcpy(dst, src, sizeof(src));
+            mats[i].mapPoints(dst, count);
+            REPORTER_ASSERT(reporter, 0 == memcmp(dst, expected, count * sizeof(SkPoint)));
+        }
+    }
+}
+
 DEF_TEST(Matrix, reporter) {
     SkMatrix    mat, inverse, iden1, iden2;
 
@@ -813,6 +853,7 @@ DEF_TEST(Matrix, reporter) {
     test_matrix_recttorect(reporter);
     test_matrix_decomposition(reporter);
     test_matrix_homogeneous(reporter);
+    test_matrix_map_points(reporter);
 }
 
 DEF_TEST(Matrix_Concat, r) {
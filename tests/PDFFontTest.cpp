@@ -0,0 +1,71 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCanvas.h"
+#include "SkData.h"
+#include "SkPDFDevice.h"
+#include "SkPDFDocument.h"
+#include "SkPDFFont.h"
+#include "SkStream.h"
+#include "SkTypeface.h"
+#include "Test.h"
+
+static const char* const kFamilies[] = { "serif", "sans-serif", "monospace" };
+
+static SkData* emit_document() {
+    SkISize pageSize = SkISize::Make(612, 792);
+    SkAutoTUnref<SkPDFDevice> dev(new SkPDFDevice(pageSize, pageSize, SkMatrix::I()));
+    SkCanvas canvas(dev);
+    SkPaint paint;
+    paint.setTextSize(SkIntToScalar(20));
+    SkScalar y = SkIntToScalar(40);
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kFamilies); i++) {
+        for (int style = SkTypeface::kNormal; style <= SkTypeface::kBoldItalic; style++) {
+            SkAutoTUnref<SkTypeface> face(
+                    SkTypeface::CreateFromName(kFamilies[i], (SkTypeface::Style)style));
+            paint.setTypeface(face);
+            canvas.drawText("Hamburgefons", 12, SkIntToScalar(20), y, paint);
+            y += SkIntToScalar(30);
+        }
+    }
+
+    SkPDFDocument doc;
+    doc.appendPage(dev);
+    SkDynamicMemoryWStream stream;
+    doc.emitPDF(&stream);
+    return stream.copyToData();
+}
+
+// The fonts of a document are subset in parallel, but the document comes out
+// the same every time.
+DEF_TEST(PDFFont_Subsetting, reporter) {
+    SkAutoTUnref<SkData> first(emit_document());
+    SkAutoTUnref<SkData> second(emit_document());
+    REPORTER_ASSERT(reporter, first->equals(second));
+}
+
+// Documents share the metrics of their typefaces.
+DEF_TEST(PDFFont_TypefaceMetrics, reporter) {
+    SkAutoTUnref<SkTypeface> face(SkTypeface::CreateFromName("serif", SkTypeface::kNormal));
+    const SkAdvancedTypefaceMetrics::PerGlyphInfo info =
+            SkAdvancedTypefaceMetrics::kHAdvance_PerGlyphInfo;
+
+    SkAutoTUnref<SkAdvancedTypefaceMetrics> metrics(
+            SkPDFFont::GetTypefaceMetrics(face, info));
+    SkAutoTUnref<SkAdvancedTypefaceMetrics> again(
+            SkPDFFont::GetTypefaceMetrics(face, info));
+    REPORTER_ASSERT(reporter, metrics.get() == again.get());
+
+    // Different per glyph info are different metrics.
+    SkAutoTUnref<SkAdvancedTypefaceMetrics> other(
+            SkPDFFont::GetTypefaceMetrics(face,
+                    SkAdvancedTypefaceMetrics::kNo_PerGlyphInfo));
+    REPORTER_ASSERT(reporter, NULL == other.get() || other.get() != metrics.get());
+    if (metrics.get()) {
+        REPORTER_ASSERT(reporter, metrics->fGlyphWidths.get());
+    }
+}
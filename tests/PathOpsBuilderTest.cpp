@@ -0,0 +1,96 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#include "PathOpsExtendedTest.h"
+#include "SkRandom.h"
+#include "SkRegion.h"
+
+static bool same_area(const SkPath& one, const SkPath& two) {
+    SkRegion clip;
+    clip.setRect(-100, -100, 200, 200);
+    SkRegion oneRgn, twoRgn;
+    oneRgn.setPath(one, clip);
+    twoRgn.setPath(two, clip);
+    return oneRgn == twoRgn;
+}
+
+static void add_rect(SkRandom* rand, SkOpBuilder* builder, SkPath* sum, SkPathOp op,
+                     bool first) {
+    int left = rand->nextRangeU(0, 90);
+    int top = rand->nextRangeU(0, 90);
+    SkPath path;
+    path.addRect(SkIntToScalar(left), SkIntToScalar(top),
+                 SkIntToScalar(left + rand->nextRangeU(1, 10)),
+                 SkIntToScalar(top + rand->nextRangeU(1, 10)),
+                 rand->nextBool() ? SkPath::kCW_Direction : SkPath::kCCW_Direction);
+    if (rand->nextBool()) {
+        path.toggleInverseFillType();
+    }
+    builder->add(path, op);
+    if (first) {
+        *sum = path;
+    } else {
+        Op(*sum, path, op, sum);
+    }
+}
+
+DEF_TEST(PathOpsBuilder, reporter) {
+    SkOpBuilder builder;
+    SkPath result;
+    REPORTER_ASSERT(reporter, builder.resolve(&result));
+    REPORTER_ASSERT(reporter, result.isEmpty());
+
+    // Rects that are apart are unioned without being intersected with each other.
+    SkPath expected;
+    for (int index = 0; index < 10; ++index) {
+        SkPath rect;
+        rect.addRect(SkIntToScalar(index * 10), 0, SkIntToScalar(index * 10 + 5), 5);
+        builder.add(rect, kUnion_PathOp);
+        expected.addPath(rect);
+    }
+    REPORTER_ASSERT(reporter, builder.resolve(&result));
+    REPORTER_ASSERT(reporter, same_area(result, expected));
+    REPORTER_ASSERT(reporter, !result.isInverseFillType());
+
+    // The builder is empty again.
+    REPORTER_ASSERT(reporter, builder.resolve(&result));
+    REPORTER_ASSERT(reporter, result.isEmpty());
+
+    // Intersections of paths that are apart are empty.
+    SkPath one, two;
+    one.addRect(0, 0, 10, 10);
+    two.addRect(20, 20, 30, 30);
+    builder.add(one, kUnion_PathOp);
+    builder.add(two, kIntersect_PathOp);
+    REPORTER_ASSERT(reporter, builder.resolve(&result));
+    REPORTER_ASSERT(reporter, result.isEmpty());
+
+    // Differences of paths that are apart leave the first.
+    builder.add(one, kUnion_PathOp);
+    builder.add(two, kDifference_PathOp);
+    REPORTER_ASSERT(reporter, builder.resolve(&result));
+    REPORTER_ASSERT(reporter, same_area(result, one));
+
+    // Any mix of operators and fills gives what as many calls to Op() give.
+    SkRandom rand;
+    for (int test = 0; test < 200; ++test) {
+        SkPath sum;
+        const int count = rand.nextRangeU(1, 12);
+        SkPathOp op = (SkPathOp) rand.nextRangeU(kDifference_PathOp, kReverseDifference_PathOp);
+        for (int index = 0; index < count; ++index) {
+            // mostly runs of the same operator
+            if (0 == rand.nextRangeU(0, 3)) {
+                op = (SkPathOp) rand.nextRangeU(kDifference_PathOp, kReverseDifference_PathOp);
+            }
+            add_rect(&rand, &builder, &sum, op, 0 == index);
+        }
+        if (1 == count) {
+            Simplify(sum, &sum);
+        }
+        REPORTER_ASSERT(reporter, builder.resolve(&result));
+        REPORTER_ASSERT(reporter, same_area(result, sum));
+    }
+}
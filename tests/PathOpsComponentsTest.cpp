@@ -0,0 +1,84 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#include "PathOpsExtendedTest.h"
+#include "SkRandom.h"
+#include "SkRegion.h"
+
+static const int kGridSize = 8;
+
+static const int kCellSize = 40;
+
+// Many groups of overlapping rects, apart from each other, so that pathops resolves each group
+// separately. The rects of a group are a staircase whose edges are all on different lines, and
+// the offset of the second operand puts its edges between those of the first, so that no edges
+// are coincident.
+static void add_groups(SkRandom* rand, int offset, SkPath* path, SkRegion* region) {
+    for (int y = 0; y < kGridSize; ++y) {
+        for (int x = 0; x < kGridSize; ++x) {
+            const int steps = rand->nextRangeU(1, 15);
+            for (int step = 0; step < 4; ++step) {
+                if (!(steps & (1 << step))) {
+                    continue;
+                }
+                SkIRect rect = SkIRect::MakeXYWH(x * kCellSize + step * 4 + offset,
+                                                 y * kCellSize + step * 4 + offset, 14, 14);
+                path->addRect(SkRect::Make(rect));
+                region->op(rect, SkRegion::kUnion_Op);
+            }
+        }
+    }
+}
+
+static bool same_area(const SkPath& path, const SkRegion& region) {
+    SkRegion clip;
+    clip.setRect(0, 0, kGridSize * kCellSize, kGridSize * kCellSize);
+    SkRegion pathRegion;
+    pathRegion.setPath(path, clip);
+    return pathRegion == region;
+}
+
+DEF_TEST(PathOpsComponents, reporter) {
+    static const SkRegion::Op kRegionOps[] = {
+        SkRegion::kDifference_Op,
+        SkRegion::kIntersect_Op,
+        SkRegion::kUnion_Op,
+        SkRegion::kXOR_Op,
+        SkRegion::kReverseDifference_Op,
+    };
+    SkRandom rand;
+    for (int test = 0; test < 10; ++test) {
+        SkPath one, two;
+        SkRegion oneRegion, twoRegion;
+        add_groups(&rand, 0, &one, &oneRegion);
+        add_groups(&rand, 1, &two, &twoRegion);
+        SkPath result, threaded;
+        REPORTER_ASSERT(reporter, Simplify(one, &result));
+        REPORTER_ASSERT(reporter, same_area(result, oneRegion));
+        // Resolving the groups on several threads gives the very same path.
+        REPORTER_ASSERT(reporter, Simplify(one, &threaded, 4));
+        REPORTER_ASSERT(reporter, threaded == result);
+        for (int op = kDifference_PathOp; op <= kReverseDifference_PathOp; ++op) {
+            REPORTER_ASSERT(reporter, Op(one, two, (SkPathOp) op, &result));
+            SkRegion expected;
+            expected.op(oneRegion, twoRegion, kRegionOps[op]);
+            REPORTER_ASSERT(reporter, same_area(result, expected));
+            REPORTER_ASSERT(reporter, Op(one, two, (SkPathOp) op, &threaded, 4));
+            REPORTER_ASSERT(reporter, threaded == result);
+        }
+        // Inverse fills are resolved in groups too.
+        one.toggleInverseFillType();
+        REPORTER_ASSERT(reporter, Simplify(one, &result));
+        REPORTER_ASSERT(reporter, result.isInverseFillType());
+        result.toggleInverseFillType();
+        REPORTER_ASSERT(reporter, same_area(result, oneRegion));
+        REPORTER_ASSERT(reporter, Op(one, two, kIntersect_PathOp, &result));
+        SkRegion expected;
+        expected.op(twoRegion, oneRegion, SkRegion::kDifference_Op);
+        REPORTER_ASSERT(reporter, !result.isInverseFillType());
+        REPORTER_ASSERT(reporter, same_area(result, expected));
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkColorPriv.h"
+#include "SkData.h"
+#include "SkForceLinking.h"
+#include "SkImageDecoder.h"
+#include "SkImageEncoder.h"
+#include "SkRandom.h"
+#include "SkStream.h"
+#include "Test.h"
+
+__SK_FORCE_IMAGE_DECODER_LINKING;
+
+// A mix of gradients and noise. If withAlpha is true, some pixels are
+// translucent or transparent, but most are opaque.
+static void make_bitmap(SkBitmap* bm, SkColorType ct, bool withAlpha) {
+    const int kWidth = 203;
+    const int kHeight = 301;
+    SkBitmap src;
+    src.allocPixels(SkImageInfo::MakeN32(kWidth, kHeight,
+                                         withAlpha ? kPremul_SkAlphaType : kOpaque_SkAlphaType));
+    SkRandom rand;
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            U8CPU a = 0xFF;
+            if (withAlpha && 0 == (x / 10 + y / 10) % 3) {
+                a = rand.nextU() & 0xFF;
+            }
+            const U8CPU noise = rand.nextU() & 0x7;
+            *src.getAddr32(x, y) = SkPreMultiplyARGB(a, x & 0xFF, (y + noise) & 0xFF,
+                                                     (x + y) & 0xFF);
+        }
+    }
+    if (kN32_SkColorType == ct) {
+        bm->swap(src);
+    } else {
+        src.copyTo(bm, ct);
+    }
+}
+
+static SkData* encode(const SkBitmap& bm, SkImageEncoder::Preset preset, int threadCount) {
+    SkAutoTDelete<SkImageEncoder> encoder(SkImageEncoder::Create(SkImageEncoder::kPNG_Type));
+    if (NULL == encoder.get()) {
+        return NULL;
+    }
+    encoder->setPreset(preset);
+    encoder->setThreadCount(threadCount);
+    return encoder->encodeData(bm, 100);
+}
+
+static int count_idat_chunks(const SkData* data) {
+    int count = 0;
+    const char* bytes = (const char*)data->data();
+    for (size_t i = 0; i + 4 <= data->size(); ++i) {
+        if (0 == memcmp(bytes + i, "IDAT", 4)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// The decoded pixels must match the original. Translucent pixels lose
+// precision when unpremultiplied, so only their alpha is compared.
+static bool matches_original(const SkBitmap& original, const SkBitmap& decoded) {
+    if (original.width() != decoded.width() || original.height() != decoded.height()) {
+        return false;
+    }
+    SkBitmap expected;
+    if (!original.copyTo(&expected, kN32_SkColorType)) {
+        return false;
+    }
+    SkAutoLockPixels alp(decoded);
+    for (int y = 0; y < expected.height(); ++y) {
+        for (int x = 0; x < expected.width(); ++x) {
+            const SkPMColor e = *expected.getAddr32(x, y);
+            const SkPMColor d = *decoded.getAddr32(x, y);
+            if (0xFF == SkGetPackedA32(e) ? e != d : SkGetPackedA32(e) != SkGetPackedA32(d)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+DEF_TEST(PngEncoder, reporter) {
+    const struct {
+        SkColorType fColorType;
+        bool        fAlpha;
+    } kBitmaps[] = {
+        { kN32_SkColorType,     false },
+        { kN32_SkColorType,     true },
+        { kRGB_565_SkColorType, false },
+    };
+    const SkImageEncoder::Preset kPresets[] = {
+        SkImageEncoder::kDefault_Preset,
+        SkImageEncoder::kFast_Preset,
+        SkImageEncoder::kSmall_Preset,
+    };
+    const int kThreads = 4;
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kBitmaps); ++i) {
+        SkBitmap bm;
+        make_bitmap(&bm, kBitmaps[i].fColorType, kBitmaps[i].fAlpha);
+        for (size_t j = 0; j < SK_ARRAY_COUNT(kPresets); ++j) {
+            for (int threadCount = 1; threadCount <= kThreads; threadCount += kThreads - 1) {
+                SkAutoTUnref<SkData> data(encode(bm, kPresets[j], threadCount));
+                if (NULL == data.get()) {
+                    // The PNG encoder was not built.
+                    return;
+                }
+                if (threadCount > 1) {
+                    // Each band is written as its own IDAT chunk.
+                    REPORTER_ASSERT(reporter, kThreads == count_idat_chunks(data));
+                }
+                SkBitmap decoded;
+                if (!SkImageDecoder::DecodeMemory(data->data(), data->size(), &decoded,
+                                                  kN32_SkColorType,
+                                                  SkImageDecoder::kDecodePixels_Mode)) {
+                    ERRORF(reporter, "Could not decode bitmap %d, preset %d, %d threads",
+                           SkToInt(i), kPresets[j], threadCount);
+                    continue;
+                }
+                if (!matches_original(bm, decoded)) {
+                    ERRORF(reporter, "Wrong pixels for bitmap %d, preset %d, %d threads",
+                           SkToInt(i), kPresets[j], threadCount);
+                }
+            }
+        }
+    }
+}
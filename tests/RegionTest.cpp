@@ -222,6 +222,46 @@ static bool test_rects(const SkIRect rect[], int count) {
     return true;
 }
 
+// setRegions() gives what applying op() to each region in turn gives.
+static void test_set_regions(skiatest::Reporter* reporter) {
+    static const SkRegion::Op gOps[] = {
+        SkRegion::kUnion_Op,
+        SkRegion::kIntersect_Op,
+        SkRegion::kDifference_Op,
+        SkRegion::kXOR_Op,
+    };
+
+    SkRandom rand;
+    for (int i = 0; i < 1000; ++i) {
+        const int N = 1 + rand.nextULessThan(6);
+        SkRegion rgns[6];
+        for (int j = 0; j < N; ++j) {
+            // big enough that the intersections are often not empty
+            randRgn(rand, &rgns[j], 1 + rand.nextULessThan(6));
+            rgns[j].op(SkIRect::MakeLTRB(2, 2, 28, 28), SkRegion::kUnion_Op);
+        }
+        for (size_t k = 0; k < SK_ARRAY_COUNT(gOps); ++k) {
+            SkRegion expected(rgns[0]);
+            for (int j = 1; j < N; ++j) {
+                expected.op(rgns[j], gOps[k]);
+            }
+            SkRegion actual;
+            REPORTER_ASSERT(reporter, actual.setRegions(rgns, N, gOps[k]) == !expected.isEmpty());
+            REPORTER_ASSERT(reporter, actual == expected);
+        }
+    }
+
+    SkRegion rgns[2];
+    rgns[0].setRect(0, 0, 10, 10);
+    rgns[1].setRect(20, 0, 30, 10);
+    SkRegion rgn;
+    REPORTER_ASSERT(reporter, !rgn.setRegions(rgns, 2, SkRegion::kIntersect_Op));
+    REPORTER_ASSERT(reporter, rgn.isEmpty());
+    REPORTER_ASSERT(reporter, !rgn.setRegions(rgns, 0, SkRegion::kUnion_Op));
+    REPORTER_ASSERT(reporter, rgn.setRegions(rgns, 2, SkRegion::kUnion_Op));
+    REPORTER_ASSERT(reporter, rgn.isComplex());
+}
+
 DEF_TEST(Region, reporter) {
     const SkIRect r2[] = {
         { 0, 0, 1, 1 },
@@ -248,9 +288,18 @@ DEF_TEST(Region, reporter) {
         }
         REPORTER_ASSERT(reporter, test_rects(rect, N));
     }
+    for (int i = 0; i < 20; i++) {
+        const int N = 200;
+        SkIRect rect[N];
+        for (int j = 0; j < N; j++) {
+            rand_rect(&rect[j], rand);
+        }
+        REPORTER_ASSERT(reporter, test_rects(rect, N));
+    }
 
     test_proc(reporter, contains_proc);
     test_proc(reporter, intersects_proc);
     test_empties(reporter);
     test_fromchrome(reporter);
+    test_set_regions(reporter);
 }
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkColorPriv.h"
+#include "SkImageDecoder.h"
+#include "SkRandom.h"
+#include "SkScaledBitmapSampler.h"
+#include "Test.h"
+
+// The portable conversion of one source pixel, which the (possibly
+// platform-specific) row procs chosen by SkScaledBitmapSampler must match.
+static SkPMColor expected_color(const uint8_t* src, SkScaledBitmapSampler::SrcConfig sc,
+                                bool premultiply) {
+    switch (sc) {
+        case SkScaledBitmapSampler::kGray:
+            return SkPackARGB32(0xFF, src[0], src[0], src[0]);
+        case SkScaledBitmapSampler::kRGB:
+        case SkScaledBitmapSampler::kRGBX:
+            return SkPackARGB32(0xFF, src[0], src[1], src[2]);
+        case SkScaledBitmapSampler::kRGBA:
+            if (premultiply) {
+                return SkPreMultiplyARGB(src[3], src[0], src[1], src[2]);
+            }
+            return SkPackARGB32NoCheck(src[3], src[0], src[1], src[2]);
+        default:
+            SkASSERT(false);
+            return 0;
+    }
+}
+
+class SamplerTestDecoder : public SkImageDecoder {
+protected:
+    virtual bool onDecode(SkStream*, SkBitmap*, SkImageDecoder::Mode) SK_OVERRIDE {
+        return false;
+    }
+};
+
+static void test_sampler(skiatest::Reporter* reporter, SkRandom* rand,
+                         SkScaledBitmapSampler::SrcConfig sc, int srcPixelSize,
+                         int width, int sampleSize, bool premultiply, bool skipZeros) {
+    const int kHeight = 4;
+    SkScaledBitmapSampler sampler(width, kHeight, sampleSize);
+    SkBitmap bm;
+    bm.allocPixels(SkImageInfo::MakeN32(sampler.scaledWidth(), sampler.scaledHeight(),
+                                        premultiply ? kPremul_SkAlphaType
+                                                    : kUnpremul_SkAlphaType));
+    // Pixels with zero alpha must be left alone when skipping zeros.
+    const SkColor kBackground = SkColorSetARGB(0xFF, 0x12, 0x34, 0x56);
+    bm.eraseColor(kBackground);
+
+    SamplerTestDecoder decoder;
+    decoder.setRequireUnpremultipliedColors(!premultiply);
+    decoder.setSkipWritingZeroes(skipZeros);
+    REPORTER_ASSERT(reporter, sampler.begin(&bm, sc, decoder));
+
+    SkAutoMalloc storage(width * srcPixelSize);
+    uint8_t* row = (uint8_t*)storage.get();
+    for (int y = 0; y < kHeight; ++y) {
+        bool expectedAlpha = false;
+        for (int i = 0; i < width * srcPixelSize; ++i) {
+            row[i] = rand->nextU() & 0xFF;
+        }
+        if (SkScaledBitmapSampler::kRGBA == sc) {
+            // Mostly opaque and transparent pixels, as in typical images, with
+            // every other pair of rows entirely opaque.
+            for (int x = 0; x < width; ++x) {
+                const uint32_t r = (y & 2) ? 3 : rand->nextU() % 4;
+                row[4 * x + 3] = 0 == r ? 0 : (1 == r ? row[4 * x + 3] : 0xFF);
+            }
+        }
+        const int dstY = sampler.srcYToDstY(y);
+        const bool hadAlpha = sampler.sampleInterlaced(row, y);
+        if (dstY < 0) {
+            continue;
+        }
+
+        bool match = true;
+        const SkPMColor* dst = bm.getAddr32(0, dstY);
+        for (int x = 0; x < sampler.scaledWidth(); ++x) {
+            const int srcX = (sampler.srcDX() >> 1) + x * sampler.srcDX();
+            const uint8_t* src = row + srcX * srcPixelSize;
+            SkPMColor expected = expected_color(src, sc, premultiply);
+            if (SkScaledBitmapSampler::kRGBA == sc) {
+                expectedAlpha |= src[3] != 0xFF;
+                if (skipZeros && 0 == src[3]) {
+                    expected = SkPreMultiplyColor(kBackground);
+                }
+            }
+            match &= expected == dst[x];
+        }
+        if (!match) {
+            ERRORF(reporter, "Wrong pixels: config %d, width %d, sampleSize %d, premul %d, "
+                   "skip %d", sc, width, sampleSize, premultiply, skipZeros);
+        }
+        REPORTER_ASSERT(reporter, expectedAlpha == hadAlpha);
+    }
+}
+
+// Compare the row procs chosen by SkScaledBitmapSampler, which may be
+// platform-specific, to the portable conversions, for widths that exercise
+// both the vectorized loops and their leftovers.
+DEF_TEST(ScaledBitmapSampler, reporter) {
+    SkRandom rand;
+    const struct {
+        SkScaledBitmapSampler::SrcConfig    fConfig;
+        int                                 fPixelSize;
+    } kConfigs[] = {
+        { SkScaledBitmapSampler::kGray, 1 },
+        { SkScaledBitmapSampler::kRGB,  3 },
+        { SkScaledBitmapSampler::kRGBX, 4 },
+        { SkScaledBitmapSampler::kRGBA, 4 },
+    };
+    const int kWidths[] = { 1, 3, 4, 5, 15, 16, 17, 31, 33, 64, 301 };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kConfigs); ++i) {
+        for (size_t j = 0; j < SK_ARRAY_COUNT(kWidths); ++j) {
+            for (int sampleSize = 1; sampleSize <= 2; ++sampleSize) {
+                for (int flags = 0; flags < 4; ++flags) {
+                    const bool premultiply = SkToBool(flags & 1);
+                    const bool skipZeros = SkToBool(flags & 2);
+                    if (skipZeros && !premultiply) {
+                        // Not a supported combination.
+                        continue;
+                    }
+                    test_sampler(reporter, &rand, kConfigs[i].fConfig, kConfigs[i].fPixelSize,
+                                 kWidths[j], sampleSize, premultiply, skipZeros);
+                }
+            }
+        }
+    }
+}
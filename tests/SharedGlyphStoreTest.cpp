@@ -0,0 +1,407 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkDescriptor.h"
+#include "SkGlyph.h"
+#include "SkGraphics.h"
+#include "SkPaint.h"
+#include "SkSharedGlyphStore.h"
+#include "SkTemplates.h"
+#include "Test.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+    #include <sys/mman.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+    #define SHARED_GLYPH_STORE_TEST_PROCESSES
+#endif
+
+static const size_t kStoreSize = 2 * 1024 * 1024;
+
+static const uint32_t kTestKeyTag = SkSetFourByteTag('t', 'e', 's', 't');
+
+// Makes a descriptor that stands for strike n.
+static void make_key(SkAutoDescriptor* key, uint32_t n) {
+    SkDescriptor* desc = key->getDesc();
+    desc->init();
+    desc->addEntry(kTestKeyTag, sizeof(n), &n);
+    desc->computeChecksum();
+}
+
+static size_t key_size() {
+    return SkDescriptor::ComputeOverhead(1) + sizeof(uint32_t);
+}
+
+// Sets the metrics of a size x size A8 glyph.
+static void make_glyph(SkGlyph* glyph, uint32_t id, int size) {
+    glyph->init(id);
+    glyph->fAdvanceX = SkIntToFixed(size + 1);
+    glyph->fAdvanceY = 0;
+    glyph->fWidth = size;
+    glyph->fHeight = size;
+    glyph->fTop = -size;
+    glyph->fLeft = 1;
+    glyph->fMaskFormat = SkMask::kA8_Format;
+    glyph->fRsbDelta = 0;
+    glyph->fLsbDelta = 0;
+}
+
+static void fill_image(uint8_t* image, size_t size, uint32_t n, uint32_t id) {
+    for (size_t i = 0; i < size; ++i) {
+        image[i] = (uint8_t)(n * 31 + id * 7 + i);
+    }
+}
+
+static bool check_image(const uint8_t* image, size_t size, uint32_t n, uint32_t id) {
+    for (size_t i = 0; i < size; ++i) {
+        if (image[i] != (uint8_t)(n * 31 + id * 7 + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Adds the glyph and its image to strike n.
+static void add_glyph(SkSharedGlyphStore* store, const SkSharedGlyphStore::Strike& strike,
+                      uint32_t n, uint32_t id, int size) {
+    SkGlyph glyph;
+    make_glyph(&glyph, id, size);
+    SkAutoMalloc image(glyph.computeImageSize());
+    fill_image((uint8_t*)image.get(), glyph.computeImageSize(), n, id);
+    glyph.fImage = image.get();
+    store->addGlyph(strike, glyph);
+    store->addImage(strike, glyph);
+}
+
+// Returns 1 if the glyph is found with the right image, 0 if it is not found,
+// and -1 if it is found with the wrong metrics or image.
+static int find_glyph(SkSharedGlyphStore* store, const SkSharedGlyphStore::Strike& strike,
+                      uint32_t n, uint32_t id, int size) {
+    SkGlyph expected;
+    make_glyph(&expected, id, size);
+
+    SkGlyph glyph;
+    glyph.init(id);
+    if (!store->findGlyph(strike, &glyph)) {
+        return 0;
+    }
+    if (glyph.fWidth != expected.fWidth || glyph.fHeight != expected.fHeight ||
+        glyph.fAdvanceX != expected.fAdvanceX || glyph.fTop != expected.fTop ||
+        glyph.fMaskFormat != expected.fMaskFormat) {
+        return -1;
+    }
+    SkAutoMalloc image(glyph.computeImageSize());
+    if (!store->findImage(strike, &glyph, image.get())) {
+        return 0;
+    }
+    return check_image((const uint8_t*)image.get(), glyph.computeImageSize(), n, id) ? 1 : -1;
+}
+
+DEF_TEST(SharedGlyphStore, reporter) {
+    REPORTER_ASSERT(reporter, NULL == SkSharedGlyphStore::Create(NULL, kStoreSize));
+    REPORTER_ASSERT(reporter, kStoreSize >= SkSharedGlyphStore::MinSize());
+
+    SkAutoMalloc memory(kStoreSize);
+    sk_bzero(memory.get(), kStoreSize);
+    REPORTER_ASSERT(reporter, NULL == SkSharedGlyphStore::Create(memory.get(),
+                                                     SkSharedGlyphStore::MinSize() - 1));
+
+    // Two views of the same memory stand for two processes.
+    SkAutoTUnref<SkSharedGlyphStore> a(SkSharedGlyphStore::Create(memory.get(), kStoreSize));
+    SkAutoTUnref<SkSharedGlyphStore> b(SkSharedGlyphStore::Create(memory.get(), kStoreSize));
+    REPORTER_ASSERT(reporter, a.get() && b.get());
+    if (NULL == a.get() || NULL == b.get()) {
+        return;
+    }
+    // A view of a different size is refused.
+    REPORTER_ASSERT(reporter, NULL == SkSharedGlyphStore::Create(memory.get(), kStoreSize - 4));
+
+    SkAutoDescriptor key(key_size());
+    make_key(&key, 1);
+    SkSharedGlyphStore::Strike strikeA, strikeB;
+    REPORTER_ASSERT(reporter, a->findStrike(*key.getDesc(), &strikeA));
+    REPORTER_ASSERT(reporter, b->findStrike(*key.getDesc(), &strikeB));
+    REPORTER_ASSERT(reporter, strikeA.fIndex == strikeB.fIndex);
+    REPORTER_ASSERT(reporter, 1 == a->countStrikes());
+
+    REPORTER_ASSERT(reporter, 0 == find_glyph(b.get(), strikeB, 1, 42, 10));
+    add_glyph(a.get(), strikeA, 1, 42, 10);
+    REPORTER_ASSERT(reporter, 1 == find_glyph(b.get(), strikeB, 1, 42, 10));
+    REPORTER_ASSERT(reporter, 0 == find_glyph(b.get(), strikeB, 1, 43, 10));
+    REPORTER_ASSERT(reporter, 2 == b->getHitCount());
+    REPORTER_ASSERT(reporter, 0 == a->getHitCount());
+
+    // Subpixel variants are different glyphs.
+    const uint32_t subpixelID = SkGlyph::MakeID(42, SK_FixedHalf, 0);
+    REPORTER_ASSERT(reporter, 0 == find_glyph(b.get(), strikeB, 1, subpixelID, 10));
+
+    // Once evicted, the strike no longer finds the glyphs, and is reassigned
+    // empty.
+    a->purgeAll();
+    REPORTER_ASSERT(reporter, 0 == a->countStrikes());
+    REPORTER_ASSERT(reporter, 0 == a->getBytesUsed());
+    REPORTER_ASSERT(reporter, 0 == find_glyph(b.get(), strikeB, 1, 42, 10));
+    REPORTER_ASSERT(reporter, b->findStrike(*key.getDesc(), &strikeB));
+    REPORTER_ASSERT(reporter, 0 == find_glyph(b.get(), strikeB, 1, 42, 10));
+}
+
+DEF_TEST(SharedGlyphStore_Eviction, reporter) {
+    SkAutoMalloc memory(kStoreSize);
+    sk_bzero(memory.get(), kStoreSize);
+    SkAutoTUnref<SkSharedGlyphStore> store(SkSharedGlyphStore::Create(memory.get(),
+                                                                       kStoreSize));
+    REPORTER_ASSERT(reporter, store.get());
+    if (NULL == store.get()) {
+        return;
+    }
+
+    // Each strike gets an image too big to share a chunk with another.
+    static const int kBigGlyph = 100;
+    static const size_t kLimit = 64 * 1024;
+    store->setByteLimit(kLimit);
+    REPORTER_ASSERT(reporter, kLimit == store->getByteLimit());
+
+    static const int kStrikes = 100;
+    SkSharedGlyphStore::Strike strikes[kStrikes];
+    for (int n = 0; n < kStrikes; ++n) {
+        SkAutoDescriptor key(key_size());
+        make_key(&key, n);
+        REPORTER_ASSERT(reporter, store->findStrike(*key.getDesc(), &strikes[n]));
+        add_glyph(store.get(), strikes[n], n, 0, kBigGlyph);
+        REPORTER_ASSERT(reporter, store->getBytesUsed() <= kLimit);
+        REPORTER_ASSERT(reporter, 1 == find_glyph(store.get(), strikes[n], n, 0, kBigGlyph));
+    }
+    REPORTER_ASSERT(reporter, store->countStrikes() < kStrikes);
+
+    // The least recently used strikes went first.
+    REPORTER_ASSERT(reporter, 0 == find_glyph(store.get(), strikes[0], 0, 0, kBigGlyph));
+    REPORTER_ASSERT(reporter, 1 == find_glyph(store.get(), strikes[kStrikes - 1],
+                                              kStrikes - 1, 0, kBigGlyph));
+
+    // Lowering the limit evicts more of them.
+    store->setByteLimit(16 * 1024);
+    REPORTER_ASSERT(reporter, store->getBytesUsed() <= 16 * 1024);
+}
+
+#ifdef SHARED_GLYPH_STORE_TEST_PROCESSES
+
+static const int kProcessStrikes = 4;
+static const int kProcessGlyphs = 200;
+
+// Reads and adds the glyphs of all the strikes, starting from a different
+// place in each process. Returns false if it ever reads a wrong glyph.
+static bool share_glyphs(void* memory, int process) {
+    SkAutoTUnref<SkSharedGlyphStore> store(SkSharedGlyphStore::Create(memory, kStoreSize));
+    if (NULL == store.get()) {
+        return false;
+    }
+    for (int i = 0; i < kProcessStrikes * kProcessGlyphs; ++i) {
+        const int index = (i + process * kProcessGlyphs / 2) % (kProcessStrikes * kProcessGlyphs);
+        const uint32_t n = index / kProcessGlyphs;
+        const uint32_t id = index % kProcessGlyphs;
+        const int size = 4 + id % 16;
+
+        SkAutoDescriptor key(key_size());
+        make_key(&key, n);
+        SkSharedGlyphStore::Strike strike;
+        if (!store->findStrike(*key.getDesc(), &strike)) {
+            return false;
+        }
+        const int found = find_glyph(store.get(), strike, n, id, size);
+        if (found < 0) {
+            return false;
+        }
+        if (0 == found) {
+            add_glyph(store.get(), strike, n, id, size);
+        }
+    }
+    return true;
+}
+
+DEF_TEST(SharedGlyphStore_Processes, reporter) {
+    void* memory = mmap(NULL, kStoreSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                        -1, 0);
+    REPORTER_ASSERT(reporter, MAP_FAILED != memory);
+    if (MAP_FAILED == memory) {
+        return;
+    }
+
+    static const int kChildren = 3;
+    pid_t children[kChildren];
+    for (int i = 0; i < kChildren; ++i) {
+        children[i] = fork();
+        if (0 == children[i]) {
+            // Only the store is used in the child, which has none of the
+            // other threads of the parent.
+            _exit(share_glyphs(memory, i + 1) ? 0 : 1);
+        }
+        REPORTER_ASSERT(reporter, children[i] > 0);
+    }
+    REPORTER_ASSERT(reporter, share_glyphs(memory, 0));
+    for (int i = 0; i < kChildren; ++i) {
+        int status = 0;
+        if (children[i] > 0) {
+            REPORTER_ASSERT(reporter, children[i] == waitpid(children[i], &status, 0));
+            REPORTER_ASSERT(reporter, WIFEXITED(status) && 0 == WEXITSTATUS(status));
+        }
+    }
+
+    // Every glyph has been added by now, by one process or another.
+    SkAutoTUnref<SkSharedGlyphStore> store(SkSharedGlyphStore::Create(memory, kStoreSize));
+    int found = 0;
+    for (int n = 0; n < kProcessStrikes; ++n) {
+        SkAutoDescriptor key(key_size());
+        make_key(&key, n);
+        SkSharedGlyphStore::Strike strike;
+        REPORTER_ASSERT(reporter, store->findStrike(*key.getDesc(), &strike));
+        for (int id = 0; id < kProcessGlyphs; ++id) {
+            found += find_glyph(store.get(), strike, n, id, 4 + id % 16);
+        }
+    }
+    REPORTER_ASSERT(reporter, kProcessStrikes * kProcessGlyphs == found);
+    munmap(memory, kStoreSize);
+}
+
+// Returns the id of a process that has exited.
+static pid_t dead_process_id() {
+    const pid_t child = fork();
+    if (0 == child) {
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    return child;
+}
+
+DEF_TEST(SharedGlyphStore_DeadLockHolder, reporter) {
+    SkAutoMalloc memory(kStoreSize);
+    sk_bzero(memory.get(), kStoreSize);
+    SkAutoTUnref<SkSharedGlyphStore> store(SkSharedGlyphStore::Create(memory.get(),
+                                                                       kStoreSize));
+    REPORTER_ASSERT(reporter, store.get());
+    if (NULL == store.get()) {
+        return;
+    }
+    SkAutoDescriptor key(key_size());
+    make_key(&key, 1);
+    SkSharedGlyphStore::Strike strike;
+    REPORTER_ASSERT(reporter, store->findStrike(*key.getDesc(), &strike));
+    add_glyph(store.get(), strike, 1, 42, 10);
+
+    // Make it look as if a process died holding the lock, which is the fourth
+    // word of the memory.
+    const pid_t child = dead_process_id();
+    REPORTER_ASSERT(reporter, child > 0);
+    reinterpret_cast<int32_t*>(memory.get())[3] = child;
+
+    // The store takes the lock over, and drops the strikes the dead process
+    // may have been changing.
+    make_key(&key, 2);
+    SkSharedGlyphStore::Strike other;
+    REPORTER_ASSERT(reporter, store->findStrike(*key.getDesc(), &other));
+    REPORTER_ASSERT(reporter, 1 == store->countStrikes());
+    REPORTER_ASSERT(reporter, 0 == find_glyph(store.get(), strike, 1, 42, 10));
+    add_glyph(store.get(), other, 2, 42, 10);
+    REPORTER_ASSERT(reporter, 1 == find_glyph(store.get(), other, 2, 42, 10));
+}
+
+DEF_TEST(SharedGlyphStore_DeadWriter, reporter) {
+    SkAutoMalloc memory(kStoreSize);
+    sk_bzero(memory.get(), kStoreSize);
+    SkAutoTUnref<SkSharedGlyphStore> store(SkSharedGlyphStore::Create(memory.get(),
+                                                                       kStoreSize));
+    REPORTER_ASSERT(reporter, store.get());
+    if (NULL == store.get()) {
+        return;
+    }
+    SkAutoDescriptor key(key_size());
+    make_key(&key, 1);
+    SkSharedGlyphStore::Strike strike;
+    REPORTER_ASSERT(reporter, store->findStrike(*key.getDesc(), &strike));
+    REPORTER_ASSERT(reporter, 0 == strike.fIndex);
+    add_glyph(store.get(), strike, 1, 1, 10);
+
+    // Make it look as if a live process is writing to the strike; the writer
+    // of the first strike is the fourteenth word of the memory.
+    int fds[2];
+    REPORTER_ASSERT(reporter, 0 == pipe(fds));
+    const pid_t writer = fork();
+    if (0 == writer) {
+        char c;
+        close(fds[1]);
+        while (read(fds[0], &c, 1) < 0) {}
+        _exit(0);
+    }
+    close(fds[0]);
+    REPORTER_ASSERT(reporter, writer > 0);
+    int32_t* words = reinterpret_cast<int32_t*>(memory.get());
+    words[13] = writer;
+
+    // A slow writer keeps the strike, even when the lock is taken over.
+    add_glyph(store.get(), strike, 1, 2, 10);
+    REPORTER_ASSERT(reporter, 0 == find_glyph(store.get(), strike, 1, 2, 10));
+    words[3] = dead_process_id();
+    make_key(&key, 2);
+    SkSharedGlyphStore::Strike other;
+    REPORTER_ASSERT(reporter, store->findStrike(*key.getDesc(), &other));
+    REPORTER_ASSERT(reporter, 2 == store->countStrikes());
+    REPORTER_ASSERT(reporter, 1 == find_glyph(store.get(), strike, 1, 1, 10));
+
+    // Once the writer has exited, the strike can be written to again.
+    close(fds[1]);
+    int status = 0;
+    waitpid(writer, &status, 0);
+    add_glyph(store.get(), strike, 1, 2, 10);
+    REPORTER_ASSERT(reporter, 1 == find_glyph(store.get(), strike, 1, 2, 10));
+}
+
+#endif
+
+static void draw_text(SkBitmap* bitmap) {
+    bitmap->allocN32Pixels(256, 64);
+    bitmap->eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(*bitmap);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(17));
+    static const char kText[] = "Shared glyphs 0123";
+    canvas.drawText(kText, strlen(kText), SkIntToScalar(4), SkIntToScalar(40), paint);
+}
+
+// Strikes of other threads may keep using the store after it is replaced, so
+// its memory is never freed.
+static uint32_t gStoreMemory[kStoreSize / sizeof(uint32_t)];
+
+DEF_TEST(SharedGlyphStore_FontCache, reporter) {
+    // This thread gets a font cache of its own, so that purging it does not
+    // affect the other tests.
+    SkGraphics::SetTLSFontCacheLimit(1024 * 1024);
+    REPORTER_ASSERT(reporter, SkGraphics::SetSharedFontCache(gStoreMemory, kStoreSize));
+
+    SkBitmap generated;
+    draw_text(&generated);
+
+    // Without its strikes, the cache reads the glyphs back from the store.
+    SkGraphics::SetTLSFontCacheLimit(0);
+    SkGraphics::SetTLSFontCacheLimit(1024 * 1024);
+    SkBitmap shared;
+    draw_text(&shared);
+
+    SkAutoTUnref<SkSharedGlyphStore> store(SkSharedGlyphStore::Create(gStoreMemory,
+                                                                       kStoreSize));
+    REPORTER_ASSERT(reporter, store.get() && store->countStrikes() > 0);
+    REPORTER_ASSERT(reporter, store.get() && store->getBytesUsed() > 0);
+
+    SkAutoLockPixels alpg(generated), alps(shared);
+    REPORTER_ASSERT(reporter, 0 == memcmp(generated.getPixels(), shared.getPixels(),
+                                          generated.getSize()));
+
+    SkGraphics::SetSharedFontCache(NULL, 0);
+    SkGraphics::SetTLSFontCacheLimit(0);
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDashPathEffect.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkStrokeCache.h"
+#include "Test.h"
+
+static void make_polyline(SkPath* path) {
+    path->moveTo(10, 10);
+    for (int i = 1; i < 20; ++i) {
+        path->lineTo(SkIntToScalar(10 + i * 15), SkIntToScalar(i & 1 ? 40 : 10));
+    }
+}
+
+static void test_keys(skiatest::Reporter* reporter) {
+    SkPath path;
+    make_polyline(&path);
+    SkPaint paint;
+    SkStrokeCache::Key key;
+
+    // filling is not cached
+    REPORTER_ASSERT(reporter, !key.init(path, paint, NULL));
+
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(3);
+    REPORTER_ASSERT(reporter, key.init(path, paint, NULL));
+    SkStrokeCache::Key other;
+    REPORTER_ASSERT(reporter, other.init(path, paint, NULL));
+    REPORTER_ASSERT(reporter, key == other);
+
+    paint.setStrokeWidth(4);
+    REPORTER_ASSERT(reporter, other.init(path, paint, NULL));
+    REPORTER_ASSERT(reporter, !(key == other));
+    paint.setStrokeWidth(3);
+
+    SkPath copy(path);
+    REPORTER_ASSERT(reporter, other.init(copy, paint, NULL));
+    REPORTER_ASSERT(reporter, key == other);
+    copy.lineTo(0, 0);
+    REPORTER_ASSERT(reporter, other.init(copy, paint, NULL));
+    REPORTER_ASSERT(reporter, !(key == other));
+
+    const SkScalar intervals[] = { 4, 2 };
+    paint.setPathEffect(SkDashPathEffect::Create(intervals, 2, 0))->unref();
+    REPORTER_ASSERT(reporter, other.init(path, paint, NULL));
+    REPORTER_ASSERT(reporter, !(key == other));
+
+    // the dash of a line is culled, so depends on the cull rect
+    SkPath line;
+    line.moveTo(0, 0);
+    line.lineTo(100, 0);
+    const SkRect cull = SkRect::MakeWH(50, 50);
+    REPORTER_ASSERT(reporter, key.init(line, paint, NULL));
+    REPORTER_ASSERT(reporter, !key.init(line, paint, &cull));
+    REPORTER_ASSERT(reporter, key.init(path, paint, &cull));
+
+    const SkScalar manyIntervals[] = { 1, 1, 2, 1, 3, 1, 4, 1, 5, 1 };
+    paint.setPathEffect(SkDashPathEffect::Create(manyIntervals,
+                                                 SK_ARRAY_COUNT(manyIntervals), 0))->unref();
+    REPORTER_ASSERT(reporter, !key.init(path, paint, NULL));
+}
+
+static void test_cache(skiatest::Reporter* reporter) {
+    SkPath path;
+    make_polyline(&path);
+    SkPaint paint;
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(3);
+
+    SkPath stroked;
+    REPORTER_ASSERT(reporter, paint.getFillPath(path, &stroked));
+
+    SkStrokeCache cache;
+    SkStrokeCache::Key key;
+    REPORTER_ASSERT(reporter, key.init(path, paint, NULL));
+
+    // A path stroked once is not kept.
+    SkPath found;
+    bool fill;
+    REPORTER_ASSERT(reporter, !cache.find(key, &found, &fill));
+    cache.add(key, stroked, true);
+    REPORTER_ASSERT(reporter, 0 == cache.count());
+    REPORTER_ASSERT(reporter, 0 == cache.getBytesUsed());
+
+    REPORTER_ASSERT(reporter, !cache.find(key, &found, &fill));
+    cache.add(key, stroked, true);
+    REPORTER_ASSERT(reporter, 1 == cache.count());
+    REPORTER_ASSERT(reporter, cache.getBytesUsed() > 0);
+
+    REPORTER_ASSERT(reporter, cache.find(key, &found, &fill));
+    REPORTER_ASSERT(reporter, fill);
+    REPORTER_ASSERT(reporter, found == stroked);
+    REPORTER_ASSERT(reporter, 1 == cache.getHitCount());
+    REPORTER_ASSERT(reporter, 2 == cache.getMissCount());
+
+    // Lowering the limit purges.
+    cache.setByteLimit(0);
+    REPORTER_ASSERT(reporter, 0 == cache.count());
+    REPORTER_ASSERT(reporter, 0 == cache.getBytesUsed());
+    REPORTER_ASSERT(reporter, !cache.find(key, &found, &fill));
+    cache.add(key, stroked, true);
+    cache.add(key, stroked, true);
+    REPORTER_ASSERT(reporter, 0 == cache.count());
+
+    cache.setByteLimit(1024 * 1024);
+    cache.add(key, stroked, true);
+    cache.add(key, stroked, true);
+    REPORTER_ASSERT(reporter, 1 == cache.count());
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, 0 == cache.count());
+    REPORTER_ASSERT(reporter, 0 == cache.getBytesUsed());
+}
+
+// Drawing through the process-wide cache gives the same outlines.
+static void test_fill_path(skiatest::Reporter* reporter) {
+    SkPath path;
+    make_polyline(&path);
+    SkPaint paint;
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(3);
+    const SkScalar intervals[] = { 4, 2 };
+
+    for (int dash = 0; dash < 2; ++dash) {
+        if (dash) {
+            paint.setPathEffect(SkDashPathEffect::Create(intervals, 2, 0))->unref();
+        }
+        SkPath first;
+        REPORTER_ASSERT(reporter, paint.getFillPath(path, &first));
+        for (int i = 0; i < 3; ++i) {
+            SkPath again;
+            REPORTER_ASSERT(reporter, paint.getFillPath(path, &again));
+            REPORTER_ASSERT(reporter, again == first);
+        }
+        // dst may be the source
+        SkPath inPlace(path);
+        REPORTER_ASSERT(reporter, paint.getFillPath(inPlace, &inPlace));
+        REPORTER_ASSERT(reporter, inPlace == first);
+    }
+
+    paint.setPathEffect(NULL);
+    paint.setStrokeWidth(0);
+    SkPath hairline;
+    REPORTER_ASSERT(reporter, !paint.getFillPath(path, &hairline));
+    REPORTER_ASSERT(reporter, !paint.getFillPath(path, &hairline));
+}
+
+DEF_TEST(StrokeCache, reporter) {
+    test_keys(reporter);
+    test_cache(reporter);
+    test_fill_path(reporter);
+}
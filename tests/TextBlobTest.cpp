@@ -0,0 +1,233 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkOffsetImageFilter.h"
+#include "SkPaint.h"
+#include "SkRecord.h"
+#include "SkRecordDraw.h"
+#include "SkRecorder.h"
+#include "SkRecords.h"
+#include "SkTextBlob.h"
+#include "Test.h"
+
+static const char kText[] = "Hamburgefons";
+static const size_t kTextLen = sizeof(kText) - 1;
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels alpA(a);
+    SkAutoLockPixels alpB(b);
+    for (int y = 0; y < a.height(); ++y) {
+        if (memcmp(a.getAddr32(0, y), b.getAddr32(0, y), a.width() * sizeof(SkPMColor))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void set_flags(SkPaint* paint, unsigned flags) {
+    paint->setAntiAlias(SkToBool(flags & 1));
+    paint->setSubpixelText(SkToBool(flags & 2));
+    paint->setLinearText(SkToBool(flags & 4));
+}
+
+// The positions drawText() would use at the identity matrix.
+static void text_positions(const SkPaint& paint, SkScalar x, SkScalar y, SkPoint pos[]) {
+    SkScalar widths[kTextLen];
+    paint.getTextWidths(kText, kTextLen, widths);
+    for (size_t i = 0; i < kTextLen; ++i) {
+        pos[i].set(x, y);
+        x += widths[i];
+    }
+}
+
+// A blob draws the same pixels as the text it was made of.
+DEF_TEST(TextBlob_MatchesText, reporter) {
+    SkBitmap textBitmap, blobBitmap;
+    textBitmap.allocN32Pixels(160, 48);
+    blobBitmap.allocN32Pixels(160, 48);
+    SkCanvas textCanvas(textBitmap);
+    SkCanvas blobCanvas(blobBitmap);
+
+    SkPaint paint;
+    paint.setColor(SK_ColorBLACK);
+    paint.setTextSize(SkIntToScalar(20));
+
+    SkPoint pos[kTextLen];
+    for (size_t i = 0; i < kTextLen; ++i) {
+        pos[i].set(SkIntToScalar(12 * i) + 3.25f, SkIntToScalar(24 + (i & 1)));
+    }
+
+    for (unsigned flags = 0; flags < 8; ++flags) {
+        set_flags(&paint, flags);
+        for (int align = 0; align < SkPaint::kAlignCount; ++align) {
+            paint.setTextAlign(static_cast<SkPaint::Align>(align));
+
+            SkAutoTUnref<SkTextBlob> posBlob(SkTextBlob::CreatePos(kText, kTextLen, pos, paint));
+            REPORTER_ASSERT(reporter, kTextLen == (size_t)posBlob->count());
+
+            textCanvas.clear(SK_ColorWHITE);
+            textCanvas.drawPosText(kText, kTextLen, pos, paint);
+            blobCanvas.clear(SK_ColorWHITE);
+            blobCanvas.drawTextBlob(posBlob, 0, 0, paint);
+            REPORTER_ASSERT(reporter, equal_pixels(textBitmap, blobBitmap));
+        }
+
+        // drawText() positions the glyphs in device space, so only compare
+        // left aligned text at an integer origin.
+        paint.setTextAlign(SkPaint::kLeft_Align);
+        SkAutoTUnref<SkTextBlob> blob(SkTextBlob::Create(kText, kTextLen, paint));
+        textCanvas.clear(SK_ColorWHITE);
+        textCanvas.drawText(kText, kTextLen, 5, 30, paint);
+        blobCanvas.clear(SK_ColorWHITE);
+        blobCanvas.drawTextBlob(blob, 5, 30, paint);
+        REPORTER_ASSERT(reporter, equal_pixels(textBitmap, blobBitmap));
+    }
+}
+
+// The blob keeps the glyphs of the last strike; drawing with another strike
+// must not use them.
+DEF_TEST(TextBlob_Strikes, reporter) {
+    SkBitmap textBitmap, blobBitmap;
+    textBitmap.allocN32Pixels(160, 96);
+    blobBitmap.allocN32Pixels(160, 96);
+    SkCanvas textCanvas(textBitmap);
+    SkCanvas blobCanvas(blobBitmap);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(16));
+    SkAutoTUnref<SkTextBlob> blob(SkTextBlob::Create(kText, kTextLen, paint));
+
+    // The paint passed to drawTextBlob() does not change the font.
+    SkPaint drawPaint;
+    drawPaint.setColor(SK_ColorBLUE);
+    drawPaint.setTextSize(SkIntToScalar(40));
+    paint.setColor(SK_ColorBLUE);
+
+    SkPoint pos[kTextLen];
+    text_positions(paint, 2, 20, pos);
+
+    const SkScalar scales[] = { SK_Scalar1, 2, SK_Scalar1, 1.5f };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(scales); ++i) {
+        // A blob is positioned once, so like drawPosText() it does not
+        // follow the hinted advances of the scaled font.
+        textCanvas.clear(SK_ColorWHITE);
+        textCanvas.save();
+        textCanvas.scale(scales[i], scales[i]);
+        textCanvas.drawPosText(kText, kTextLen, pos, paint);
+        textCanvas.restore();
+
+        // Twice, the second time with the glyphs of the first.
+        for (int j = 0; j < 2; ++j) {
+            blobCanvas.clear(SK_ColorWHITE);
+            blobCanvas.save();
+            blobCanvas.scale(scales[i], scales[i]);
+            blobCanvas.drawTextBlob(blob, 2, 20, drawPaint);
+            blobCanvas.restore();
+            REPORTER_ASSERT(reporter, equal_pixels(textBitmap, blobBitmap));
+        }
+    }
+}
+
+DEF_TEST(TextBlob_Bounds, reporter) {
+    SkPaint paint;
+    paint.setTextSize(SkIntToScalar(20));
+    SkAutoTUnref<SkTextBlob> blob(SkTextBlob::Create(kText, kTextLen, paint));
+
+    SkRect textBounds;
+    SkScalar width = paint.measureText(kText, kTextLen, &textBounds);
+    REPORTER_ASSERT(reporter, blob->bounds().contains(textBounds));
+
+    paint.setTextAlign(SkPaint::kRight_Align);
+    SkAutoTUnref<SkTextBlob> rightBlob(SkTextBlob::Create(kText, kTextLen, paint));
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(rightBlob->bounds().fLeft,
+                                                  blob->bounds().fLeft - width));
+    REPORTER_ASSERT(reporter, SkScalarNearlyEqual(rightBlob->bounds().fRight,
+                                                  blob->bounds().fRight - width));
+
+    SkAutoTUnref<SkTextBlob> empty(SkTextBlob::Create(kText, 0, paint));
+    REPORTER_ASSERT(reporter, 0 == empty->count());
+    REPORTER_ASSERT(reporter, empty->bounds().isEmpty());
+    REPORTER_ASSERT(reporter, blob->uniqueID() != rightBlob->uniqueID());
+}
+
+// Under a matrix that scales down, hinting may move the glyphs' masks further
+// past the blob's bounds than a unit of the blob; the layer of an image filter
+// must still hold them.
+DEF_TEST(TextBlob_LayerBounds, reporter) {
+    SkBitmap textBitmap, blobBitmap;
+    textBitmap.allocN32Pixels(64, 64);
+    blobBitmap.allocN32Pixels(64, 64);
+    SkCanvas textCanvas(textBitmap);
+    SkCanvas blobCanvas(blobBitmap);
+
+    SkPaint paint;
+    paint.setTextSize(SkIntToScalar(40));
+    paint.setImageFilter(SkOffsetImageFilter::Create(0, 0))->unref();
+    SkPoint pos[kTextLen];
+    text_positions(paint, 0, 0, pos);
+
+    const SkScalar scales[] = { 0.25f, 0.1f };
+    for (int aa = 0; aa < 2; ++aa) {
+        paint.setAntiAlias(SkToBool(aa));
+        SkAutoTUnref<SkTextBlob> blob(SkTextBlob::Create(kText, kTextLen, paint));
+        for (size_t i = 0; i < SK_ARRAY_COUNT(scales); ++i) {
+            const SkScalar scale = scales[i];
+            // step the blob by a tenth of a device pixel
+            for (int step = 0; step < 10; ++step) {
+                const SkScalar x = (20 + step / SkIntToScalar(10)) / scale;
+                const SkScalar y = 30 / scale;
+                SkPoint textPos[kTextLen];
+                for (size_t j = 0; j < kTextLen; ++j) {
+                    textPos[j].set(pos[j].fX + x, pos[j].fY + y);
+                }
+
+                textCanvas.clear(SK_ColorWHITE);
+                textCanvas.save();
+                textCanvas.scale(scale, scale);
+                textCanvas.drawPosText(kText, kTextLen, textPos, paint);
+                textCanvas.restore();
+
+                blobCanvas.clear(SK_ColorWHITE);
+                blobCanvas.save();
+                blobCanvas.scale(scale, scale);
+                blobCanvas.drawTextBlob(blob, x, y, paint);
+                blobCanvas.restore();
+                REPORTER_ASSERT(reporter, equal_pixels(textBitmap, blobBitmap));
+            }
+        }
+    }
+}
+
+DEF_TEST(TextBlob_Record, reporter) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setTextSize(SkIntToScalar(20));
+    SkTextBlob* blob = SkTextBlob::Create(kText, kTextLen, paint);
+
+    SkRecord record;
+    SkRecorder recorder(&record, 160, 48);
+    recorder.drawTextBlob(blob, 4, 30, paint);
+    REPORTER_ASSERT(reporter, 1 == record.count());
+    // The record holds a ref to the blob.
+    blob->unref();
+
+    SkBitmap expected, actual;
+    expected.allocN32Pixels(160, 48);
+    actual.allocN32Pixels(160, 48);
+
+    SkCanvas expectedCanvas(expected);
+    expectedCanvas.clear(SK_ColorWHITE);
+    expectedCanvas.drawText(kText, kTextLen, 4, 30, paint);
+
+    SkCanvas actualCanvas(actual);
+    actualCanvas.clear(SK_ColorWHITE);
+    SkRecordDraw(record, &actualCanvas);
+    REPORTER_ASSERT(reporter, equal_pixels(expected, actual));
+}
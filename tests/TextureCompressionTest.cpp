@@ -6,10 +6,18 @@
  */
 
 #include "SkBitmap.h"
+#include "SkColorPriv.h"
+#include "SkCoreBlitters.h"
 #include "SkData.h"
 #include "SkEndian.h"
 #include "SkImageInfo.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkRandom.h"
+#include "SkRasterClip.h"
+#include "SkScan.h"
 #include "SkTextureCompressor.h"
+#include "SkThreadPool.h"
 #include "Test.h"
 
 static const int kLATCBlockDimension = 4;
@@ -112,3 +120,256 @@ DEF_TEST(CompressLATC, reporter) {
         }
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Reference decoders for the alpha formats, written from the specifications.
+
+static uint8_t decode_r11eac_pixel(const uint8_t* block, int x, int y) {
+    static const int kModifierTable[16][8] = {
+        { -3, -6,  -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 },
+        { -2, -5,  -8, -13, 1, 4, 7, 12 }, { -2, -4,  -6, -13, 1, 3, 5, 12 },
+        { -3, -6,  -8, -12, 2, 5, 7, 11 }, { -3, -7,  -9, -11, 2, 6, 8, 10 },
+        { -4, -7,  -8, -11, 3, 6, 7, 10 }, { -3, -5,  -8, -11, 2, 4, 7, 10 },
+        { -2, -6,  -8, -10, 1, 5, 7,  9 }, { -2, -5,  -8, -10, 1, 4, 7,  9 },
+        { -2, -4,  -8, -10, 1, 3, 7,  9 }, { -2, -5,  -7, -10, 1, 4, 6,  9 },
+        { -3, -4,  -7, -10, 2, 3, 6,  9 }, { -1, -2,  -3, -10, 0, 1, 2,  9 },
+        { -4, -6,  -8,  -9, 3, 5, 7,  8 }, { -3, -5,  -7,  -9, 2, 4, 6,  8 },
+    };
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) {
+        bits = (bits << 8) | block[i];
+    }
+    const int base = static_cast<int>(bits >> 56);
+    const int multiplier = static_cast<int>(bits >> 52) & 0xF;
+    const int table = static_cast<int>(bits >> 48) & 0xF;
+    const int index = static_cast<int>(bits >> (45 - 3 * (4 * x + y))) & 0x7;
+    const int modifier = kModifierTable[table][index];
+    int value = base * 8 + 4 + (multiplier ? modifier * multiplier * 8 : modifier);
+    value = SkPin32(value, 0, 2047);
+    return (value * 255 + 1023) / 2047;
+}
+
+// Decodes the one ASTC block mode that the compressor writes.
+static uint8_t decode_astc12x12_pixel(const uint8_t* block, int s, int t) {
+    const int kWeightsX = 6;
+    const int kWeightsY = 5;
+    uint64_t lo = 0, hi = 0;
+    for (int i = 7; i >= 0; --i) {
+        lo = (lo << 8) | block[i];
+        hi = (hi << 8) | block[8 + i];
+    }
+    #define ASTC_BIT(n) static_cast<int>(((n) < 64 ? lo >> (n) : hi >> ((n) - 64)) & 1)
+    int blockMode = 0;
+    for (int i = 0; i < 11; ++i) {
+        blockMode |= ASTC_BIT(i) << i;
+    }
+    SkASSERT(((2 << 7) | (3 << 5) | (1 << 4) | 3) == blockMode);
+    int e0 = 0, e1 = 0;
+    for (int i = 0; i < 8; ++i) {
+        e0 |= ASTC_BIT(17 + i) << i;
+        e1 |= ASTC_BIT(25 + i) << i;
+    }
+    int weights[kWeightsX * kWeightsY];
+    for (int w = 0; w < kWeightsX * kWeightsY; ++w) {
+        int q = 0;
+        for (int b = 0; b < 3; ++b) {
+            q |= ASTC_BIT(127 - (3 * w + b)) << b;
+        }
+        weights[w] = (q << 3) | q;
+        if (weights[w] > 32) {
+            weights[w] += 1;
+        }
+    }
+    #undef ASTC_BIT
+
+    // Weight infill.
+    const int ds = (1024 + 6) / 11;
+    const int gs = (ds * s * (kWeightsX - 1) + 32) >> 6;
+    const int gt = (ds * t * (kWeightsY - 1) + 32) >> 6;
+    const int js = gs >> 4, fs = gs & 0xF;
+    const int jt = gt >> 4, ft = gt & 0xF;
+    const int w11 = (fs * ft + 8) >> 4;
+    const int w10 = ft - w11;
+    const int w01 = fs - w11;
+    const int w00 = 16 - fs - ft + w11;
+    const int v0 = js + jt * kWeightsX;
+    const int p00 = weights[v0];
+    const int p01 = js + 1 < kWeightsX ? weights[v0 + 1] : 0;
+    const int p10 = jt + 1 < kWeightsY ? weights[v0 + kWeightsX] : 0;
+    const int p11 = js + 1 < kWeightsX && jt + 1 < kWeightsY ? weights[v0 + kWeightsX + 1] : 0;
+    const int weight = (p00 * w00 + p01 * w01 + p10 * w10 + p11 * w11 + 8) >> 4;
+
+    const int c = ((e0 * 257) * (64 - weight) + (e1 * 257) * weight + 32) / 64;
+    return c >> 8;
+}
+
+typedef uint8_t (*DecodePixelProc)(const uint8_t* block, int x, int y);
+
+// Returns the largest difference between the bitmap and its compressed data.
+static int max_error(const SkBitmap& bitmap, const SkData* data, int blockDim, int blockSize,
+                     DecodePixelProc decode) {
+    const uint8_t* blocks = reinterpret_cast<const uint8_t*>(data->data());
+    const int blocksX = bitmap.width() / blockDim;
+    int maxError = 0;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            const uint8_t* block = blocks + ((y / blockDim) * blocksX + x / blockDim) * blockSize;
+            const int decoded = decode(block, x % blockDim, y % blockDim);
+            maxError = SkMax32(maxError, SkAbs32(decoded - *bitmap.getAddr8(x, y)));
+        }
+    }
+    return maxError;
+}
+
+// Smooth gradients, like the edges of antialiased masks, plus some noise.
+static void make_a8_mask(SkBitmap* bitmap, int width, int height) {
+    bitmap->allocPixels(SkImageInfo::MakeA8(width, height));
+    SkRandom rand;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const int value = (x * 255 / (width - 1) + y * 255 / (height - 1)) / 2;
+            *bitmap->getAddr8(x, y) = SkPin32(value + (rand.nextU() & 3), 0, 255);
+        }
+    }
+}
+
+static void test_alpha_format(skiatest::Reporter* reporter, SkTextureCompressor::Format format,
+                              int blockSize, DecodePixelProc decode, int tolerance) {
+    int blockDimX, blockDimY;
+    SkTextureCompressor::GetBlockDimensions(format, &blockDimX, &blockDimY);
+    REPORTER_ASSERT(reporter, blockDimX == blockDimY);
+
+    // Solid blocks must be exact.
+    SkBitmap solid;
+    solid.allocPixels(SkImageInfo::MakeA8(blockDimX, blockDimY));
+    for (int value = 0; value < 256; ++value) {
+        solid.eraseARGB(value, 0, 0, 0);
+        SkAutoDataUnref data(SkTextureCompressor::CompressBitmapToFormat(solid, format));
+        REPORTER_ASSERT(reporter, NULL != data);
+        if (NULL != data && 0 != max_error(solid, data, blockDimX, blockSize, decode)) {
+            ERRORF(reporter, "Format %d: solid %d is not exact", format, value);
+        }
+    }
+
+    SkBitmap bitmap;
+    make_a8_mask(&bitmap, 16 * blockDimX, 8 * blockDimY);
+    SkAutoDataUnref data(SkTextureCompressor::CompressBitmapToFormat(bitmap, format));
+    REPORTER_ASSERT(reporter, NULL != data);
+    if (NULL == data) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, static_cast<size_t>(
+        SkTextureCompressor::GetCompressedDataSize(format, bitmap.width(), bitmap.height())) ==
+        data->size());
+    const int error = max_error(bitmap, data, blockDimX, blockSize, decode);
+    if (error > tolerance) {
+        ERRORF(reporter, "Format %d: error %d is above %d", format, error, tolerance);
+    }
+
+    // Compressing rows of blocks on several threads must give the same data.
+    SkAutoDataUnref threaded(SkTextureCompressor::CompressBitmapToFormat(bitmap, format, 3));
+    REPORTER_ASSERT(reporter, NULL != threaded && threaded->equals(data));
+}
+
+DEF_TEST(CompressR11EAC, reporter) {
+    test_alpha_format(reporter, SkTextureCompressor::kR11_EAC_Format, 8,
+                      decode_r11eac_pixel, 4);
+}
+
+DEF_TEST(CompressASTC, reporter) {
+    test_alpha_format(reporter, SkTextureCompressor::kASTC_12x12_Format, 16,
+                      decode_astc12x12_pixel, 8);
+}
+
+DEF_TEST(CompressETC1, reporter) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(64, 32);
+    SkRandom rand;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            *bitmap.getAddr32(x, y) = SkPackARGB32(0xFF, 4 * x, 8 * y, rand.nextU() & 0xFF);
+        }
+    }
+    const SkTextureCompressor::Format kETC1Format = SkTextureCompressor::kETC1_Format;
+    SkAutoDataUnref data(SkTextureCompressor::CompressBitmapToFormat(bitmap, kETC1Format));
+#ifdef SK_IGNORE_ETC1_SUPPORT
+    REPORTER_ASSERT(reporter, NULL == data);
+#else
+    REPORTER_ASSERT(reporter, NULL != data);
+    if (NULL == data) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, (64 / 4) * (32 / 4) * 8 == data->size());
+    SkAutoDataUnref threaded(SkTextureCompressor::CompressBitmapToFormat(
+        bitmap, kETC1Format, SkThreadPool::kThreadPerCore));
+    REPORTER_ASSERT(reporter, NULL != threaded && threaded->equals(data));
+#endif
+
+    // ETC1 does not compress alpha masks.
+    SkBitmap mask;
+    mask.allocPixels(SkImageInfo::MakeA8(64, 32));
+    SkAutoDataUnref maskData(SkTextureCompressor::CompressBitmapToFormat(mask, kETC1Format));
+    REPORTER_ASSERT(reporter, NULL == maskData);
+}
+
+/**
+ * Compressing the rows of a path as the scan converter blits them must give
+ * the same data as compressing the whole mask afterwards.
+ */
+DEF_TEST(CompressedBlitter, reporter) {
+    static const int kWidth = 96;
+    static const int kHeight = 72;
+    SkPath path;
+    path.addCircle(40, 30, 25);
+    path.addRect(SkRect::MakeLTRB(60, 2, 93, 70));
+    path.moveTo(5, 70);
+    path.lineTo(90, 40);
+    path.lineTo(20, 60);
+    path.close();
+    SkRasterClip clip(SkIRect::MakeWH(kWidth, kHeight));
+
+    SkBitmap mask;
+    mask.allocPixels(SkImageInfo::MakeA8(kWidth, kHeight));
+    mask.eraseColor(0);
+    {
+        SkPaint paint;
+        SkA8_Coverage_Blitter blitter(mask, paint);
+        SkScan::AntiFillPath(path, clip, &blitter);
+    }
+
+    const SkTextureCompressor::Format kFormats[] = {
+        SkTextureCompressor::kLATC_Format,
+        SkTextureCompressor::kR11_EAC_Format,
+        SkTextureCompressor::kASTC_12x12_Format,
+    };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kFormats); ++i) {
+        SkAutoDataUnref expected(SkTextureCompressor::CompressBitmapToFormat(mask, kFormats[i]));
+        REPORTER_ASSERT(reporter, NULL != expected);
+        if (NULL == expected) {
+            continue;
+        }
+
+        SkAutoMalloc storage(expected->size());
+        // Fill with garbage, to check that every block gets written.
+        memset(storage.get(), 0xA5, expected->size());
+        SkBlitter* blitter = SkTextureCompressor::CreateBlitterForFormat(
+            kWidth, kHeight, storage.get(), kFormats[i]);
+        REPORTER_ASSERT(reporter, NULL != blitter);
+        if (NULL == blitter) {
+            continue;
+        }
+        SkScan::AntiFillPath(path, clip, blitter);
+        SkDELETE(blitter);
+
+        if (0 != memcmp(storage.get(), expected->data(), expected->size())) {
+            ERRORF(reporter, "Format %d: the blitter's data does not match", kFormats[i]);
+        }
+    }
+
+    // ETC1 does not compress alpha masks.
+    SkAutoMalloc storage(SkTextureCompressor::GetCompressedDataSize(
+        SkTextureCompressor::kETC1_Format, kWidth, kHeight));
+    REPORTER_ASSERT(reporter, NULL == SkTextureCompressor::CreateBlitterForFormat(
+        kWidth, kHeight, storage.get(), SkTextureCompressor::kETC1_Format));
+}
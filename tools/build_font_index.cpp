@@ -0,0 +1,143 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCommandLineFlags.h"
+#include "SkData.h"
+#include "SkFontIndex.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkTArray.h"
+
+#include <fontconfig/fontconfig.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+DEFINE_string2(output, o, "", "Where to write the index; defaults to $SK_FONT_INDEX_PATH.");
+
+// Builds the font index that SkFontMgr_fontconfig loads, from the fonts
+// fontconfig knows about. Run it when the fonts are installed, and whenever
+// the index has gone stale; until then, the font manager asks fontconfig.
+// return codes:
+static const int kSuccess = 0;
+static const int kMissingOutput = 1;
+static const int kNoFonts = 2;
+static const int kIOError = 3;
+
+// Lists the scalable font files in the order fontconfig prefers them for its
+// default pattern, which is the order fallback tries them in, and the
+// languages each supports.
+static void list_fonts(SkTArray<SkString>* files, SkTArray<SkString>* languages) {
+    FcPattern* pattern = FcPatternCreate();
+    FcConfigSubstitute(NULL, pattern, FcMatchPattern);
+    FcDefaultSubstitute(pattern);
+    FcResult result;
+    FcFontSet* fontSet = FcFontSort(NULL, pattern, FcFalse, NULL, &result);
+    FcPatternDestroy(pattern);
+
+    for (int i = 0; fontSet && i < fontSet->nfont; ++i) {
+        FcPattern* font = fontSet->fonts[i];
+        FcBool scalable;
+        FcChar8* file;
+        if (FcPatternGetBool(font, FC_SCALABLE, 0, &scalable) != FcResultMatch || !scalable ||
+            FcPatternGetString(font, FC_FILE, 0, &file) != FcResultMatch ||
+            0 != access((const char*)file, R_OK)) {
+            continue;
+        }
+        // each face of a collection is listed, but the file is indexed once
+        bool listed = false;
+        for (int j = 0; j < files->count() && !listed; ++j) {
+            listed = (*files)[j].equals((const char*)file);
+        }
+        if (listed) {
+            continue;
+        }
+        files->push_back().set((const char*)file);
+
+        SkString& fileLanguages = languages->push_back();
+        FcLangSet* langSet;
+        if (FcPatternGetLangSet(font, FC_LANG, 0, &langSet) == FcResultMatch) {
+            FcStrSet* langs = FcLangSetGetLangs(langSet);
+            FcStrList* list = FcStrListCreate(langs);
+            while (FcChar8* lang = FcStrListNext(list)) {
+                if (!fileLanguages.isEmpty()) {
+                    fileLanguages.append("|");
+                }
+                fileLanguages.append((const char*)lang);
+            }
+            FcStrListDone(list);
+            FcStrSetDestroy(langs);
+        }
+    }
+    if (fontSet) {
+        FcFontSetDestroy(fontSet);
+    }
+}
+
+static void list_font_directories(SkTArray<SkString>* directories) {
+    FcStrList* dirs = FcConfigGetFontDirs(NULL);
+    while (FcChar8* dir = dirs ? FcStrListNext(dirs) : NULL) {
+        directories->push_back().set((const char*)dir);
+    }
+    if (dirs) {
+        FcStrListDone(dirs);
+    }
+}
+
+int tool_main(int argc, char** argv);
+int tool_main(int argc, char** argv) {
+    SkCommandLineFlags::SetUsage("Builds the font index of SkFontMgr_fontconfig");
+    SkCommandLineFlags::Parse(argc, argv);
+
+    const char* path = FLAGS_output.count() > 0 ? FLAGS_output[0] : getenv("SK_FONT_INDEX_PATH");
+#ifdef SK_FONT_INDEX_PATH
+    if (NULL == path || 0 == *path) {
+        path = SK_FONT_INDEX_PATH;
+    }
+#endif
+    if (NULL == path || 0 == *path) {
+        SkDebugf("Missing output path\n");
+        return kMissingOutput;
+    }
+
+    SkTArray<SkString> files;
+    SkTArray<SkString> languages;
+    SkTArray<SkString> directories;
+    list_fonts(&files, &languages);
+    list_font_directories(&directories);
+
+    SkAutoTUnref<SkData> image(SkFontIndex::Build(files, directories, &languages));
+    if (NULL == image.get()) {
+        SkDebugf("No fonts could be read\n");
+        return kNoFonts;
+    }
+
+    // Write a copy and move it into place, so that a process starting
+    // meanwhile never maps a partly written index.
+    SkString tmpPath;
+    tmpPath.printf("%s.%d", path, getpid());
+    {
+        SkFILEWStream stream(tmpPath.c_str());
+        if (!stream.isValid() || !stream.write(image->data(), image->size())) {
+            SkDebugf("Couldn't write %s\n", tmpPath.c_str());
+            return kIOError;
+        }
+    }
+    if (0 != rename(tmpPath.c_str(), path)) {
+        unlink(tmpPath.c_str());
+        SkDebugf("Couldn't move the index to %s\n", path);
+        return kIOError;
+    }
+    SkDebugf("Indexed %d font files into %s\n", files.count(), path);
+    return kSuccess;
+}
+
+#if !defined SK_BUILD_FOR_IOS
+int main(int argc, char * const argv[]) {
+    return tool_main(argc, (char**) argv);
+}
+#endif